@@ -0,0 +1,178 @@
+#include "coro_http/coro_http_client.hpp"
+#include "bench_server.hpp"
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Loopback suite for comparing asio reactor backends
+ *
+ * The suite is built once per backend: bench_backend follows
+ * CORO_HTTP_WITH_IO_URING, and in an epoll build bench_backend_io_uring is
+ * added when liburing is found, so both run from one build tree. A forked
+ * server answers on loopback, so only the client's reactor is measured.
+ * Per scenario, `connections` coroutines each send `requests` keep-alive
+ * GETs. Reported:
+ *
+ * - requests per second and latency percentiles
+ * - client CPU time per request (user + system, where syscalls show up)
+ * - voluntary context switches per request (reactor wakeups)
+ *
+ * Usage: bench_backend [connections=32] [requests=2000]
+ * Build with -DENABLE_SANITIZER=OFF for meaningful numbers.
+ */
+
+using namespace coro_http;
+using Clock = std::chrono::steady_clock;
+
+#if defined(ASIO_HAS_IO_URING) && defined(ASIO_DISABLE_EPOLL)
+static const char* backend_name = "io_uring";
+#else
+static const char* backend_name = "epoll";
+#endif
+
+struct Scenario {
+    const char* name;
+    const char* path;
+};
+
+static const Scenario scenarios[] = {
+    {"small (128 B)", "/small"},
+    {"medium (16 KiB)", "/medium"},
+    {"large (1 MiB)", "/large"},
+    {"chunked (64 KiB)", "/chunked"},
+};
+
+static std::string chunked_response(size_t size, size_t piece) {
+    std::string response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+    char hex[16];
+    for (size_t sent = 0; sent < size; sent += piece) {
+        size_t n = std::min(piece, size - sent);
+        std::snprintf(hex, sizeof(hex), "%zx\r\n", n);
+        response += hex;
+        response.append(n, 'c');
+        response += "\r\n";
+    }
+    return response + "0\r\n\r\n";
+}
+
+static int run_server(int ready_fd) {
+    asio::io_context io;
+    const std::string small = bench::make_response(200, std::string(128, 's'));
+    const std::string medium = bench::make_response(200, std::string(16 * 1024, 'm'));
+    const std::string large = bench::make_response(200, std::string(1024 * 1024, 'l'));
+    const std::string chunked = chunked_response(64 * 1024, 4096);
+    bench::LocalHttpServer server(io, [&](const bench::ServerRequest& request) -> std::string {
+        if (request.target == "/medium") return medium;
+        if (request.target == "/large") return large;
+        if (request.target == "/chunked") return chunked;
+        if (request.target == "/quit") {
+            asio::post(io, [&io] { io.stop(); });
+            return bench::make_response(200, "");
+        }
+        return small;
+    });
+    server.start();
+    unsigned short port = server.port();
+    if (write(ready_fd, &port, sizeof(port)) != sizeof(port)) return 1;
+    close(ready_fd);
+    io.run();
+    return 0;
+}
+
+static double cpu_seconds(const rusage& usage) {
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+static void run_scenario(const Scenario& scenario, const std::string& base, int connections, int requests) {
+    asio::io_context io;
+    ClientConfig config;
+    config.max_connections_per_host = connections;
+    CoroHttpClient client(io, config);
+    std::string url = base + scenario.path;
+
+    std::vector<long long> latencies;
+    latencies.reserve(static_cast<size_t>(connections) * requests);
+    int failed = 0;
+
+    rusage before{};
+    getrusage(RUSAGE_SELF, &before);
+    auto start = Clock::now();
+    for (int c = 0; c < connections; ++c) {
+        asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+            for (int i = 0; i < requests; ++i) {
+                auto sent = Clock::now();
+                try {
+                    auto response = co_await client.co_get(url);
+                    if (response.status_code() != 200) ++failed;
+                } catch (const std::exception&) {
+                    ++failed;
+                }
+                latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sent).count());
+            }
+        }, asio::detached);
+    }
+    io.run();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    rusage after{};
+    getrusage(RUSAGE_SELF, &after);
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) -> double {
+        if (latencies.empty()) return 0;
+        size_t index = std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+        return latencies[index] / 1e3;
+    };
+    double total = static_cast<double>(latencies.size());
+
+    std::cout << scenario.name << "\n";
+    std::cout << "  requests/s:       " << static_cast<long long>(total / seconds)
+              << (failed ? " (" + std::to_string(failed) + " failed)" : std::string()) << "\n";
+    std::cout << "  latency p50/p99:  " << percentile(0.50) << " / " << percentile(0.99) << " us\n";
+    std::cout << "  CPU per request:  " << (cpu_seconds(after) - cpu_seconds(before)) / total * 1e6 << " us\n";
+    std::cout << "  wakeups/request:  " << (after.ru_nvcsw - before.ru_nvcsw) / total << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    int connections = argc > 1 ? std::atoi(argv[1]) : 32;
+    int requests = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) return 1;
+    pid_t server_pid = fork();
+    if (server_pid == 0) {
+        close(pipe_fds[0]);
+        _exit(run_server(pipe_fds[1]));
+    }
+    close(pipe_fds[1]);
+    unsigned short port = 0;
+    if (read(pipe_fds[0], &port, sizeof(port)) != sizeof(port)) return 1;
+    close(pipe_fds[0]);
+    std::string base = "http://127.0.0.1:" + std::to_string(port);
+
+    std::cout << "=== Backend Benchmark (" << backend_name << ") ===\n";
+    std::cout << connections << " connections x " << requests << " requests\n\n";
+    for (const auto& scenario : scenarios) {
+        run_scenario(scenario, base, connections, requests);
+    }
+
+    // Stop the server
+    asio::io_context io;
+    CoroHttpClient client(io);
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        try {
+            co_await client.co_get(base + "/quit");
+        } catch (const std::exception&) {
+        }
+    }, asio::detached);
+    io.run();
+    waitpid(server_pid, nullptr, 0);
+    return 0;
+}
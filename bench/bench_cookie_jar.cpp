@@ -0,0 +1,121 @@
+#include "coro_http/cookie_jar.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Contention benchmark for the shared cookie jar
+ *
+ * Reader threads build Cookie headers for hosts spread across a jar of
+ * several thousand cookies while one writer applies a Set-Cookie every
+ * 100us. "snapshot" calls the jar directly; "mutex" wraps the same calls
+ * in one lock, as a client would have to without a thread-safe jar.
+ * Snapshot lookups should scale with the number of reader threads without
+ * slowing the writer; under the mutex, readers and writer queue on one lock.
+ *
+ * Build with -DENABLE_SANITIZER=OFF for meaningful numbers.
+ */
+
+using namespace coro_http;
+
+constexpr int domains = 500;
+constexpr int cookies_per_domain = 10;
+
+static void fill(CookieJar& jar) {
+    for (int d = 0; d < domains; ++d) {
+        std::string domain = "site" + std::to_string(d) + ".example.com";
+        for (int c = 0; c < cookies_per_domain; ++c) {
+            std::string path = c % 2 ? "/" : "/api";
+            jar.set("c" + std::to_string(c), "value" + std::to_string(c), domain, path);
+        }
+    }
+}
+
+struct ContentionResult {
+    double lookups_per_second{0};
+    double writes_per_second{0};
+};
+
+template<typename Lookup>
+ContentionResult run_scenario(int threads, std::chrono::milliseconds duration, Lookup lookup, CookieJar& jar,
+                    std::mutex* lock) {
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> total{0};
+    size_t writes = 0;
+
+    std::thread writer([&] {
+        int i = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            std::string header = "w=" + std::to_string(i) + "; Path=/";
+            std::string host = "site" + std::to_string(i % domains) + ".example.com";
+            if (lock) {
+                std::lock_guard<std::mutex> guard(*lock);
+                jar.parse_set_cookie(header, host);
+            } else {
+                jar.parse_set_cookie(header, host);
+            }
+            ++i;
+            ++writes;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < threads; ++t) {
+        readers.emplace_back([&, t] {
+            size_t ops = 0;
+            size_t bytes = 0;
+            int d = t * 7;
+            while (!stop.load(std::memory_order_relaxed)) {
+                std::string host = "www.site" + std::to_string(d++ % domains) + ".example.com";
+                bytes += lookup(host).size();
+                ++ops;
+            }
+            total.fetch_add(ops + (bytes == 0), std::memory_order_relaxed);
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto& reader : readers) reader.join();
+    writer.join();
+    double seconds = duration.count() / 1000.0;
+    return {total.load() / seconds, writes / seconds};
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency());
+    if (max_threads < 1) max_threads = 1;
+    auto duration = std::chrono::milliseconds(500);
+
+    std::cout << "=== Cookie Jar Contention Benchmark ===\n";
+    std::cout << domains * cookies_per_domain << " cookies across " << domains << " domains\n\n";
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        CookieJar snapshot_jar;
+        fill(snapshot_jar);
+        auto snapshot = run_scenario(threads, duration, [&](const std::string& host) {
+            return snapshot_jar.get_cookies_for_request(host, "/api/items", true);
+        }, snapshot_jar, nullptr);
+
+        CookieJar locked_jar;
+        fill(locked_jar);
+        std::mutex lock;
+        auto locked = run_scenario(threads, duration, [&](const std::string& host) {
+            std::lock_guard<std::mutex> guard(lock);
+            return locked_jar.get_cookies_for_request(host, "/api/items", true);
+        }, locked_jar, &lock);
+
+        std::cout << "threads=" << threads
+                  << "  snapshot lookups/s=" << static_cast<size_t>(snapshot.lookups_per_second)
+                  << " writes/s=" << static_cast<size_t>(snapshot.writes_per_second)
+                  << "  mutex lookups/s=" << static_cast<size_t>(locked.lookups_per_second)
+                  << " writes/s=" << static_cast<size_t>(locked.writes_per_second) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,361 @@
+#pragma once
+
+#include <asio.hpp>
+#include <asio/ssl.hpp>
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/use_awaitable.hpp>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <unistd.h>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace coro_http::bench {
+
+// Minimal HTTP/1.1 server used by the benchmarks to keep measurements on
+// loopback, independent of network conditions.
+
+struct ServerRequest {
+    std::string method;
+    std::string target;
+    std::map<std::string, std::string> headers;  // lower-cased names
+    std::string body;
+
+    std::string header(const std::string& name) const {
+        auto it = headers.find(name);
+        return it != headers.end() ? it->second : "";
+    }
+};
+
+// Handler returns the complete raw response (status line, headers and body)
+using ServerHandler = std::function<std::string(const ServerRequest&)>;
+
+inline std::string make_response(int status, const std::string& body,
+                                 const std::string& extra_headers = "") {
+    std::string response = "HTTP/1.1 " + std::to_string(status) + " OK\r\n";
+    response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    response += extra_headers;
+    response += "\r\n";
+    response += body;
+    return response;
+}
+
+// Server context with a fresh self-signed P-256 certificate; clients of the
+// TLS benchmarks run with verify_ssl off
+inline std::unique_ptr<asio::ssl::context> make_self_signed_context() {
+    auto context = std::make_unique<asio::ssl::context>(asio::ssl::context::tls_server);
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("127.0.0.1"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+    SSL_CTX_use_certificate(context->native_handle(), cert);
+    SSL_CTX_use_PrivateKey(context->native_handle(), key);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    return context;
+}
+
+class LocalHttpServer {
+public:
+    LocalHttpServer(asio::io_context& io_context, ServerHandler handler)
+        : acceptor_(io_context, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0)),
+          handler_(std::move(handler)) {}
+
+    unsigned short port() const {
+        return acceptor_.local_endpoint().port();
+    }
+
+    std::string url(const std::string& path = "/") const {
+        return "http://127.0.0.1:" + std::to_string(port()) + path;
+    }
+
+    void start() {
+        asio::co_spawn(acceptor_.get_executor(), co_accept(), asio::detached);
+    }
+
+    // Also serve TLS on a second loopback port, with the same handler.
+    // `context` must outlive the server.
+    void listen_tls(asio::ssl::context& context) {
+        tls_context_ = &context;
+        tls_acceptor_ = std::make_unique<asio::ip::tcp::acceptor>(
+            acceptor_.get_executor(), asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+        asio::co_spawn(acceptor_.get_executor(), co_accept_tls(), asio::detached);
+    }
+
+    std::string tls_url(const std::string& path = "/") const {
+        return "https://127.0.0.1:" + std::to_string(tls_acceptor_->local_endpoint().port()) + path;
+    }
+
+    // Also serve on a Unix domain socket at `path`, with the same handler
+    void listen_unix(const std::string& path) {
+        ::unlink(path.c_str());
+        unix_acceptor_ = std::make_unique<asio::local::stream_protocol::acceptor>(
+            acceptor_.get_executor(), asio::local::stream_protocol::endpoint(path));
+        asio::co_spawn(acceptor_.get_executor(), co_accept_unix(), asio::detached);
+    }
+
+    void stop() {
+        asio::error_code ec;
+        acceptor_.close(ec);
+        if (unix_acceptor_) unix_acceptor_->close(ec);
+        if (tls_acceptor_) tls_acceptor_->close(ec);
+    }
+
+private:
+    asio::awaitable<void> co_accept() {
+        while (acceptor_.is_open()) {
+            auto [ec, socket] = co_await acceptor_.async_accept(asio::as_tuple(asio::use_awaitable));
+            if (ec) break;
+            asio::ip::tcp::no_delay no_delay(true);
+            socket.set_option(no_delay, ec);
+            asio::co_spawn(acceptor_.get_executor(), co_session(std::move(socket)), asio::detached);
+        }
+    }
+
+    asio::awaitable<void> co_accept_unix() {
+        while (unix_acceptor_->is_open()) {
+            auto [ec, socket] = co_await unix_acceptor_->async_accept(asio::as_tuple(asio::use_awaitable));
+            if (ec) break;
+            asio::co_spawn(acceptor_.get_executor(), co_session(std::move(socket)), asio::detached);
+        }
+    }
+
+    asio::awaitable<void> co_accept_tls() {
+        while (tls_acceptor_->is_open()) {
+            auto [ec, socket] = co_await tls_acceptor_->async_accept(asio::as_tuple(asio::use_awaitable));
+            if (ec) break;
+            asio::ip::tcp::no_delay no_delay(true);
+            socket.set_option(no_delay, ec);
+            asio::co_spawn(acceptor_.get_executor(), co_tls_session(std::move(socket)), asio::detached);
+        }
+    }
+
+    asio::awaitable<void> co_tls_session(asio::ip::tcp::socket socket) {
+        asio::ssl::stream<asio::ip::tcp::socket> stream(std::move(socket), *tls_context_);
+        auto [ec] = co_await stream.async_handshake(asio::ssl::stream_base::server, asio::as_tuple(asio::use_awaitable));
+        if (ec) co_return;
+        co_await co_session(std::move(stream));
+    }
+
+    template<typename Stream>
+    asio::awaitable<void> co_session(Stream socket) {
+        std::string buffer;
+        char chunk[8192];
+
+        while (true) {
+            size_t header_end;
+            while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                auto [ec, len] = co_await socket.async_read_some(
+                    asio::buffer(chunk), asio::as_tuple(asio::use_awaitable));
+                if (ec || len == 0) co_return;
+                buffer.append(chunk, len);
+            }
+
+            ServerRequest request = parse_head(buffer.substr(0, header_end));
+            buffer.erase(0, header_end + 4);
+
+            if (request.header("transfer-encoding") == "chunked") {
+                // Body sizes are hex lines; a zero-size chunk ends the body
+                while (true) {
+                    size_t line_end;
+                    while ((line_end = buffer.find("\r\n")) == std::string::npos) {
+                        auto [ec, len] = co_await socket.async_read_some(
+                            asio::buffer(chunk), asio::as_tuple(asio::use_awaitable));
+                        if (ec || len == 0) co_return;
+                        buffer.append(chunk, len);
+                    }
+                    size_t chunk_size = std::stoull(buffer.substr(0, line_end), nullptr, 16);
+                    size_t needed = line_end + 2 + chunk_size + 2;
+                    while (buffer.size() < needed) {
+                        auto [ec, len] = co_await socket.async_read_some(
+                            asio::buffer(chunk), asio::as_tuple(asio::use_awaitable));
+                        if (ec || len == 0) co_return;
+                        buffer.append(chunk, len);
+                    }
+                    request.body.append(buffer, line_end + 2, chunk_size);
+                    buffer.erase(0, needed);
+                    if (chunk_size == 0) break;
+                }
+            }
+
+            size_t content_length = 0;
+            std::string cl = request.header("content-length");
+            if (!cl.empty()) content_length = std::stoull(cl);
+            while (buffer.size() < content_length) {
+                auto [ec, len] = co_await socket.async_read_some(
+                    asio::buffer(chunk), asio::as_tuple(asio::use_awaitable));
+                if (ec || len == 0) co_return;
+                buffer.append(chunk, len);
+            }
+            if (content_length > 0) {
+                request.body = buffer.substr(0, content_length);
+                buffer.erase(0, content_length);
+            }
+
+            std::string response = handler_(request);
+            auto [wec, wlen] = co_await asio::async_write(
+                socket, asio::buffer(response), asio::as_tuple(asio::use_awaitable));
+            if (wec) co_return;
+
+            if (request.header("connection") == "close") {
+                asio::error_code ec;
+                socket.lowest_layer().shutdown(asio::socket_base::shutdown_both, ec);
+                co_return;
+            }
+        }
+    }
+
+    static ServerRequest parse_head(const std::string& head) {
+        ServerRequest request;
+        size_t line_end = head.find("\r\n");
+        std::string request_line = head.substr(0, line_end);
+        size_t sp1 = request_line.find(' ');
+        size_t sp2 = request_line.find(' ', sp1 + 1);
+        request.method = request_line.substr(0, sp1);
+        request.target = request_line.substr(sp1 + 1, sp2 - sp1 - 1);
+
+        size_t pos = (line_end == std::string::npos) ? head.size() : line_end + 2;
+        while (pos < head.size()) {
+            size_t end = head.find("\r\n", pos);
+            if (end == std::string::npos) end = head.size();
+            std::string line = head.substr(pos, end - pos);
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                std::string name = line.substr(0, colon);
+                for (auto& c : name) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                size_t value_start = line.find_first_not_of(" \t", colon + 1);
+                request.headers[name] = value_start == std::string::npos ? "" : line.substr(value_start);
+            }
+            pos = end + 2;
+        }
+        return request;
+    }
+
+    asio::ip::tcp::acceptor acceptor_;
+    std::unique_ptr<asio::local::stream_protocol::acceptor> unix_acceptor_;
+    std::unique_ptr<asio::ip::tcp::acceptor> tls_acceptor_;
+    asio::ssl::context* tls_context_{nullptr};
+    ServerHandler handler_;
+};
+
+// SSE server for the streaming benchmarks: answers every request with an
+// event stream, holds the connection open and writes each broadcast event to
+// every stream. Writes to one connection are queued, never interleaved.
+class LocalEventServer {
+public:
+    explicit LocalEventServer(asio::io_context& io_context)
+        : acceptor_(io_context, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0)) {}
+
+    unsigned short port() const {
+        return acceptor_.local_endpoint().port();
+    }
+
+    std::string url(const std::string& path = "/") const {
+        return "http://127.0.0.1:" + std::to_string(port()) + path;
+    }
+
+    void start() {
+        asio::co_spawn(acceptor_.get_executor(), co_accept(), asio::detached);
+    }
+
+    // Stop accepting and close every stream
+    void stop() {
+        asio::error_code ec;
+        acceptor_.close(ec);
+        for (auto& connection : connections_) {
+            connection->socket.close(ec);
+        }
+        connections_.clear();
+    }
+
+    // Streams currently open
+    size_t connections() const {
+        return connections_.size();
+    }
+
+    // Write a complete event, including its blank line, to every stream
+    void broadcast(const std::string& event) {
+        for (auto& connection : connections_) {
+            connection->outbox += event;
+            if (!connection->writing) {
+                asio::co_spawn(acceptor_.get_executor(), co_flush(connection), asio::detached);
+            }
+        }
+    }
+
+private:
+    struct Connection {
+        explicit Connection(asio::ip::tcp::socket s) : socket(std::move(s)) {}
+        asio::ip::tcp::socket socket;
+        std::string outbox;
+        bool writing{false};
+    };
+
+    asio::awaitable<void> co_accept() {
+        while (acceptor_.is_open()) {
+            auto [ec, socket] = co_await acceptor_.async_accept(asio::as_tuple(asio::use_awaitable));
+            if (ec) break;
+            asio::ip::tcp::no_delay no_delay(true);
+            socket.set_option(no_delay, ec);
+            auto connection = std::make_shared<Connection>(std::move(socket));
+            asio::co_spawn(acceptor_.get_executor(), co_session(connection), asio::detached);
+        }
+    }
+
+    asio::awaitable<void> co_session(std::shared_ptr<Connection> connection) {
+        std::string buffer;
+        char chunk[1024];
+        while (buffer.find("\r\n\r\n") == std::string::npos) {
+            auto [ec, len] = co_await connection->socket.async_read_some(
+                asio::buffer(chunk), asio::as_tuple(asio::use_awaitable));
+            if (ec || len == 0) co_return;
+            buffer.append(chunk, len);
+        }
+
+        connection->outbox = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                             "Cache-Control: no-cache\r\n\r\n";
+        co_await co_flush(connection);
+        connections_.push_back(connection);
+
+        // Wait for the client to go away
+        auto [ec, len] = co_await connection->socket.async_read_some(
+            asio::buffer(chunk), asio::as_tuple(asio::use_awaitable));
+        auto it = std::find(connections_.begin(), connections_.end(), connection);
+        if (it != connections_.end()) {
+            std::swap(*it, connections_.back());
+            connections_.pop_back();
+        }
+    }
+
+    asio::awaitable<void> co_flush(std::shared_ptr<Connection> connection) {
+        connection->writing = true;
+        std::string sending;
+        while (!connection->outbox.empty()) {
+            sending.swap(connection->outbox);
+            auto [ec, len] = co_await asio::async_write(
+                connection->socket, asio::buffer(sending), asio::as_tuple(asio::use_awaitable));
+            sending.clear();
+            if (ec) {
+                connection->outbox.clear();
+                break;
+            }
+        }
+        connection->writing = false;
+    }
+
+    asio::ip::tcp::acceptor acceptor_;
+    std::vector<std::shared_ptr<Connection>> connections_;
+};
+
+}
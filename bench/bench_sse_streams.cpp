@@ -0,0 +1,174 @@
+#include "coro_http/coro_http_client.hpp"
+#include "bench_server.hpp"
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Concurrent SSE streams on one thread
+ *
+ * A forked event server accepts N streams, then broadcasts one event per
+ * interval to all of them; each event carries its send time. The client
+ * holds every stream on a single io_context thread, each consumed through
+ * open_event_stream by its own coroutine. Reported:
+ *
+ * - client memory per stream, from the RSS growth once every stream is open
+ *   (the server runs in its own process and is not counted)
+ * - delivery latency from broadcast to the consumer's next(), which
+ *   includes fanning the event out to all N connections
+ *
+ * Usage: bench_sse_streams [streams=10000] [events=10] [block|drop_oldest|coalesce]
+ * Build with -DENABLE_SANITIZER=OFF for meaningful numbers.
+ */
+
+using namespace coro_http;
+using Clock = std::chrono::steady_clock;
+
+static long rss_kib() {
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static long long now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// Raise the descriptor limit as far as allowed and return it
+static size_t raise_fd_limit() {
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    getrlimit(RLIMIT_NOFILE, &limit);
+    return static_cast<size_t>(limit.rlim_cur);
+}
+
+// Server process: wait for every stream, broadcast, then close them all.
+// steady_clock is system-wide on Linux, so send times compare across processes.
+static int run_server(int ready_fd, int streams, int events, std::chrono::milliseconds interval) {
+    asio::io_context io;
+    bench::LocalEventServer server(io);
+    server.start();
+    unsigned short port = server.port();
+    if (write(ready_fd, &port, sizeof(port)) != sizeof(port)) return 1;
+    close(ready_fd);
+
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        asio::steady_timer timer(io);
+        while (server.connections() < static_cast<size_t>(streams)) {
+            timer.expires_after(std::chrono::milliseconds(10));
+            co_await timer.async_wait(asio::use_awaitable);
+        }
+        for (int i = 0; i < events; ++i) {
+            timer.expires_after(interval);
+            co_await timer.async_wait(asio::use_awaitable);
+            server.broadcast("id: " + std::to_string(i) + "\ndata: " + std::to_string(now_ns()) + "\n\n");
+        }
+        timer.expires_after(interval);
+        co_await timer.async_wait(asio::use_awaitable);
+        server.stop();
+    }, asio::detached);
+    io.run();
+    return 0;
+}
+
+static SseOverflowPolicy parse_policy(const std::string& name) {
+    if (name == "drop_oldest") return SseOverflowPolicy::drop_oldest;
+    if (name == "coalesce") return SseOverflowPolicy::coalesce;
+    return SseOverflowPolicy::block;
+}
+
+int main(int argc, char* argv[]) {
+    int streams = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int events = argc > 2 ? std::atoi(argv[2]) : 10;
+    std::string policy_name = argc > 3 ? argv[3] : "block";
+    auto interval = std::chrono::milliseconds(200);
+
+    size_t fd_limit = raise_fd_limit();
+    if (static_cast<size_t>(streams) + 64 > fd_limit) {
+        streams = static_cast<int>(fd_limit) - 64;
+        std::cout << "Descriptor limit " << fd_limit << ": using " << streams << " streams\n";
+    }
+
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) return 1;
+    pid_t server_pid = fork();
+    if (server_pid == 0) {
+        close(pipe_fds[0]);
+        _exit(run_server(pipe_fds[1], streams, events, interval));
+    }
+    close(pipe_fds[1]);
+    unsigned short port = 0;
+    if (read(pipe_fds[0], &port, sizeof(port)) != sizeof(port)) return 1;
+    close(pipe_fds[0]);
+
+    std::cout << "=== SSE Streams Benchmark ===\n";
+    std::cout << streams << " streams, " << events << " events each, policy " << policy_name << "\n\n";
+
+    asio::io_context io;
+    CoroHttpClient client(io);
+    std::string url = "http://127.0.0.1:" + std::to_string(port) + "/events";
+    SseChannelOptions options{16, parse_policy(policy_name)};
+
+    std::vector<long long> latencies;
+    latencies.reserve(static_cast<size_t>(streams) * events);
+    int opened = 0;
+    int failed = 0;
+    long rss_before = rss_kib();
+    long rss_open = 0;
+    auto start = Clock::now();
+    Clock::duration connect_time{};
+
+    for (int i = 0; i < streams; ++i) {
+        asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+            try {
+                auto stream = client.open_event_stream(HttpRequest(HttpMethod::GET, url), options);
+                bool first = true;
+                while (auto event = co_await stream.next()) {
+                    latencies.push_back(now_ns() - std::stoll(event->data));
+                    if (first && ++opened == streams) {
+                        // Every stream is connected and has its first event
+                        rss_open = rss_kib();
+                        connect_time = Clock::now() - start;
+                    }
+                    first = false;
+                }
+            } catch (const std::exception&) {
+                ++failed;
+            }
+        }, asio::detached);
+    }
+    io.run();
+    auto elapsed = Clock::now() - start;
+    waitpid(server_pid, nullptr, 0);
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) -> double {
+        if (latencies.empty()) return 0;
+        size_t index = std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+        return latencies[index] / 1e6;
+    };
+
+    std::cout << "streams opened:     " << opened << " (" << failed << " failed)\n";
+    std::cout << "events delivered:   " << latencies.size() << "\n";
+    std::cout << "all streams live:   "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(connect_time).count() << " ms\n";
+    if (opened > 0 && rss_open > 0) {
+        std::cout << "memory per stream:  " << (rss_open - rss_before) * 1024 / opened << " bytes\n";
+    }
+    std::cout << "latency p50:        " << percentile(0.50) << " ms\n";
+    std::cout << "latency p99:        " << percentile(0.99) << " ms\n";
+    std::cout << "latency max:        " << percentile(1.0) << " ms\n";
+    std::cout << "total time:         "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms\n";
+    return failed == 0 ? 0 : 1;
+}
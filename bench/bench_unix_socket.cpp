@@ -0,0 +1,165 @@
+#include "coro_http/coro_http_client.hpp"
+#include "coro_http/form_data.hpp"
+#include "bench_server.hpp"
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * TCP loopback vs. Unix domain socket
+ *
+ * A forked server answers the same handler on 127.0.0.1 and on a Unix
+ * socket, the way a local sidecar would. Each scenario runs once per
+ * transport: `connections` coroutines each send `requests` keep-alive
+ * requests through the pool. Reported per transport:
+ *
+ * - requests per second and latency percentiles
+ * - client CPU time per request (user + system)
+ *
+ * Usage: bench_unix_socket [connections=16] [requests=2000]
+ * Build with -DENABLE_SANITIZER=OFF for meaningful numbers.
+ */
+
+using namespace coro_http;
+using Clock = std::chrono::steady_clock;
+
+struct Scenario {
+    const char* name;
+    const char* path;
+    size_t upload;  // Request body bytes; 0 sends a GET
+};
+
+static const Scenario scenarios[] = {
+    {"small (128 B)", "/small", 0},
+    {"medium (16 KiB)", "/medium", 0},
+    {"large (1 MiB)", "/large", 0},
+    {"upload (64 KiB)", "/upload", 64 * 1024},
+};
+
+static int run_server(int ready_fd, const std::string& socket_path) {
+    asio::io_context io;
+    const std::string small = bench::make_response(200, std::string(128, 's'));
+    const std::string medium = bench::make_response(200, std::string(16 * 1024, 'm'));
+    const std::string large = bench::make_response(200, std::string(1024 * 1024, 'l'));
+    bench::LocalHttpServer server(io, [&](const bench::ServerRequest& request) -> std::string {
+        if (request.target == "/medium") return medium;
+        if (request.target == "/large") return large;
+        if (request.target == "/quit") {
+            asio::post(io, [&io] { io.stop(); });
+            return bench::make_response(200, "");
+        }
+        return small;
+    });
+    server.start();
+    server.listen_unix(socket_path);
+    unsigned short port = server.port();
+    if (write(ready_fd, &port, sizeof(port)) != sizeof(port)) return 1;
+    close(ready_fd);
+    io.run();
+    ::unlink(socket_path.c_str());
+    return 0;
+}
+
+static double cpu_seconds(const rusage& usage) {
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+static void run_transport(const char* transport, const Scenario& scenario, const std::string& base,
+                          int connections, int requests) {
+    asio::io_context io;
+    ClientConfig config;
+    config.max_connections_per_host = connections;
+    CoroHttpClient client(io, config);
+    std::string url = base + scenario.path;
+    std::string body(scenario.upload, 'u');
+
+    std::vector<long long> latencies;
+    latencies.reserve(static_cast<size_t>(connections) * requests);
+    int failed = 0;
+
+    rusage before{};
+    getrusage(RUSAGE_SELF, &before);
+    auto start = Clock::now();
+    for (int c = 0; c < connections; ++c) {
+        asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+            for (int i = 0; i < requests; ++i) {
+                auto sent = Clock::now();
+                try {
+                    HttpRequest request(body.empty() ? HttpMethod::GET : HttpMethod::POST, url);
+                    request.set_body(body);
+                    auto response = co_await client.co_execute(std::move(request));
+                    if (response.status_code() != 200) ++failed;
+                } catch (const std::exception&) {
+                    ++failed;
+                }
+                latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sent).count());
+            }
+        }, asio::detached);
+    }
+    io.run();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    rusage after{};
+    getrusage(RUSAGE_SELF, &after);
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) -> double {
+        if (latencies.empty()) return 0;
+        size_t index = std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+        return latencies[index] / 1e3;
+    };
+    double total = static_cast<double>(latencies.size());
+
+    std::cout << "  " << transport << "\n";
+    std::cout << "    requests/s:       " << static_cast<long long>(total / seconds)
+              << (failed ? " (" + std::to_string(failed) + " failed)" : std::string()) << "\n";
+    std::cout << "    latency p50/p99:  " << percentile(0.50) << " / " << percentile(0.99) << " us\n";
+    std::cout << "    CPU per request:  " << (cpu_seconds(after) - cpu_seconds(before)) / total * 1e6 << " us\n";
+}
+
+int main(int argc, char* argv[]) {
+    int connections = argc > 1 ? std::atoi(argv[1]) : 16;
+    int requests = argc > 2 ? std::atoi(argv[2]) : 2000;
+    std::string socket_path = "/tmp/bench_unix_socket_" + std::to_string(getpid()) + ".sock";
+
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) return 1;
+    pid_t server_pid = fork();
+    if (server_pid == 0) {
+        close(pipe_fds[0]);
+        _exit(run_server(pipe_fds[1], socket_path));
+    }
+    close(pipe_fds[1]);
+    unsigned short port = 0;
+    if (read(pipe_fds[0], &port, sizeof(port)) != sizeof(port)) return 1;
+    close(pipe_fds[0]);
+    std::string tcp_base = "http://127.0.0.1:" + std::to_string(port);
+    std::string unix_base = "http+unix://" + url_encode(socket_path);
+
+    std::cout << "=== TCP Loopback vs. Unix Socket Benchmark ===\n";
+    std::cout << connections << " connections x " << requests << " requests\n\n";
+    for (const auto& scenario : scenarios) {
+        std::cout << scenario.name << "\n";
+        run_transport("tcp loopback", scenario, tcp_base, connections, requests);
+        run_transport("unix socket", scenario, unix_base, connections, requests);
+    }
+
+    // Stop the server
+    asio::io_context io;
+    CoroHttpClient client(io);
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        try {
+            co_await client.co_get(unix_base + "/quit");
+        } catch (const std::exception&) {
+        }
+    }, asio::detached);
+    io.run();
+    waitpid(server_pid, nullptr, 0);
+    return 0;
+}
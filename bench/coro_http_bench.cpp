@@ -0,0 +1,372 @@
+#include "coro_http/coro_http_client.hpp"
+#include "bench_server.hpp"
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * End-to-end loopback benchmark suite
+ *
+ * An embedded HTTP/1.1 and TLS server runs on its own thread; the client
+ * runs on the main thread, so the allocation and CPU figures below count
+ * the client only. Per scenario, `connections` coroutines each send
+ * `requests` requests after a short warm-up. Scenarios:
+ *
+ * - http_pooled / http_unpooled: keep-alive pool vs. a connection per request
+ * - http_server_close: pool on, but the server answers Connection: close
+ * - https_pooled / https_unpooled: the same over TLS (handshake per request)
+ * - chunked: 64 KiB responses in 4 KiB chunks
+ * - gzip: 64 KiB JSON responses, gzip-encoded
+ * - large: 4 MiB responses
+ * - many_hosts: requests spread over 32 servers, so 32 pool keys
+ * - sse: events per second and delivery latency over `connections` streams
+ *
+ * Reported: requests per second, latency p50/p99/p999, heap allocations
+ * and CPU time per request. --json writes the same figures to a file for
+ * tracking regressions between builds.
+ *
+ * Usage: coro_http_bench [--connections N] [--requests N] [--only NAME] [--json FILE]
+ * Build with -DENABLE_SANITIZER=OFF for meaningful numbers.
+ */
+
+namespace {
+thread_local size_t t_allocations = 0;
+}
+
+void* operator new(std::size_t size) {
+    ++t_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using namespace coro_http;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    int connections{8};
+    int requests{2000};
+    std::string only;
+    std::string json_path;
+};
+
+struct Result {
+    std::string name;
+    size_t requests{0};
+    int failed{0};
+    double seconds{0};
+    std::vector<long long> latencies;  // Nanoseconds, sorted
+    size_t allocations{0};
+    double cpu_seconds{0};
+
+    double percentile_us(double p) const {
+        if (latencies.empty()) return 0;
+        size_t index = std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+        return latencies[index] / 1e3;
+    }
+};
+
+static double thread_cpu_seconds() {
+    rusage usage{};
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+// Counters of the client thread between start() and stop()
+class Meter {
+public:
+    void start() {
+        allocations_ = t_allocations;
+        cpu_ = thread_cpu_seconds();
+        started_ = Clock::now();
+    }
+
+    void stop(Result& result) {
+        result.seconds = std::chrono::duration<double>(Clock::now() - started_).count();
+        result.allocations = t_allocations - allocations_;
+        result.cpu_seconds = thread_cpu_seconds() - cpu_;
+        std::sort(result.latencies.begin(), result.latencies.end());
+    }
+
+private:
+    size_t allocations_{0};
+    double cpu_{0};
+    Clock::time_point started_;
+};
+
+// Server side: every listener runs on one io_context on its own thread
+class Servers {
+public:
+    Servers() : work_(asio::make_work_guard(io_)), tls_context_(bench::make_self_signed_context()) {
+        small_ = bench::make_response(200, std::string(128, 's'), "Content-Type: application/json\r\n");
+        closing_ = bench::make_response(200, std::string(128, 's'), "Connection: close\r\n");
+        large_ = bench::make_response(200, std::string(4 * 1024 * 1024, 'l'));
+
+        chunked_ = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+        for (int i = 0; i < 16; ++i) {
+            chunked_ += "1000\r\n" + std::string(4096, 'c') + "\r\n";
+        }
+        chunked_ += "0\r\n\r\n";
+
+        std::string json = "[";
+        while (json.size() < 64 * 1024) {
+            json += "{\"id\":" + std::to_string(json.size()) + ",\"name\":\"item\",\"tags\":[\"a\",\"b\"]},";
+        }
+        json.back() = ']';
+        std::string gzipped;
+        auto encoder = make_content_encoder("gzip", 6);
+        encoder->write(json, gzipped);
+        encoder->finish(gzipped);
+        gzip_ = bench::make_response(200, gzipped, "Content-Encoding: gzip\r\nContent-Type: application/json\r\n");
+
+        auto handler = [this](const bench::ServerRequest& request) -> std::string {
+            if (request.target == "/close") return closing_;
+            if (request.target == "/chunked") return chunked_;
+            if (request.target == "/gzip") return gzip_;
+            if (request.target == "/large") return large_;
+            return small_;
+        };
+        for (int i = 0; i < 32; ++i) {
+            servers_.push_back(std::make_unique<bench::LocalHttpServer>(io_, handler));
+            servers_.back()->start();
+        }
+        servers_.front()->listen_tls(*tls_context_);
+        events_ = std::make_unique<bench::LocalEventServer>(io_);
+        events_->start();
+        thread_ = std::thread([this] { io_.run(); });
+    }
+
+    ~Servers() {
+        asio::post(io_, [this] {
+            for (auto& server : servers_) server->stop();
+            events_->stop();
+            work_.reset();
+        });
+        thread_.join();
+    }
+
+    std::string url(const std::string& path, size_t server = 0) const { return servers_[server]->url(path); }
+    std::string tls_url(const std::string& path) const { return servers_.front()->tls_url(path); }
+    std::string events_url() const { return events_->url("/events"); }
+    size_t count() const { return servers_.size(); }
+
+    // Send `events` events to `streams` streams once all of them are open.
+    // Each event carries its send time, so the client can measure delivery.
+    void broadcast_when_open(size_t streams, int events) {
+        asio::co_spawn(io_, [this, streams, events]() -> asio::awaitable<void> {
+            asio::steady_timer timer(io_);
+            while (events_->connections() < streams) {
+                timer.expires_after(std::chrono::milliseconds(1));
+                co_await timer.async_wait(asio::use_awaitable);
+            }
+            for (int i = 0; i < events; ++i) {
+                auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch());
+                events_->broadcast("data: " + std::to_string(now.count()) + "\n\n");
+                if (i % 32 == 31) {
+                    // Let queued writes go out before queueing more
+                    co_await asio::post(io_, asio::use_awaitable);
+                }
+            }
+        }, asio::detached);
+    }
+
+private:
+    asio::io_context io_;
+    asio::executor_work_guard<asio::io_context::executor_type> work_;
+    std::unique_ptr<asio::ssl::context> tls_context_;
+    std::string small_, closing_, large_, chunked_, gzip_;
+    std::vector<std::unique_ptr<bench::LocalHttpServer>> servers_;
+    std::unique_ptr<bench::LocalEventServer> events_;
+    std::thread thread_;
+};
+
+// `connections` coroutines each send `requests` GETs, cycling through `urls`
+static Result run_requests(const std::string& name, const ClientConfig& config,
+                           const std::vector<std::string>& urls, const Options& options) {
+    asio::io_context io;
+    CoroHttpClient client(io, config);
+    Result result;
+    result.name = name;
+    result.latencies.reserve(static_cast<size_t>(options.connections) * options.requests);
+    int warmup = std::max(1, options.requests / 20);
+
+    Meter meter;
+    int warming = options.connections;
+    for (int c = 0; c < options.connections; ++c) {
+        asio::co_spawn(io, [&, c]() -> asio::awaitable<void> {
+            size_t next = static_cast<size_t>(c);
+            for (int i = 0; i < warmup; ++i) {
+                try {
+                    co_await client.co_get(urls[next++ % urls.size()]);
+                } catch (const std::exception&) {
+                }
+            }
+            // Start measuring once every connection is warm
+            if (--warming == 0) meter.start();
+            asio::steady_timer gate(io);
+            while (warming > 0) {
+                gate.expires_after(std::chrono::microseconds(100));
+                co_await gate.async_wait(asio::use_awaitable);
+            }
+            for (int i = 0; i < options.requests; ++i) {
+                auto sent = Clock::now();
+                try {
+                    auto response = co_await client.co_get(urls[next++ % urls.size()]);
+                    if (response.status_code() != 200) ++result.failed;
+                } catch (const std::exception&) {
+                    ++result.failed;
+                }
+                result.latencies.push_back(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sent).count());
+            }
+        }, asio::detached);
+    }
+    io.run();
+    meter.stop(result);
+    result.requests = result.latencies.size();
+    return result;
+}
+
+// `connections` event streams; latency is from the server's write to delivery
+static Result run_events(Servers& servers, const Options& options) {
+    asio::io_context io;
+    CoroHttpClient client(io);
+    Result result;
+    result.name = "sse";
+    result.latencies.reserve(static_cast<size_t>(options.connections) * options.requests);
+
+    Meter meter;
+    meter.start();
+    servers.broadcast_when_open(static_cast<size_t>(options.connections), options.requests);
+    for (int c = 0; c < options.connections; ++c) {
+        asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+            auto stream = client.open_event_stream(HttpRequest(HttpMethod::GET, servers.events_url()));
+            for (int i = 0; i < options.requests; ++i) {
+                auto event = co_await stream.next();
+                if (!event) {
+                    result.failed += options.requests - i;
+                    break;
+                }
+                auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch());
+                result.latencies.push_back(now.count() - std::stoll(event->data));
+            }
+            stream.close();
+        }, asio::detached);
+    }
+    io.run();
+    meter.stop(result);
+    result.requests = result.latencies.size();
+    return result;
+}
+
+static void print(const Result& r) {
+    double n = r.requests ? static_cast<double>(r.requests) : 1;
+    std::printf("%-18s %10.0f %10.1f %10.1f %10.1f %10.1f %10.1f%s\n", r.name.c_str(), r.requests / r.seconds,
+                r.percentile_us(0.50), r.percentile_us(0.99), r.percentile_us(0.999), r.allocations / n,
+                r.cpu_seconds / n * 1e6, r.failed ? ("  (" + std::to_string(r.failed) + " failed)").c_str() : "");
+}
+
+static std::string to_json(const std::vector<Result>& results, const Options& options) {
+    std::ostringstream out;
+    out << "{\n  \"connections\": " << options.connections << ",\n  \"requests\": " << options.requests
+        << ",\n  \"scenarios\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double n = r.requests ? static_cast<double>(r.requests) : 1;
+        out << "    {\"name\": \"" << r.name << "\", \"requests\": " << r.requests << ", \"failed\": " << r.failed
+            << ", \"requests_per_second\": " << r.requests / r.seconds
+            << ", \"latency_us\": {\"p50\": " << r.percentile_us(0.50) << ", \"p99\": " << r.percentile_us(0.99)
+            << ", \"p999\": " << r.percentile_us(0.999) << "}"
+            << ", \"allocations_per_request\": " << r.allocations / n
+            << ", \"cpu_us_per_request\": " << r.cpu_seconds / n * 1e6 << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+static Options parse_options(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--connections") options.connections = std::atoi(argv[i + 1]);
+        else if (flag == "--requests") options.requests = std::atoi(argv[i + 1]);
+        else if (flag == "--only") options.only = argv[i + 1];
+        else if (flag == "--json") options.json_path = argv[i + 1];
+    }
+    return options;
+}
+
+int main(int argc, char* argv[]) {
+    Options options = parse_options(argc, argv);
+    Servers servers;
+
+    ClientConfig pooled;
+    pooled.max_connections_per_host = options.connections;
+    ClientConfig unpooled = pooled;
+    unpooled.enable_connection_pool = false;
+    ClientConfig insecure = pooled;
+    insecure.verify_ssl = false;
+    ClientConfig insecure_unpooled = insecure;
+    insecure_unpooled.enable_connection_pool = false;
+
+    std::vector<std::string> many_hosts;
+    for (size_t i = 0; i < servers.count(); ++i) {
+        many_hosts.push_back(servers.url("/small", i));
+    }
+
+    struct Scenario {
+        const char* name;
+        std::function<Result()> run;
+    };
+    std::vector<Scenario> scenarios = {
+        {"http_pooled", [&] { return run_requests("http_pooled", pooled, {servers.url("/small")}, options); }},
+        {"http_unpooled", [&] { return run_requests("http_unpooled", unpooled, {servers.url("/small")}, options); }},
+        {"http_server_close", [&] { return run_requests("http_server_close", pooled, {servers.url("/close")}, options); }},
+        {"https_pooled", [&] { return run_requests("https_pooled", insecure, {servers.tls_url("/small")}, options); }},
+        {"https_unpooled", [&] {
+            return run_requests("https_unpooled", insecure_unpooled, {servers.tls_url("/small")}, options);
+        }},
+        {"chunked", [&] { return run_requests("chunked", pooled, {servers.url("/chunked")}, options); }},
+        {"gzip", [&] { return run_requests("gzip", pooled, {servers.url("/gzip")}, options); }},
+        {"large", [&] {
+            Options fewer = options;
+            fewer.requests = std::max(1, options.requests / 20);
+            return run_requests("large", pooled, {servers.url("/large")}, fewer);
+        }},
+        {"many_hosts", [&] { return run_requests("many_hosts", pooled, many_hosts, options); }},
+        {"sse", [&] { return run_events(servers, options); }},
+    };
+
+    std::cout << "=== coro_http Loopback Benchmark ===\n";
+    std::cout << options.connections << " connections x " << options.requests << " requests\n\n";
+    std::printf("%-18s %10s %10s %10s %10s %10s %10s\n", "scenario", "req/s", "p50 us", "p99 us", "p999 us",
+                "allocs/req", "CPU us/req");
+
+    std::vector<Result> results;
+    for (const auto& scenario : scenarios) {
+        if (!options.only.empty() && options.only != scenario.name) continue;
+        results.push_back(scenario.run());
+        print(results.back());
+        std::fflush(stdout);
+    }
+
+    if (!options.json_path.empty()) {
+        std::ofstream(options.json_path) << to_json(results, options);
+        std::cout << "\nWrote " << options.json_path << "\n";
+    }
+    return 0;
+}
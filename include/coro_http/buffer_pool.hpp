@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace coro_http {
+
+// Per-thread free list of fixed-size I/O buffers.
+// Coroutines hold a PooledBuffer instead of an inline std::array so their
+// frames stay small enough for asio's recycling frame allocator, and the
+// read buffers themselves are reused across requests instead of malloc'd.
+class BufferPool {
+public:
+    static constexpr std::size_t buffer_size = 8192;
+    static constexpr std::size_t max_cached_buffers = 32;
+
+    BufferPool() = default;
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    ~BufferPool() {
+        for (char* block : free_list_) {
+            delete[] block;
+        }
+    }
+
+    // Pool owned by the calling thread
+    static BufferPool& local() {
+        thread_local BufferPool pool;
+        return pool;
+    }
+
+    char* acquire() {
+        if (!free_list_.empty()) {
+            char* block = free_list_.back();
+            free_list_.pop_back();
+            return block;
+        }
+        return new char[buffer_size];
+    }
+
+    // Blocks may be released on a different thread than they were acquired on
+    // (coroutines can resume anywhere on a multi-threaded io_context).
+    void release(char* block) {
+        if (!block) return;
+        if (free_list_.size() < max_cached_buffers) {
+            free_list_.push_back(block);
+        } else {
+            delete[] block;
+        }
+    }
+
+    std::size_t cached() const {
+        return free_list_.size();
+    }
+
+private:
+    std::vector<char*> free_list_;
+};
+
+// RAII handle to a BufferPool block
+class PooledBuffer {
+public:
+    PooledBuffer() : data_(BufferPool::local().acquire()) {}
+
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    PooledBuffer(PooledBuffer&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)) {}
+
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept {
+        if (this != &other) {
+            BufferPool::local().release(data_);
+            data_ = std::exchange(other.data_, nullptr);
+        }
+        return *this;
+    }
+
+    ~PooledBuffer() {
+        BufferPool::local().release(data_);
+    }
+
+    char* data() { return data_; }
+    const char* data() const { return data_; }
+    static constexpr std::size_t size() { return BufferPool::buffer_size; }
+
+private:
+    char* data_;
+};
+
+}
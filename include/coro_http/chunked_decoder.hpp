@@ -1,36 +1,199 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
 #include <string>
-#include <sstream>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace coro_http {
 
-inline std::string decode_chunked(const std::string& data) {
-    std::istringstream stream(data);
-    std::string result;
-    std::string line;
-    
-    while (std::getline(stream, line)) {
-        if (line.back() == '\r') line.pop_back();
-        
-        if (line.empty()) continue;
-        
-        size_t chunk_size = 0;
-        try {
-            chunk_size = std::stoul(line, nullptr, 16);
-        } catch (...) {
-            break;
+// Resumable decoder for Transfer-Encoding: chunked.
+// Input is fed as it arrives off the wire, in pieces of any size. Chunk data
+// is handed to the callback as spans into the caller's buffer, so nothing is
+// copied until the caller decides where the body goes. feed() stops at the
+// exact end of the message and reports how many bytes it consumed, so bytes
+// belonging to whatever follows on the connection are never swallowed.
+class ChunkedDecoder {
+public:
+    // Bound on a size, extension or trailer line; longer lines are rejected
+    static constexpr size_t max_line_length = 8192;
+
+    // Consume input, calling on_data(std::string_view) for each piece of chunk
+    // data. Returns the number of bytes consumed, which is less than
+    // input.size() only when the message ended inside this input.
+    template<typename OnData>
+    size_t feed(std::string_view input, OnData&& on_data) {
+        size_t pos = 0;
+        while (pos < input.size() && state_ != State::Done) {
+            if (state_ == State::Data) {
+                size_t take = std::min(remaining_, input.size() - pos);
+                on_data(input.substr(pos, take));
+                pos += take;
+                remaining_ -= take;
+                if (remaining_ == 0) state_ = State::DataEnd;
+                continue;
+            }
+
+            char c = input[pos++];
+            switch (state_) {
+                case State::Size:
+                    if (int digit = hex_value(c); digit >= 0) {
+                        if (chunk_size_ > (SIZE_MAX >> 4)) {
+                            throw std::runtime_error("Chunk size overflow");
+                        }
+                        chunk_size_ = (chunk_size_ << 4) | static_cast<size_t>(digit);
+                        ++size_digits_;
+                    } else if (size_digits_ == 0) {
+                        // Stray empty lines before a size line are skipped
+                        if (c != '\r' && c != '\n') throw std::runtime_error("Invalid chunk size");
+                    } else if (c == ';' || c == ' ' || c == '\t') {
+                        extensions_.clear();
+                        state_ = State::Extension;
+                    } else if (c == '\r') {
+                        extensions_.clear();
+                        state_ = State::SizeLF;
+                    } else if (c == '\n') {
+                        extensions_.clear();
+                        end_size_line();
+                    } else {
+                        throw std::runtime_error("Invalid chunk size");
+                    }
+                    break;
+
+                case State::Extension:
+                    if (c == '\r') {
+                        state_ = State::SizeLF;
+                    } else if (c == '\n') {
+                        end_size_line();
+                    } else {
+                        append_bounded(extensions_, c);
+                    }
+                    break;
+
+                case State::SizeLF:
+                    if (c != '\n') throw std::runtime_error("Malformed chunk size line");
+                    end_size_line();
+                    break;
+
+                case State::DataEnd:
+                    // CRLF after chunk data; a bare LF is tolerated
+                    if (c == '\r') {
+                        state_ = State::DataLF;
+                    } else if (c == '\n') {
+                        start_chunk();
+                    } else {
+                        throw std::runtime_error("Missing CRLF after chunk data");
+                    }
+                    break;
+
+                case State::DataLF:
+                    if (c != '\n') throw std::runtime_error("Missing CRLF after chunk data");
+                    start_chunk();
+                    break;
+
+                case State::Trailer:
+                    if (c == '\n') {
+                        end_trailer_line();
+                    } else if (c != '\r') {
+                        append_bounded(line_, c);
+                    }
+                    break;
+
+                case State::Data:
+                case State::Done:
+                    break;
+            }
+        }
+        return pos;
+    }
+
+    // True once the last chunk and the trailer section have been consumed
+    bool done() const {
+        return state_ == State::Done;
+    }
+
+    // Raw extensions of the most recent chunk (text after ';'), if any
+    const std::string& extensions() const {
+        return extensions_;
+    }
+
+    // Trailer fields received after the last chunk
+    const std::vector<std::pair<std::string, std::string>>& trailers() const {
+        return trailers_;
+    }
+
+    void reset() {
+        *this = ChunkedDecoder();
+    }
+
+private:
+    enum class State { Size, Extension, SizeLF, Data, DataEnd, DataLF, Trailer, Done };
+
+    static int hex_value(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    static void append_bounded(std::string& line, char c) {
+        if (line.size() >= max_line_length) {
+            throw std::runtime_error("Chunked line too long");
+        }
+        line.push_back(c);
+    }
+
+    void end_size_line() {
+        if (chunk_size_ == 0) {
+            state_ = State::Trailer;
+        } else {
+            remaining_ = chunk_size_;
+            state_ = State::Data;
+        }
+    }
+
+    void start_chunk() {
+        chunk_size_ = 0;
+        size_digits_ = 0;
+        state_ = State::Size;
+    }
+
+    void end_trailer_line() {
+        if (line_.empty()) {
+            state_ = State::Done;
+            return;
+        }
+        size_t colon = line_.find(':');
+        if (colon != std::string::npos) {
+            size_t value_start = line_.find_first_not_of(" \t", colon + 1);
+            size_t value_end = line_.find_last_not_of(" \t");
+            trailers_.emplace_back(line_.substr(0, colon),
+                value_start == std::string::npos
+                    ? std::string() : line_.substr(value_start, value_end - value_start + 1));
         }
-        
-        if (chunk_size == 0) break;
-        
-        std::string chunk_data(chunk_size, '\0');
-        stream.read(&chunk_data[0], chunk_size);
-        result.append(chunk_data);
-        
-        std::getline(stream, line);
-    }
-    
+        line_.clear();
+    }
+
+    State state_ = State::Size;
+    size_t chunk_size_ = 0;
+    size_t size_digits_ = 0;
+    size_t remaining_ = 0;
+    std::string extensions_;
+    std::string line_;
+    std::vector<std::pair<std::string, std::string>> trailers_;
+};
+
+// Decode a complete chunked body. A truncated body yields the data decoded
+// so far; malformed framing throws.
+inline std::string decode_chunked(std::string_view data) {
+    std::string result;
+    result.reserve(data.size());
+    ChunkedDecoder decoder;
+    decoder.feed(data, [&](std::string_view span) { result.append(span); });
     return result;
 }
 
@@ -1,10 +1,19 @@
 #pragma once
 
+#include "socket_options.hpp"
 #include <chrono>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace coro_http {
 
+// One proxy of a weighted proxy set
+struct ProxyServer {
+    std::string url;                   // As for proxy_url
+    unsigned weight{1};                // Relative share of requests
+};
+
 struct ClientConfig {
     std::chrono::milliseconds connect_timeout{30000};
     std::chrono::milliseconds read_timeout{30000};
@@ -12,9 +21,17 @@ struct ClientConfig {
     
     bool follow_redirects{true};
     int max_redirects{10};
+    size_t redirect_cache_size{256};   // Permanent redirects remembered and applied before sending (0 = off)
     
     bool enable_compression{true};
     
+    // Request body compression ("gzip", "zstd"; empty = off)
+    std::string request_compression;
+    int request_compression_level{0};                  // 0 = codec default
+    size_t request_compression_min_size{1024};         // smaller bodies are sent as-is
+    size_t request_compression_stream_threshold{256 * 1024};  // larger bodies are streamed chunked
+    std::map<std::string, std::string> request_compression_hosts;  // host -> encoding override
+    
     bool verify_ssl{false};
     std::string ca_cert_file;
     std::string ca_cert_path;
@@ -22,11 +39,25 @@ struct ClientConfig {
     std::string proxy_url;
     std::string proxy_username;
     std::string proxy_password;
+    bool socks5_pipelining{false};     // Send SOCKS5 greeting, auth and CONNECT in one write (proxy must accept early data)
+    std::vector<ProxyServer> proxies;  // Weighted proxy set, chosen from per request (proxy_url joins it with weight 1)
+    std::string no_proxy;              // Hosts that go direct: "*", "example.com", ".internal", "10.0.0.0/8", comma separated
+    int proxy_max_failures{3};         // Consecutive transport failures before a proxy is ejected
+    std::chrono::milliseconds proxy_probe_interval{5000};  // Between health probes of an ejected proxy
     
     bool enable_connection_pool{true};
     int max_connections_per_host{5};
     std::chrono::seconds connection_idle_timeout{60};
     
+    // Socket tuning for every connection opened, overridden per host
+    // (the host connected to, which is the proxy when one is used)
+    SocketOptions socket_options;
+    std::map<std::string, SocketOptions> socket_options_hosts;
+    
+    // Hosts served on a Unix domain socket: plain http:// requests to the
+    // host connect to the socket path instead, bypassing any proxy
+    std::map<std::string, std::string> unix_sockets;
+    
     // Rate limiting settings
     bool enable_rate_limit{false};
     int rate_limit_requests{100};      // requests per window
@@ -44,6 +75,31 @@ struct ClientConfig {
     
     // Cookie settings
     bool enable_cookies{false};        // Enable automatic cookie management
+    
+    // HTTP cache settings (RFC 9111, GET responses only)
+    bool enable_cache{false};          // Serve fresh responses from memory, revalidate stale ones
+    size_t cache_max_bytes{64 * 1024 * 1024};  // Total size of cached responses
+    size_t cache_shards{16};           // Independently locked partitions
+    std::string cache_directory;       // Persist entries here across restarts (empty = memory only)
+    size_t cache_disk_max_bytes{1024ull * 1024 * 1024};  // On-disk budget, evicted oldest segment first
+    
+    // Request coalescing (GET only)
+    bool enable_request_coalescing{false};  // Identical concurrent GETs share one fetch
+    std::chrono::milliseconds coalescing_max_wait{30000};  // Waiters fetch on their own after this
+    
+    // Warm-start state
+    bool enable_dns_cache{false};      // Reuse resolved endpoints for dns_cache_ttl
+    std::chrono::seconds dns_cache_ttl{60};
+    bool enable_tls_session_cache{false};  // Resume TLS sessions per host
+    std::string state_snapshot_path;   // Load cookies, DNS entries and TLS sessions from here and save them back (empty = off)
+    std::chrono::milliseconds state_snapshot_interval{60000};  // Background save period
+    
+    // Server-Sent Events
+    bool sse_reconnect{false};         // Resume dropped streams with Last-Event-ID
+    std::chrono::milliseconds sse_retry_delay{100};        // Reconnect delay until the server sends retry:
+    std::chrono::milliseconds sse_max_retry_delay{30000};  // Backoff cap while reconnects fail
+    int sse_max_reconnect_attempts{10};  // Consecutive failed attempts before giving up (0 = never)
+    std::chrono::milliseconds sse_idle_timeout{0};  // Silence after which a stream is dead (0 = read_timeout)
 };
 
 }
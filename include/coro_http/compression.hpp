@@ -1,71 +1,511 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <zlib.h>
 #include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#if defined(CORO_HTTP_HAS_LIBDEFLATE)
+#include <libdeflate.h>
+#endif
+
+#if defined(CORO_HTTP_HAS_ZSTD)
+#include <zstd.h>
+#endif
+
+#if defined(CORO_HTTP_HAS_BROTLI)
+#include <brotli/decode.h>
+#endif
 
 namespace coro_http {
 
-inline std::string decompress_gzip(const std::string& compressed_data) {
+// zlib container used by the gzip and deflate content codings
+enum class ZlibFormat {
+    Gzip,
+    Deflate
+};
+
+// Incremental decoder for one Content-Encoding
+class ContentDecoder {
+public:
+    virtual ~ContentDecoder() = default;
+
+    // Decode the next piece of input, appending the result to `out`
+    virtual void write(std::string_view input, std::string& out) = 0;
+
+    // True once the end of the encoded stream has been seen
+    virtual bool done() const = 0;
+
+    // Throws if the encoded stream ended early
+    void finish() const {
+        if (!done()) {
+            throw std::runtime_error("Truncated compressed data");
+        }
+    }
+};
+
+// Incremental encoder for one Content-Encoding
+class ContentEncoder {
+public:
+    virtual ~ContentEncoder() = default;
+
+    // Encode the next piece of input, appending any output to `out`
+    virtual void write(std::string_view input, std::string& out) = 0;
+
+    // Flush buffered input and append the end of the encoded stream
+    virtual void finish(std::string& out) = 0;
+};
+
+namespace detail {
+
+// Upper bound of the DEFLATE expansion ratio; size hints beyond it are bogus
+constexpr size_t max_inflate_ratio = 1032;
+
+// Output size recorded in the gzip ISIZE trailer (uncompressed size mod 2^32),
+// or 0 when the trailer is missing or implausible for the input size.
+inline size_t gzip_size_hint(std::string_view data) {
+    if (data.size() < 18) return 0;
+    const auto* p = reinterpret_cast<const unsigned char*>(data.data() + data.size() - 4);
+    size_t isize = static_cast<uint32_t>(p[0]) |
+                   (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) |
+                   (static_cast<uint32_t>(p[3]) << 24);
+    if (isize > data.size() * max_inflate_ratio) return 0;
+    return isize;
+}
+
+// One spare byte past an exact hint lets the trailer be consumed in the same pass
+inline size_t initial_output_size(std::string_view data, size_t size_hint) {
+    if (size_hint > 0) return size_hint + 1;
+    return std::max<size_t>(data.size() * 4, 1024);
+}
+
+// One-shot zlib inflate straight into the output string, grown geometrically
+inline std::string inflate_oneshot(std::string_view data, int window_bits,
+                                   size_t size_hint, const char* format) {
     z_stream stream{};
-    stream.avail_in = compressed_data.size();
-    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed_data.data()));
-    
-    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
-        throw std::runtime_error("Failed to initialize gzip decompression");
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+
+    if (inflateInit2(&stream, window_bits) != Z_OK) {
+        throw std::runtime_error(std::string("Failed to initialize ") + format + " decompression");
     }
-    
-    std::string decompressed;
-    char buffer[32768];
-    
+
+    std::string decompressed(initial_output_size(data, size_hint), '\0');
+
     int ret;
     do {
-        stream.avail_out = sizeof(buffer);
-        stream.next_out = reinterpret_cast<Bytef*>(buffer);
-        
+        if (stream.total_out == decompressed.size()) {
+            decompressed.resize(decompressed.size() * 2);
+        }
+        size_t available = decompressed.size() - stream.total_out;
+        stream.next_out = reinterpret_cast<Bytef*>(&decompressed[stream.total_out]);
+        stream.avail_out = static_cast<uInt>(std::min<size_t>(available, std::numeric_limits<uInt>::max()));
+
         ret = inflate(&stream, Z_NO_FLUSH);
         if (ret != Z_OK && ret != Z_STREAM_END) {
             inflateEnd(&stream);
-            throw std::runtime_error("Failed to decompress gzip data");
+            throw std::runtime_error(std::string("Failed to decompress ") + format + " data");
         }
-        
-        size_t have = sizeof(buffer) - stream.avail_out;
-        decompressed.append(buffer, have);
     } while (ret != Z_STREAM_END);
-    
+
+    decompressed.resize(stream.total_out);
     inflateEnd(&stream);
     return decompressed;
 }
 
-inline std::string decompress_deflate(const std::string& compressed_data) {
-    z_stream stream{};
-    stream.avail_in = compressed_data.size();
-    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed_data.data()));
-    
-    if (inflateInit(&stream) != Z_OK) {
-        throw std::runtime_error("Failed to initialize deflate decompression");
+#if defined(CORO_HTTP_HAS_LIBDEFLATE)
+// One decompressor per thread; libdeflate decompressors are not thread-safe
+inline libdeflate_decompressor* thread_decompressor() {
+    struct Holder {
+        libdeflate_decompressor* decompressor{libdeflate_alloc_decompressor()};
+        ~Holder() { libdeflate_free_decompressor(decompressor); }
+    };
+    thread_local Holder holder;
+    return holder.decompressor;
+}
+
+using libdeflate_fn = libdeflate_result (*)(libdeflate_decompressor*, const void*, size_t,
+                                            void*, size_t, size_t*);
+
+// Returns false when libdeflate cannot handle the input (e.g. multi-member
+// gzip) so the caller can fall back to zlib.
+inline bool libdeflate_oneshot(libdeflate_fn decompress, std::string_view data,
+                               size_t size_hint, std::string& out) {
+    libdeflate_decompressor* decompressor = thread_decompressor();
+    if (!decompressor) return false;
+
+    size_t capacity = initial_output_size(data, size_hint);
+    const size_t max_capacity = std::max<size_t>(data.size() * max_inflate_ratio, capacity);
+
+    while (true) {
+        out.resize(capacity);
+        size_t actual = 0;
+        libdeflate_result result = decompress(decompressor, data.data(), data.size(),
+                                              out.data(), out.size(), &actual);
+        if (result == LIBDEFLATE_SUCCESS) {
+            out.resize(actual);
+            return true;
+        }
+        if (result != LIBDEFLATE_INSUFFICIENT_SPACE || capacity >= max_capacity) {
+            return false;
+        }
+        capacity = std::min(capacity * 2, max_capacity);
     }
-    
+}
+#endif
+
+}
+
+// One-shot decompression, used when the whole body is in memory.
+// The output is presized from the gzip ISIZE trailer.
+inline std::string decompress_gzip(std::string_view compressed_data) {
+    size_t size_hint = detail::gzip_size_hint(compressed_data);
+#if defined(CORO_HTTP_HAS_LIBDEFLATE)
     std::string decompressed;
-    char buffer[32768];
-    
-    int ret;
-    do {
-        stream.avail_out = sizeof(buffer);
-        stream.next_out = reinterpret_cast<Bytef*>(buffer);
-        
-        ret = inflate(&stream, Z_NO_FLUSH);
-        if (ret != Z_OK && ret != Z_STREAM_END) {
-            inflateEnd(&stream);
-            throw std::runtime_error("Failed to decompress deflate data");
+    if (detail::libdeflate_oneshot(libdeflate_gzip_decompress, compressed_data, size_hint, decompressed)) {
+        return decompressed;
+    }
+#endif
+    return detail::inflate_oneshot(compressed_data, 16 + MAX_WBITS, size_hint, "gzip");
+}
+
+inline std::string decompress_deflate(std::string_view compressed_data) {
+#if defined(CORO_HTTP_HAS_LIBDEFLATE)
+    std::string decompressed;
+    if (detail::libdeflate_oneshot(libdeflate_zlib_decompress, compressed_data, 0, decompressed)) {
+        return decompressed;
+    }
+#endif
+    return detail::inflate_oneshot(compressed_data, MAX_WBITS, 0, "deflate");
+}
+
+// Incremental inflater for bodies that arrive in pieces.
+// Each write() decompresses as much as the given input allows and appends
+// the output, so nothing has to wait for the complete compressed body.
+class StreamingInflater : public ContentDecoder {
+public:
+    using Format = ZlibFormat;
+
+    explicit StreamingInflater(Format format) : format_(format) {
+        int window_bits = (format_ == Format::Gzip) ? 16 + MAX_WBITS : MAX_WBITS;
+        if (inflateInit2(&stream_, window_bits) != Z_OK) {
+            throw std::runtime_error("Failed to initialize streaming decompression");
         }
-        
-        size_t have = sizeof(buffer) - stream.avail_out;
-        decompressed.append(buffer, have);
-    } while (ret != Z_STREAM_END);
-    
-    inflateEnd(&stream);
+    }
+
+    StreamingInflater(const StreamingInflater&) = delete;
+    StreamingInflater& operator=(const StreamingInflater&) = delete;
+
+    ~StreamingInflater() {
+        inflateEnd(&stream_);
+    }
+
+    void write(std::string_view input, std::string& out) override {
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream_.avail_in = static_cast<uInt>(input.size());
+
+        // Keep going while input remains or the last pass filled the output,
+        // since inflate may still hold pending output in that case.
+        bool output_full = false;
+        while ((stream_.avail_in > 0 || output_full) && !done_) {
+            size_t old_size = out.size();
+            size_t grow = std::max<size_t>(stream_.avail_in * 4, 16384);
+            out.resize(old_size + grow);
+
+            stream_.next_out = reinterpret_cast<Bytef*>(&out[old_size]);
+            stream_.avail_out = static_cast<uInt>(grow);
+
+            int ret = inflate(&stream_, Z_NO_FLUSH);
+            output_full = (stream_.avail_out == 0);
+            out.resize(old_size + (grow - stream_.avail_out));
+
+            if (ret == Z_STREAM_END) {
+                done_ = true;
+            } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                throw std::runtime_error("Failed to decompress streamed data");
+            } else if (ret == Z_BUF_ERROR && stream_.avail_out != 0) {
+                break;  // Needs more input
+            }
+        }
+    }
+
+    bool done() const override {
+        return done_;
+    }
+
+    // Reuse the inflate state for another body
+    void reset() {
+        inflateReset(&stream_);
+        done_ = false;
+    }
+
+private:
+    Format format_;
+    z_stream stream_{};
+    bool done_{false};
+};
+
+// Incremental gzip/deflate encoder for request bodies
+class StreamingDeflater : public ContentEncoder {
+public:
+    using Format = ZlibFormat;
+
+    // level 0 selects zlib's default compression level
+    StreamingDeflater(Format format, int level) {
+        int window_bits = (format == Format::Gzip) ? 16 + MAX_WBITS : MAX_WBITS;
+        if (level == 0) level = Z_DEFAULT_COMPRESSION;
+        if (deflateInit2(&stream_, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("Failed to initialize compression");
+        }
+    }
+
+    StreamingDeflater(const StreamingDeflater&) = delete;
+    StreamingDeflater& operator=(const StreamingDeflater&) = delete;
+
+    ~StreamingDeflater() {
+        deflateEnd(&stream_);
+    }
+
+    void write(std::string_view input, std::string& out) override {
+        run(input, Z_NO_FLUSH, out);
+    }
+
+    void finish(std::string& out) override {
+        run({}, Z_FINISH, out);
+    }
+
+private:
+    void run(std::string_view input, int flush, std::string& out) {
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream_.avail_in = static_cast<uInt>(input.size());
+
+        int ret;
+        do {
+            size_t old_size = out.size();
+            size_t grow = std::max<size_t>(stream_.avail_in / 2, 16384);
+            out.resize(old_size + grow);
+
+            stream_.next_out = reinterpret_cast<Bytef*>(&out[old_size]);
+            stream_.avail_out = static_cast<uInt>(grow);
+
+            ret = deflate(&stream_, flush);
+            out.resize(old_size + (grow - stream_.avail_out));
+
+            if (ret == Z_STREAM_ERROR) {
+                throw std::runtime_error("Failed to compress data");
+            }
+        } while (flush == Z_FINISH ? ret != Z_STREAM_END : stream_.avail_out == 0);
+    }
+
+    z_stream stream_{};
+};
+
+#if defined(CORO_HTTP_HAS_ZSTD)
+// Incremental zstd decoder
+class StreamingZstdDecoder : public ContentDecoder {
+public:
+    StreamingZstdDecoder() : dctx_(ZSTD_createDCtx()) {
+        if (!dctx_) {
+            throw std::runtime_error("Failed to initialize zstd decompression");
+        }
+    }
+
+    StreamingZstdDecoder(const StreamingZstdDecoder&) = delete;
+    StreamingZstdDecoder& operator=(const StreamingZstdDecoder&) = delete;
+
+    ~StreamingZstdDecoder() {
+        ZSTD_freeDCtx(dctx_);
+    }
+
+    void write(std::string_view input, std::string& out) override {
+        ZSTD_inBuffer in{input.data(), input.size(), 0};
+
+        bool output_full = false;
+        while (in.pos < in.size || output_full) {
+            size_t old_size = out.size();
+            size_t grow = std::max<size_t>((in.size - in.pos) * 4, ZSTD_DStreamOutSize());
+            out.resize(old_size + grow);
+
+            ZSTD_outBuffer output{&out[old_size], grow, 0};
+            size_t ret = ZSTD_decompressStream(dctx_, &output, &in);
+            output_full = (output.pos == output.size);
+            out.resize(old_size + output.pos);
+
+            if (ZSTD_isError(ret)) {
+                throw std::runtime_error("Failed to decompress zstd data");
+            }
+            // A body may hold several concatenated frames; it is complete
+            // only while the last one seen has ended
+            done_ = (ret == 0);
+        }
+    }
+
+    bool done() const override {
+        return done_;
+    }
+
+private:
+    ZSTD_DCtx* dctx_;
+    bool done_{false};
+};
+
+// One-shot zstd decode of one or more concatenated frames, presized from
+// their content sizes when every frame declares one
+inline std::string decompress_zstd(std::string_view compressed_data) {
+    unsigned long long content_size = 0;
+    for (std::string_view rest = compressed_data; !rest.empty() && content_size != ZSTD_CONTENTSIZE_UNKNOWN;) {
+        unsigned long long frame_size = ZSTD_getFrameContentSize(rest.data(), rest.size());
+        size_t frame_length = ZSTD_findFrameCompressedSize(rest.data(), rest.size());
+        if (frame_size == ZSTD_CONTENTSIZE_UNKNOWN || frame_size == ZSTD_CONTENTSIZE_ERROR ||
+            ZSTD_isError(frame_length)) {
+            content_size = ZSTD_CONTENTSIZE_UNKNOWN;
+        } else {
+            content_size += frame_size;
+            rest.remove_prefix(frame_length);
+        }
+    }
+
+    if (content_size != ZSTD_CONTENTSIZE_UNKNOWN && content_size != ZSTD_CONTENTSIZE_ERROR &&
+        content_size <= compressed_data.size() * detail::max_inflate_ratio) {
+        struct Holder {
+            ZSTD_DCtx* dctx{ZSTD_createDCtx()};
+            ~Holder() { ZSTD_freeDCtx(dctx); }
+        };
+        thread_local Holder holder;
+
+        std::string decompressed(static_cast<size_t>(content_size), '\0');
+        size_t ret = ZSTD_decompressDCtx(holder.dctx, decompressed.data(), decompressed.size(),
+                                         compressed_data.data(), compressed_data.size());
+        if (ZSTD_isError(ret)) {
+            throw std::runtime_error("Failed to decompress zstd data");
+        }
+        decompressed.resize(ret);
+        return decompressed;
+    }
+
+    StreamingZstdDecoder decoder;
+    std::string decompressed;
+    decompressed.reserve(compressed_data.size() * 4);
+    decoder.write(compressed_data, decompressed);
+    decoder.finish();
+    return decompressed;
+}
+
+// Incremental zstd encoder for request bodies
+class StreamingZstdEncoder : public ContentEncoder {
+public:
+    // level 0 selects zstd's default compression level
+    explicit StreamingZstdEncoder(int level) : cctx_(ZSTD_createCCtx()) {
+        if (!cctx_ || ZSTD_isError(ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level))) {
+            ZSTD_freeCCtx(cctx_);
+            throw std::runtime_error("Failed to initialize zstd compression");
+        }
+    }
+
+    StreamingZstdEncoder(const StreamingZstdEncoder&) = delete;
+    StreamingZstdEncoder& operator=(const StreamingZstdEncoder&) = delete;
+
+    ~StreamingZstdEncoder() {
+        ZSTD_freeCCtx(cctx_);
+    }
+
+    void write(std::string_view input, std::string& out) override {
+        run(input, ZSTD_e_continue, out);
+    }
+
+    void finish(std::string& out) override {
+        run({}, ZSTD_e_end, out);
+    }
+
+private:
+    void run(std::string_view input, ZSTD_EndDirective directive, std::string& out) {
+        ZSTD_inBuffer in{input.data(), input.size(), 0};
+
+        size_t remaining;
+        do {
+            size_t old_size = out.size();
+            size_t grow = ZSTD_CStreamOutSize();
+            out.resize(old_size + grow);
+
+            ZSTD_outBuffer output{&out[old_size], grow, 0};
+            remaining = ZSTD_compressStream2(cctx_, &output, &in, directive);
+            out.resize(old_size + output.pos);
+
+            if (ZSTD_isError(remaining)) {
+                throw std::runtime_error("Failed to compress zstd data");
+            }
+        } while (directive == ZSTD_e_end ? remaining != 0 : in.pos < in.size);
+    }
+
+    ZSTD_CCtx* cctx_;
+};
+#endif
+
+#if defined(CORO_HTTP_HAS_BROTLI)
+// Incremental brotli decoder
+class StreamingBrotliDecoder : public ContentDecoder {
+public:
+    StreamingBrotliDecoder() : state_(BrotliDecoderCreateInstance(nullptr, nullptr, nullptr)) {
+        if (!state_) {
+            throw std::runtime_error("Failed to initialize brotli decompression");
+        }
+    }
+
+    StreamingBrotliDecoder(const StreamingBrotliDecoder&) = delete;
+    StreamingBrotliDecoder& operator=(const StreamingBrotliDecoder&) = delete;
+
+    ~StreamingBrotliDecoder() {
+        BrotliDecoderDestroyInstance(state_);
+    }
+
+    void write(std::string_view input, std::string& out) override {
+        size_t avail_in = input.size();
+        const uint8_t* next_in = reinterpret_cast<const uint8_t*>(input.data());
+
+        while (!done_) {
+            size_t old_size = out.size();
+            size_t grow = std::max<size_t>(avail_in * 4, 16384);
+            out.resize(old_size + grow);
+
+            size_t avail_out = grow;
+            uint8_t* next_out = reinterpret_cast<uint8_t*>(&out[old_size]);
+            BrotliDecoderResult result = BrotliDecoderDecompressStream(
+                state_, &avail_in, &next_in, &avail_out, &next_out, nullptr);
+            out.resize(old_size + (grow - avail_out));
+
+            if (result == BROTLI_DECODER_RESULT_SUCCESS) {
+                done_ = true;
+            } else if (result == BROTLI_DECODER_RESULT_ERROR) {
+                throw std::runtime_error("Failed to decompress brotli data");
+            } else if (result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT) {
+                break;
+            }
+        }
+    }
+
+    bool done() const override {
+        return done_;
+    }
+
+private:
+    BrotliDecoderState* state_;
+    bool done_{false};
+};
+
+// One-shot brotli decode; brotli carries no size header, so the output
+// grows from a 4x estimate.
+inline std::string decompress_brotli(std::string_view compressed_data) {
+    StreamingBrotliDecoder decoder;
+    std::string decompressed;
+    decompressed.reserve(compressed_data.size() * 4);
+    decoder.write(compressed_data, decompressed);
+    decoder.finish();
     return decompressed;
 }
+#endif
 
 }
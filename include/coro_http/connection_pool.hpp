@@ -7,205 +7,153 @@
 #include <deque>
 #include <mutex>
 #include <chrono>
+#include <tuple>
 
 namespace coro_http {
 
-struct PooledConnection {
-    std::shared_ptr<asio::ip::tcp::socket> socket;
+template<typename Stream>
+struct PooledStream {
+    std::shared_ptr<Stream> stream;
     std::chrono::steady_clock::time_point last_used;
     bool in_use{false};
     
-    PooledConnection(std::shared_ptr<asio::ip::tcp::socket> sock)
-        : socket(sock), last_used(std::chrono::steady_clock::now()) {}
+    PooledStream(std::shared_ptr<Stream> s)
+        : stream(std::move(s)), last_used(std::chrono::steady_clock::now()) {}
 };
 
-struct PooledSSLConnection {
-    std::shared_ptr<asio::ssl::stream<asio::ip::tcp::socket>> ssl_stream;
-    std::chrono::steady_clock::time_point last_used;
-    bool in_use{false};
-    
-    PooledSSLConnection(std::shared_ptr<asio::ssl::stream<asio::ip::tcp::socket>> stream)
-        : ssl_stream(stream), last_used(std::chrono::steady_clock::now()) {}
-};
+using UnixSocket = asio::local::stream_protocol::socket;
 
+// Keep-alive connections per stream type: plain TCP, TLS over TCP and Unix
+// domain sockets. Each type has its own map of key -> connections, so the
+// same request code pools whichever transport a URL resolves to.
 class ConnectionPool {
 public:
     ConnectionPool(int max_per_host, std::chrono::seconds idle_timeout)
         : max_connections_per_host_(max_per_host),
           idle_timeout_(idle_timeout) {}
     
-    // Get or create HTTP connection
-    std::shared_ptr<asio::ip::tcp::socket> get_connection(
-        asio::io_context& io_context,
-        const std::string& host,
-        const std::string& port) {
-        
+    // Pool key for a target reached over `route`, the proxy a connection
+    // goes through (empty when direct). Connections through different
+    // proxies, or none, never serve each other's requests.
+    static std::string key_for(const std::string& host, const std::string& port, const std::string& route = "") {
+        std::string key = host + ":" + port;
+        return route.empty() ? key : route + " " + key;
+    }
+    
+    // Get an idle connection for `key`, or a new unconnected one built from
+    // `args`. New connections are pooled while the key is under its limit;
+    // past it they are temporary and never come back.
+    template<typename Stream, typename... Args>
+    std::shared_ptr<Stream> acquire(const std::string& key, Args&&... args) {
         std::lock_guard<std::mutex> lock(mutex_);
         
-        std::string key = host + ":" + port;
-        auto& connections = http_pool_[key];
+        auto& connections = pool<Stream>()[key];
         
         // Find available connection
         auto now = std::chrono::steady_clock::now();
         for (auto it = connections.begin(); it != connections.end(); ) {
+            // Connections in use belong to their request; probing one would
+            // consume response bytes its reader is waiting for
+            if (it->in_use) {
+                ++it;
+                continue;
+            }
+            
             // Remove timed out connections
             if (now - it->last_used > idle_timeout_) {
                 it = connections.erase(it);
                 continue;
             }
             
-            // Check if connection is available and valid
-            if (!it->in_use && is_socket_valid(it->socket)) {
+            // Check if connection is valid
+            if (is_alive(*it->stream)) {
                 it->in_use = true;
                 it->last_used = now;
-                return it->socket;
+                return it->stream;
             }
             
             // Remove invalid connections
-            if (!is_socket_valid(it->socket)) {
-                it = connections.erase(it);
-                continue;
-            }
-            
-            ++it;
+            it = connections.erase(it);
         }
         
+        auto stream = std::make_shared<Stream>(std::forward<Args>(args)...);
+        
         // Create new connection if under limit
         if (static_cast<int>(connections.size()) < max_connections_per_host_) {
-            auto socket = std::make_shared<asio::ip::tcp::socket>(io_context);
-            connections.emplace_back(socket);
+            connections.emplace_back(stream);
             connections.back().in_use = true;
-            return socket;
         }
         
-        // Pool is full, create temporary connection
-        return std::make_shared<asio::ip::tcp::socket>(io_context);
+        // Pool is full, the connection is temporary
+        return stream;
     }
     
-    // Get or create HTTPS connection
-    std::shared_ptr<asio::ssl::stream<asio::ip::tcp::socket>> get_ssl_connection(
-        asio::io_context& io_context,
-        asio::ssl::context& ssl_context,
-        const std::string& host,
-        const std::string& port) {
-        
+    // Return a connection taken with acquire(); without keep-alive it
+    // leaves the pool
+    template<typename Stream>
+    void release(const std::shared_ptr<Stream>& stream, const std::string& key, bool should_keep_alive = true) {
         std::lock_guard<std::mutex> lock(mutex_);
         
-        std::string key = host + ":" + port;
-        auto& connections = ssl_pool_[key];
-        
-        // Find available connection
-        auto now = std::chrono::steady_clock::now();
-        for (auto it = connections.begin(); it != connections.end(); ) {
-            // Remove timed out connections
-            if (now - it->last_used > idle_timeout_) {
-                it = connections.erase(it);
-                continue;
-            }
+        auto& connections = pool<Stream>()[key];
+        for (auto it = connections.begin(); it != connections.end(); ++it) {
+            if (it->stream != stream) continue;
             
-            // Check if connection is available and valid
-            if (!it->in_use && is_ssl_socket_valid(it->ssl_stream)) {
-                it->in_use = true;
-                it->last_used = now;
-                return it->ssl_stream;
-            }
-            
-            // Remove invalid connections
-            if (!is_ssl_socket_valid(it->ssl_stream)) {
-                it = connections.erase(it);
-                continue;
+            // If server sent Connection: close, remove from pool
+            if (!should_keep_alive) {
+                connections.erase(it);
+                return;
             }
             
-            ++it;
-        }
-        
-        // Create new connection if under limit
-        if (static_cast<int>(connections.size()) < max_connections_per_host_) {
-            auto ssl_stream = std::make_shared<asio::ssl::stream<asio::ip::tcp::socket>>(
-                io_context, ssl_context);
-            connections.emplace_back(ssl_stream);
-            connections.back().in_use = true;
-            return ssl_stream;
+            // Normal release - mark as available
+            it->in_use = false;
+            it->last_used = std::chrono::steady_clock::now();
+            return;
         }
-        
-        // Pool is full, create temporary connection
-        return std::make_shared<asio::ssl::stream<asio::ip::tcp::socket>>(
-            io_context, ssl_context);
+    }
+    
+    // Get or create HTTP connection
+    std::shared_ptr<asio::ip::tcp::socket> get_connection(
+        asio::io_context& io_context,
+        const std::string& host,
+        const std::string& port,
+        const std::string& route = "") {
+        return acquire<asio::ip::tcp::socket>(key_for(host, port, route), io_context);
+    }
+    
+    // Get or create HTTPS connection
+    std::shared_ptr<asio::ssl::stream<asio::ip::tcp::socket>> get_ssl_connection(
+        asio::io_context& io_context,
+        asio::ssl::context& ssl_context,
+        const std::string& host,
+        const std::string& port,
+        const std::string& route = "") {
+        return acquire<asio::ssl::stream<asio::ip::tcp::socket>>(key_for(host, port, route), io_context, ssl_context);
     }
     
     // Release HTTP connection back to pool
-    // Returns true if connection was released, false if it should be closed
     void release_connection(
         const std::shared_ptr<asio::ip::tcp::socket>& socket,
         const std::string& host,
         const std::string& port,
-        bool should_keep_alive = true) {
-        
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        std::string key = host + ":" + port;
-        auto& connections = http_pool_[key];
-        
-        // If server sent Connection: close, remove from pool
-        if (!should_keep_alive) {
-            for (auto it = connections.begin(); it != connections.end(); ++it) {
-                if (it->socket == socket) {
-                    connections.erase(it);
-                    return;
-                }
-            }
-            return;
-        }
-        
-        // Normal release - mark as available
-        for (auto& conn : connections) {
-            if (conn.socket == socket) {
-                conn.in_use = false;
-                conn.last_used = std::chrono::steady_clock::now();
-                return;
-            }
-        }
+        bool should_keep_alive = true,
+        const std::string& route = "") {
+        release(socket, key_for(host, port, route), should_keep_alive);
     }
     
     // Release HTTPS connection back to pool
-    // Returns true if connection was released, false if it should be closed
     void release_ssl_connection(
         const std::shared_ptr<asio::ssl::stream<asio::ip::tcp::socket>>& ssl_stream,
         const std::string& host,
         const std::string& port,
-        bool should_keep_alive = true) {
-        
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        std::string key = host + ":" + port;
-        auto& connections = ssl_pool_[key];
-        
-        // If server sent Connection: close, remove from pool
-        if (!should_keep_alive) {
-            for (auto it = connections.begin(); it != connections.end(); ++it) {
-                if (it->ssl_stream == ssl_stream) {
-                    connections.erase(it);
-                    return;
-                }
-            }
-            return;
-        }
-        
-        // Normal release - mark as available
-        for (auto& conn : connections) {
-            if (conn.ssl_stream == ssl_stream) {
-                conn.in_use = false;
-                conn.last_used = std::chrono::steady_clock::now();
-                return;
-            }
-        }
+        bool should_keep_alive = true,
+        const std::string& route = "") {
+        release(ssl_stream, key_for(host, port, route), should_keep_alive);
     }
     
     // Clear all connections
     void clear() {
         std::lock_guard<std::mutex> lock(mutex_);
-        http_pool_.clear();
-        ssl_pool_.clear();
+        std::apply([](auto&... pools) { (pools.clear(), ...); }, pools_);
     }
     
     // Get pool statistics
@@ -214,58 +162,66 @@ public:
         int active_http_connections{0};
         int total_ssl_connections{0};
         int active_ssl_connections{0};
+        int total_unix_connections{0};
+        int active_unix_connections{0};
     };
     
     Stats get_stats() const {
         std::lock_guard<std::mutex> lock(mutex_);
         Stats stats;
-        
-        for (const auto& [key, connections] : http_pool_) {
-            stats.total_http_connections += connections.size();
-            for (const auto& conn : connections) {
-                if (conn.in_use) {
-                    stats.active_http_connections++;
-                }
-            }
-        }
-        
-        for (const auto& [key, connections] : ssl_pool_) {
-            stats.total_ssl_connections += connections.size();
+        count(std::get<0>(pools_), stats.total_http_connections, stats.active_http_connections);
+        count(std::get<1>(pools_), stats.total_ssl_connections, stats.active_ssl_connections);
+        count(std::get<2>(pools_), stats.total_unix_connections, stats.active_unix_connections);
+        return stats;
+    }
+
+private:
+    template<typename Stream>
+    using Connections = std::map<std::string, std::deque<PooledStream<Stream>>>;
+    
+    template<typename Stream>
+    Connections<Stream>& pool() {
+        return std::get<Connections<Stream>>(pools_);
+    }
+    
+    template<typename Stream>
+    static void count(const Connections<Stream>& pool, int& total, int& active) {
+        for (const auto& [key, connections] : pool) {
+            total += connections.size();
             for (const auto& conn : connections) {
                 if (conn.in_use) {
-                    stats.active_ssl_connections++;
+                    active++;
                 }
             }
         }
-        
-        return stats;
     }
-
-private:
-    bool is_socket_valid(const std::shared_ptr<asio::ip::tcp::socket>& socket) {
-        if (!socket || !socket->is_open()) {
+    
+    // Plain sockets, TCP or Unix domain
+    template<typename Socket>
+    static bool is_alive(Socket& socket) {
+        if (!socket.is_open()) {
             return false;
         }
         
         // Check if remote endpoint is still valid
         asio::error_code ec;
-        socket->lowest_layer().remote_endpoint(ec);
+        socket.remote_endpoint(ec);
         if (ec) {
             return false;
         }
         
         // Detect server-initiated close by attempting non-blocking read
         // If server closed the connection, we'll get immediate EOF or error
-        socket->non_blocking(true, ec);
+        socket.non_blocking(true, ec);
         if (ec) {
             return false;
         }
         
         char test_byte;
-        size_t bytes_read = socket->read_some(asio::buffer(&test_byte, 1), ec);
+        socket.read_some(asio::buffer(&test_byte, 1), ec);
         
         // Restore blocking mode
-        socket->non_blocking(false);
+        socket.non_blocking(false);
         
         // If we got data, this is unexpected (server shouldn't send unsolicited data)
         // If we got EOF, connection was closed
@@ -277,13 +233,8 @@ private:
         return false;  // Connection closed or error
     }
     
-    bool is_ssl_socket_valid(
-        const std::shared_ptr<asio::ssl::stream<asio::ip::tcp::socket>>& ssl_stream) {
-        if (!ssl_stream) {
-            return false;
-        }
-        
-        auto& socket = ssl_stream->lowest_layer();
+    static bool is_alive(asio::ssl::stream<asio::ip::tcp::socket>& ssl_stream) {
+        auto& socket = ssl_stream.lowest_layer();
         if (!socket.is_open()) {
             return false;
         }
@@ -296,7 +247,7 @@ private:
         }
         
         // Verify SSL session state
-        SSL* ssl = ssl_stream->native_handle();
+        SSL* ssl = ssl_stream.native_handle();
         if (!ssl) {
             return false;
         }
@@ -321,7 +272,7 @@ private:
         char test_byte;
         // For SSL, we need to try reading through the SSL layer
         asio::error_code read_ec;
-        size_t bytes_read = ssl_stream->read_some(asio::buffer(&test_byte, 1), read_ec);
+        ssl_stream.read_some(asio::buffer(&test_byte, 1), read_ec);
         
         // Restore blocking mode
         socket.non_blocking(false);
@@ -337,8 +288,9 @@ private:
     
     int max_connections_per_host_;
     std::chrono::seconds idle_timeout_;
-    std::map<std::string, std::deque<PooledConnection>> http_pool_;
-    std::map<std::string, std::deque<PooledSSLConnection>> ssl_pool_;
+    std::tuple<Connections<asio::ip::tcp::socket>,
+               Connections<asio::ssl::stream<asio::ip::tcp::socket>>,
+               Connections<UnixSocket>> pools_;
     mutable std::mutex mutex_;
 };
 
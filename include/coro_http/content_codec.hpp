@@ -0,0 +1,177 @@
+#pragma once
+
+#include "compression.hpp"
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace coro_http {
+
+// Codec implementation for one Content-Encoding token
+struct ContentCodec {
+    std::string token;
+
+    // Decode a complete body
+    std::function<std::string(std::string_view)> decode;
+
+    // Create an incremental decoder for a body that arrives in pieces
+    std::function<std::unique_ptr<ContentDecoder>()> make_decoder;
+
+    // Create an encoder for request bodies (level 0 = codec default);
+    // empty for decode-only codecs
+    std::function<std::unique_ptr<ContentEncoder>(int level)> make_encoder;
+};
+
+// Content-Encoding decoders keyed by token.
+// Built-in codecs are registered in order of preference and only when
+// compiled in, so Accept-Encoding never advertises what cannot be decoded.
+// Register custom codecs at start-up, before any request is issued.
+class ContentCodecRegistry {
+public:
+    static ContentCodecRegistry& instance() {
+        static ContentCodecRegistry registry;
+        return registry;
+    }
+
+    // Add a codec, replacing any existing codec with the same token
+    void register_codec(ContentCodec codec) {
+        auto it = find_codec(codec.token);
+        if (it != codecs_.end()) {
+            *it = std::move(codec);
+        } else {
+            codecs_.push_back(std::move(codec));
+        }
+        rebuild_accept_encoding();
+    }
+
+    void unregister_codec(std::string_view token) {
+        auto it = find_codec(token);
+        if (it != codecs_.end()) {
+            codecs_.erase(it);
+            rebuild_accept_encoding();
+        }
+    }
+
+    // Case-insensitive lookup; nullptr when the token is unknown
+    const ContentCodec* find(std::string_view token) const {
+        auto it = std::find_if(codecs_.begin(), codecs_.end(),
+            [&](const ContentCodec& codec) { return token_equals(codec.token, token); });
+        return it != codecs_.end() ? &*it : nullptr;
+    }
+
+    // Accept-Encoding value listing every registered codec
+    const std::string& accept_encoding() const {
+        return accept_encoding_;
+    }
+
+private:
+    ContentCodecRegistry() {
+#if defined(CORO_HTTP_HAS_ZSTD)
+        register_codec({"zstd",
+            [](std::string_view data) { return decompress_zstd(data); },
+            [] { return std::make_unique<StreamingZstdDecoder>(); },
+            [](int level) { return std::make_unique<StreamingZstdEncoder>(level); }});
+#endif
+#if defined(CORO_HTTP_HAS_BROTLI)
+        register_codec({"br",
+            [](std::string_view data) { return decompress_brotli(data); },
+            [] { return std::make_unique<StreamingBrotliDecoder>(); },
+            nullptr});
+#endif
+        register_codec({"gzip",
+            [](std::string_view data) { return decompress_gzip(data); },
+            [] { return std::make_unique<StreamingInflater>(ZlibFormat::Gzip); },
+            [](int level) { return std::make_unique<StreamingDeflater>(ZlibFormat::Gzip, level); }});
+        register_codec({"deflate",
+            [](std::string_view data) { return decompress_deflate(data); },
+            [] { return std::make_unique<StreamingInflater>(ZlibFormat::Deflate); },
+            [](int level) { return std::make_unique<StreamingDeflater>(ZlibFormat::Deflate, level); }});
+    }
+
+    static bool token_equals(std::string_view a, std::string_view b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+            [](char ca, char cb) {
+                return std::tolower(static_cast<unsigned char>(ca)) ==
+                       std::tolower(static_cast<unsigned char>(cb));
+            });
+    }
+
+    std::vector<ContentCodec>::iterator find_codec(std::string_view token) {
+        return std::find_if(codecs_.begin(), codecs_.end(),
+            [&](const ContentCodec& codec) { return token_equals(codec.token, token); });
+    }
+
+    void rebuild_accept_encoding() {
+        accept_encoding_.clear();
+        for (const auto& codec : codecs_) {
+            if (!accept_encoding_.empty()) accept_encoding_ += ", ";
+            accept_encoding_ += codec.token;
+        }
+    }
+
+    std::vector<ContentCodec> codecs_;
+    std::string accept_encoding_;
+};
+
+namespace detail {
+
+// Split a Content-Encoding value into its trimmed, non-empty codings
+inline std::vector<std::string_view> split_codings(std::string_view content_encoding) {
+    std::vector<std::string_view> codings;
+    while (!content_encoding.empty()) {
+        size_t comma = content_encoding.find(',');
+        std::string_view coding = content_encoding.substr(0, comma);
+        size_t first = coding.find_first_not_of(" \t");
+        size_t last = coding.find_last_not_of(" \t");
+        if (first != std::string_view::npos) {
+            coding = coding.substr(first, last - first + 1);
+            if (coding != "identity") {
+                codings.push_back(coding);
+            }
+        }
+        if (comma == std::string_view::npos) break;
+        content_encoding.remove_prefix(comma + 1);
+    }
+    return codings;
+}
+
+}
+
+// Decode a complete body according to its Content-Encoding header.
+// Codings are undone in reverse order of application. When any coding is
+// unknown the body is returned untouched, never half decoded.
+inline std::string decode_content(std::string body, std::string_view content_encoding) {
+    auto codings = detail::split_codings(content_encoding);
+    std::vector<const ContentCodec*> codecs;
+    for (auto it = codings.rbegin(); it != codings.rend(); ++it) {
+        const ContentCodec* codec = ContentCodecRegistry::instance().find(*it);
+        if (!codec) return body;
+        codecs.push_back(codec);
+    }
+    for (const ContentCodec* codec : codecs) {
+        body = codec->decode(body);
+    }
+    return body;
+}
+
+// Incremental decoder for a single-coding Content-Encoding, or nullptr when
+// the value is unknown or stacks several codings.
+inline std::unique_ptr<ContentDecoder> make_content_decoder(std::string_view content_encoding) {
+    auto codings = detail::split_codings(content_encoding);
+    if (codings.size() != 1) return nullptr;
+    const ContentCodec* codec = ContentCodecRegistry::instance().find(codings.front());
+    return (codec && codec->make_decoder) ? codec->make_decoder() : nullptr;
+}
+
+// Encoder for request bodies, or nullptr when the coding is unknown or
+// the codec cannot encode
+inline std::unique_ptr<ContentEncoder> make_content_encoder(std::string_view encoding, int level = 0) {
+    const ContentCodec* codec = ContentCodecRegistry::instance().find(encoding);
+    return (codec && codec->make_encoder) ? codec->make_encoder(level) : nullptr;
+}
+
+}
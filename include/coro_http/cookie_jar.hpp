@@ -1,11 +1,19 @@
 #pragma once
 
+#include "http_date.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <map>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <chrono>
-#include <sstream>
+#include <cstdint>
 #include <algorithm>
+#include <array>
+#include <bitset>
 
 namespace coro_http {
 
@@ -26,8 +34,12 @@ struct Cookie {
     
     // Check if cookie is expired
     bool is_expired() const {
+        return is_expired(std::chrono::system_clock::now());
+    }
+    
+    bool is_expired(std::chrono::system_clock::time_point now) const {
         if (session) return false;
-        return std::chrono::system_clock::now() > expires;
+        return now > expires;
     }
     
     // Check if cookie matches domain
@@ -37,12 +49,14 @@ struct Cookie {
         // Exact match
         if (domain == request_domain) return true;
         
-        // Domain cookie (starts with .)
+        // Domain cookie (starts with .) matches the domain and its subdomains
         if (domain[0] == '.') {
-            std::string domain_suffix = domain.substr(1);
-            if (request_domain.size() >= domain_suffix.size()) {
-                auto pos = request_domain.size() - domain_suffix.size();
-                return request_domain.substr(pos) == domain_suffix;
+            std::string_view suffix(domain);
+            suffix.remove_prefix(1);
+            if (request_domain == suffix) return true;
+            if (request_domain.size() > suffix.size()) {
+                auto pos = request_domain.size() - suffix.size();
+                return request_domain[pos - 1] == '.' && request_domain.compare(pos, suffix.size(), suffix) == 0;
             }
         }
         
@@ -50,13 +64,13 @@ struct Cookie {
     }
     
     // Check if cookie matches path
-    bool matches_path(const std::string& request_path) const {
+    bool matches_path(std::string_view request_path) const {
         if (path.empty() || path == "/") return true;
         
         // Path must be prefix of request path
-        if (request_path.find(path) == 0) {
+        if (request_path.compare(0, path.size(), path) == 0) {
             // Exact match or path ends with /
-            if (request_path.size() == path.size() || 
+            if (request_path.size() == path.size() ||
                 request_path[path.size()] == '/' ||
                 path.back() == '/') {
                 return true;
@@ -67,18 +81,107 @@ struct Cookie {
     }
 };
 
+namespace detail {
+
+inline void lower_host_in_place(std::string& host) {
+    for (auto& c : host) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+}
+
+inline std::string lower_host(std::string_view host) {
+    std::string out(host);
+    lower_host_in_place(out);
+    return out;
+}
+
+inline bool is_ip_literal(std::string_view host) {
+    if (host.find(':') != std::string_view::npos) return true;  // IPv6
+    return !host.empty() && host.find_first_not_of("0123456789.") == std::string_view::npos;
+}
+
+// Multi-label public suffixes under which registrations are common. Every
+// single-label TLD is treated as public as well.
+inline const std::unordered_set<std::string_view>& builtin_public_suffixes() {
+    static const std::unordered_set<std::string_view> suffixes = {
+        "co.uk", "org.uk", "me.uk", "ltd.uk", "plc.uk", "net.uk", "ac.uk", "gov.uk", "nhs.uk",
+        "com.au", "net.au", "org.au", "edu.au", "gov.au", "id.au",
+        "co.nz", "org.nz", "net.nz", "govt.nz", "ac.nz",
+        "co.jp", "ne.jp", "or.jp", "ac.jp", "go.jp",
+        "co.kr", "or.kr", "ac.kr", "go.kr",
+        "com.cn", "net.cn", "org.cn", "gov.cn", "edu.cn",
+        "com.hk", "org.hk", "net.hk", "edu.hk", "gov.hk",
+        "com.tw", "org.tw", "net.tw", "edu.tw", "gov.tw",
+        "com.sg", "org.sg", "net.sg", "edu.sg", "gov.sg",
+        "co.in", "net.in", "org.in", "firm.in", "gen.in", "ind.in", "ac.in", "gov.in",
+        "com.br", "net.br", "org.br", "gov.br", "edu.br",
+        "com.ar", "com.mx", "org.mx", "gob.mx", "com.co", "com.pe", "com.ve",
+        "co.za", "org.za", "gov.za", "ac.za", "web.za",
+        "com.tr", "org.tr", "net.tr", "gov.tr", "edu.tr",
+        "co.il", "org.il", "ac.il", "gov.il",
+        "com.ru", "org.ru", "net.ru", "com.ua", "org.ua",
+        "com.pl", "org.pl", "net.pl", "co.at", "or.at", "ac.at",
+        "github.io", "gitlab.io", "herokuapp.com", "appspot.com", "blogspot.com",
+        "cloudfront.net", "azurewebsites.net", "netlify.app", "vercel.app", "pages.dev", "workers.dev",
+    };
+    return suffixes;
+}
+
+}
+
+// Cookie storage indexed by domain. Lookups walk the request host's domain
+// suffixes (a.b.example.com, b.example.com, example.com, com) in a hash
+// index instead of scanning the whole jar. Each domain's cookies are kept
+// longest path first, so the Cookie header comes out in RFC 6265 order.
+//
+// The jar is safe to share between threads, and readers take no lock on the
+// common path. Its contents are published as immutable snapshots; every
+// thread holds on to the latest snapshot it has seen until the jar's
+// generation moves, and keeps its own cache of serialized Cookie headers,
+// each valid until a write touches one of the domains it was built from. Writers serialize on a
+// mutex and publish a new snapshot that shares every untouched domain with
+// the previous one. Expired cookies are skipped by readers and dropped by
+// the next write to their domain, or by a reader that finds the write lock
+// free.
 class CookieJar {
 public:
-    CookieJar() = default;
+    CookieJar() : core_(std::make_shared<Core>()) {}
     
-    // Add a cookie
+    CookieJar(const CookieJar& other) : CookieJar() {
+        auto snapshot = other.core_->load();
+        core_->generation.store(snapshot->generation, std::memory_order_relaxed);
+        core_->state = std::move(snapshot);
+    }
+    
+    CookieJar& operator=(const CookieJar& other) {
+        if (this != &other) {
+            auto snapshot = other.core_->load();
+            update([&](Batch& batch) {
+                batch.assign(*snapshot);
+            });
+        }
+        return *this;
+    }
+    
+    // Add a cookie, replacing one with the same domain, path and name
     void add(const Cookie& cookie) {
-        std::string key = cookie.domain + cookie.path + cookie.name;
-        cookies_[key] = cookie;
+        update([&](Batch& batch) {
+            batch.add(cookie);
+        });
+    }
+    
+    // Add many cookies as a single update (e.g. when restoring a snapshot)
+    void add_cookies(std::vector<Cookie> cookies) {
+        if (cookies.empty()) return;
+        update([&](Batch& batch) {
+            for (auto& cookie : cookies) {
+                batch.add(std::move(cookie));
+            }
+        });
     }
     
     // Set a simple cookie (name=value)
-    void set(const std::string& name, const std::string& value, 
+    void set(const std::string& name, const std::string& value,
              const std::string& domain = "", const std::string& path = "/") {
         Cookie cookie(name, value);
         cookie.domain = domain;
@@ -86,101 +189,120 @@ public:
         add(cookie);
     }
     
-    // Parse Set-Cookie header and add to jar
-    void parse_set_cookie(const std::string& set_cookie_header, const std::string& default_domain) {
-        Cookie cookie;
-        cookie.domain = default_domain;
-        
-        // Split by semicolon
-        std::istringstream ss(set_cookie_header);
-        std::string segment;
-        bool first = true;
-        
-        while (std::getline(ss, segment, ';')) {
-            // Trim whitespace
-            segment.erase(0, segment.find_first_not_of(" \t"));
-            segment.erase(segment.find_last_not_of(" \t") + 1);
-            
-            if (first) {
-                // First segment is name=value
-                auto eq_pos = segment.find('=');
-                if (eq_pos != std::string::npos) {
-                    cookie.name = segment.substr(0, eq_pos);
-                    cookie.value = segment.substr(eq_pos + 1);
-                }
-                first = false;
-            } else {
-                // Parse attributes
-                auto eq_pos = segment.find('=');
-                std::string attr_name = segment.substr(0, eq_pos);
-                std::string attr_value = (eq_pos != std::string::npos) 
-                    ? segment.substr(eq_pos + 1) : "";
-                
-                // Convert to lowercase for comparison
-                std::transform(attr_name.begin(), attr_name.end(), 
-                             attr_name.begin(), ::tolower);
-                
-                if (attr_name == "domain") {
-                    cookie.domain = attr_value;
-                } else if (attr_name == "path") {
-                    cookie.path = attr_value;
-                } else if (attr_name == "secure") {
-                    cookie.secure = true;
-                } else if (attr_name == "httponly") {
-                    cookie.http_only = true;
-                } else if (attr_name == "max-age") {
-                    // Convert max-age to expires
-                    try {
-                        int max_age = std::stoi(attr_value);
-                        cookie.expires = std::chrono::system_clock::now() + 
-                                       std::chrono::seconds(max_age);
-                        cookie.session = false;
-                    } catch (...) {}
-                }
-                // TODO: Parse Expires attribute (requires date parsing)
+    // Parse Set-Cookie header and add to jar. request_path supplies the
+    // default Path (RFC 6265 section 5.1.4) when the header has none.
+    void parse_set_cookie(const std::string& set_cookie_header, const std::string& default_domain,
+                          const std::string& request_path = "/") {
+        update([&](Batch& batch) {
+            batch.apply_set_cookie(set_cookie_header, detail::lower_host(default_domain), request_path);
+        });
+    }
+    
+    // Apply all Set-Cookie headers of one response as a single update
+    void parse_set_cookies(const std::vector<std::string>& set_cookie_headers,
+                           const std::string& default_domain, const std::string& request_path = "/") {
+        if (set_cookie_headers.empty()) return;
+        std::string host = detail::lower_host(default_domain);
+        update([&](Batch& batch) {
+            for (const auto& header : set_cookie_headers) {
+                batch.apply_set_cookie(header, host, request_path);
             }
-        }
-        
-        if (!cookie.name.empty()) {
-            add(cookie);
-        }
+        });
     }
     
-    // Get all cookies for a request
-    std::string get_cookies_for_request(const std::string& domain, 
+    // Get all cookies for a request, serialized as a Cookie header value
+    std::string get_cookies_for_request(const std::string& domain,
                                         const std::string& path,
                                         bool is_https) const {
-        std::vector<std::string> matching_cookies;
+        std::string_view request_path(path);
+        request_path = request_path.substr(0, request_path.find_first_of("?#"));
+        if (request_path.empty()) request_path = "/";
         
-        for (const auto& [key, cookie] : cookies_) {
-            // Skip expired cookies
-            if (cookie.is_expired()) continue;
-            
-            // Skip secure cookies on non-HTTPS
-            if (cookie.secure && !is_https) continue;
-            
-            // Check domain and path match
-            if (cookie.matches_domain(domain) && cookie.matches_path(path)) {
-                matching_cookies.push_back(cookie.name + "=" + cookie.value);
+        std::string cache_key;
+        cache_key.reserve(domain.size() + request_path.size() + 2);
+        cache_key += is_https ? 's' : 'p';
+        cache_key += domain;
+        cache_key += ' ';
+        cache_key += request_path;
+        
+        auto now = std::chrono::system_clock::now();
+        ReaderCache& reader = reader_cache();
+        const State& state = *reader.state;
+        auto cached = reader.headers.find(cache_key);
+        if (cached != reader.headers.end() && now <= cached->second.valid_until) {
+            // After a write, the header still holds if its domains were not touched
+            CachedHeader& entry = cached->second;
+            if (entry.generation == state.generation || sources_unchanged(entry, state, detail::lower_host(domain))) {
+                entry.generation = state.generation;
+                return entry.header;
             }
         }
         
-        // Join with semicolons
-        std::ostringstream result;
-        for (size_t i = 0; i < matching_cookies.size(); ++i) {
-            if (i > 0) result << "; ";
-            result << matching_cookies[i];
+        std::string host = detail::lower_host(domain);
+        std::vector<const Entry*> matches;
+        std::vector<std::shared_ptr<const Bucket>> sources;
+        std::vector<std::string> expired_domains;
+        for_each_domain(host, [&](std::string_view key) {
+            const std::shared_ptr<const Bucket>* found = state.find_shared(key);
+            sources.push_back(found ? *found : nullptr);
+            if (!found) return;
+            const Bucket& bucket = **found;
+            if (now > bucket.next_expiry) expired_domains.emplace_back(key);
+            for (const auto& entry : bucket.cookies) {
+                const Cookie& cookie = entry.cookie;
+                // Skip secure cookies on non-HTTPS
+                if (cookie.secure && !is_https) continue;
+                if (cookie.is_expired(now)) continue;
+                if (cookie.matches_domain(host) && cookie.matches_path(request_path)) {
+                    matches.push_back(&entry);
+                }
+            }
+        });
+        
+        // Buckets are path-ordered already; merge them longest path first
+        std::sort(matches.begin(), matches.end(), [](const Entry* a, const Entry* b) {
+            if (a->cookie.path.size() != b->cookie.path.size()) {
+                return a->cookie.path.size() > b->cookie.path.size();
+            }
+            return a->sequence < b->sequence;
+        });
+        
+        std::string header;
+        auto valid_until = std::chrono::system_clock::time_point::max();
+        for (const Entry* entry : matches) {
+            if (!header.empty()) header += "; ";
+            header += entry->cookie.name;
+            header += '=';
+            header += entry->cookie.value;
+            if (!entry->cookie.session) valid_until = std::min(valid_until, entry->cookie.expires);
         }
         
-        return result.str();
+        if (reader.headers.size() >= max_cached_headers) reader.headers.clear();
+        reader.headers[std::move(cache_key)] = CachedHeader{header, valid_until, state.generation, std::move(sources)};
+        
+        // Drop what expired if no writer is busy; otherwise leave it to the next write
+        if (!expired_domains.empty() && core_->write_mutex.try_lock()) {
+            std::lock_guard<std::mutex> lock(core_->write_mutex, std::adopt_lock);
+            publish(*core_, [&](Batch& batch) {
+                for (const auto& key : expired_domains) batch.drop_expired(key);
+            });
+        }
+        return header;
     }
     
     // Get a specific cookie value
     std::string get(const std::string& name, const std::string& domain = "") const {
-        for (const auto& [key, cookie] : cookies_) {
-            if (cookie.name == name && !cookie.is_expired()) {
-                if (domain.empty() || cookie.matches_domain(domain)) {
-                    return cookie.value;
+        auto now = std::chrono::system_clock::now();
+        std::string host = detail::lower_host(domain);
+        for (const auto& shard : reader_cache().state->shards) {
+            for (const auto& [key, bucket] : *shard) {
+                for (const auto& entry : bucket->cookies) {
+                    const Cookie& cookie = entry.cookie;
+                    if (cookie.name == name && !cookie.is_expired(now)) {
+                        if (host.empty() || cookie.matches_domain(host)) {
+                            return cookie.value;
+                        }
+                    }
                 }
             }
         }
@@ -188,23 +310,31 @@ public:
     }
     
     // Remove a cookie
-    void remove(const std::string& name, const std::string& domain = "", 
+    void remove(const std::string& name, const std::string& domain = "",
                 const std::string& path = "/") {
-        std::string key = domain + path + name;
-        cookies_.erase(key);
+        update([&](Batch& batch) {
+            batch.remove(name, detail::lower_host(domain), path);
+        });
     }
     
     // Clear all cookies
     void clear() {
-        cookies_.clear();
+        update([&](Batch& batch) {
+            batch.clear();
+        });
     }
     
     // Get all cookies
     std::vector<Cookie> all_cookies() const {
+        auto now = std::chrono::system_clock::now();
         std::vector<Cookie> result;
-        for (const auto& [key, cookie] : cookies_) {
-            if (!cookie.is_expired()) {
-                result.push_back(cookie);
+        for (const auto& shard : reader_cache().state->shards) {
+            for (const auto& [key, bucket] : *shard) {
+                for (const auto& entry : bucket->cookies) {
+                    if (!entry.cookie.is_expired(now)) {
+                        result.push_back(entry.cookie);
+                    }
+                }
             }
         }
         return result;
@@ -212,17 +342,452 @@ public:
     
     // Remove expired cookies
     void remove_expired() {
-        for (auto it = cookies_.begin(); it != cookies_.end(); ) {
-            if (it->second.is_expired()) {
-                it = cookies_.erase(it);
-            } else {
-                ++it;
+        update([&](Batch& batch) {
+            std::vector<std::string> keys;
+            for (const auto& shard : batch.state.shards) {
+                for (const auto& [key, bucket] : *shard) keys.push_back(key);
             }
-        }
+            for (const auto& key : keys) batch.drop_expired(key);
+        });
+    }
+    
+    // Number of stored cookies, including expired ones not yet dropped
+    size_t size() const {
+        return reader_cache().state->size;
+    }
+    
+    // Incremented by every change to the jar
+    uint64_t generation() const {
+        return core_->generation.load(std::memory_order_acquire);
+    }
+    
+    // Treat domain (e.g. "example.net" or "corp.internal") as a public
+    // suffix, so Set-Cookie cannot scope cookies to it
+    void add_public_suffix(const std::string& domain) {
+        std::string suffix = detail::lower_host(domain);
+        if (!suffix.empty() && suffix[0] == '.') suffix.erase(0, 1);
+        update([&](Batch& batch) {
+            auto suffixes = std::make_shared<std::unordered_set<std::string>>(*batch.state.public_suffixes);
+            suffixes->insert(suffix);
+            batch.state.public_suffixes = std::move(suffixes);
+            batch.changed = true;
+        });
+    }
+    
+    bool is_public_suffix(std::string_view domain) const {
+        return is_public_suffix(*reader_cache().state, domain);
     }
 
 private:
-    std::map<std::string, Cookie> cookies_;  // key = domain+path+name
+    static constexpr size_t max_cached_headers = 1024;
+    
+    struct Entry {
+        Cookie cookie;
+        uint64_t sequence;  // Creation order, for ties between equal path lengths
+    };
+    
+    struct Bucket {
+        std::vector<Entry> cookies;  // Longest path first
+        std::chrono::system_clock::time_point next_expiry{std::chrono::system_clock::time_point::max()};
+    };
+    
+    // Heterogeneous lookup so suffix walks do not allocate
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+    using BucketMap = std::unordered_map<std::string, std::shared_ptr<const Bucket>, StringHash, std::equal_to<>>;
+    
+    // One published version of the jar; never modified once published.
+    // Domains are spread over fixed shards so that a write copies only the
+    // shard and bucket it touches.
+    struct State {
+        static constexpr size_t shard_count = 64;
+        
+        std::array<std::shared_ptr<const BucketMap>, shard_count> shards;
+        size_t size{0};
+        uint64_t generation{0};
+        uint64_t next_sequence{0};
+        std::shared_ptr<const std::unordered_set<std::string>> public_suffixes{
+            std::make_shared<const std::unordered_set<std::string>>()};
+        
+        State() {
+            shards.fill(std::make_shared<const BucketMap>());
+        }
+        
+        static size_t shard_of(std::string_view key) {
+            return StringHash{}(key) % shard_count;
+        }
+        
+        const std::shared_ptr<const Bucket>* find_shared(std::string_view key) const {
+            const BucketMap& shard = *shards[shard_of(key)];
+            auto it = shard.find(key);
+            return it == shard.end() ? nullptr : &it->second;
+        }
+        
+        const Bucket* find(std::string_view key) const {
+            auto found = find_shared(key);
+            return found ? found->get() : nullptr;
+        }
+    };
+    
+    struct Core {
+        std::shared_ptr<const State> state{std::make_shared<const State>()};
+        std::mutex state_mutex;             // Guards the state pointer only
+        std::atomic<uint64_t> generation{0};  // Generation of state, checked by readers without locking
+        std::mutex write_mutex;             // Serializes writers
+        uint64_t id{next_id()};
+        
+        std::shared_ptr<const State> load() {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            return state;
+        }
+        
+        void store(std::shared_ptr<const State> next) {
+            uint64_t next_generation = next->generation;
+            {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                state.swap(next);
+            }
+            generation.store(next_generation, std::memory_order_release);
+            // The previous snapshot is released here, outside the lock
+        }
+        
+        static uint64_t next_id() {
+            static std::atomic<uint64_t> counter{0};
+            return counter.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    
+    struct CachedHeader {
+        std::string header;
+        std::chrono::system_clock::time_point valid_until;  // Earliest expiry among included cookies
+        uint64_t generation;                                // Jar generation last known to hold
+        std::vector<std::shared_ptr<const Bucket>> sources; // Buckets visited, in walk order
+    };
+    
+    // A thread's view of one jar
+    struct ReaderCache {
+        std::weak_ptr<const Core> owner;
+        std::shared_ptr<const State> state;
+        std::unordered_map<std::string, CachedHeader> headers;
+    };
+    
+    // Changes to a private copy of the state. Buckets are copied the first
+    // time the batch touches them, and expired cookies are dropped then.
+    struct Batch {
+        State& state;
+        std::chrono::system_clock::time_point now;
+        std::unordered_set<const Bucket*> owned;  // Created by this batch, so safe to modify
+        std::bitset<State::shard_count> owned_shards;
+        bool changed{false};
+        
+        BucketMap& writable_shard(std::string_view key) {
+            size_t index = State::shard_of(key);
+            auto& slot = state.shards[index];
+            if (!owned_shards[index]) {
+                slot = std::make_shared<BucketMap>(*slot);
+                owned_shards[index] = true;
+            }
+            return const_cast<BucketMap&>(*slot);
+        }
+        
+        Bucket& writable(std::string_view key) {
+            BucketMap& shard = writable_shard(key);
+            auto it = shard.find(key);
+            if (it == shard.end()) {
+                auto bucket = std::make_shared<Bucket>();
+                Bucket& created = *bucket;
+                owned.insert(bucket.get());
+                shard.emplace(std::string(key), std::move(bucket));
+                return created;
+            }
+            if (owned.count(it->second.get())) {
+                return const_cast<Bucket&>(*it->second);
+            }
+            auto copy = std::make_shared<Bucket>(*it->second);
+            Bucket& copied = *copy;
+            owned.insert(copy.get());
+            it->second = std::move(copy);
+            prune(copied);
+            return copied;
+        }
+        
+        void erase_if_empty(std::string_view key) {
+            const Bucket* bucket = state.find(key);
+            if (!bucket || !bucket->cookies.empty()) return;
+            owned.erase(bucket);
+            BucketMap& shard = writable_shard(key);
+            shard.erase(shard.find(key));
+        }
+        
+        void prune(Bucket& bucket) {
+            if (now <= bucket.next_expiry) return;
+            auto next_expiry = std::chrono::system_clock::time_point::max();
+            size_t before = bucket.cookies.size();
+            bucket.cookies.erase(std::remove_if(bucket.cookies.begin(), bucket.cookies.end(), [&](const Entry& e) {
+                if (e.cookie.is_expired(now)) return true;
+                if (!e.cookie.session) next_expiry = std::min(next_expiry, e.cookie.expires);
+                return false;
+            }), bucket.cookies.end());
+            bucket.next_expiry = next_expiry;
+            if (bucket.cookies.size() != before) {
+                state.size -= before - bucket.cookies.size();
+                changed = true;
+            }
+        }
+        
+        void drop_expired(std::string_view key) {
+            const Bucket* bucket = state.find(key);
+            if (!bucket || now <= bucket->next_expiry) return;
+            writable(key);
+            erase_if_empty(key);
+        }
+        
+        void add(Cookie stored) {
+            detail::lower_host_in_place(stored.domain);
+            if (stored.path.empty() || stored.path[0] != '/') stored.path = "/";
+            
+            Bucket& bucket = writable(index_key(stored.domain));
+            auto it = std::find_if(bucket.cookies.begin(), bucket.cookies.end(), [&](const Entry& e) {
+                return e.cookie.name == stored.name && e.cookie.domain == stored.domain &&
+                       e.cookie.path == stored.path;
+            });
+            if (it != bucket.cookies.end()) {
+                it->cookie = std::move(stored);  // Keeps its creation order
+            } else {
+                Entry entry{std::move(stored), state.next_sequence++};
+                // Longest path first, then oldest first
+                auto pos = std::find_if(bucket.cookies.begin(), bucket.cookies.end(), [&](const Entry& e) {
+                    return e.cookie.path.size() < entry.cookie.path.size();
+                });
+                it = bucket.cookies.insert(pos, std::move(entry));
+                ++state.size;
+            }
+            if (!it->cookie.session && it->cookie.expires < bucket.next_expiry) {
+                bucket.next_expiry = it->cookie.expires;
+            }
+            changed = true;
+        }
+        
+        void remove(const std::string& name, const std::string& domain, const std::string& path) {
+            std::string_view key = index_key(domain);
+            const Bucket* found = state.find(key);
+            if (!found) return;
+            auto matches = [&](const Entry& e) {
+                return e.cookie.name == name && e.cookie.domain == domain && e.cookie.path == path;
+            };
+            const auto& existing = found->cookies;
+            if (std::find_if(existing.begin(), existing.end(), matches) == existing.end()) return;
+            
+            Bucket& bucket = writable(key);
+            auto it = std::find_if(bucket.cookies.begin(), bucket.cookies.end(), matches);
+            if (it != bucket.cookies.end()) {
+                bucket.cookies.erase(it);
+                --state.size;
+                changed = true;
+            }
+            erase_if_empty(key);
+        }
+        
+        void clear() {
+            auto suffixes = std::move(state.public_suffixes);
+            uint64_t sequence = state.next_sequence;
+            state = State{};
+            state.public_suffixes = std::move(suffixes);
+            state.next_sequence = sequence;
+            owned.clear();
+            owned_shards.reset();
+            changed = true;
+        }
+        
+        void assign(const State& other) {
+            state = other;
+            owned.clear();
+            owned_shards.reset();
+            changed = true;
+        }
+        
+        void apply_set_cookie(std::string_view header, const std::string& host, std::string_view request_path) {
+            Cookie cookie;
+            if (!parse_cookie(header, host, request_path, cookie)) return;
+            if (cookie.is_expired(now)) {
+                // An expiry in the past deletes the stored cookie
+                remove(cookie.name, cookie.domain, cookie.path);
+            } else {
+                add(std::move(cookie));
+            }
+        }
+        
+        bool parse_cookie(std::string_view header, const std::string& host, std::string_view request_path,
+                          Cookie& cookie) const {
+            cookie.domain = host;
+            cookie.path = default_path(request_path);
+            
+            bool has_max_age = false;
+            bool first = true;
+            while (!header.empty()) {
+                size_t semi = header.find(';');
+                std::string_view segment = trim(header.substr(0, semi));
+                header = semi == std::string_view::npos ? std::string_view() : header.substr(semi + 1);
+                
+                size_t eq_pos = segment.find('=');
+                if (first) {
+                    // First segment is name=value
+                    first = false;
+                    if (eq_pos == std::string_view::npos) return false;
+                    cookie.name = std::string(trim(segment.substr(0, eq_pos)));
+                    cookie.value = std::string(trim(segment.substr(eq_pos + 1)));
+                    if (cookie.name.empty()) return false;
+                    continue;
+                }
+                
+                std::string attr_name = detail::lower_host(trim(segment.substr(0, eq_pos)));
+                std::string_view attr_value = eq_pos == std::string_view::npos
+                    ? std::string_view() : trim(segment.substr(eq_pos + 1));
+                
+                if (attr_name == "domain") {
+                    if (attr_value.empty()) continue;
+                    if (attr_value[0] == '.') attr_value.remove_prefix(1);
+                    std::string domain = detail::lower_host(attr_value);
+                    if (domain == host) {
+                        // Public suffixes may only set cookies for themselves
+                        if (!is_public_suffix(state, domain)) cookie.domain = "." + domain;
+                        continue;
+                    }
+                    // The request host must domain-match, and the domain must
+                    // be more specific than a public suffix
+                    if (detail::is_ip_literal(host) || is_public_suffix(state, domain) ||
+                        host.size() <= domain.size() ||
+                        host.compare(host.size() - domain.size(), domain.size(), domain) != 0 ||
+                        host[host.size() - domain.size() - 1] != '.') {
+                        return false;
+                    }
+                    cookie.domain = "." + domain;
+                } else if (attr_name == "path") {
+                    if (!attr_value.empty() && attr_value[0] == '/') cookie.path = std::string(attr_value);
+                } else if (attr_name == "secure") {
+                    cookie.secure = true;
+                } else if (attr_name == "httponly") {
+                    cookie.http_only = true;
+                } else if (attr_name == "max-age") {
+                    // Max-Age takes precedence over Expires
+                    try {
+                        long long max_age = std::stoll(std::string(attr_value));
+                        cookie.expires = max_age <= 0 ? std::chrono::system_clock::time_point::min()
+                                                      : now + std::chrono::seconds(max_age);
+                        cookie.session = false;
+                        has_max_age = true;
+                    } catch (...) {}
+                } else if (attr_name == "expires" && !has_max_age) {
+                    if (auto expires = parse_http_date(attr_value)) {
+                        cookie.expires = *expires;
+                        cookie.session = false;
+                    }
+                }
+            }
+            return !cookie.name.empty();
+        }
+    };
+    
+    template<typename F>
+    void update(F&& f) {
+        std::lock_guard<std::mutex> lock(core_->write_mutex);
+        publish(*core_, f);
+    }
+    
+    // Apply f to a copy of the current state and publish it; the caller
+    // holds the write mutex
+    template<typename F>
+    static void publish(Core& core, F&& f) {
+        auto current = core.load();
+        auto next = std::make_shared<State>(*current);
+        Batch batch{*next, std::chrono::system_clock::now(), {}, {}};
+        f(batch);
+        if (!batch.changed) return;
+        
+        next->generation = current->generation + 1;
+        core.store(std::move(next));
+    }
+    
+    // This thread's snapshot of the jar, refreshed when the generation moves;
+    // only then does a reader touch a lock, and only briefly.
+    // A thread keeps a reference per jar it uses; entries of destroyed jars
+    // are swept as new jars are seen.
+    ReaderCache& reader_cache() const {
+        thread_local std::unordered_map<uint64_t, ReaderCache> caches;
+        auto it = caches.find(core_->id);
+        if (it == caches.end()) {
+            if (caches.size() >= 16) {
+                for (auto c = caches.begin(); c != caches.end(); ) {
+                    c = c->second.owner.expired() ? caches.erase(c) : std::next(c);
+                }
+            }
+            it = caches.emplace(core_->id, ReaderCache{core_, nullptr, {}}).first;
+        }
+        ReaderCache& reader = it->second;
+        uint64_t generation = core_->generation.load(std::memory_order_acquire);
+        if (!reader.state || reader.state->generation != generation) {
+            reader.state = core_->load();
+        }
+        return reader;
+    }
+    
+    // Call f with the host, each parent domain, then "" for cookies without a domain
+    template<typename F>
+    static void for_each_domain(std::string_view host, F&& f) {
+        while (!host.empty()) {
+            f(host);
+            size_t dot = host.find('.');
+            if (dot == std::string_view::npos) break;
+            host.remove_prefix(dot + 1);
+        }
+        f(std::string_view());
+    }
+    
+    // Writes share untouched buckets between snapshots, so pointer equality
+    // means the cookies behind a cached header are unchanged
+    static bool sources_unchanged(const CachedHeader& entry, const State& state, const std::string& host) {
+        size_t i = 0;
+        bool unchanged = true;
+        for_each_domain(host, [&](std::string_view key) {
+            if (!unchanged) return;
+            unchanged = i < entry.sources.size() && entry.sources[i++].get() == state.find(key);
+        });
+        return unchanged && i == entry.sources.size();
+    }
+    
+    static bool is_public_suffix(const State& state, std::string_view domain) {
+        if (domain.find('.') == std::string_view::npos) return true;  // TLDs
+        return detail::builtin_public_suffixes().count(domain) > 0 ||
+               state.public_suffixes->count(std::string(domain)) > 0;
+    }
+    
+    // Domain cookies (".example.com") share a bucket with host cookies
+    static std::string_view index_key(std::string_view domain) {
+        if (!domain.empty() && domain[0] == '.') domain.remove_prefix(1);
+        return domain;
+    }
+    
+    static std::string_view trim(std::string_view s) {
+        size_t start = s.find_first_not_of(" \t");
+        if (start == std::string_view::npos) return {};
+        size_t end = s.find_last_not_of(" \t");
+        return s.substr(start, end - start + 1);
+    }
+    
+    // Directory of the request path, per RFC 6265 section 5.1.4
+    static std::string default_path(std::string_view request_path) {
+        request_path = request_path.substr(0, request_path.find_first_of("?#"));
+        if (request_path.empty() || request_path[0] != '/') return "/";
+        size_t last = request_path.rfind('/');
+        if (last == 0) return "/";
+        return std::string(request_path.substr(0, last));
+    }
+    
+    std::shared_ptr<Core> core_;
 };
 
 }
@@ -9,3 +9,4 @@
 #include "cookie_jar.hpp"
 #include "interceptor.hpp"
 #include "sse_event.hpp"
+#include "sse_stream.hpp"
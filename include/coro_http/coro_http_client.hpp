@@ -6,11 +6,22 @@
 #include "http_parser.hpp"
 #include "client_config.hpp"
 #include "proxy_handler.hpp"
+#include "proxy_selector.hpp"
 #include "connection_pool.hpp"
 #include "rate_limiter.hpp"
 #include "retry_policy.hpp"
 #include "cookie_jar.hpp"
 #include "sse_event.hpp"
+#include "sse_stream.hpp"
+#include "idle_deadline.hpp"
+#include "buffer_pool.hpp"
+#include "http_cache.hpp"
+#include "request_coalescer.hpp"
+#include "dns_cache.hpp"
+#include "tls_session_cache.hpp"
+#include "redirect_cache.hpp"
+#include "file_body.hpp"
+#include "state_snapshot.hpp"
 #include <asio.hpp>
 #include <asio/ssl.hpp>
 #include <asio/co_spawn.hpp>
@@ -20,6 +31,9 @@
 #include <sstream>
 #include <type_traits>
 #include <functional>
+#include <array>
+#include <cstdio>
+#include <random>
 
 namespace coro_http {
 
@@ -32,7 +46,8 @@ public:
         : io_context_(io_context), 
           ssl_context_(asio::ssl::context::tlsv12_client),
           config_(config),
-          proxy_info_(parse_proxy_url(config.proxy_url)),
+          proxies_(make_proxy_routes(config), NoProxyMatcher(config.no_proxy),
+                   config.proxy_max_failures, config.proxy_probe_interval),
           connection_pool_(config.max_connections_per_host, config.connection_idle_timeout),
           rate_limiter_(config.enable_rate_limit ? config.rate_limit_requests : 0, config.rate_limit_window),
           retry_policy_(config.max_retries,
@@ -56,17 +71,153 @@ public:
             ssl_context_.set_verify_mode(asio::ssl::verify_none);
         }
         
-        if (!config_.proxy_username.empty()) {
-            proxy_info_.username = config_.proxy_username;
-            proxy_info_.password = config_.proxy_password;
+        if (config_.enable_cache) {
+            std::shared_ptr<DiskCache> disk;
+#if !defined(_WIN32)
+            // There is no disk cache on Windows; the cache stays memory only
+            if (!config_.cache_directory.empty()) {
+                disk = std::make_shared<DiskCache>(config_.cache_directory, config_.cache_disk_max_bytes);
+            }
+#endif
+            cache_ = std::make_unique<HttpCache>(config_.cache_max_bytes, config_.cache_shards, std::move(disk));
+        }
+        
+        if (config_.enable_request_coalescing) {
+            coalescer_ = std::make_unique<RequestCoalescer>(config_.coalescing_max_wait);
+        }
+        
+        if (config_.enable_dns_cache) {
+            dns_cache_ = std::make_unique<DnsCache>(config_.dns_cache_ttl);
+        }
+        
+        if (config_.enable_tls_session_cache) {
+            tls_sessions_ = std::make_unique<TlsSessionCache>();
+        }
+        
+        if (config_.redirect_cache_size > 0) {
+            redirect_cache_ = std::make_unique<RedirectCache>(config_.redirect_cache_size);
+        }
+        
+        if (!config_.state_snapshot_path.empty()) {
+            // An unreadable snapshot only costs the warm start; the next save replaces it
+            try {
+                if (auto snapshot = StateSnapshot::load(config_.state_snapshot_path)) {
+                    snapshot->restore(&cookie_jar_, dns_cache_.get(), tls_sessions_.get());
+                }
+            } catch (const std::exception&) {
+            }
+            snapshot_writer_ = std::make_unique<StateSnapshotWriter>(
+                [this, path = config_.state_snapshot_path] { save_state(path); },
+                config_.state_snapshot_interval);
         }
     }
 
-    asio::awaitable<HttpResponse> co_execute(const HttpRequest& request) {
+    // Not a coroutine itself: hands the request straight to the coalescing,
+    // cache, redirect or retry layer so the common path does not pay for an extra frame.
+    asio::awaitable<HttpResponse> co_execute(HttpRequest request) {
+        if (coalescer_ && request.method() == HttpMethod::GET) {
+            return co_execute_coalesced(std::move(request));
+        }
+        return co_execute_single(std::move(request));
+    }
+    
+    // Like co_execute, but the response is shared rather than copied: with
+    // request coalescing enabled, every caller that joined the same fetch
+    // receives the same object.
+    asio::awaitable<std::shared_ptr<const HttpResponse>> co_execute_shared(HttpRequest request) {
+        if (coalescer_ && request.method() == HttpMethod::GET) {
+            co_return co_await coalescer_->co_execute(std::move(request), [this](HttpRequest r) {
+                return co_execute_single(std::move(r));
+            });
+        }
+        co_return std::make_shared<const HttpResponse>(co_await co_execute_single(std::move(request)));
+    }
+
+private:
+    asio::awaitable<HttpResponse> co_execute_coalesced(HttpRequest request) {
+        auto shared = co_await co_execute_shared(std::move(request));
+        co_return *shared;
+    }
+    
+    asio::awaitable<HttpResponse> co_execute_single(HttpRequest request) {
+        if (cache_) {
+            return co_execute_cached(std::move(request));
+        }
+        return co_execute_uncached(std::move(request));
+    }
+    
+    asio::awaitable<HttpResponse> co_execute_uncached(HttpRequest request) {
         if (!config_.enable_retry) {
-            co_return co_await co_execute_with_redirects(request, 0);
+            return co_execute_with_redirects(std::move(request));
+        }
+        return co_execute_with_retry(std::move(request));
+    }
+    
+    asio::awaitable<HttpResponse> co_execute_cached(HttpRequest request) {
+        if (!HttpCache::is_cacheable_request(request)) {
+            bool unsafe = request.method() != HttpMethod::GET && request.method() != HttpMethod::HEAD &&
+                          request.method() != HttpMethod::OPTIONS;
+            std::string url = request.url();
+            HttpResponse response = co_await co_execute_uncached(std::move(request));
+            // A successful unsafe method makes stored responses for the URL stale
+            if (unsafe && response.status_code() < 400) {
+                cache_->invalidate(url);
+            }
+            co_return response;
+        }
+        
+        auto now = std::chrono::system_clock::now();
+        auto cached = cache_->lookup(request, now);
+        if (cached && cached->freshness == HttpCache::Freshness::Fresh) {
+            co_return HttpCache::serve(*cached->entry, now);
+        }
+        if (cached && cached->freshness == HttpCache::Freshness::StaleWhileRevalidate) {
+            // Serve the stale copy now; one refresh per entry runs in the background
+            if (!cached->entry->revalidating.exchange(true)) {
+                asio::co_spawn(io_context_, co_background_revalidate(request, cached->entry), asio::detached);
+            }
+            co_return HttpCache::serve(*cached->entry, now);
         }
+        std::shared_ptr<const CacheEntry> entry;
+        if (cached) entry = cached->entry;
+        co_return co_await co_revalidate(std::move(request), std::move(entry));
+    }
+    
+    // Fetch from the origin, conditionally when a stored entry has validators,
+    // and update the cache with the result.
+    asio::awaitable<HttpResponse> co_revalidate(HttpRequest request, std::shared_ptr<const CacheEntry> entry) {
+        HttpRequest conditional = request;
+        if (entry) {
+            HttpCache::add_validators(conditional, *entry);
+        }
+        
+        auto request_time = std::chrono::system_clock::now();
+        HttpResponse response = co_await co_execute_uncached(std::move(conditional));
+        auto response_time = std::chrono::system_clock::now();
         
+        if (entry && response.status_code() == 304) {
+            auto refreshed = cache_->freshen(request, *entry, response, request_time, response_time);
+            co_return HttpCache::serve(refreshed ? *refreshed : *entry, response_time);
+        }
+        if (entry && response.status_code() >= 500 && HttpCache::usable_on_error(*entry, response_time)) {
+            co_return HttpCache::serve(*entry, response_time);
+        }
+        if (response.redirect_chain().empty()) {
+            cache_->store(request, response, request_time, response_time);
+        }
+        co_return response;
+    }
+    
+    asio::awaitable<void> co_background_revalidate(HttpRequest request, std::shared_ptr<const CacheEntry> entry) {
+        try {
+            co_await co_revalidate(std::move(request), entry);
+        } catch (...) {
+            // The stale copy keeps being served until it expires for good
+        }
+        entry->revalidating = false;
+    }
+
+    asio::awaitable<HttpResponse> co_execute_with_retry(HttpRequest request) {
         // Retry logic with exponential backoff
         retry_policy_.reset();
         
@@ -80,7 +231,7 @@ public:
             
             // Try to execute request
             try {
-                response = co_await co_execute_with_redirects(request, 0);
+                response = co_await co_execute_with_redirects(request);
                 success = true;
                 
                 // Check if we should retry based on status code  
@@ -133,133 +284,214 @@ public:
         }
     }
 
-private:
-    asio::awaitable<HttpResponse> co_execute_with_redirects(const HttpRequest& request, int redirect_count) {
-        auto url_info = parse_url(request.url());
+    // Redirect hops run in this loop, so a chain costs one coroutine frame.
+    // Permanent redirects already seen are taken from redirect_cache_ without
+    // asking the server again; hops to the same host reuse its pooled
+    // connection like any other request.
+    asio::awaitable<HttpResponse> co_execute_with_redirects(HttpRequest request) {
+        std::vector<std::string> chain;
+        int redirects = 0;
         
-        // Add cookies to request if enabled
-        HttpRequest req_with_cookies = request;
-        if (config_.enable_cookies) {
-            std::string cookies = cookie_jar_.get_cookies_for_request(
-                url_info.host, url_info.path, url_info.is_https);
-            if (!cookies.empty()) {
-                req_with_cookies.add_header("Cookie", cookies);
+        while (true) {
+            if (redirect_cache_ && config_.follow_redirects) {
+                while (redirects < config_.max_redirects) {
+                    auto cached = redirect_cache_->lookup(request.url());
+                    if (!cached) break;
+                    chain.push_back(cached->url);
+                    request = redirect_request(request, cached->url, cached->preserve_method ? 308 : 301);
+                    ++redirects;
+                }
             }
-        }
-        
-        HttpResponse response;
-        if (url_info.is_https) {
-            response = co_await co_execute_https(req_with_cookies, url_info);
-        } else {
-            response = co_await co_execute_http(req_with_cookies, url_info);
-        }
-        
-        // Extract cookies from response if enabled
-        if (config_.enable_cookies) {
-            for (const auto& [key, value] : response.headers()) {
-                if (strcasecmp_parser(key, "Set-Cookie")) {
-                    cookie_jar_.parse_set_cookie(value, url_info.host);
+            
+            auto url_info = target_of(request.url());
+            
+            // Add cookies to request if enabled
+            bool added_cookies = false;
+            if (config_.enable_cookies) {
+                std::string cookies = cookie_jar_.get_cookies_for_request(
+                    url_info.host, url_info.path, url_info.is_https);
+                if (!cookies.empty()) {
+                    request.add_header("Cookie", cookies);
+                    added_cookies = true;
                 }
             }
-        }
-        
-        if (config_.follow_redirects && 
-            redirect_count < config_.max_redirects &&
-            (response.status_code() >= 300 && response.status_code() < 400)) {
             
-            std::string location = response.get_header("Location");
-            if (!location.empty()) {
-                response.add_redirect(location);
-                
-                if (location[0] == '/') {
-                    location = url_info.scheme + "://" + url_info.host + 
-                              (url_info.port != (url_info.is_https ? "443" : "80") ? ":" + url_info.port : "") + 
-                              location;
+            // Only a failure to reach the proxy or open its tunnel counts
+            // against it; errors from the origin server do not
+            url_info.proxy = acquire_proxy(url_info);
+            bool proxy_failed = false;
+            url_info.proxy_failed = &proxy_failed;
+            start_due_probe();
+            auto started = std::chrono::steady_clock::now();
+            
+            HttpResponse response;
+            try {
+                if (url_info.is_https) {
+                    response = co_await co_execute_https(request, url_info);
+                } else {
+                    response = co_await co_execute_http(request, url_info);
                 }
-                
-                HttpRequest redirect_req(HttpMethod::GET, location);
-                for (const auto& [key, value] : request.headers()) {
-                    redirect_req.add_header(key, value);
+            } catch (...) {
+                proxies_.release(url_info.proxy, !proxy_failed, {});
+                throw;
+            }
+            proxies_.release(url_info.proxy, true, std::chrono::steady_clock::now() - started);
+            
+            // Extract cookies from response if enabled
+            if (config_.enable_cookies) {
+                std::vector<std::string> set_cookies;
+                for (const auto& [key, value] : response.headers()) {
+                    if (strcasecmp_parser(key, "Set-Cookie")) {
+                        set_cookies.push_back(value);
+                    }
                 }
-                
-                auto redirect_resp = co_await co_execute_with_redirects(redirect_req, redirect_count + 1);
-                for (const auto& url : response.redirect_chain()) {
-                    redirect_resp.add_redirect(url);
+                cookie_jar_.parse_set_cookies(set_cookies, url_info.host, url_info.path);
+            }
+            
+            int status = response.status_code();
+            std::string location = response.get_header("Location");
+            if (!config_.follow_redirects || redirects >= config_.max_redirects || location.empty() ||
+                !is_redirect_status(status)) {
+                for (const auto& url : chain) {
+                    response.add_redirect(url);
                 }
-                co_return redirect_resp;
+                co_return response;
+            }
+            
+            location = resolve_location(url_info, location);
+            if (redirect_cache_) {
+                redirect_cache_->store(request.url(), location, response);
             }
+            chain.push_back(location);
+            
+            // Cookies for the new location are looked up again by the next hop
+            if (added_cookies) {
+                request.remove_header("Cookie");
+            }
+            request = redirect_request(request, location, status);
+            ++redirects;
         }
-        
-        co_return response;
     }
-
+    
+    static bool is_redirect_status(int status) {
+        return status == 301 || status == 302 || status == 303 || status == 307 || status == 308;
+    }
+    
+    // The URL a Location value points to. The fragment is dropped, since
+    // it is never sent and parse_url would keep it in the path.
+    static std::string resolve_location(const UrlInfo& base, const std::string& location) {
+        std::string resolved = resolve_url(base, location);
+        return resolved.substr(0, resolved.find('#'));
+    }
+    
+    // The request to send to `location` after a `status` redirect (RFC 9110
+    // 15.4): 303 turns anything but HEAD into GET, 301 and 302 turn POST into
+    // GET, and 307 and 308 keep the method and body. Credentials stay behind
+    // when the origin changes.
+    static HttpRequest redirect_request(const HttpRequest& request, const std::string& location, int status) {
+        HttpMethod method = request.method();
+        bool to_get = (status == 303 && method != HttpMethod::HEAD) ||
+                      ((status == 301 || status == 302) && method == HttpMethod::POST);
+        
+        auto from = parse_url(request.url());
+        auto to = parse_url(location);
+        bool same_origin = from.scheme == to.scheme && from.host == to.host && from.port == to.port;
+        
+        HttpRequest next(to_get ? HttpMethod::GET : method, location);
+        for (const auto& [key, value] : request.headers()) {
+            if (to_get && (strcasecmp_parser(key, "Content-Type") || strcasecmp_parser(key, "Content-Length") ||
+                           strcasecmp_parser(key, "Content-Encoding") ||
+                           strcasecmp_parser(key, "Transfer-Encoding"))) {
+                continue;
+            }
+            if (!same_origin && (strcasecmp_parser(key, "Authorization") || strcasecmp_parser(key, "Cookie"))) {
+                continue;
+            }
+            next.add_header(key, value);
+        }
+        if (!to_get) {
+            next.set_body(request.body());
+            if (!request.body_file().empty()) {
+                next.set_body_file(request.body_file());
+            }
+            if (request.body_compression()) {
+                next.set_body_compression(*request.body_compression());
+            }
+        }
+        return next;
+    }
+    
+    // Dispatchers below are plain functions returning the selected coroutine,
+    // so choosing pooled vs. direct transport does not cost a frame.
     asio::awaitable<HttpResponse> co_execute_http(const HttpRequest& request, const UrlInfo& url_info) {
         // Apply rate limiting (synchronous for now)
         rate_limiter_.acquire();
         
         // Use connection pool if enabled
-        if (config_.enable_connection_pool && proxy_info_.type == ProxyType::NONE) {
-            co_return co_await co_execute_http_pooled(request, url_info);
+        if (!url_info.unix_socket.empty()) {
+            return use_connection_pool() ? co_execute_http_pooled<UnixSocket>(request, url_info)
+                                         : co_execute_http_direct<UnixSocket>(request, url_info);
         }
-        
-        // Non-pooled connection for proxy requests
-        asio::ip::tcp::socket socket(io_context_);
-        co_await co_connect_socket(socket, url_info);
-        
-        std::string request_str;
-        if (proxy_info_.type == ProxyType::HTTP) {
-            request_str = build_proxy_request(request, url_info, config_.enable_compression);
-        } else {
-            request_str = build_request(request, url_info, config_.enable_compression);
+        if (use_connection_pool()) {
+            return co_execute_http_pooled<asio::ip::tcp::socket>(request, url_info);
         }
+        return co_execute_http_direct<asio::ip::tcp::socket>(request, url_info);
+    }
+    
+    // Plain HTTP over TCP or a Unix domain socket; the stream type picks the
+    // connect path, and pooling, framing and body writing are shared
+    template<typename Socket>
+    asio::awaitable<HttpResponse> co_execute_http_direct(const HttpRequest& request, const UrlInfo& url_info) {
+        // Non-pooled connection
+        Socket socket(io_context_);
+        co_await co_connect_socket(socket, url_info);
         
-        co_await asio::async_write(socket, asio::buffer(request_str), asio::use_awaitable);
-        std::string response_data = co_await co_read_response(socket, request.method());
+        co_await co_write_request(socket, request, url_info, false);
+        auto wire = co_await co_read_response(socket, request.method());
         
-        co_return parse_response(response_data);
+        co_return parse_response(wire.head, std::move(wire.body), wire.decoded);
     }
     
+    template<typename Socket>
     asio::awaitable<HttpResponse> co_execute_http_pooled(const HttpRequest& request, const UrlInfo& url_info) {
-        auto socket = connection_pool_.get_connection(io_context_, url_info.host, url_info.port);
-        
-        // Check if we need to connect
-        if (!socket->is_open()) {
-            asio::ip::tcp::resolver resolver(io_context_);
-            auto endpoints = co_await resolver.async_resolve(
-                url_info.host, url_info.port, asio::use_awaitable);
-            co_await asio::async_connect(*socket, endpoints, asio::use_awaitable);
-        }
-        
-        std::string request_str = build_request(request, url_info, config_.enable_compression, true);
+        auto key = pool_key(url_info);
+        auto socket = connection_pool_.acquire<Socket>(key, io_context_);
         
         try {
-            co_await asio::async_write(*socket, asio::buffer(request_str), asio::use_awaitable);
-            std::string response_data = co_await co_read_response(*socket, request.method());
+            // Check if we need to connect
+            if (!socket->is_open()) {
+                co_await co_connect_socket(*socket, url_info);
+            }
+            
+            co_await co_write_request(*socket, request, url_info, true);
+            auto wire = co_await co_read_response(*socket, request.method());
             
             // Parse response and check Connection header
-            auto response = parse_response(response_data);
+            auto response = parse_response(wire.head, std::move(wire.body), wire.decoded);
             
-            // Check if server wants to close the connection
+            // Check if server wants to close the connection; a response that
+            // was not framed exactly leaves the connection unusable either way
             std::string connection_header = response.get_header("Connection");
             std::transform(connection_header.begin(), connection_header.end(), 
                          connection_header.begin(), ::tolower);
-            bool should_keep_alive = (connection_header != "close");
+            bool should_keep_alive = wire.reusable && (connection_header != "close");
             
             // Return connection to pool only if keep-alive
-            connection_pool_.release_connection(socket, url_info.host, url_info.port, should_keep_alive);
+            connection_pool_.release(socket, key, should_keep_alive);
             
             // Close socket if server requested close
             if (!should_keep_alive) {
                 asio::error_code ec;
-                socket->shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+                socket->shutdown(Socket::shutdown_both, ec);
                 socket->close(ec);
             }
             
             co_return response;
         } catch (...) {
-            // Don't return broken connection to pool
+            // Don't return broken connection to pool, and free its slot
+            connection_pool_.release(socket, key, false);
             asio::error_code ec;
-            socket->shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+            socket->shutdown(Socket::shutdown_both, ec);
             socket->close(ec);
             throw;
         }
@@ -270,67 +502,53 @@ private:
         rate_limiter_.acquire();
         
         // Use SSL connection pool if enabled
-        if (config_.enable_connection_pool && proxy_info_.type == ProxyType::NONE) {
-            co_return co_await co_execute_https_pooled(request, url_info);
+        if (use_connection_pool()) {
+            return co_execute_https_pooled(request, url_info);
         }
-        
-        // Non-pooled connection for proxy requests
+        return co_execute_https_direct(request, url_info);
+    }
+    
+    asio::awaitable<HttpResponse> co_execute_https_direct(const HttpRequest& request, const UrlInfo& url_info) {
+        // Non-pooled connection
         asio::ssl::stream<asio::ip::tcp::socket> ssl_socket(io_context_, ssl_context_);
         
-        co_await co_connect_socket(ssl_socket.next_layer(), url_info);
-        
-        if (proxy_info_.type != ProxyType::NONE) {
-            co_await co_establish_tunnel(ssl_socket.next_layer(), url_info);
-        }
-        
-        if (config_.verify_ssl) {
-            SSL_set_tlsext_host_name(ssl_socket.native_handle(), url_info.host.c_str());
-        }
+        co_await co_open_tls(ssl_socket, url_info, tls_sessions_.get());
         
-        co_await ssl_socket.async_handshake(asio::ssl::stream_base::client, asio::use_awaitable);
+        co_await co_write_request(ssl_socket, request, url_info, false);
         
-        std::string request_str = build_request(request, url_info, config_.enable_compression);
-        co_await asio::async_write(ssl_socket, asio::buffer(request_str), asio::use_awaitable);
+        auto wire = co_await co_read_response(ssl_socket, request.method());
+        remember_tls_session(ssl_socket.native_handle(), url_info);
         
-        std::string response_data = co_await co_read_response(ssl_socket, request.method());
-        
-        co_return parse_response(response_data);
+        co_return parse_response(wire.head, std::move(wire.body), wire.decoded);
     }
     
     asio::awaitable<HttpResponse> co_execute_https_pooled(const HttpRequest& request, const UrlInfo& url_info) {
-        auto ssl_stream = connection_pool_.get_ssl_connection(io_context_, ssl_context_, url_info.host, url_info.port);
+        auto ssl_stream = connection_pool_.get_ssl_connection(io_context_, ssl_context_, url_info.host, url_info.port,
+                                                              route_of(url_info));
         
-        // Check if we need to connect
-        if (!ssl_stream->lowest_layer().is_open()) {
-            asio::ip::tcp::resolver resolver(io_context_);
-            auto endpoints = co_await resolver.async_resolve(
-                url_info.host, url_info.port, asio::use_awaitable);
-            co_await asio::async_connect(ssl_stream->lowest_layer(), endpoints, asio::use_awaitable);
-            
-            if (config_.verify_ssl) {
-                SSL_set_tlsext_host_name(ssl_stream->native_handle(), url_info.host.c_str());
+        try {
+            // Check if we need to connect
+            if (!ssl_stream->lowest_layer().is_open()) {
+                co_await co_open_tls(*ssl_stream, url_info, tls_sessions_.get());
             }
             
-            co_await ssl_stream->async_handshake(asio::ssl::stream_base::client, asio::use_awaitable);
-        }
-        
-        std::string request_str = build_request(request, url_info, config_.enable_compression, true);
-        
-        try {
-            co_await asio::async_write(*ssl_stream, asio::buffer(request_str), asio::use_awaitable);
-            std::string response_data = co_await co_read_response(*ssl_stream, request.method());
+            co_await co_write_request(*ssl_stream, request, url_info, true);
+            auto wire = co_await co_read_response(*ssl_stream, request.method());
+            remember_tls_session(ssl_stream->native_handle(), url_info);
             
             // Parse response and check Connection header
-            auto response = parse_response(response_data);
+            auto response = parse_response(wire.head, std::move(wire.body), wire.decoded);
             
-            // Check if server wants to close the connection
+            // Check if server wants to close the connection; a response that
+            // was not framed exactly leaves the connection unusable either way
             std::string connection_header = response.get_header("Connection");
             std::transform(connection_header.begin(), connection_header.end(), 
                          connection_header.begin(), ::tolower);
-            bool should_keep_alive = (connection_header != "close");
+            bool should_keep_alive = wire.reusable && (connection_header != "close");
             
             // Return connection to pool only if keep-alive
-            connection_pool_.release_ssl_connection(ssl_stream, url_info.host, url_info.port, should_keep_alive);
+            connection_pool_.release_ssl_connection(ssl_stream, url_info.host, url_info.port, should_keep_alive,
+                                                    route_of(url_info));
             
             // Close SSL connection if server requested close
             if (!should_keep_alive) {
@@ -341,68 +559,272 @@ private:
             
             co_return response;
         } catch (...) {
-            // Don't return broken connection to pool
+            // Don't return broken connection to pool, and free its slot
+            connection_pool_.release_ssl_connection(ssl_stream, url_info.host, url_info.port, false,
+                                                    route_of(url_info));
             asio::error_code ec;
             ssl_stream->lowest_layer().close(ec);
             throw;
         }
     }
 
+    // Proxy a request goes through, as chosen by proxies_ for its UrlInfo
+    static const ProxyInfo& proxy_of(const UrlInfo& url_info) {
+        static const ProxyInfo direct;
+        return url_info.proxy ? url_info.proxy->info : direct;
+    }
+    
+    static const std::string& route_of(const UrlInfo& url_info) {
+        static const std::string direct;
+        return url_info.proxy ? url_info.proxy->key : direct;
+    }
+    
+    // Proxies from proxy_url and proxies, with the configured credentials
+    static std::vector<ProxyRoute> make_proxy_routes(const ClientConfig& config) {
+        std::vector<ProxyServer> servers = config.proxies;
+        if (!config.proxy_url.empty()) {
+            servers.insert(servers.begin(), ProxyServer{config.proxy_url, 1});
+        }
+        std::vector<ProxyRoute> routes;
+        for (const auto& server : servers) {
+            ProxyRoute route;
+            route.info = parse_proxy_url(server.url);
+            if (!config.proxy_username.empty()) {
+                route.info.username = config.proxy_username;
+                route.info.password = config.proxy_password;
+            }
+            route.key = proxy_route(route.info);
+            route.weight = server.weight;
+            routes.push_back(std::move(route));
+        }
+        return routes;
+    }
+    
+    // Start the health probe of an ejected proxy if one is due. Probing
+    // piggybacks on traffic, so an idle client leaves no timers behind.
+    void start_due_probe() {
+        if (const ProxyRoute* route = proxies_.take_due_probe()) {
+            asio::co_spawn(io_context_, co_probe_proxy(route), asio::detached);
+        }
+    }
+    
+    // A proxy is healthy again once it accepts a connection within connect_timeout
+    asio::awaitable<void> co_probe_proxy(const ProxyRoute* route) {
+        auto socket = std::make_shared<asio::ip::tcp::socket>(io_context_);
+        IdleDeadline deadline(io_context_, config_.connect_timeout, [socket] {
+            asio::error_code ec;
+            socket->close(ec);
+        });
+        bool healthy = false;
+        try {
+            co_await co_connect_host(*socket, route->info.host, route->info.port);
+            healthy = true;
+        } catch (...) {
+        }
+        asio::error_code ec;
+        socket->close(ec);
+        proxies_.probe_result(route, healthy);
+    }
+    
+    // Pooled connections are keyed by the proxy route as well as the target, so
+    // proxied and direct connections never mix
+    bool use_connection_pool() const {
+        return config_.enable_connection_pool;
+    }
+    
+    // Target a pooled plain HTTP connection is keyed by. A forward proxy
+    // takes requests for any host on one connection, so it is the proxy
+    // itself; tunnels (CONNECT or SOCKS5) and direct connections lead to
+    // one target.
+    std::string pool_key(const UrlInfo& url_info) const {
+        if (!url_info.unix_socket.empty()) {
+            return url_info.unix_socket;
+        }
+        const ProxyInfo& proxy = proxy_of(url_info);
+        if (!url_info.is_https && proxy.type == ProxyType::HTTP) {
+            return ConnectionPool::key_for(proxy.host, proxy.port, route_of(url_info));
+        }
+        return ConnectionPool::key_for(url_info.host, url_info.port, route_of(url_info));
+    }
+    
+    // The URL's target with ClientConfig::unix_sockets applied
+    UrlInfo target_of(const std::string& url) const {
+        auto url_info = parse_url(url);
+        if (!url_info.is_https && url_info.unix_socket.empty()) {
+            auto it = config_.unix_sockets.find(url_info.host);
+            if (it != config_.unix_sockets.end()) {
+                url_info.unix_socket = it->second;
+            }
+        }
+        return url_info;
+    }
+    
+    // Unix domain socket targets are local and never go through a proxy
+    const ProxyRoute* acquire_proxy(const UrlInfo& url_info) {
+        return url_info.unix_socket.empty() ? proxies_.acquire(url_info.host) : nullptr;
+    }
+
     asio::awaitable<void> co_connect_socket(asio::ip::tcp::socket& socket, const UrlInfo& url_info) {
-        asio::ip::tcp::resolver resolver(io_context_);
-        
-        std::string connect_host;
-        std::string connect_port;
-        
-        if (proxy_info_.type != ProxyType::NONE) {
-            connect_host = proxy_info_.host;
-            connect_port = proxy_info_.port;
-        } else {
-            connect_host = url_info.host;
-            connect_port = url_info.port;
+        const ProxyInfo& proxy = proxy_of(url_info);
+        if (proxy.type == ProxyType::NONE) {
+            co_await co_connect_host(socket, url_info.host, url_info.port);
+            co_return;
         }
         
-        auto endpoints = co_await resolver.async_resolve(
-            connect_host, 
-            connect_port, 
-            asio::use_awaitable
-        );
+        try {
+            co_await co_connect_host(socket, proxy.host, proxy.port);
+            if (proxy.type == ProxyType::SOCKS5) {
+                co_await co_perform_socks5_handshake(socket, url_info);
+            }
+        } catch (...) {
+            mark_proxy_failed(url_info);
+            throw;
+        }
+    }
+    
+    static void mark_proxy_failed(const UrlInfo& url_info) {
+        if (url_info.proxy_failed) {
+            *url_info.proxy_failed = true;
+        }
+    }
+    
+    asio::awaitable<void> co_connect_socket(UnixSocket& socket, const UrlInfo& url_info) {
+        co_await socket.async_connect(UnixSocket::endpoint_type(url_info.unix_socket), asio::use_awaitable);
+    }
+
+    // Resolve and connect. When no endpoint accepts, the cached addresses
+    // are dropped so the next attempt resolves the host again.
+    asio::awaitable<void> co_connect_host(asio::ip::tcp::socket& socket, const std::string& host,
+                                          const std::string& port) {
+        auto endpoints = co_await co_resolve(host, port);
+        try {
+            co_await co_connect_endpoints(socket, endpoints, socket_options_for(host));
+        } catch (...) {
+            if (dns_cache_) {
+                dns_cache_->remove(host, port);
+            }
+            throw;
+        }
+    }
+    
+    // Try each endpoint in turn. The socket is opened and tuned before
+    // connect, since buffer sizes and fast open only count at the handshake.
+    asio::awaitable<void> co_connect_endpoints(asio::ip::tcp::socket& socket,
+                                               const std::vector<asio::ip::tcp::endpoint>& endpoints,
+                                               const SocketOptions& options) {
+        asio::error_code ec = asio::error::host_not_found;
+        for (const auto& endpoint : endpoints) {
+            asio::error_code ignored;
+            socket.close(ignored);
+            socket.open(endpoint.protocol(), ec);
+            if (ec) continue;
+            apply_socket_options(socket, options);
+            auto [connect_ec] = co_await socket.async_connect(endpoint, asio::as_tuple(asio::use_awaitable));
+            if (!connect_ec) co_return;
+            ec = connect_ec;
+            if (ec == asio::error::operation_aborted) break;  // Closed by a deadline
+        }
+        asio::error_code ignored;
+        socket.close(ignored);
+        throw std::system_error(ec);
+    }
+    
+    asio::awaitable<std::vector<asio::ip::tcp::endpoint>> co_resolve(const std::string& host, const std::string& port) {
+        if (dns_cache_) {
+            if (auto cached = dns_cache_->lookup(host, port)) {
+                co_return std::move(*cached);
+            }
+        }
+        asio::ip::tcp::resolver resolver(io_context_);
+        auto results = co_await resolver.async_resolve(host, port, asio::use_awaitable);
+        std::vector<asio::ip::tcp::endpoint> endpoints;
+        for (const auto& result : results) {
+            endpoints.push_back(result.endpoint());
+        }
+        if (dns_cache_) {
+            dns_cache_->store(host, port, endpoints);
+        }
+        co_return endpoints;
+    }
+    
+    // Connect, through the proxy and its tunnel if one is configured, and
+    // run the TLS handshake, resuming a session from `sessions` if it has one
+    asio::awaitable<void> co_open_tls(asio::ssl::stream<asio::ip::tcp::socket>& ssl_stream, const UrlInfo& url_info,
+                                      TlsSessionCache* sessions) {
+        co_await co_connect_socket(ssl_stream.next_layer(), url_info);
+        
+        // A SOCKS5 tunnel is already open once connected
+        ProxyType proxy_type = proxy_of(url_info).type;
+        if (proxy_type == ProxyType::HTTP || proxy_type == ProxyType::HTTPS) {
+            try {
+                co_await co_establish_tunnel(ssl_stream.next_layer(), url_info);
+            } catch (...) {
+                mark_proxy_failed(url_info);
+                throw;
+            }
+        }
         
-        co_await asio::async_connect(socket, endpoints, asio::use_awaitable);
+        if (config_.verify_ssl) {
+            SSL_set_tlsext_host_name(ssl_stream.native_handle(), url_info.host.c_str());
+        }
+        if (sessions) {
+            sessions->apply(ssl_stream.native_handle(), TlsSessionCache::key_for(url_info.host, url_info.port));
+        }
         
-        if (proxy_info_.type == ProxyType::SOCKS5) {
-            co_await co_perform_socks5_handshake(socket, url_info);
+        co_await ssl_stream.async_handshake(asio::ssl::stream_base::client, asio::use_awaitable);
+    }
+    
+    void remember_tls_session(SSL* ssl, const UrlInfo& url_info) {
+        if (tls_sessions_) {
+            tls_sessions_->store(ssl, TlsSessionCache::key_for(url_info.host, url_info.port));
         }
     }
-
+    
     asio::awaitable<void> co_establish_tunnel(asio::ip::tcp::socket& socket, const UrlInfo& url_info) {
         std::string connect_req = build_connect_request(
             url_info.host, url_info.port,
-            proxy_info_.username, proxy_info_.password
+            proxy_of(url_info).username, proxy_of(url_info).password
         );
         
         co_await asio::async_write(socket, asio::buffer(connect_req), asio::use_awaitable);
         
-        std::array<char, 8192> buffer;
-        auto [ec, len] = co_await socket.async_read_some(
-            asio::buffer(buffer),
+        // Read the whole response head; the tunnel carries only TLS after it,
+        // and the server speaks no earlier than our handshake
+        std::string response;
+        auto [ec, len] = co_await asio::async_read_until(
+            socket, asio::dynamic_buffer(response, 16 * 1024), "\r\n\r\n",
             asio::as_tuple(asio::use_awaitable)
         );
         
-        if (ec && ec != asio::error::eof) {
+        if (ec) {
             throw std::system_error(ec);
         }
         
-        std::string response(buffer.data(), len);
         if (!parse_connect_response(response)) {
             throw std::runtime_error("Proxy CONNECT failed");
         }
     }
 
+    // With socks5_pipelining the greeting offers a single method, so auth and
+    // CONNECT can follow in the same write and the handshake costs one round
+    // trip; the replies are then read in order. Otherwise each step waits for
+    // the proxy's answer.
     asio::awaitable<void> co_perform_socks5_handshake(asio::ip::tcp::socket& socket, const UrlInfo& url_info) {
-        bool use_auth = !proxy_info_.username.empty();
-        std::string handshake = build_socks5_handshake(use_auth);
-        co_await asio::async_write(socket, asio::buffer(handshake), asio::use_awaitable);
+        const ProxyInfo& proxy = proxy_of(url_info);
+        bool use_auth = !proxy.username.empty();
+        bool pipelined = config_.socks5_pipelining;
+        std::string handshake = build_socks5_handshake(use_auth, pipelined);
+        std::string auth = use_auth ? build_socks5_auth(proxy.username, proxy.password) : "";
+        std::string connect_req = build_socks5_connect(url_info.host, url_info.port);
+        
+        if (pipelined) {
+            std::array<asio::const_buffer, 3> buffers{
+                asio::buffer(handshake), asio::buffer(auth), asio::buffer(connect_req)
+            };
+            co_await asio::async_write(socket, buffers, asio::use_awaitable);
+        } else {
+            co_await asio::async_write(socket, asio::buffer(handshake), asio::use_awaitable);
+        }
         
         std::array<char, 2> response1;
         co_await asio::async_read(socket, asio::buffer(response1), asio::use_awaitable);
@@ -411,9 +833,10 @@ private:
             throw std::runtime_error("Invalid SOCKS5 response");
         }
         
-        if (response1[1] == 0x02) {
-            std::string auth = build_socks5_auth(proxy_info_.username, proxy_info_.password);
-            co_await asio::async_write(socket, asio::buffer(auth), asio::use_awaitable);
+        if (response1[1] == 0x02 && use_auth) {
+            if (!pipelined) {
+                co_await asio::async_write(socket, asio::buffer(auth), asio::use_awaitable);
+            }
             
             std::array<char, 2> auth_response;
             co_await asio::async_read(socket, asio::buffer(auth_response), asio::use_awaitable);
@@ -421,22 +844,178 @@ private:
             if (auth_response[1] != 0x00) {
                 throw std::runtime_error("SOCKS5 authentication failed");
             }
-        } else if (response1[1] != 0x00) {
+        } else if (response1[1] != 0x00 || (pipelined && use_auth)) {
             throw std::runtime_error("SOCKS5 method not accepted");
         }
         
-        std::string connect_req = build_socks5_connect(url_info.host, url_info.port);
-        co_await asio::async_write(socket, asio::buffer(connect_req), asio::use_awaitable);
+        if (!pipelined) {
+            co_await asio::async_write(socket, asio::buffer(connect_req), asio::use_awaitable);
+        }
+        
+        // The reply's bound address is 4, 16 or 1 + n bytes long; reading it
+        // whole leaves the tunnel at the first byte from the target
+        std::array<unsigned char, 4 + 1 + 255 + 2> reply;
+        co_await asio::async_read(socket, asio::buffer(reply.data(), 5), asio::use_awaitable);
+        
+        if (reply[0] != 0x05) {
+            throw std::runtime_error("Invalid SOCKS5 response");
+        }
+        if (reply[1] != 0x00) {
+            throw std::runtime_error("SOCKS5 connection failed: " + socks5_reply_error(reply[1]));
+        }
+        
+        size_t length = socks5_reply_length(reply[3], reply[4]);
+        if (length == 0) {
+            throw std::runtime_error("SOCKS5 reply has unknown address type");
+        }
+        co_await asio::async_read(socket, asio::buffer(reply.data() + 5, length - 5), asio::use_awaitable);
+    }
+
+    // Content-Encoding for the request body: the request's own choice, then
+    // the per-host setting, then the client default. Empty means send as-is.
+    std::string body_compression_for(const HttpRequest& request, const UrlInfo& url_info) const {
+        if (request.body().empty() || request.body().size() < config_.request_compression_min_size) {
+            return {};
+        }
+        for (const auto& [key, value] : request.headers()) {
+            if (strcasecmp_parser(key, "Content-Encoding")) {
+                return {};  // Body is already encoded by the caller
+            }
+        }
+        if (request.body_compression()) {
+            return *request.body_compression();
+        }
+        auto it = config_.request_compression_hosts.find(url_info.host);
+        if (it != config_.request_compression_hosts.end()) {
+            return it->second;
+        }
+        return config_.request_compression;
+    }
+    
+    std::string serialize_request(const HttpRequest& request, const UrlInfo& url_info, bool keep_alive) {
+        if (!url_info.is_https && proxy_of(url_info).type == ProxyType::HTTP) {
+            return build_proxy_request(request, url_info, config_.enable_compression, keep_alive);
+        }
+        return build_request(request, url_info, config_.enable_compression, keep_alive);
+    }
+    
+    // Send a request, compressing the body when configured. Bodies above
+    // request_compression_stream_threshold are encoded slice by slice and
+    // written as chunked transfer, so the compressed copy is never held whole.
+    template<typename AsyncWriteStream>
+    asio::awaitable<void> co_write_request(AsyncWriteStream& stream, const HttpRequest& request,
+                                           const UrlInfo& url_info, bool keep_alive) {
+        if (!request.body_file().empty()) {
+            co_await co_write_file_request(stream, request, url_info, keep_alive);
+            co_return;
+        }
+        
+        std::string encoding = body_compression_for(request, url_info);
+        auto encoder = encoding.empty()
+            ? nullptr : make_content_encoder(encoding, config_.request_compression_level);
+        
+        if (!encoder) {
+            std::string request_str = serialize_request(request, url_info, keep_alive);
+            co_await asio::async_write(stream, asio::buffer(request_str), asio::use_awaitable);
+            co_return;
+        }
+        
+        HttpRequest encoded(request.method(), request.url());
+        for (const auto& [key, value] : request.headers()) {
+            encoded.add_header(key, value);
+        }
+        encoded.add_header("Content-Encoding", encoding);
+        
+        const std::string& body = request.body();
+        if (body.size() < config_.request_compression_stream_threshold) {
+            std::string compressed;
+            compressed.reserve(body.size() / 2);
+            encoder->write(body, compressed);
+            encoder->finish(compressed);
+            encoded.set_body(std::move(compressed));
+            
+            std::string request_str = serialize_request(encoded, url_info, keep_alive);
+            co_await asio::async_write(stream, asio::buffer(request_str), asio::use_awaitable);
+            co_return;
+        }
         
-        std::array<char, 10> connect_response;
-        co_await asio::async_read(socket, asio::buffer(connect_response), asio::use_awaitable);
+        encoded.add_header("Transfer-Encoding", "chunked");
+        std::string head = serialize_request(encoded, url_info, keep_alive);
+        co_await asio::async_write(stream, asio::buffer(head), asio::use_awaitable);
+        
+        constexpr size_t slice_size = 64 * 1024;
+        std::string chunk;
+        for (size_t pos = 0; pos < body.size(); pos += slice_size) {
+            chunk.clear();
+            encoder->write(std::string_view(body).substr(pos, slice_size), chunk);
+            co_await co_write_chunk(stream, chunk, false);
+        }
+        chunk.clear();
+        encoder->finish(chunk);
+        co_await co_write_chunk(stream, chunk, true);
+    }
+    
+    // Send a request whose body is a file. Small files go out with the head
+    // in one write; larger ones follow it by sendfile() over a plain socket on
+    // Linux, the head marked MSG_MORE so it shares a segment with the first
+    // file bytes. Elsewhere the head is written on its own.
+    template<typename AsyncWriteStream>
+    asio::awaitable<void> co_write_file_request(AsyncWriteStream& stream, const HttpRequest& request,
+                                                const UrlInfo& url_info, bool keep_alive) {
+        FileBody file(request.body_file());
+        HttpRequest head_only(request.method(), request.url());
+        for (const auto& [key, value] : request.headers()) {
+            if (!strcasecmp_parser(key, "Content-Length")) {
+                head_only.add_header(key, value);
+            }
+        }
+        head_only.add_header("Content-Length", std::to_string(file.size()));
+        std::string head = serialize_request(head_only, url_info, keep_alive);
+        
+        if (file.size() <= FileBody::inline_limit) {
+            std::string body;
+            file.read(0, file.size(), body);
+            std::array<asio::const_buffer, 2> buffers{asio::buffer(head), asio::buffer(body)};
+            co_await asio::async_write(stream, buffers, asio::use_awaitable);
+            co_return;
+        }
         
-        if (connect_response[1] != 0x00) {
-            throw std::runtime_error("SOCKS5 connection failed");
+#if defined(__linux__)
+        if constexpr (is_plain_socket_v<AsyncWriteStream>) {
+            size_t sent = 0;
+            while (sent < head.size()) {
+                sent += co_await stream.async_send(asio::buffer(head.data() + sent, head.size() - sent),
+                                                   MSG_MORE, asio::use_awaitable);
+            }
+            co_await file.co_send(stream);
+            co_return;
         }
+#endif
+        co_await asio::async_write(stream, asio::buffer(head), asio::use_awaitable);
+        co_await file.co_send(stream);
+    }
+    
+    // Write one chunk of a chunked body; `last` appends the terminating chunk
+    template<typename AsyncWriteStream>
+    asio::awaitable<void> co_write_chunk(AsyncWriteStream& stream, const std::string& data, bool last) {
+        if (data.empty() && !last) co_return;
+        
+        char size_line[24];
+        int size_len = std::snprintf(size_line, sizeof(size_line), "%zx\r\n", data.size());
+        static constexpr char crlf[] = "\r\n";
+        static constexpr char last_chunk[] = "0\r\n\r\n";
+        
+        std::array<asio::const_buffer, 4> buffers{
+            asio::buffer(size_line, data.empty() ? 0 : size_len),
+            asio::buffer(data),
+            asio::buffer(crlf, data.empty() ? 0 : 2),
+            asio::buffer(last_chunk, last ? 5 : 0)
+        };
+        co_await asio::async_write(stream, buffers, asio::use_awaitable);
     }
 
-    std::string build_proxy_request(const HttpRequest& request, const UrlInfo& url_info, bool enable_compression) {
+    std::string build_proxy_request(const HttpRequest& request, const UrlInfo& url_info, bool enable_compression,
+                                    bool keep_alive) {
         std::ostringstream req;
         
         std::string full_url = url_info.scheme + "://" + url_info.host;
@@ -457,14 +1036,20 @@ private:
         }
         
         if (enable_compression && !has_accept_encoding) {
-            req << "Accept-Encoding: gzip, deflate\r\n";
+            req << "Accept-Encoding: " << ContentCodecRegistry::instance().accept_encoding() << "\r\n";
         }
         
         if (!request.body().empty()) {
             req << "Content-Length: " << request.body().size() << "\r\n";
         }
         
-        req << "Connection: close\r\n";
+        const ProxyInfo& proxy = proxy_of(url_info);
+        std::string authorization = proxy_authorization(proxy.username, proxy.password);
+        if (!authorization.empty()) {
+            req << "Proxy-Authorization: " << authorization << "\r\n";
+        }
+        
+        req << "Connection: " << (keep_alive ? "keep-alive" : "close") << "\r\n";
         req << "\r\n";
         
         if (!request.body().empty()) {
@@ -493,84 +1078,130 @@ private:
         }
     }
 
+    // Response as read off the wire: status line and headers, plus the body
+    // with any chunked transfer coding already removed. `reusable` is false
+    // when the message was cut short by EOF or more bytes followed it, so the
+    // connection is out of sync and must not go back to the pool.
+    // `decoded` is set when a single Content-Encoding was undone as the body
+    // arrived; stacked or unknown codings are left for parse_response.
+    struct WireResponse {
+        std::string head;
+        std::string body;
+        bool reusable{true};
+        bool decoded{false};
+    };
+
     template<typename AsyncReadStream>
-    asio::awaitable<std::string> co_read_response(AsyncReadStream& stream, HttpMethod request_method = HttpMethod::GET) {
-        std::string response_data;
-        std::array<char, 8192> buffer;
+    asio::awaitable<WireResponse> co_read_response(AsyncReadStream& stream, HttpMethod request_method = HttpMethod::GET) {
+        WireResponse wire;
+        std::string& response_data = wire.head;
+        PooledBuffer buffer;
         
         bool headers_complete = false;
-        size_t content_length = 0;
+        std::optional<size_t> content_length;
         bool is_chunked = false;
         size_t headers_end_pos = 0;
+        size_t body_received = 0;
+        
+        // Body spans go through the content decoder, when there is one, as
+        // they arrive instead of after the whole compressed body is buffered
+        std::unique_ptr<ContentDecoder> decoder;
+        bool body_seen = false;
+        auto append_body = [&](std::string_view span) {
+            if (span.empty()) return;
+            body_seen = true;
+            if (decoder) {
+                decoder->write(span, wire.body);
+            } else {
+                wire.body.append(span);
+            }
+        };
+        
+        // Chunk data is appended straight from the read buffer into the body
+        ChunkedDecoder chunked;
+        auto feed_body = [&](std::string_view data) {
+            if (is_chunked) {
+                size_t used = chunked.feed(data, append_body);
+                if (used < data.size()) wire.reusable = false;
+                return;
+            }
+            if (content_length && body_received + data.size() > *content_length) {
+                data = data.substr(0, *content_length - body_received);
+                wire.reusable = false;
+            }
+            body_received += data.size();
+            append_body(data);
+        };
         
         while (true) {
             auto [ec, len] = co_await stream.async_read_some(
-                asio::buffer(buffer),
+                asio::buffer(buffer.data(), buffer.size()),
                 asio::as_tuple(asio::use_awaitable)
             );
             
-            if (len > 0) {
+            if (len > 0 && headers_complete) {
+                feed_body(std::string_view(buffer.data(), len));
+            } else if (len > 0) {
                 response_data.append(buffer.data(), len);
                 
                 // Check if headers are complete
-                if (!headers_complete) {
-                    size_t header_end = response_data.find("\r\n\r\n");
-                    if (header_end != std::string::npos) {
-                        headers_complete = true;
-                        headers_end_pos = header_end + 4;
-                        
-                        // Parse headers to find Content-Length or Transfer-Encoding
-                        std::string headers = response_data.substr(0, headers_end_pos);
-                        
-                        // Check for chunked encoding
-                        if (headers.find("Transfer-Encoding: chunked") != std::string::npos ||
-                            headers.find("transfer-encoding: chunked") != std::string::npos) {
-                            is_chunked = true;
-                        }
+                size_t header_end = response_data.find("\r\n\r\n");
+                if (header_end != std::string::npos) {
+                    headers_complete = true;
+                    headers_end_pos = header_end + 4;
+                    
+                    // Framing comes from the parsed header fields; 204 and
+                    // 304 never carry a body, whatever Content-Length says
+                    HttpResponse parsed;
+                    std::istringstream head_stream(response_data.substr(0, headers_end_pos));
+                    parse_response_head(head_stream, parsed);
+                    if (parsed.status_code() == 204 || parsed.status_code() == 304) {
+                        content_length = 0;
+                    } else {
+                        is_chunked = is_chunked_response(parsed);
+                        content_length = response_content_length(parsed);
+                    }
+                    
+                    // Per RFC, responses to HEAD must not include a message body
+                    if (request_method != HttpMethod::HEAD) {
+                        decoder = make_content_decoder(parsed.get_header("Content-Encoding"));
                         
-                        // Try to find Content-Length
-                        size_t cl_pos = headers.find("Content-Length:");
-                        if (cl_pos == std::string::npos) {
-                            cl_pos = headers.find("content-length:");
-                        }
-                        if (cl_pos != std::string::npos) {
-                            size_t value_start = headers.find(':', cl_pos) + 1;
-                            size_t value_end = headers.find('\r', value_start);
-                            std::string cl_str = headers.substr(value_start, value_end - value_start);
-                            // Trim whitespace
-                            cl_str.erase(0, cl_str.find_first_not_of(" \t"));
-                            cl_str.erase(cl_str.find_last_not_of(" \t") + 1);
-                            try {
-                                content_length = std::stoull(cl_str);
-                            } catch (...) {}
-                        }
+                        // Body bytes that arrived with the headers start the body
+                        feed_body(std::string_view(response_data).substr(headers_end_pos));
+                    } else if (response_data.size() > headers_end_pos) {
+                        wire.reusable = false;
                     }
+                    response_data.resize(headers_end_pos);
+                }
+            }
+            
+            // Check if we have complete body
+            if (headers_complete) {
+                // Don't wait for a body for HEAD requests — treat response as complete.
+                if (request_method == HttpMethod::HEAD) {
+                    break;
                 }
                 
-                // Check if we have complete body
-                if (headers_complete) {
-                    // Per RFC, responses to HEAD must not include a message body.
-                    // Don't wait for a body for HEAD requests — treat response as complete.
-                    if (request_method == HttpMethod::HEAD) {
+                if (is_chunked) {
+                    // The decoder knows exactly where the last chunk and trailers end
+                    if (chunked.done()) {
                         break;
                     }
-                    size_t body_size = response_data.size() - headers_end_pos;
-                    
-                    if (is_chunked) {
-                        // For chunked, check if we have the final chunk (0\r\n\r\n)
-                        if (response_data.find("0\r\n\r\n") != std::string::npos) {
-                            break;
-                        }
-                    } else if (content_length > 0) {
-                        // For content-length, check if we have all data
-                        if (body_size >= content_length) {
-                            break;
-                        }
+                } else if (content_length) {
+                    // For content-length, check if we have all data
+                    if (body_received >= *content_length) {
+                        break;
                     }
                 }
             }
             
             if (ec == asio::error::eof || ec == asio::ssl::error::stream_truncated) {
+                // Only a body without framing ends at the close; anything
+                // else was cut short
+                if (!headers_complete || is_chunked || content_length) {
+                    throw std::runtime_error("Connection closed before the response was complete");
+                }
+                wire.reusable = false;
                 break;
             } else if (ec) {
                 throw std::system_error(ec);
@@ -578,7 +1209,7 @@ private:
             
             // Safety: if we have headers but no content length and no chunked,
             // and we got some data, try a short wait and then check for available bytes
-            if (headers_complete && !is_chunked && content_length == 0 && len > 0) {
+            if (headers_complete && !is_chunked && !content_length && len > 0) {
                 asio::steady_timer timer(io_context_);
                 timer.expires_after(std::chrono::milliseconds(100));
                 co_await timer.async_wait(asio::use_awaitable);
@@ -598,12 +1229,12 @@ private:
 
                 if (available_bytes > 0) {
                     auto [peek_ec, peek_len] = co_await stream.async_read_some(
-                        asio::buffer(buffer),
+                        asio::buffer(buffer.data(), buffer.size()),
                         asio::as_tuple(asio::use_awaitable)
                     );
 
                     if (peek_len > 0) {
-                        response_data.append(buffer.data(), peek_len);
+                        feed_body(std::string_view(buffer.data(), peek_len));
                     }
                 } else {
                     // No more data, response complete
@@ -612,47 +1243,198 @@ private:
             }
         }
         
-        co_return response_data;
+        if (!headers_complete) {
+            wire.reusable = false;
+            co_return wire;
+        }
+        
+        if (is_chunked && request_method != HttpMethod::HEAD) {
+            if (!chunked.done()) wire.reusable = false;
+            // Trailer fields are exposed alongside the regular headers
+            for (const auto& [key, value] : chunked.trailers()) {
+                response_data.insert(response_data.size() - 2, key + ": " + value + "\r\n");
+            }
+        }
+        
+        // An empty body is left to parse_response, as are stacked codings
+        if (decoder && body_seen) {
+            decoder->finish();
+            wire.decoded = true;
+        }
+        
+        co_return wire;
     }
 
 public:
 
+    // Convenience wrappers forward the awaitable from co_execute directly
+    // instead of wrapping it in another coroutine frame.
     asio::awaitable<HttpResponse> co_get(const std::string& url) {
-        co_return co_await co_execute(HttpRequest(HttpMethod::GET, url));
+        return co_execute(HttpRequest(HttpMethod::GET, url));
     }
 
     asio::awaitable<HttpResponse> co_post(const std::string& url, const std::string& body) {
-        co_return co_await co_execute(HttpRequest(HttpMethod::POST, url).set_body(body));
+        return co_execute(HttpRequest(HttpMethod::POST, url).set_body(body));
     }
 
     asio::awaitable<HttpResponse> co_put(const std::string& url, const std::string& body) {
-        co_return co_await co_execute(HttpRequest(HttpMethod::PUT, url).set_body(body));
+        return co_execute(HttpRequest(HttpMethod::PUT, url).set_body(body));
     }
 
     asio::awaitable<HttpResponse> co_delete(const std::string& url) {
-        co_return co_await co_execute(HttpRequest(HttpMethod::DEL, url));
+        return co_execute(HttpRequest(HttpMethod::DEL, url));
     }
 
     asio::awaitable<HttpResponse> co_head(const std::string& url) {
-        co_return co_await co_execute(HttpRequest(HttpMethod::HEAD, url));
+        return co_execute(HttpRequest(HttpMethod::HEAD, url));
     }
 
     asio::awaitable<HttpResponse> co_patch(const std::string& url, const std::string& body) {
-        co_return co_await co_execute(HttpRequest(HttpMethod::PATCH, url).set_body(body));
+        return co_execute(HttpRequest(HttpMethod::PATCH, url).set_body(body));
     }
 
     asio::awaitable<HttpResponse> co_options(const std::string& url) {
-        co_return co_await co_execute(HttpRequest(HttpMethod::OPTIONS, url));
+        return co_execute(HttpRequest(HttpMethod::OPTIONS, url));
     }
 
     // SSE streaming support with callback
     // EventCallback: void(const SseEvent& event)
     using SseEventCallback = std::function<void(const SseEvent&)>;
     
+    // Stream events until the server closes the connection. With
+    // ClientConfig::sse_reconnect the stream is resumed instead (see
+    // co_stream_events_resilient). Throw from the callback to stop early.
     asio::awaitable<void> co_stream_events(const HttpRequest& request, 
                                            SseEventCallback callback) {
-        auto url_info = parse_url(request.url());
+        SseStreamState state{callback};
+        co_await co_run_event_stream(request, state);
+    }
+    
+    // Open a stream whose events are read with co_await stream.next().
+    // The connection is read by a coroutine on the client's io_context
+    // and events are queued for the consumer, so a slow consumer does not
+    // hold up the read loop; options set the queue's capacity and what
+    // happens when it is full. Reconnects follow ClientConfig::sse_reconnect.
+    // Destroying the stream closes the connection. The client must outlive
+    // its streams.
+    SseStream open_event_stream(const HttpRequest& request, SseChannelOptions options = {}) {
+        auto channel = std::make_shared<SseEventChannel>(io_context_.get_executor(), options);
+        asio::co_spawn(io_context_, co_pump_event_stream(request, channel), asio::detached);
+        return SseStream(channel);
+    }
+    
+private:
+    // State of one logical stream, kept across reconnects
+    struct SseStreamState {
+        SseEventCallback& callback;
+        SseParser parser{};
+        TlsSessionCache* tls_sessions{nullptr};  // Sessions to resume reconnects with
+        bool require_ok{false};      // Parse only 200 responses
+        int status{0};               // Status of the latest response, 0 if none arrived
+        size_t delivered{0};         // Events delivered on the latest connection
+        bool callback_failed{false};
+        SseEventChannel* channel{nullptr};  // Set for streams opened with open_event_stream
+    };
+    
+    asio::awaitable<void> co_run_event_stream(const HttpRequest& request, SseStreamState& state) {
+        auto url_info = target_of(request.url());
+        state.tls_sessions = tls_sessions_.get();
+        
+        if (config_.sse_reconnect) {
+            co_await co_stream_events_resilient(request, url_info, state);
+        } else {
+            co_await co_stream_events_once(request, url_info, state);
+        }
+    }
+    
+    asio::awaitable<void> co_pump_event_stream(HttpRequest request, std::shared_ptr<SseEventChannel> channel) {
+        SseEventCallback push = [&channel](const SseEvent& event) { channel->push(event); };
+        SseStreamState state{push};
+        state.channel = channel.get();
+        try {
+            co_await co_run_event_stream(request, state);
+            channel->close();
+        } catch (...) {
+            if (!channel->cancelled()) channel->close(std::current_exception());
+        }
+    }
+    
+    // Reconnects dropped streams. Each attempt sends Last-Event-ID with the
+    // last id seen, and an event cut off by the disconnect is discarded, so
+    // nothing is delivered twice. Reconnects wait for the server's retry
+    // interval (ClientConfig::sse_retry_delay until it sends one); attempts
+    // that fail back off exponentially with jitter, and after
+    // sse_max_reconnect_attempts consecutive failures the last error is thrown.
+    // A 204 response ends the stream; statuses other than 200, 429 and 5xx
+    // are errors.
+    asio::awaitable<void> co_stream_events_resilient(const HttpRequest& request, const UrlInfo& url_info,
+                                                     SseStreamState& state) {
+        state.require_ok = true;
+        TlsSessionCache stream_sessions;  // Warm reconnects even without the client-wide cache
+        if (!state.tls_sessions) {
+            state.tls_sessions = &stream_sessions;
+        }
         
+        HttpRequest attempt = request;
+        asio::steady_timer timer(io_context_);
+        int failures = 0;
+        while (!(state.channel && state.channel->cancelled())) {
+            std::exception_ptr error;
+            try {
+                co_await co_stream_events_once(attempt, url_info, state);
+            } catch (const std::system_error& e) {
+                if (state.callback_failed || e.code() == std::errc::operation_canceled) throw;
+                error = std::current_exception();
+            } catch (const std::exception&) {
+                if (state.callback_failed) throw;
+                error = std::current_exception();
+            }
+            
+            int status = state.status;
+            if (status == 204) {
+                co_return;
+            }
+            if (status != 0 && status != 200 && status != 429 && status < 500) {
+                throw std::runtime_error("SSE stream failed with HTTP status " + std::to_string(status));
+            }
+            
+            if (status == 200 && state.delivered > 0) {
+                failures = 0;
+            } else if (config_.sse_max_reconnect_attempts > 0 && ++failures > config_.sse_max_reconnect_attempts) {
+                if (error) std::rethrow_exception(error);
+                throw std::runtime_error("SSE stream failed with HTTP status " + std::to_string(status));
+            }
+            
+            state.parser.reset();
+            if (!state.parser.last_event_id().empty()) {
+                attempt.add_header("Last-Event-ID", state.parser.last_event_id());
+            }
+            
+            timer.expires_after(sse_reconnect_delay(state.parser.retry_ms(), failures));
+            co_await timer.async_wait(asio::use_awaitable);
+        }
+    }
+    
+    // The server's retry interval, or the configured one, with jitter; while
+    // attempts fail it doubles per failure up to sse_max_retry_delay
+    std::chrono::milliseconds sse_reconnect_delay(long long server_retry_ms, int failures) const {
+        auto base = server_retry_ms >= 0 ? std::chrono::milliseconds(server_retry_ms) : config_.sse_retry_delay;
+        auto delay = base;
+        if (failures > 0) {
+            delay = std::max(base, std::chrono::milliseconds(100));
+            for (int i = 1; i < failures && delay < config_.sse_max_retry_delay; ++i) {
+                delay *= 2;
+            }
+            delay = std::min(delay, std::max(config_.sse_max_retry_delay, base));
+        }
+        // Between half and all of the delay, so streams dropped together do not return together
+        thread_local std::mt19937 generator{std::random_device{}()};
+        std::uniform_int_distribution<long long> jitter(delay.count() / 2, delay.count());
+        return std::chrono::milliseconds(jitter(generator));
+    }
+    
+    asio::awaitable<void> co_stream_events_once(const HttpRequest& request, const UrlInfo& url_info,
+                                                SseStreamState& state) {
         HttpRequest req_with_cookies = request;
         if (config_.enable_cookies) {
             std::string cookies = cookie_jar_.get_cookies_for_request(
@@ -662,179 +1444,282 @@ public:
             }
         }
         
-        if (url_info.is_https) {
-            co_await co_stream_events_https(req_with_cookies, url_info, callback);
-        } else {
-            co_await co_stream_events_http(req_with_cookies, url_info, callback);
+        state.status = 0;
+        state.delivered = 0;
+        
+        // Each connection attempt picks its proxy. Only an attempt that could
+        // not reach the proxy or open its tunnel counts against it, and a
+        // stream's lifetime says nothing about proxy latency, so none is
+        // recorded.
+        UrlInfo routed = url_info;
+        routed.proxy = acquire_proxy(routed);
+        bool proxy_failed = false;
+        routed.proxy_failed = &proxy_failed;
+        start_due_probe();
+        try {
+            if (routed.is_https) {
+                co_await co_stream_events_https(req_with_cookies, routed, state);
+            } else if (!routed.unix_socket.empty()) {
+                co_await co_stream_events_http<UnixSocket>(req_with_cookies, routed, state);
+            } else {
+                co_await co_stream_events_http<asio::ip::tcp::socket>(req_with_cookies, routed, state);
+            }
+        } catch (...) {
+            proxies_.release(routed.proxy, !proxy_failed, {});
+            throw;
         }
-        co_return;
+        proxies_.release(routed.proxy, true, {});
     }
     
+    // Streams take their connection from the pool like regular requests,
+    // go through the proxy and its CONNECT tunnel, and use the DNS and TLS
+    // session caches. A connection is returned to the pool only when a
+    // chunked stream ended cleanly; otherwise it is closed.
+    template<typename Socket>
     asio::awaitable<void> co_stream_events_http(const HttpRequest& request, 
                                                  const UrlInfo& url_info,
-                                                 SseEventCallback callback) {
+                                                 SseStreamState& state) {
         rate_limiter_.acquire();
         
-        asio::ip::tcp::socket socket(io_context_);
-        co_await co_connect_socket(socket, url_info);
-        
-        std::string request_str = build_request(request, url_info, config_.enable_compression);
-        co_await asio::async_write(socket, asio::buffer(request_str), asio::use_awaitable);
-        
-        std::array<char, 8192> buffer;
-        std::string partial_event;
-        SseEvent current_event;
-        std::vector<std::string> data_lines;
-        
-        // Read response headers first
-        std::string headers;
-        bool headers_complete = false;
-        
-        while (!headers_complete) {
-            auto [ec, len] = co_await socket.async_read_some(
-                asio::buffer(buffer),
-                asio::as_tuple(asio::use_awaitable)
-            );
-            
-            if (ec) throw std::system_error(ec);
-            if (len == 0) throw std::runtime_error("Connection closed while reading headers");
-            
-            headers.append(buffer.data(), len);
-            size_t header_end = headers.find("\r\n\r\n");
-            if (header_end != std::string::npos) {
-                headers_complete = true;
-                partial_event = headers.substr(header_end + 4);
-                headers = headers.substr(0, header_end);
-            }
-        }
+        bool pooled = use_connection_pool();
+        auto key = pool_key(url_info);
+        auto socket = pooled
+            ? connection_pool_.acquire<Socket>(key, io_context_)
+            : std::make_shared<Socket>(io_context_);
+        IdleDeadline deadline(io_context_, config_.connect_timeout, [socket] {
+            asio::error_code ec;
+            socket->close(ec);
+        });
         
-        // Stream event lines
-        while (true) {
-            auto [ec, len] = co_await socket.async_read_some(
-                asio::buffer(buffer),
-                asio::as_tuple(asio::use_awaitable)
-            );
-            
-            if (len > 0) {
-                partial_event.append(buffer.data(), len);
-                
-                // Process complete lines
-                size_t pos = 0;
-                while ((pos = partial_event.find('\n')) != std::string::npos) {
-                    std::string line = partial_event.substr(0, pos);
-                    partial_event = partial_event.substr(pos + 1);
-                    
-                    std::vector<SseEvent> events;
-                    parse_sse_line(line, current_event, data_lines, events);
-                    
-                    for (const auto& event : events) {
-                        callback(event);
-                    }
-                }
-            }
-            
-            // Check for end of stream or error
-            if (len == 0 || ec == asio::error::eof || (ec && ec != asio::error::would_block)) {
-                // Process any remaining data
-                if (!partial_event.empty()) {
-                    std::vector<SseEvent> events;
-                    parse_sse_line(partial_event, current_event, data_lines, events);
-                    for (const auto& event : events) {
-                        callback(event);
+        bool reusable = false;
+        try {
+            if (!socket->is_open()) {
+                try {
+                    co_await co_connect_socket(*socket, url_info);
+                } catch (...) {
+                    if (deadline.expired()) {
+                        throw std::system_error(std::make_error_code(std::errc::timed_out), "SSE connect timed out");
                     }
+                    throw;
                 }
-                break;
             }
+            reusable = co_await co_read_event_stream(*socket, request, url_info, state, deadline, pooled);
+        } catch (...) {
+            if (pooled) connection_pool_.release(socket, key, false);
+            asio::error_code ec;
+            socket->close(ec);
+            throw;
+        }
+        
+        if (pooled) {
+            connection_pool_.release(socket, key, reusable);
+        }
+        if (!reusable) {
+            asio::error_code ec;
+            socket->close(ec);
         }
-        co_return;
     }
     
     asio::awaitable<void> co_stream_events_https(const HttpRequest& request,
                                                   const UrlInfo& url_info,
-                                                  SseEventCallback callback) {
+                                                  SseStreamState& state) {
         rate_limiter_.acquire();
         
-        asio::ssl::stream<asio::ip::tcp::socket> ssl_socket(io_context_, ssl_context_);
+        bool pooled = use_connection_pool();
+        auto ssl_stream = pooled
+            ? connection_pool_.get_ssl_connection(io_context_, ssl_context_, url_info.host, url_info.port,
+                                                  route_of(url_info))
+            : std::make_shared<asio::ssl::stream<asio::ip::tcp::socket>>(io_context_, ssl_context_);
+        IdleDeadline deadline(io_context_, config_.connect_timeout, [ssl_stream] {
+            asio::error_code ec;
+            ssl_stream->lowest_layer().close(ec);
+        });
         
-        co_await co_connect_socket(ssl_socket.next_layer(), url_info);
+        bool reusable = false;
+        try {
+            if (!ssl_stream->lowest_layer().is_open()) {
+                try {
+                    co_await co_open_tls(*ssl_stream, url_info, state.tls_sessions);
+                } catch (...) {
+                    if (deadline.expired()) {
+                        throw std::system_error(std::make_error_code(std::errc::timed_out), "SSE connect timed out");
+                    }
+                    throw;
+                }
+            }
+            reusable = co_await co_read_event_stream(*ssl_stream, request, url_info, state, deadline, pooled);
+        } catch (...) {
+            if (pooled) {
+                connection_pool_.release_ssl_connection(ssl_stream, url_info.host, url_info.port, false,
+                                                        route_of(url_info));
+            }
+            asio::error_code ec;
+            ssl_stream->lowest_layer().close(ec);
+            throw;
+        }
+        if (state.tls_sessions) {
+            state.tls_sessions->store(ssl_stream->native_handle(),
+                                      TlsSessionCache::key_for(url_info.host, url_info.port));
+        }
         
-        if (config_.verify_ssl) {
-            SSL_set_tlsext_host_name(ssl_socket.native_handle(), url_info.host.c_str());
+        if (pooled) {
+            connection_pool_.release_ssl_connection(ssl_stream, url_info.host, url_info.port, reusable,
+                                                    route_of(url_info));
+        }
+        if (!reusable) {
+            asio::error_code ec;
+            ssl_stream->lowest_layer().close(ec);
+        }
+    }
+    
+    // No bytes for this long means the stream is dead
+    std::chrono::milliseconds sse_idle_timeout() const {
+        return config_.sse_idle_timeout.count() > 0 ? config_.sse_idle_timeout : config_.read_timeout;
+    }
+    
+    // Send the request and feed the response body to the stream's parser
+    // until the server closes the connection or ends a chunked body. Returns
+    // whether the connection can carry another request. The deadline closes
+    // the connection when it stays silent for sse_idle_timeout.
+    template<typename Stream>
+    asio::awaitable<bool> co_read_event_stream(Stream& stream, const HttpRequest& request,
+                                               const UrlInfo& url_info, SseStreamState& state,
+                                               IdleDeadline& deadline, bool keep_alive) {
+        auto idle_timeout = sse_idle_timeout();
+        deadline.reset(idle_timeout);
+        auto check_deadline = [&] {
+            if (deadline.expired()) {
+                throw std::system_error(std::make_error_code(std::errc::timed_out),
+                                        "SSE stream idle for " + std::to_string(idle_timeout.count()) + " ms");
+            }
+        };
+        
+        // Event streams are parsed as they arrive, so compression is not offered
+        std::string request_str = !url_info.is_https && proxy_of(url_info).type == ProxyType::HTTP
+            ? build_proxy_request(request, url_info, false, keep_alive)
+            : build_request(request, url_info, false, keep_alive);
+        auto [write_ec, written] = co_await asio::async_write(stream, asio::buffer(request_str),
+                                                              asio::as_tuple(asio::use_awaitable));
+        if (write_ec) {
+            check_deadline();
+            throw std::system_error(write_ec);
         }
         
-        co_await ssl_socket.async_handshake(asio::ssl::stream_base::client, asio::use_awaitable);
+        // A consumer that goes away closes the socket to end a pending read
+        struct CancelHook {
+            SseEventChannel* channel;
+            ~CancelHook() {
+                if (channel) channel->set_cancel_handler(nullptr);
+            }
+        } cancel_hook{state.channel};
+        if (state.channel) {
+            if (state.channel->cancelled()) {
+                throw std::system_error(std::make_error_code(std::errc::operation_canceled));
+            }
+            state.channel->set_cancel_handler([&stream] {
+                asio::error_code ec;
+                stream.lowest_layer().close(ec);
+            });
+        }
         
-        std::string request_str = build_request(request, url_info, config_.enable_compression);
-        co_await asio::async_write(ssl_socket, asio::buffer(request_str), asio::use_awaitable);
+        PooledBuffer buffer;
+        auto on_event = [&](const SseEvent& event) {
+            try {
+                state.callback(event);
+            } catch (...) {
+                state.callback_failed = true;
+                throw;
+            }
+            ++state.delivered;
+        };
         
-        std::array<char, 8192> buffer;
-        std::string partial_event;
-        SseEvent current_event;
-        std::vector<std::string> data_lines;
+        // Chunked streams are de-chunked as they arrive, before line splitting;
+        // a stream with Content-Length ends after that many bytes
+        bool is_chunked = false;
+        ChunkedDecoder chunked;
+        std::optional<size_t> content_length;
+        size_t body_received = 0;
+        auto feed = [&](std::string_view data) {
+            if (is_chunked) {
+                chunked.feed(data, [&](std::string_view span) { state.parser.feed(span, on_event); });
+                return;
+            }
+            if (content_length) {
+                data = data.substr(0, *content_length - body_received);
+                body_received += data.size();
+            }
+            state.parser.feed(data, on_event);
+        };
+        auto body_complete = [&] {
+            return is_chunked ? chunked.done() : (content_length && body_received == *content_length);
+        };
         
         // Read response headers first
         std::string headers;
-        bool headers_complete = false;
-        
-        while (!headers_complete) {
-            auto [ec, len] = co_await ssl_socket.async_read_some(
-                asio::buffer(buffer),
+        size_t scanned = 0;
+        while (true) {
+            auto [ec, len] = co_await stream.async_read_some(
+                asio::buffer(buffer.data(), buffer.size()),
                 asio::as_tuple(asio::use_awaitable)
             );
             
-            if (ec) throw std::system_error(ec);
+            if (ec) {
+                check_deadline();
+                throw std::system_error(ec);
+            }
             if (len == 0) throw std::runtime_error("Connection closed while reading headers");
+            deadline.touch();
             
             headers.append(buffer.data(), len);
-            size_t header_end = headers.find("\r\n\r\n");
+            size_t header_end = headers.find("\r\n\r\n", scanned);
             if (header_end != std::string::npos) {
-                headers_complete = true;
-                partial_event = headers.substr(header_end + 4);
-                headers = headers.substr(0, header_end);
+                HttpResponse parsed;
+                std::istringstream head_stream(headers.substr(0, header_end + 4));
+                parse_response_head(head_stream, parsed);
+                state.status = parsed.status_code();
+                if (state.require_ok && state.status != 200) {
+                    co_return false;
+                }
+                is_chunked = is_chunked_response(parsed);
+                content_length = response_content_length(parsed);
+                feed(std::string_view(headers).substr(header_end + 4));
+                break;
             }
+            scanned = headers.size() > 3 ? headers.size() - 3 : 0;
         }
         
-        // Stream event lines
-        while (true) {
-            auto [ec, len] = co_await ssl_socket.async_read_some(
-                asio::buffer(buffer),
+        // Stream events; an event cut off by the end of the stream is dropped
+        while (!body_complete()) {
+            // Backpressure: stop reading while the consumer's queue is full.
+            // The connection is quiet by our choice, so the deadline pauses.
+            if (state.channel && state.channel->full()) {
+                deadline.reset(std::chrono::milliseconds(0));
+                co_await state.channel->wait_writable();
+                deadline.reset(idle_timeout);
+            }
+            
+            auto [ec, len] = co_await stream.async_read_some(
+                asio::buffer(buffer.data(), buffer.size()),
                 asio::as_tuple(asio::use_awaitable)
             );
             
             if (len > 0) {
-                partial_event.append(buffer.data(), len);
-                
-                // Process complete lines
-                size_t pos = 0;
-                while ((pos = partial_event.find('\n')) != std::string::npos) {
-                    std::string line = partial_event.substr(0, pos);
-                    partial_event = partial_event.substr(pos + 1);
-                    
-                    std::vector<SseEvent> events;
-                    parse_sse_line(line, current_event, data_lines, events);
-                    
-                    for (const auto& event : events) {
-                        callback(event);
-                    }
-                }
+                deadline.touch();
+                feed(std::string_view(buffer.data(), len));
             }
             
-            // Check for end of stream or error
-            if (len == 0 || ec == asio::error::eof || (ec && ec != asio::error::would_block)) {
-                // Process any remaining data
-                if (!partial_event.empty()) {
-                    std::vector<SseEvent> events;
-                    parse_sse_line(partial_event, current_event, data_lines, events);
-                    for (const auto& event : events) {
-                        callback(event);
-                    }
-                }
-                break;
+            if (ec == asio::error::operation_aborted || (ec && deadline.expired())) {
+                check_deadline();
+                throw std::system_error(ec);
+            }
+            if (len == 0 || ec) {
+                co_return false;
             }
         }
-        co_return;
+        co_return keep_alive;
     }
-
+    
+public:
     template<typename CoroFunc>
     void run(CoroFunc&& coro) {
         asio::co_spawn(io_context_, std::forward<CoroFunc>(coro), asio::detached);
@@ -869,11 +1754,50 @@ public:
         rate_limiter_.reset();
     }
     
+    // Response cache, or nullptr when ClientConfig::enable_cache is off
+    HttpCache* cache() {
+        return cache_.get();
+    }
+    
+    // GET coalescer, or nullptr when ClientConfig::enable_request_coalescing is off
+    RequestCoalescer* coalescer() {
+        return coalescer_.get();
+    }
+    
+    // Resolver cache, or nullptr when ClientConfig::enable_dns_cache is off
+    DnsCache* dns_cache() {
+        return dns_cache_.get();
+    }
+    
+    // TLS session cache, or nullptr when ClientConfig::enable_tls_session_cache is off
+    TlsSessionCache* tls_sessions() {
+        return tls_sessions_.get();
+    }
+    
+    // Write cookies, DNS entries and TLS sessions to path (see StateSnapshot).
+    // Safe to call from any thread, also while the background writer runs.
+    void save_state(const std::string& path) {
+        auto snapshot = StateSnapshot::capture(&cookie_jar_, dns_cache_.get(), tls_sessions_.get());
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        snapshot.save(path);
+    }
+    
     // Get cookie jar
     CookieJar& cookies() {
         return cookie_jar_;
     }
     
+    // Socket options used for connections to `host`
+    const SocketOptions& socket_options_for(const std::string& host) const {
+        auto it = config_.socket_options_hosts.find(host);
+        return it != config_.socket_options_hosts.end() ? it->second : config_.socket_options;
+    }
+    
+    // Load, latency and health of each configured proxy
+    std::vector<ProxySelector::Stats> proxy_stats() const {
+        return proxies_.stats();
+    }
+    
     // Get cookie jar (const)
     const CookieJar& cookies() const {
         return cookie_jar_;
@@ -883,11 +1807,18 @@ private:
     asio::io_context& io_context_;
     asio::ssl::context ssl_context_;
     ClientConfig config_;
-    ProxyInfo proxy_info_;
+    ProxySelector proxies_;
     ConnectionPool connection_pool_;
     RateLimiter rate_limiter_;
     RetryPolicy retry_policy_;
     CookieJar cookie_jar_;
+    std::unique_ptr<HttpCache> cache_;
+    std::unique_ptr<RequestCoalescer> coalescer_;
+    std::unique_ptr<DnsCache> dns_cache_;
+    std::unique_ptr<TlsSessionCache> tls_sessions_;
+    std::unique_ptr<RedirectCache> redirect_cache_;
+    std::mutex snapshot_mutex_;
+    std::unique_ptr<StateSnapshotWriter> snapshot_writer_;  // Last: stops before the state it saves goes away
 };
 
 }
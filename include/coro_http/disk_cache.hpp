@@ -0,0 +1,669 @@
+#pragma once
+
+#if !defined(_WIN32)
+#include <zlib.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace coro_http {
+
+#if !defined(_WIN32)
+
+// Persistent key/value store backing the HTTP cache across restarts (POSIX).
+//
+// Layout of the cache directory:
+//   index.bin          memory-mapped open-addressing hash table of slots
+//   seg-NNNNNNNN.dat   append-only segments of records (key, meta, body)
+//
+// A record is written by put() and published in the index by a sync thread
+// once fdatasync has made it durable; records put while a sync runs share
+// the next one, and find() serves them from the segment in the meantime.
+// Every slot carries a checksum, so after a crash the index only ever
+// refers to complete records; torn slots are dropped when the index is
+// reopened. Eviction is by whole segment, oldest first, once
+// the segments exceed the byte budget. Hits are served from an mmap of the
+// record, without reading the body into memory.
+class DiskCache {
+public:
+    // A record mapped into memory; the views stay valid while it is alive,
+    // even if its segment is evicted in the meantime.
+    struct Record {
+        std::shared_ptr<const void> mapping;
+        std::string_view meta;
+        std::string_view body;
+    };
+
+    struct Stats {
+        size_t entries{0};
+        size_t bytes{0};
+        size_t segments{0};
+    };
+
+    DiskCache(const std::string& directory, size_t max_bytes,
+              size_t segment_size = 32 * 1024 * 1024)
+        : directory_(directory),
+          max_bytes_(max_bytes),
+          segment_size_(std::max<size_t>(segment_size, 64 * 1024)) {
+        std::filesystem::create_directories(directory_);
+        open_index();
+        open_segments();
+        validate_index();
+        syncer_ = std::thread([this] { sync_loop(); });
+    }
+
+    ~DiskCache() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        syncer_.join();  // Publishes whatever is still pending
+        for (auto& [id, fd] : read_fds_) ::close(fd);
+        if (active_fd_ >= 0) ::close(active_fd_);
+        if (index_) {
+            ::msync(index_, index_size_, MS_ASYNC);
+            ::munmap(index_, index_size_);
+        }
+        if (index_fd_ >= 0) ::close(index_fd_);  // Also releases the flock
+    }
+
+    DiskCache(const DiskCache&) = delete;
+    DiskCache& operator=(const DiskCache&) = delete;
+
+    std::optional<Record> find(std::string_view key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // A record waiting for its sync is newer than any published one
+        auto pending = pending_.find(key);
+        if (pending != pending_.end()) return map_record(pending->second.slot, key);
+        std::optional<Record> record;
+        find_slot(key, &record);
+        return record;
+    }
+
+    // Append a record; the sync thread publishes it in the index once it is
+    // durable. Returns false when the record is too large to store.
+    bool put(std::string_view key, std::string_view meta, std::string_view body) {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        uint64_t length = sizeof(RecordHeader) + key.size() + meta.size() + body.size();
+        if (length > max_bytes_ / 2 || key.size() > UINT32_MAX || meta.size() > UINT32_MAX) {
+            return false;
+        }
+
+        if (active_size_ > 0 && active_size_ + length > segment_size_) {
+            start_segment(active_id_ + 1);
+        }
+
+        RecordHeader header{};
+        header.magic = record_magic;
+        header.key_length = static_cast<uint32_t>(key.size());
+        header.meta_length = static_cast<uint32_t>(meta.size());
+        header.body_length = body.size();
+        header.checksum = record_checksum(header, key, meta);
+
+        iovec parts[4] = {
+            {&header, sizeof(header)},
+            {const_cast<char*>(key.data()), key.size()},
+            {const_cast<char*>(meta.data()), meta.size()},
+            {const_cast<char*>(body.data()), body.size()}
+        };
+        uint64_t offset = active_size_;
+        write_all(active_fd_, parts, 4, offset);
+        active_size_ += length;
+        segment_bytes_[active_id_] = active_size_;
+        total_bytes_ += length;
+
+        while (total_bytes_ > max_bytes_ && segment_bytes_.size() > 1) {
+            evict_oldest_segment();
+        }
+
+        Pending pending{};
+        pending.slot.key_hash = hash_key(key);
+        pending.slot.offset = offset;
+        pending.slot.length = length;
+        pending.slot.segment = active_id_;
+        pending.slot.state = slot_live;
+        pending.sequence = ++sequence_;
+        auto previous = pending_.find(key);
+        if (previous != pending_.end()) {
+            pending.replaces = previous->second.replaces;
+            previous->second = pending;
+        } else {
+            pending.replaces = find_slot(key) != npos;
+            pending_.emplace(std::string(key), pending);
+        }
+        wake_.notify_one();
+        return true;
+    }
+
+    // Wait until every record put so far is durable and in the index
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t target = sequence_;
+        synced_.wait(lock, [&] { return synced_sequence_ >= target; });
+    }
+
+    void erase(std::string_view key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto pending = pending_.find(key);
+        if (pending != pending_.end()) pending_.erase(pending);
+        size_t index = find_slot(key);
+        if (index != npos) release_slot(slots()[index]);
+    }
+
+    // Drop every record and start over with an empty segment
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.clear();
+        while (segment_bytes_.size() > 1) {
+            evict_oldest_segment();
+        }
+        for (uint32_t i = 0; i < capacity(); ++i) {
+            slots()[i] = Slot{};
+        }
+        live_entries_ = 0;
+        deleted_entries_ = 0;
+        uint32_t id = active_id_;
+        start_segment(id + 1);
+        remove_segment(id);
+    }
+
+    // Entries include records still waiting for their sync
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t entries = live_entries_;
+        for (const auto& [key, pending] : pending_) {
+            if (!pending.replaces) ++entries;
+        }
+        return Stats{entries, total_bytes_, segment_bytes_.size()};
+    }
+
+private:
+    static constexpr uint64_t index_magic = 0x31584449'50545448ULL;  // "HTTPIDX1"
+    static constexpr uint32_t record_magic = 0x31524843;              // "CHR1"
+    static constexpr uint32_t slot_empty = 0;
+    static constexpr uint32_t slot_live = 1;
+    static constexpr uint32_t slot_deleted = 2;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    struct IndexHeader {
+        uint64_t magic;
+        uint32_t capacity;
+        uint32_t reserved[13];
+    };
+
+    struct Slot {
+        uint64_t key_hash;
+        uint64_t offset;
+        uint64_t length;
+        uint32_t segment;
+        uint32_t state;
+        uint32_t checksum;
+        uint32_t reserved;
+    };
+
+    struct RecordHeader {
+        uint32_t magic;
+        uint32_t key_length;
+        uint32_t meta_length;
+        uint32_t checksum;   // over this header and the key and meta bytes
+        uint64_t body_length;
+    };
+
+    // A record written to its segment but not yet synced and published
+    struct Pending {
+        Slot slot;
+        uint64_t sequence;
+        bool replaces;   // a published record of the same key exists
+    };
+
+    static uint64_t hash_key(std::string_view key) {
+        uint64_t hash = 1469598103934665603ULL;  // FNV-1a
+        for (unsigned char c : key) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    static uint32_t slot_checksum(const Slot& slot) {
+        Slot copy = slot;
+        copy.checksum = 0;
+        return static_cast<uint32_t>(::crc32(0, reinterpret_cast<const Bytef*>(&copy), sizeof(copy)));
+    }
+
+    static uint32_t record_checksum(RecordHeader header, std::string_view key, std::string_view meta) {
+        header.checksum = 0;
+        uLong crc = ::crc32(0, reinterpret_cast<const Bytef*>(&header), sizeof(header));
+        crc = ::crc32(crc, reinterpret_cast<const Bytef*>(key.data()), static_cast<uInt>(key.size()));
+        crc = ::crc32(crc, reinterpret_cast<const Bytef*>(meta.data()), static_cast<uInt>(meta.size()));
+        return static_cast<uint32_t>(crc);
+    }
+
+    static void throw_errno(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    static void write_all(int fd, iovec* parts, int count, uint64_t offset) {
+        while (count > 0) {
+            ssize_t written = ::pwritev(fd, parts, count, static_cast<off_t>(offset));
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw_errno("Disk cache write failed");
+            }
+            offset += static_cast<uint64_t>(written);
+            while (count > 0 && static_cast<size_t>(written) >= parts->iov_len) {
+                written -= static_cast<ssize_t>(parts->iov_len);
+                ++parts;
+                --count;
+            }
+            if (count > 0) {
+                parts->iov_base = static_cast<char*>(parts->iov_base) + written;
+                parts->iov_len -= static_cast<size_t>(written);
+            }
+        }
+    }
+
+    uint32_t capacity() const {
+        return reinterpret_cast<const IndexHeader*>(index_)->capacity;
+    }
+
+    Slot* slots() const {
+        return reinterpret_cast<Slot*>(static_cast<char*>(index_) + sizeof(IndexHeader));
+    }
+
+    std::string index_path() const {
+        return (std::filesystem::path(directory_) / "index.bin").string();
+    }
+
+    std::string segment_path(uint32_t id) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "seg-%08u.dat", id);
+        return (std::filesystem::path(directory_) / name).string();
+    }
+
+    void open_index() {
+        std::string path = index_path();
+        index_fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (index_fd_ < 0) throw_errno("Cannot open cache index " + path);
+        if (::flock(index_fd_, LOCK_EX | LOCK_NB) != 0) {
+            ::close(index_fd_);
+            index_fd_ = -1;
+            throw std::runtime_error("Cache directory is in use by another process: " + directory_);
+        }
+
+        // Roughly one slot per 4 KiB of budget, as a power of two
+        uint32_t wanted = 4096;
+        while (wanted < (1u << 24) && static_cast<uint64_t>(wanted) * 4096 < max_bytes_) wanted <<= 1;
+
+        struct stat st{};
+        ::fstat(index_fd_, &st);
+        IndexHeader header{};
+        bool valid = static_cast<size_t>(st.st_size) >= sizeof(IndexHeader) &&
+                     ::pread(index_fd_, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                     header.magic == index_magic && header.capacity != 0 &&
+                     (header.capacity & (header.capacity - 1)) == 0 &&
+                     static_cast<size_t>(st.st_size) == sizeof(IndexHeader) + header.capacity * sizeof(Slot);
+
+        if (!valid) {
+            header = IndexHeader{};
+            header.magic = index_magic;
+            header.capacity = wanted;
+            size_t size = sizeof(IndexHeader) + header.capacity * sizeof(Slot);
+            // ftruncate zero-fills, so every slot starts out empty
+            if (::ftruncate(index_fd_, 0) != 0 || ::ftruncate(index_fd_, static_cast<off_t>(size)) != 0 ||
+                ::pwrite(index_fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+                throw_errno("Cannot initialize cache index " + path);
+            }
+        }
+
+        index_size_ = sizeof(IndexHeader) + header.capacity * sizeof(Slot);
+        index_ = ::mmap(nullptr, index_size_, PROT_READ | PROT_WRITE, MAP_SHARED, index_fd_, 0);
+        if (index_ == MAP_FAILED) {
+            index_ = nullptr;
+            throw_errno("Cannot map cache index " + path);
+        }
+    }
+
+    void open_segments() {
+        for (const auto& file : std::filesystem::directory_iterator(directory_)) {
+            std::string name = file.path().filename().string();
+            unsigned id = 0;
+            if (name.size() == 16 && std::sscanf(name.c_str(), "seg-%8u.dat", &id) == 1) {
+                uint64_t size = file.file_size();
+                segment_bytes_[id] = size;
+                total_bytes_ += size;
+            }
+        }
+        uint32_t id = segment_bytes_.empty() ? 1 : segment_bytes_.rbegin()->first;
+        start_segment(id);
+    }
+
+    // Drop slots whose checksum, segment or extent does not hold up
+    void validate_index() {
+        for (uint32_t i = 0; i < capacity(); ++i) {
+            Slot& slot = slots()[i];
+            if (slot.state == slot_empty) continue;
+            auto segment = segment_bytes_.find(slot.segment);
+            bool valid = slot.checksum == slot_checksum(slot) &&
+                         (slot.state == slot_live || slot.state == slot_deleted) &&
+                         (slot.state == slot_deleted ||
+                          (segment != segment_bytes_.end() && slot.offset + slot.length <= segment->second));
+            if (!valid) {
+                slot = Slot{};
+            } else if (slot.state == slot_live) {
+                ++live_entries_;
+            } else {
+                ++deleted_entries_;
+            }
+        }
+    }
+
+    void start_segment(uint32_t id) {
+        if (active_fd_ >= 0) ::close(active_fd_);
+        std::string path = segment_path(id);
+        active_fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (active_fd_ < 0) throw_errno("Cannot open cache segment " + path);
+        struct stat st{};
+        ::fstat(active_fd_, &st);
+        active_id_ = id;
+        active_size_ = static_cast<uint64_t>(st.st_size);
+        segment_bytes_.emplace(id, active_size_);
+    }
+
+    int read_fd(uint32_t segment) {
+        auto it = read_fds_.find(segment);
+        if (it != read_fds_.end()) return it->second;
+        int fd = ::open(segment_path(segment).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) read_fds_[segment] = fd;
+        return fd;
+    }
+
+    std::optional<Record> map_record(const Slot& slot, std::string_view key) {
+        int fd = read_fd(slot.segment);
+        if (fd < 0) return std::nullopt;
+
+        static const uint64_t page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+        uint64_t base = slot.offset & ~(page - 1);
+        size_t length = static_cast<size_t>(slot.offset + slot.length - base);
+        void* address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(base));
+        if (address == MAP_FAILED) return std::nullopt;
+        std::shared_ptr<const void> region(address, [length](void* p) { ::munmap(p, length); });
+
+        const char* record = static_cast<const char*>(address) + (slot.offset - base);
+        RecordHeader header;
+        std::memcpy(&header, record, sizeof(header));
+        if (header.magic != record_magic ||
+            sizeof(header) + header.key_length + header.meta_length + header.body_length != slot.length) {
+            return std::nullopt;
+        }
+        std::string_view stored_key(record + sizeof(header), header.key_length);
+        std::string_view meta(stored_key.data() + stored_key.size(), header.meta_length);
+        if (stored_key != key || header.checksum != record_checksum(header, stored_key, meta)) {
+            return std::nullopt;
+        }
+        std::string_view body(meta.data() + meta.size(), header.body_length);
+        return Record{std::move(region), meta, body};
+    }
+
+    // Slot of the live record stored under `key`, or npos; the mapped
+    // record is handed back through `record` when asked for
+    size_t find_slot(std::string_view key, std::optional<Record>* record = nullptr) {
+        uint64_t hash = hash_key(key);
+        uint32_t mask = capacity() - 1;
+        for (uint32_t probe = 0; probe < capacity(); ++probe) {
+            size_t index = (hash + probe) & mask;
+            const Slot& slot = slots()[index];
+            if (slot.state == slot_empty) return npos;
+            if (slot.state == slot_live && slot.key_hash == hash) {
+                if (auto mapped = map_record(slot, key)) {
+                    if (record) *record = std::move(mapped);
+                    return index;
+                }
+            }
+        }
+        return npos;
+    }
+
+    // Slot to publish `key` into: its current slot, else the first free one.
+    // Keeps the table at most 3/4 full so probe sequences stay short.
+    size_t claim_slot(std::string_view key) {
+        size_t existing = find_slot(key);
+        if (existing != npos) return existing;
+        if ((live_entries_ + 1) * 4 > static_cast<size_t>(capacity()) * 3) return npos;
+        if ((live_entries_ + deleted_entries_ + 1) * 8 > static_cast<size_t>(capacity()) * 7) {
+            compact_index();
+        }
+
+        uint64_t hash = hash_key(key);
+        uint32_t mask = capacity() - 1;
+        for (uint32_t probe = 0; probe < capacity(); ++probe) {
+            size_t index = (hash + probe) & mask;
+            if (slots()[index].state != slot_live) return index;
+        }
+        return npos;
+    }
+
+    // Rehash live slots into a fresh index file to clear out tombstones left
+    // by erase and eviction. The file is renamed over the old index, so a
+    // crash leaves one table or the other, never a half-rebuilt one. On
+    // failure the current table stays in use.
+    void compact_index() {
+        std::vector<char> table(index_size_, '\0');
+        std::memcpy(table.data(), index_, sizeof(IndexHeader));
+        Slot* fresh = reinterpret_cast<Slot*>(table.data() + sizeof(IndexHeader));
+        uint32_t mask = capacity() - 1;
+        for (uint32_t i = 0; i < capacity(); ++i) {
+            const Slot& slot = slots()[i];
+            if (slot.state != slot_live) continue;
+            for (uint32_t probe = 0; probe < capacity(); ++probe) {
+                Slot& target = fresh[(slot.key_hash + probe) & mask];
+                if (target.state == slot_empty) {
+                    target = slot;
+                    break;
+                }
+            }
+        }
+
+        std::string path = index_path();
+        std::string temp = path + ".tmp";
+        int fd = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return;
+        iovec part{table.data(), table.size()};
+        void* mapping = MAP_FAILED;
+        try {
+            write_all(fd, &part, 1, 0);
+            if (::flock(fd, LOCK_EX | LOCK_NB) == 0 && ::fdatasync(fd) == 0) {
+                mapping = ::mmap(nullptr, index_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+        } catch (const std::system_error&) {
+        }
+        if (mapping == MAP_FAILED || ::rename(temp.c_str(), path.c_str()) != 0) {
+            if (mapping != MAP_FAILED) ::munmap(mapping, index_size_);
+            ::close(fd);
+            ::unlink(temp.c_str());
+            return;
+        }
+
+        ::munmap(index_, index_size_);
+        ::close(index_fd_);
+        index_ = mapping;
+        index_fd_ = fd;
+        deleted_entries_ = 0;
+    }
+
+    void release_slot(Slot& slot) {
+        if (slot.state == slot_live) --live_entries_;
+        if (slot.state != slot_deleted) ++deleted_entries_;
+        slot.state = slot_deleted;
+        slot.checksum = slot_checksum(slot);
+    }
+
+    void evict_oldest_segment() {
+        uint32_t oldest = segment_bytes_.begin()->first;
+        if (oldest == active_id_) return;
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            it = it->second.slot.segment == oldest ? pending_.erase(it) : std::next(it);
+        }
+        for (uint32_t i = 0; i < capacity(); ++i) {
+            Slot& slot = slots()[i];
+            if (slot.state == slot_live && slot.segment == oldest) release_slot(slot);
+        }
+        remove_segment(oldest);
+    }
+
+    void remove_segment(uint32_t id) {
+        auto fd = read_fds_.find(id);
+        if (fd != read_fds_.end()) {
+            ::close(fd->second);
+            read_fds_.erase(fd);
+        }
+        auto segment = segment_bytes_.find(id);
+        if (segment != segment_bytes_.end()) {
+            total_bytes_ -= segment->second;
+            segment_bytes_.erase(segment);
+        }
+        ::unlink(segment_path(id).c_str());
+    }
+
+    // Point the index at a durable record, evicting to make room if needed
+    void publish(std::string_view key, const Slot& record) {
+        size_t index = claim_slot(key);
+        while (index == npos && segment_bytes_.size() > 1) {
+            evict_oldest_segment();
+            index = claim_slot(key);
+        }
+        if (index == npos || segment_bytes_.count(record.segment) == 0) return;
+
+        Slot& slot = slots()[index];
+        if (slot.state == slot_deleted) --deleted_entries_;
+        if (slot.state != slot_live) ++live_entries_;
+        slot = record;
+        slot.checksum = slot_checksum(slot);
+    }
+
+    // Sync thread: fdatasync the segments holding pending records, then
+    // publish those records. Runs until stopped with nothing pending.
+    void sync_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this] { return stopping_ || synced_sequence_ < sequence_; });
+            if (synced_sequence_ == sequence_) return;
+
+            uint64_t batch = sequence_;
+            std::vector<uint32_t> segments;
+            for (const auto& [key, pending] : pending_) {
+                if (std::find(segments.begin(), segments.end(), pending.slot.segment) == segments.end()) {
+                    segments.push_back(pending.slot.segment);
+                }
+            }
+            lock.unlock();
+            std::vector<uint32_t> failed;
+            for (uint32_t segment : segments) {
+                // Fails for a segment evicted in the meantime, whose records are dropped anyway
+                int fd = ::open(segment_path(segment).c_str(), O_WRONLY | O_CLOEXEC);
+                if (fd < 0 || ::fdatasync(fd) != 0) failed.push_back(segment);
+                if (fd >= 0) ::close(fd);
+            }
+            lock.lock();
+
+            std::vector<std::pair<std::string, Slot>> durable;
+            for (auto it = pending_.begin(); it != pending_.end();) {
+                if (it->second.sequence > batch) {
+                    ++it;
+                    continue;
+                }
+                if (std::find(failed.begin(), failed.end(), it->second.slot.segment) == failed.end()) {
+                    durable.emplace_back(it->first, it->second.slot);
+                }
+                it = pending_.erase(it);
+            }
+            for (const auto& [key, slot] : durable) publish(key, slot);
+            synced_sequence_ = batch;
+            synced_.notify_all();
+        }
+    }
+
+    std::string directory_;
+    size_t max_bytes_;
+    size_t segment_size_;
+
+    mutable std::mutex mutex_;
+    int index_fd_{-1};
+    void* index_{nullptr};
+    size_t index_size_{0};
+    size_t live_entries_{0};
+    size_t deleted_entries_{0};
+
+    std::map<uint32_t, uint64_t> segment_bytes_;   // by id, oldest first
+    std::map<uint32_t, int> read_fds_;
+    uint64_t total_bytes_{0};
+    int active_fd_{-1};
+    uint32_t active_id_{0};
+    uint64_t active_size_{0};
+
+    std::map<std::string, Pending, std::less<>> pending_;
+    uint64_t sequence_{0};          // of the latest put
+    uint64_t synced_sequence_{0};   // puts up to here are durable or dropped
+    bool stopping_{false};
+    std::condition_variable wake_;
+    std::condition_variable synced_;
+    std::thread syncer_;
+};
+
+#else
+
+// Persistence relies on POSIX file locking and mmap. Elsewhere the client
+// keeps the HTTP cache in memory and never constructs a DiskCache.
+class DiskCache {
+public:
+    struct Record {
+        std::shared_ptr<const void> mapping;
+        std::string_view meta;
+        std::string_view body;
+    };
+
+    struct Stats {
+        size_t entries{0};
+        size_t bytes{0};
+        size_t segments{0};
+    };
+
+    DiskCache(const std::string&, size_t, size_t = 0) {
+        throw std::runtime_error("Disk cache is not supported on this platform");
+    }
+
+    std::optional<Record> find(std::string_view) { return std::nullopt; }
+    bool put(std::string_view, std::string_view, std::string_view) { return false; }
+    void flush() {}
+    void erase(std::string_view) {}
+    void clear() {}
+    Stats stats() const { return {}; }
+};
+
+#endif
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <asio.hpp>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace coro_http {
+
+// Resolved endpoints per host and port.
+// getaddrinfo does not report record TTLs, so every entry lives for the
+// configured TTL. Expiry uses the system clock so entries keep their
+// deadline when saved to a state snapshot and loaded by another process.
+class DnsCache {
+public:
+    using Clock = std::chrono::system_clock;
+    using Endpoints = std::vector<asio::ip::tcp::endpoint>;
+
+    struct Entry {
+        std::string host;
+        std::string port;
+        Endpoints endpoints;
+        Clock::time_point expires;
+    };
+
+    explicit DnsCache(std::chrono::seconds ttl = std::chrono::seconds(60))
+        : ttl_(ttl) {}
+
+    DnsCache(const DnsCache&) = delete;
+    DnsCache& operator=(const DnsCache&) = delete;
+
+    std::optional<Endpoints> lookup(const std::string& host, const std::string& port) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key_for(host, port));
+        if (it == entries_.end()) return std::nullopt;
+        if (it->second.expires <= Clock::now()) {
+            entries_.erase(it);
+            return std::nullopt;
+        }
+        return it->second.endpoints;
+    }
+
+    void store(const std::string& host, const std::string& port, Endpoints endpoints) {
+        if (endpoints.empty()) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_[key_for(host, port)] = Entry{host, port, std::move(endpoints), Clock::now() + ttl_};
+    }
+
+    // Restore entries, keeping their original expiry; expired ones are skipped
+    void import(std::vector<Entry> entries) {
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : entries) {
+            if (entry.expires <= now || entry.endpoints.empty()) continue;
+            std::string key = key_for(entry.host, entry.port);
+            entries_[std::move(key)] = std::move(entry);
+        }
+    }
+
+    // Unexpired entries, for saving
+    std::vector<Entry> entries() const {
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<Entry> result;
+        result.reserve(entries_.size());
+        for (const auto& [key, entry] : entries_) {
+            if (entry.expires > now) result.push_back(entry);
+        }
+        return result;
+    }
+
+    void remove(const std::string& host, const std::string& port) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.erase(key_for(host, port));
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+private:
+    static std::string key_for(const std::string& host, const std::string& port) {
+        return host + ':' + port;
+    }
+
+    std::chrono::seconds ttl_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+}
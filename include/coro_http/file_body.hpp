@@ -0,0 +1,146 @@
+#pragma once
+
+#include <asio.hpp>
+#if defined(_WIN32)
+#include <filesystem>
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+namespace coro_http {
+
+// TCP and Unix domain stream sockets, which sendfile() writes to directly
+template<typename Stream>
+struct is_plain_socket : std::false_type {};
+
+template<typename Protocol, typename Executor>
+struct is_plain_socket<asio::basic_stream_socket<Protocol, Executor>> : std::true_type {};
+
+template<typename Stream>
+inline constexpr bool is_plain_socket_v = is_plain_socket<Stream>::value;
+
+// A request body read from a file at send time instead of held in memory.
+// Over a plain socket on Linux the kernel copies it straight from the page
+// cache with sendfile(); through TLS, and on other platforms, it is read
+// and written in slices.
+class FileBody {
+public:
+    // Files up to this size are read whole and sent with the head in one write
+    static constexpr size_t inline_limit = 64 * 1024;
+    static constexpr size_t slice_size = 64 * 1024;
+
+    explicit FileBody(const std::string& path) {
+#if defined(_WIN32)
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(path, ec)) {
+            throw std::system_error(EINVAL, std::generic_category(), "Request body is not a regular file: " + path);
+        }
+        file_.open(path, std::ios::binary);
+        if (!file_) {
+            throw std::system_error(ENOENT, std::generic_category(), "Cannot open request body " + path);
+        }
+        size_ = static_cast<size_t>(std::filesystem::file_size(path));
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "Cannot open request body " + path);
+        }
+        struct stat info {};
+        if (::fstat(fd_, &info) != 0 || !S_ISREG(info.st_mode)) {
+            ::close(fd_);
+            throw std::system_error(EINVAL, std::generic_category(), "Request body is not a regular file: " + path);
+        }
+        size_ = static_cast<size_t>(info.st_size);
+#endif
+    }
+
+    FileBody(const FileBody&) = delete;
+    FileBody& operator=(const FileBody&) = delete;
+
+    ~FileBody() {
+#if !defined(_WIN32)
+        ::close(fd_);
+#endif
+    }
+
+    size_t size() const { return size_; }
+
+    // Read up to `length` bytes at `offset` into `out`, replacing its contents
+    void read(size_t offset, size_t length, std::string& out) const {
+        out.resize(length);
+#if defined(_WIN32)
+        file_.clear();
+        file_.seekg(static_cast<std::streamoff>(offset));
+        file_.read(out.data(), static_cast<std::streamsize>(length));
+        if (static_cast<size_t>(file_.gcount()) != length) {
+            throw std::runtime_error("Request body file shrank while sending");
+        }
+#else
+        size_t done = 0;
+        while (done < length) {
+            ssize_t n = ::pread(fd_, out.data() + done, length - done, static_cast<off_t>(offset + done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) throw std::system_error(errno, std::generic_category(), "Reading request body");
+            if (n == 0) throw std::runtime_error("Request body file shrank while sending");
+            done += static_cast<size_t>(n);
+        }
+#endif
+    }
+
+    // Write the whole file to `stream`: sendfile() for a plain socket on
+    // Linux, sliced reads and writes for anything else
+    template<typename AsyncWriteStream>
+    asio::awaitable<void> co_send(AsyncWriteStream& stream) const {
+#if defined(__linux__)
+        if constexpr (is_plain_socket_v<AsyncWriteStream>) {
+            co_await co_sendfile(stream);
+            co_return;
+        }
+#endif
+        std::string slice;
+        for (size_t offset = 0; offset < size_; offset += slice_size) {
+            read(offset, std::min(slice_size, size_ - offset), slice);
+            co_await asio::async_write(stream, asio::buffer(slice), asio::use_awaitable);
+        }
+    }
+
+private:
+#if defined(__linux__)
+    template<typename Socket>
+    asio::awaitable<void> co_sendfile(Socket& socket) const {
+        socket.native_non_blocking(true);
+        off_t offset = 0;
+        while (static_cast<size_t>(offset) < size_) {
+            ssize_t n = ::sendfile(socket.native_handle(), fd_, &offset, size_ - static_cast<size_t>(offset));
+            if (n > 0 || (n < 0 && errno == EINTR)) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                co_await socket.async_wait(Socket::wait_write, asio::use_awaitable);
+                continue;
+            }
+            if (n == 0) throw std::runtime_error("Request body file shrank while sending");
+            throw std::system_error(errno, std::generic_category(), "sendfile");
+        }
+    }
+#endif
+
+#if defined(_WIN32)
+    mutable std::ifstream file_;
+#else
+    int fd_{-1};
+#endif
+    size_t size_{0};
+};
+
+}
@@ -0,0 +1,706 @@
+#pragma once
+
+#include "http_request.hpp"
+#include "http_response.hpp"
+#include "http_date.hpp"
+#include "disk_cache.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace coro_http {
+
+// Cache-Control directives understood by the cache (RFC 9111 section 5.2)
+struct CacheControl {
+    bool no_store{false};
+    bool no_cache{false};
+    bool must_revalidate{false};
+    bool is_public{false};
+    bool is_private{false};
+    std::optional<std::chrono::seconds> max_age;
+    std::optional<std::chrono::seconds> s_maxage;
+    std::optional<std::chrono::seconds> stale_while_revalidate;
+    std::optional<std::chrono::seconds> stale_if_error;
+};
+
+namespace detail {
+
+inline std::string lower_copy(std::string_view s) {
+    std::string out(s);
+    std::transform(out.begin(), out.end(), out.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return out;
+}
+
+inline std::string_view trim_view(std::string_view s) {
+    size_t first = s.find_first_not_of(" \t");
+    if (first == std::string_view::npos) return {};
+    size_t last = s.find_last_not_of(" \t");
+    return s.substr(first, last - first + 1);
+}
+
+// Delta-seconds; out-of-range values clamp, invalid ones are nullopt
+inline std::optional<std::chrono::seconds> parse_delta_seconds(std::string_view value) {
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        value = value.substr(1, value.size() - 2);
+    }
+    if (value.empty()) return std::nullopt;
+    int64_t seconds = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') return std::nullopt;
+        seconds = std::min<int64_t>(seconds * 10 + (c - '0'), int64_t{1} << 31);
+    }
+    return std::chrono::seconds(seconds);
+}
+
+inline std::string find_request_header(const HttpRequest& request, std::string_view name) {
+    for (const auto& [key, value] : request.headers()) {
+        if (key.size() == name.size() && lower_copy(key) == lower_copy(name)) return value;
+    }
+    return {};
+}
+
+// Length-prefixed encoding for entry metadata stored on disk
+inline void put_u64(std::string& out, uint64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline void put_string(std::string& out, std::string_view value) {
+    put_u64(out, value.size());
+    out.append(value);
+}
+
+struct MetaReader {
+    std::string_view data;
+    bool ok{true};
+
+    uint64_t u64() {
+        uint64_t value = 0;
+        if (data.size() < sizeof(value)) {
+            ok = false;
+            return 0;
+        }
+        std::memcpy(&value, data.data(), sizeof(value));
+        data.remove_prefix(sizeof(value));
+        return value;
+    }
+
+    std::string str() {
+        uint64_t length = u64();
+        if (!ok || data.size() < length) {
+            ok = false;
+            return {};
+        }
+        std::string value(data.substr(0, length));
+        data.remove_prefix(length);
+        return value;
+    }
+};
+
+}
+
+inline CacheControl parse_cache_control(std::string_view value) {
+    CacheControl cc;
+    while (!value.empty()) {
+        size_t comma = value.find(',');
+        std::string_view directive = detail::trim_view(value.substr(0, comma));
+        value = comma == std::string_view::npos ? std::string_view() : value.substr(comma + 1);
+        if (directive.empty()) continue;
+
+        size_t eq = directive.find('=');
+        std::string name = detail::lower_copy(detail::trim_view(directive.substr(0, eq)));
+        std::string_view arg = eq == std::string_view::npos
+            ? std::string_view() : detail::trim_view(directive.substr(eq + 1));
+
+        if (name == "no-store") cc.no_store = true;
+        else if (name == "no-cache") cc.no_cache = true;
+        else if (name == "must-revalidate" || name == "proxy-revalidate") cc.must_revalidate = true;
+        else if (name == "public") cc.is_public = true;
+        else if (name == "private") cc.is_private = true;
+        else if (name == "max-age") cc.max_age = detail::parse_delta_seconds(arg);
+        else if (name == "s-maxage") cc.s_maxage = detail::parse_delta_seconds(arg);
+        else if (name == "stale-while-revalidate") cc.stale_while_revalidate = detail::parse_delta_seconds(arg);
+        else if (name == "stale-if-error") cc.stale_if_error = detail::parse_delta_seconds(arg);
+    }
+    return cc;
+}
+
+// A stored response with the timing needed to compute its age
+struct CacheEntry {
+    using time_point = std::chrono::system_clock::time_point;
+
+    HttpResponse response;
+    CacheControl cache_control;
+    std::string etag;
+    std::string last_modified;
+    std::chrono::seconds freshness_lifetime{0};
+    std::chrono::seconds corrected_initial_age{0};
+    time_point response_time;
+    size_t size{0};
+
+    // Set while a background (stale-while-revalidate) refresh is in flight
+    mutable std::atomic<bool> revalidating{false};
+
+    // RFC 9111 section 4.2.3
+    std::chrono::seconds current_age(time_point now) const {
+        auto resident = std::chrono::duration_cast<std::chrono::seconds>(now - response_time);
+        return corrected_initial_age + std::max(resident, std::chrono::seconds(0));
+    }
+
+    bool has_validators() const {
+        return !etag.empty() || !last_modified.empty();
+    }
+};
+
+// In-memory private HTTP cache (RFC 9111) for GET responses.
+// Entries are held in an LRU bounded by total bytes and split across shards,
+// each with its own lock, so concurrent lookups for different URLs rarely
+// contend. Responses with Vary are stored per variant of the listed request
+// headers.
+class HttpCache {
+public:
+    using time_point = std::chrono::system_clock::time_point;
+
+    enum class Freshness {
+        Fresh,                  // serve as-is
+        StaleWhileRevalidate,   // serve, and refresh in the background
+        Stale                   // revalidate before serving
+    };
+
+    struct Lookup {
+        std::shared_ptr<const CacheEntry> entry;
+        Freshness freshness;
+    };
+
+    struct Stats {
+        size_t hits{0};
+        size_t misses{0};
+        size_t revalidations{0};   // 304 responses that refreshed an entry
+        size_t stores{0};
+        size_t evictions{0};
+        size_t entries{0};
+        size_t bytes{0};
+    };
+
+    // Heuristic freshness (10% of the Last-Modified age) is capped at this
+    static constexpr std::chrono::seconds max_heuristic_lifetime{24 * 3600};
+
+    // Variants kept on disk per URL; the oldest is dropped beyond this
+    static constexpr size_t max_disk_variants = 64;
+
+    // With a DiskCache, stored responses are also written through to disk and
+    // memory misses are filled from it, so entries survive restarts.
+    explicit HttpCache(size_t max_bytes = 64 * 1024 * 1024, size_t shard_count = 16,
+                       std::shared_ptr<DiskCache> disk = nullptr)
+        : shard_budget_(max_bytes / std::max<size_t>(shard_count, 1)),
+          disk_(std::move(disk)) {
+        shards_.reserve(std::max<size_t>(shard_count, 1));
+        for (size_t i = 0; i < std::max<size_t>(shard_count, 1); ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    HttpCache(const HttpCache&) = delete;
+    HttpCache& operator=(const HttpCache&) = delete;
+
+    // GET requests without no-store, Range or caller-supplied validators.
+    // Conditional requests from the caller are passed through untouched.
+    static bool is_cacheable_request(const HttpRequest& request) {
+        if (request.method() != HttpMethod::GET) return false;
+        for (const auto& [key, value] : request.headers()) {
+            std::string name = detail::lower_copy(key);
+            if (name == "range" || name == "if-none-match" || name == "if-modified-since" ||
+                name == "if-match" || name == "if-unmodified-since" || name == "if-range") {
+                return false;
+            }
+            if (name == "cache-control" && parse_cache_control(value).no_store) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::optional<Lookup> lookup(const HttpRequest& request, time_point now = std::chrono::system_clock::now()) {
+        Shard& shard = shard_for(request.url());
+        std::shared_ptr<const CacheEntry> entry;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto variants = shard.variants.find(request.url());
+            if (variants != shard.variants.end()) {
+                auto it = shard.index.find(variant_key(request, variants->second.fields));
+                if (it != shard.index.end()) {
+                    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                    entry = it->second->second;
+                }
+            }
+        }
+        if (!entry && disk_) {
+            entry = load_from_disk(request);
+        }
+        if (!entry) {
+            ++misses_;
+            return std::nullopt;
+        }
+
+        Freshness freshness = freshness_of(*entry, request, now);
+        if (freshness == Freshness::Stale && !entry->has_validators()) {
+            ++misses_;
+            return std::nullopt;  // Nothing to revalidate with; a plain fetch replaces it
+        }
+        if (freshness != Freshness::Stale) ++hits_;
+        return Lookup{std::move(entry), freshness};
+    }
+
+    // Store a response if RFC 9111 allows it and it can be reused; returns the
+    // new entry, or nullptr when the response was not stored.
+    std::shared_ptr<const CacheEntry> store(const HttpRequest& request, const HttpResponse& response,
+                                            time_point request_time, time_point response_time) {
+        if (request.method() != HttpMethod::GET) return nullptr;
+
+        CacheControl cc = parse_cache_control(response.get_header("Cache-Control"));
+        CacheControl request_cc = parse_cache_control(detail::find_request_header(request, "Cache-Control"));
+        if (cc.no_store || request_cc.no_store) return nullptr;
+
+        std::vector<std::string> vary_fields;
+        if (!parse_vary(response.get_header("Vary"), vary_fields)) return nullptr;
+
+        // Responses to authenticated requests need explicit permission
+        if (!detail::find_request_header(request, "Authorization").empty() &&
+            !cc.is_public && !cc.must_revalidate && !cc.s_maxage) {
+            return nullptr;
+        }
+
+        auto entry = std::make_shared<CacheEntry>();
+        entry->response = response;
+        entry->cache_control = cc;
+        entry->etag = response.get_header("ETag");
+        entry->last_modified = response.get_header("Last-Modified");
+        entry->response_time = response_time;
+        entry->freshness_lifetime = freshness_lifetime(response, cc, response_time);
+        entry->corrected_initial_age = initial_age(response, request_time, response_time);
+
+        if (entry->freshness_lifetime.count() == 0 && !entry->has_validators()) {
+            return nullptr;  // Could never be served without a full fetch
+        }
+
+        std::string key = variant_key(request, vary_fields);
+        entry->size = entry_size(*entry, key);
+
+        bool on_disk = disk_ && store_on_disk(request.url(), key, vary_fields,
+                                              encode_meta(*entry, key, vary_fields), entry->response.body());
+        // Entries too large for memory can still be served from disk
+        if (entry->size > shard_budget_) {
+            if (!on_disk) return nullptr;
+        } else {
+            insert(request.url(), std::move(key), std::move(vary_fields), entry);
+        }
+        ++stores_;
+        return entry;
+    }
+
+    // Update a stored entry from a 304 Not Modified (RFC 9111 section 4.3.4)
+    // and store the refreshed entry in its place.
+    std::shared_ptr<const CacheEntry> freshen(const HttpRequest& request, const CacheEntry& entry,
+                                              const HttpResponse& not_modified,
+                                              time_point request_time, time_point response_time) {
+        HttpResponse updated;
+        updated.set_status_code(entry.response.status_code());
+        updated.set_reason(entry.response.reason());
+        for (const auto& [key, value] : entry.response.headers()) {
+            if (!has_header_ci(not_modified, key) || is_unupdatable_header(key)) {
+                updated.add_header(key, value);
+            }
+        }
+        for (const auto& [key, value] : not_modified.headers()) {
+            if (!is_unupdatable_header(key)) updated.add_header(key, value);
+        }
+        updated.set_body(entry.response.body());
+        ++revalidations_;
+        return store(request, updated, request_time, response_time);
+    }
+
+    // Drop every stored variant of a URL (after an unsafe method succeeds)
+    void invalidate(const std::string& url) {
+        Shard& shard = shard_for(url);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.variants.find(url);
+            if (it != shard.variants.end()) {
+                for (const auto& key : std::vector<std::string>(it->second.keys)) {
+                    erase_locked(shard, key);
+                }
+            }
+        }
+        if (disk_) {
+            std::lock_guard<std::mutex> lock(disk_mutex_);
+            Variants stored = disk_variants(url);
+            for (const auto& key : stored.keys) disk_->erase(key);
+            disk_->erase(disk_variants_key(url));
+        }
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> disk_lock(disk_mutex_);
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->lru.clear();
+            shard->index.clear();
+            shard->variants.clear();
+            shard->bytes = 0;
+        }
+        if (disk_) disk_->clear();
+    }
+
+    // Add If-None-Match / If-Modified-Since for revalidating `entry`
+    static void add_validators(HttpRequest& request, const CacheEntry& entry) {
+        if (!entry.etag.empty()) request.add_header("If-None-Match", entry.etag);
+        if (!entry.last_modified.empty()) request.add_header("If-Modified-Since", entry.last_modified);
+    }
+
+    // The stored response as served to the caller, with its current Age
+    static HttpResponse serve(const CacheEntry& entry, time_point now = std::chrono::system_clock::now()) {
+        HttpResponse response = entry.response;
+        response.add_header("Age", std::to_string(entry.current_age(now).count()));
+        return response;
+    }
+
+    // Whether a stale entry may stand in for a 5xx from the origin
+    static bool usable_on_error(const CacheEntry& entry, time_point now = std::chrono::system_clock::now()) {
+        if (!entry.cache_control.stale_if_error || entry.cache_control.must_revalidate) return false;
+        return entry.current_age(now) < entry.freshness_lifetime + *entry.cache_control.stale_if_error;
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.hits = hits_;
+        s.misses = misses_;
+        s.revalidations = revalidations_;
+        s.stores = stores_;
+        s.evictions = evictions_;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            s.entries += shard->lru.size();
+            s.bytes += shard->bytes;
+        }
+        return s;
+    }
+
+private:
+    struct Variants {
+        std::vector<std::string> fields;   // lower-cased Vary field names
+        std::vector<std::string> keys;     // stored variant keys
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        // Most recently used at the front
+        std::list<std::pair<std::string, std::shared_ptr<const CacheEntry>>> lru;
+        std::unordered_map<std::string, decltype(lru)::iterator> index;
+        std::unordered_map<std::string, Variants> variants;  // by URL
+        size_t bytes{0};
+    };
+
+    void insert(const std::string& url, std::string key, std::vector<std::string> vary_fields,
+                std::shared_ptr<const CacheEntry> entry) {
+        Shard& shard = shard_for(url);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        // The latest response decides which headers select a variant
+        auto previous = shard.variants.find(url);
+        if (previous != shard.variants.end() && previous->second.fields != vary_fields) {
+            for (const auto& old_key : std::vector<std::string>(previous->second.keys)) {
+                erase_locked(shard, old_key);
+            }
+        }
+
+        erase_locked(shard, key);
+        shard.bytes += entry->size;
+        shard.lru.emplace_front(key, std::move(entry));
+        shard.index[key] = shard.lru.begin();
+        auto& variants = shard.variants[url];
+        variants.fields = std::move(vary_fields);
+        variants.keys.push_back(std::move(key));
+
+        while (shard.bytes > shard_budget_ && !shard.lru.empty()) {
+            erase_locked(shard, shard.lru.back().first);
+            ++evictions_;
+        }
+    }
+
+    static std::string encode_meta(const CacheEntry& entry, const std::string& key,
+                                   const std::vector<std::string>& vary_fields) {
+        std::string meta;
+        detail::put_string(meta, key);
+        detail::put_u64(meta, vary_fields.size());
+        for (const auto& field : vary_fields) detail::put_string(meta, field);
+        detail::put_u64(meta, static_cast<uint64_t>(entry.response.status_code()));
+        detail::put_string(meta, entry.response.reason());
+        detail::put_u64(meta, entry.response.headers().size());
+        for (const auto& [name, value] : entry.response.headers()) {
+            detail::put_string(meta, name);
+            detail::put_string(meta, value);
+        }
+        detail::put_u64(meta, static_cast<uint64_t>(entry.freshness_lifetime.count()));
+        detail::put_u64(meta, static_cast<uint64_t>(entry.corrected_initial_age.count()));
+        detail::put_u64(meta, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            entry.response_time.time_since_epoch()).count()));
+        return meta;
+    }
+
+    // On disk, as in memory, each variant is stored under its variant key. A
+    // record under the URL's variants key lists the Vary fields that select
+    // a variant and the variant keys stored, so lookups can find the variant
+    // and invalidation can drop them all. Field names never contain '*'.
+    static std::string disk_variants_key(const std::string& url) {
+        return url + "\n*";
+    }
+
+    Variants disk_variants(const std::string& url) {
+        Variants stored;
+        auto record = disk_->find(disk_variants_key(url));
+        if (!record) return stored;
+        detail::MetaReader reader{record->meta};
+        stored.fields.resize(reader.u64() & 0xffff);
+        for (auto& field : stored.fields) field = reader.str();
+        stored.keys.resize(reader.u64() & 0xffff);
+        for (auto& key : stored.keys) key = reader.str();
+        if (!reader.ok) return Variants();
+        return stored;
+    }
+
+    bool store_on_disk(const std::string& url, const std::string& key, const std::vector<std::string>& vary_fields,
+                       const std::string& meta, const std::string& body) {
+        std::lock_guard<std::mutex> lock(disk_mutex_);
+        Variants stored = disk_variants(url);
+        bool changed = stored.fields != vary_fields;
+        if (changed) {
+            // The latest response decides which headers select a variant
+            for (const auto& old_key : stored.keys) disk_->erase(old_key);
+            stored.keys.clear();
+            stored.fields = vary_fields;
+        }
+        if (!disk_->put(key, meta, body)) return false;
+        if (std::find(stored.keys.begin(), stored.keys.end(), key) == stored.keys.end()) {
+            stored.keys.push_back(key);
+            if (stored.keys.size() > max_disk_variants) {
+                disk_->erase(stored.keys.front());
+                stored.keys.erase(stored.keys.begin());
+            }
+            changed = true;
+        }
+        if (changed) {
+            std::string list;
+            detail::put_u64(list, stored.fields.size());
+            for (const auto& field : stored.fields) detail::put_string(list, field);
+            detail::put_u64(list, stored.keys.size());
+            for (const auto& stored_key : stored.keys) detail::put_string(list, stored_key);
+            disk_->put(disk_variants_key(url), list, {});
+        }
+        return true;
+    }
+
+    // Rebuild an entry stored on disk, if it is the variant `request` selects
+    std::shared_ptr<const CacheEntry> load_from_disk(const HttpRequest& request) {
+        auto variants = disk_->find(disk_variants_key(request.url()));
+        if (!variants) return nullptr;
+        detail::MetaReader variants_reader{variants->meta};
+        std::vector<std::string> selecting(variants_reader.u64() & 0xffff);
+        for (auto& field : selecting) field = variants_reader.str();
+        if (!variants_reader.ok) return nullptr;
+
+        auto record = disk_->find(variant_key(request, selecting));
+        if (!record) return nullptr;
+
+        detail::MetaReader reader{record->meta};
+        std::string stored_key = reader.str();
+        std::vector<std::string> vary_fields(reader.u64() & 0xffff);
+        for (auto& field : vary_fields) field = reader.str();
+        if (!reader.ok) return nullptr;
+
+        std::string key = variant_key(request, vary_fields);
+        if (key != stored_key) return nullptr;
+
+        auto entry = std::make_shared<CacheEntry>();
+        entry->response.set_status_code(static_cast<int>(reader.u64()));
+        entry->response.set_reason(reader.str());
+        for (uint64_t count = reader.u64(); reader.ok && count > 0; --count) {
+            std::string name = reader.str();
+            entry->response.add_header(name, reader.str());
+        }
+        entry->freshness_lifetime = std::chrono::seconds(static_cast<int64_t>(reader.u64()));
+        entry->corrected_initial_age = std::chrono::seconds(static_cast<int64_t>(reader.u64()));
+        entry->response_time = time_point(std::chrono::seconds(static_cast<int64_t>(reader.u64())));
+        if (!reader.ok) return nullptr;
+
+        entry->response.set_body(std::string(record->body));
+        entry->cache_control = parse_cache_control(entry->response.get_header("Cache-Control"));
+        entry->etag = entry->response.get_header("ETag");
+        entry->last_modified = entry->response.get_header("Last-Modified");
+        entry->size = entry_size(*entry, key);
+
+        if (entry->size <= shard_budget_) {
+            insert(request.url(), std::move(key), std::move(vary_fields), entry);
+        }
+        return entry;
+    }
+
+    Shard& shard_for(const std::string& url) {
+        return *shards_[std::hash<std::string>{}(url) % shards_.size()];
+    }
+
+    static std::string variant_key(const HttpRequest& request, const std::vector<std::string>& fields) {
+        std::string key = request.url();
+        for (const auto& field : fields) {
+            key += '\n';
+            key += field;
+            key += ':';
+            key += detail::find_request_header(request, field);
+        }
+        return key;
+    }
+
+    // False for "Vary: *", which can never be matched
+    static bool parse_vary(std::string_view vary, std::vector<std::string>& fields) {
+        while (!vary.empty()) {
+            size_t comma = vary.find(',');
+            std::string field = detail::lower_copy(detail::trim_view(vary.substr(0, comma)));
+            vary = comma == std::string_view::npos ? std::string_view() : vary.substr(comma + 1);
+            if (field == "*") return false;
+            if (!field.empty()) fields.push_back(std::move(field));
+        }
+        std::sort(fields.begin(), fields.end());
+        fields.erase(std::unique(fields.begin(), fields.end()), fields.end());
+        return true;
+    }
+
+    static bool heuristically_cacheable(int status) {
+        switch (status) {
+            case 200: case 203: case 204: case 300: case 301: case 308:
+            case 404: case 405: case 410: case 414: case 501:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // RFC 9111 section 4.2.1 (private cache, so s-maxage is ignored)
+    static std::chrono::seconds freshness_lifetime(const HttpResponse& response, const CacheControl& cc,
+                                                   time_point response_time) {
+        using std::chrono::seconds;
+        if (cc.max_age) return *cc.max_age;
+
+        auto date = parse_http_date(response.get_header("Date"));
+        time_point date_value = date ? *date : response_time;
+
+        std::string expires_header = response.get_header("Expires");
+        if (!expires_header.empty()) {
+            auto expires = parse_http_date(expires_header);
+            if (!expires || *expires <= date_value) return seconds(0);
+            return std::chrono::duration_cast<seconds>(*expires - date_value);
+        }
+
+        if (heuristically_cacheable(response.status_code())) {
+            auto last_modified = parse_http_date(response.get_header("Last-Modified"));
+            if (last_modified && *last_modified < date_value) {
+                auto lifetime = std::chrono::duration_cast<seconds>(date_value - *last_modified) / 10;
+                return std::min(lifetime, max_heuristic_lifetime);
+            }
+        }
+        return seconds(0);
+    }
+
+    // RFC 9111 section 4.2.3
+    static std::chrono::seconds initial_age(const HttpResponse& response,
+                                            time_point request_time, time_point response_time) {
+        using std::chrono::seconds;
+        seconds apparent_age{0};
+        if (auto date = parse_http_date(response.get_header("Date"))) {
+            apparent_age = std::max(seconds(0), std::chrono::duration_cast<seconds>(response_time - *date));
+        }
+        seconds age_value = detail::parse_delta_seconds(response.get_header("Age")).value_or(seconds(0));
+        seconds response_delay = std::max(seconds(0),
+            std::chrono::duration_cast<seconds>(response_time - request_time));
+        return std::max(apparent_age, age_value + response_delay);
+    }
+
+    static Freshness freshness_of(const CacheEntry& entry, const HttpRequest& request, time_point now) {
+        CacheControl request_cc = parse_cache_control(detail::find_request_header(request, "Cache-Control"));
+        if (entry.cache_control.no_cache || request_cc.no_cache) return Freshness::Stale;
+
+        auto age = entry.current_age(now);
+        auto lifetime = entry.freshness_lifetime;
+        if (request_cc.max_age) lifetime = std::min(lifetime, *request_cc.max_age);
+
+        if (age < lifetime) return Freshness::Fresh;
+        if (entry.cache_control.stale_while_revalidate && !entry.cache_control.must_revalidate &&
+            age < lifetime + *entry.cache_control.stale_while_revalidate) {
+            return Freshness::StaleWhileRevalidate;
+        }
+        return Freshness::Stale;
+    }
+
+    static bool has_header_ci(const HttpResponse& response, const std::string& name) {
+        std::string lower = detail::lower_copy(name);
+        for (const auto& [key, value] : response.headers()) {
+            if (detail::lower_copy(key) == lower) return true;
+        }
+        return false;
+    }
+
+    // Headers a 304 must not overwrite (RFC 9111 section 3.2)
+    static bool is_unupdatable_header(const std::string& name) {
+        std::string lower = detail::lower_copy(name);
+        return lower == "content-length" || lower == "content-encoding" ||
+               lower == "transfer-encoding" || lower == "content-range";
+    }
+
+    static size_t entry_size(const CacheEntry& entry, const std::string& key) {
+        size_t size = sizeof(CacheEntry) + key.size() * 2 + entry.response.body().size();
+        for (const auto& [name, value] : entry.response.headers()) {
+            size += name.size() + value.size() + 64;  // map node overhead
+        }
+        return size;
+    }
+
+    // `key` may refer to the entry's own key, so it is not used after the erase
+    void erase_locked(Shard& shard, const std::string& key) {
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) return;
+
+        std::string url = key.substr(0, key.find('\n'));
+        auto variants = shard.variants.find(url);
+        if (variants != shard.variants.end()) {
+            auto& keys = variants->second.keys;
+            keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+            if (keys.empty()) shard.variants.erase(variants);
+        }
+
+        shard.bytes -= it->second->second->size;
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+
+    size_t shard_budget_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::shared_ptr<DiskCache> disk_;
+    std::mutex disk_mutex_;   // Serializes updates to the variant lists on disk
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> misses_{0};
+    std::atomic<size_t> revalidations_{0};
+    std::atomic<size_t> stores_{0};
+    std::atomic<size_t> evictions_{0};
+};
+
+}
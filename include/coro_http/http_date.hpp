@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace coro_http {
+
+namespace detail {
+
+// Days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's
+// days_from_civil), so no platform timegm/_mkgmtime is needed.
+inline int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+inline bool is_date_delimiter(char c) {
+    return c == '\t' || (c >= 0x20 && c <= 0x2F) || (c >= 0x3B && c <= 0x40) ||
+           (c >= 0x5B && c <= 0x60) || (c >= 0x7B && c <= 0x7E);
+}
+
+// Leading run of 1..max_digits digits, or -1
+inline int parse_digits(std::string_view token, size_t min_digits, size_t max_digits, size_t& used) {
+    used = 0;
+    int value = 0;
+    while (used < token.size() && used < max_digits && token[used] >= '0' && token[used] <= '9') {
+        value = value * 10 + (token[used] - '0');
+        ++used;
+    }
+    return used >= min_digits ? value : -1;
+}
+
+}
+
+// Parse an HTTP date (IMF-fixdate, RFC 850 or asctime) or a cookie Expires
+// value. Uses the tolerant token scan of RFC 6265 section 5.1.1, which
+// accepts all three HTTP formats. Returns nullopt when no valid date is found.
+inline std::optional<std::chrono::system_clock::time_point> parse_http_date(std::string_view text) {
+    int hour = -1, minute = -1, second = -1;
+    int day = -1, month = -1, year = -1;
+
+    static constexpr const char* months[] = {
+        "jan", "feb", "mar", "apr", "may", "jun", "jul", "aug", "sep", "oct", "nov", "dec"};
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        while (pos < text.size() && detail::is_date_delimiter(text[pos])) ++pos;
+        size_t end = pos;
+        while (end < text.size() && !detail::is_date_delimiter(text[end])) ++end;
+        std::string_view token = text.substr(pos, end - pos);
+        pos = end;
+        if (token.empty()) continue;
+
+        size_t used = 0;
+        if (hour < 0) {
+            // hms-time = 1*2DIGIT ":" 1*2DIGIT ":" 1*2DIGIT
+            int h = detail::parse_digits(token, 1, 2, used);
+            if (h >= 0 && used < token.size() && token[used] == ':') {
+                std::string_view rest = token.substr(used + 1);
+                int m = detail::parse_digits(rest, 1, 2, used);
+                if (m >= 0 && used < rest.size() && rest[used] == ':') {
+                    rest = rest.substr(used + 1);
+                    int s = detail::parse_digits(rest, 1, 2, used);
+                    if (s >= 0) {
+                        hour = h; minute = m; second = s;
+                        continue;
+                    }
+                }
+            }
+        }
+        if (day < 0) {
+            int d = detail::parse_digits(token, 1, 2, used);
+            if (d >= 0 && (used == token.size() || token[used] < '0' || token[used] > '9')) {
+                day = d;
+                continue;
+            }
+        }
+        if (month < 0 && token.size() >= 3) {
+            bool found = false;
+            for (int i = 0; i < 12; ++i) {
+                bool match = true;
+                for (int j = 0; j < 3; ++j) {
+                    char c = token[j];
+                    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+                    if (c != months[i][j]) { match = false; break; }
+                }
+                if (match) { month = i + 1; found = true; break; }
+            }
+            if (found) continue;
+        }
+        if (year < 0) {
+            int y = detail::parse_digits(token, 2, 4, used);
+            if (y >= 0 && (used == token.size() || token[used] < '0' || token[used] > '9')) {
+                year = y;
+                continue;
+            }
+        }
+    }
+
+    if (year >= 70 && year <= 99) year += 1900;
+    else if (year >= 0 && year <= 69) year += 2000;
+
+    if (hour < 0 || day < 1 || day > 31 || month < 0 || year < 1601 ||
+        hour > 23 || minute > 59 || second > 59) {
+        return std::nullopt;
+    }
+
+    int64_t days = detail::days_from_civil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+    int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second;
+    return std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+}
+
+}
@@ -2,12 +2,14 @@
 
 #include "http_response.hpp"
 #include "chunked_decoder.hpp"
-#include "compression.hpp"
+#include "content_codec.hpp"
 #include <string>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <optional>
+#include <stdexcept>
 
 namespace coro_http {
 
@@ -17,9 +19,8 @@ inline bool strcasecmp_parser(const std::string& a, const char* b) {
         [](char ca, char cb) { return std::tolower(ca) == std::tolower(cb); });
 }
 
-inline HttpResponse parse_response(const std::string& response_data) {
-    HttpResponse response;
-    std::istringstream stream(response_data);
+// Parse the status line and header fields, leaving the stream at the body
+inline void parse_response_head(std::istream& stream, HttpResponse& response) {
     std::string line;
 
     if (std::getline(stream, line)) {
@@ -52,31 +53,74 @@ inline HttpResponse parse_response(const std::string& response_data) {
             response.add_header(key, value);
         }
     }
+}
 
-    std::string body;
-    std::string remaining((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
-    
+// Chunked framing applies only when chunked is the final transfer coding
+inline bool is_chunked_response(const HttpResponse& response) {
     std::string transfer_encoding = response.get_header("Transfer-Encoding");
     std::transform(transfer_encoding.begin(), transfer_encoding.end(), transfer_encoding.begin(), ::tolower);
-    
-    if (transfer_encoding.find("chunked") != std::string::npos) {
-        remaining = decode_chunked(remaining);
+    size_t last = transfer_encoding.find_last_not_of(" \t");
+    if (last == std::string::npos) return false;
+    size_t first = transfer_encoding.find_last_of(", \t", last);
+    first = (first == std::string::npos) ? 0 : first + 1;
+    return transfer_encoding.compare(first, last + 1 - first, "chunked") == 0;
+}
+
+// Body length declared by Content-Length; empty when the field is absent or
+// invalid, or when Transfer-Encoding is present and overrides it
+inline std::optional<size_t> response_content_length(const HttpResponse& response) {
+    if (!response.get_header("Transfer-Encoding").empty()) return std::nullopt;
+    std::string value = response.get_header("Content-Length");
+    if (value.empty() || !std::all_of(value.begin(), value.end(),
+                                      [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; })) {
+        return std::nullopt;
     }
-    
+    try {
+        return static_cast<size_t>(std::stoull(value));
+    } catch (const std::out_of_range&) {
+        return std::nullopt;
+    }
+}
+
+inline void set_decoded_body(HttpResponse& response, std::string body) {
     std::string content_encoding = response.get_header("Content-Encoding");
-    std::transform(content_encoding.begin(), content_encoding.end(), content_encoding.begin(), ::tolower);
+    if (!content_encoding.empty()) {
+        body = decode_content(std::move(body), content_encoding);
+    }
+    response.set_body(std::move(body));
+}
+
+inline HttpResponse parse_response(const std::string& response_data) {
+    HttpResponse response;
+    std::istringstream stream(response_data);
+    parse_response_head(stream, response);
+
+    std::string remaining((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
     
-    if (content_encoding == "gzip") {
-        remaining = decompress_gzip(remaining);
-    } else if (content_encoding == "deflate") {
-        remaining = decompress_deflate(remaining);
+    if (is_chunked_response(response)) {
+        remaining = decode_chunked(remaining);
     }
     
-    response.set_body(remaining);
+    set_decoded_body(response, std::move(remaining));
 
     return response;
 }
 
+// Response read off the wire with the transfer coding already removed:
+// `head` is the status line and headers, `body` the de-chunked payload.
+// `content_decoded` is set when the body was inflated while it was read.
+inline HttpResponse parse_response(const std::string& head, std::string body, bool content_decoded = false) {
+    HttpResponse response;
+    std::istringstream stream(head);
+    parse_response_head(stream, response);
+    if (content_decoded) {
+        response.set_body(std::move(body));
+    } else {
+        set_decoded_body(response, std::move(body));
+    }
+    return response;
+}
+
 inline std::string build_request(const HttpRequest& request, const UrlInfo& url_info, bool enable_compression = true, bool keep_alive = false) {
     std::ostringstream req;
     
@@ -96,7 +140,7 @@ inline std::string build_request(const HttpRequest& request, const UrlInfo& url_
     }
     
     if (enable_compression && !has_accept_encoding) {
-        req << "Accept-Encoding: gzip, deflate\r\n";
+        req << "Accept-Encoding: " << ContentCodecRegistry::instance().accept_encoding() << "\r\n";
     }
     
     if (!request.body().empty()) {
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <map>
+#include <optional>
 
 namespace coro_http {
 
@@ -25,21 +26,50 @@ public:
         return *this;
     }
 
+    HttpRequest& remove_header(const std::string& key) {
+        headers_.erase(key);
+        return *this;
+    }
+
     HttpRequest& set_body(const std::string& body) {
         body_ = body;
         return *this;
     }
 
+    HttpRequest& set_body(std::string&& body) {
+        body_ = std::move(body);
+        return *this;
+    }
+
+    // Send the contents of a file as the body, read when the request is
+    // sent rather than held in memory. Takes precedence over set_body() and
+    // is sent as-is, without request compression.
+    HttpRequest& set_body_file(const std::string& path) {
+        body_file_ = path;
+        return *this;
+    }
+
+    // Compress the body with the given Content-Encoding ("gzip", "zstd"),
+    // overriding the client and per-host settings. Empty disables it.
+    HttpRequest& set_body_compression(const std::string& encoding) {
+        body_compression_ = encoding;
+        return *this;
+    }
+
     HttpMethod method() const { return method_; }
     const std::string& url() const { return url_; }
     const std::map<std::string, std::string>& headers() const { return headers_; }
     const std::string& body() const { return body_; }
+    const std::string& body_file() const { return body_file_; }
+    const std::optional<std::string>& body_compression() const { return body_compression_; }
 
 private:
     HttpMethod method_;
     std::string url_;
     std::map<std::string, std::string> headers_;
     std::string body_;
+    std::string body_file_;
+    std::optional<std::string> body_compression_;
 };
 
 }
@@ -22,6 +22,7 @@ public:
         headers_[key] = value;
     }
     void set_body(const std::string& body) { body_ = body; }
+    void set_body(std::string&& body) { body_ = std::move(body); }
     void add_redirect(const std::string& url) { redirect_chain_.push_back(url); }
 
     int status_code() const { return status_code_; }
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <asio.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace coro_http {
+
+// Runs an action, typically closing a socket, once no progress has been
+// reported for the timeout, which makes pending operations on the socket
+// fail. touch() only stores a time; the timer is waited on once per timeout
+// period rather than re-armed for every read.
+//
+// Completion handlers hold shared state, so destroying the deadline while a
+// wait is queued is safe.
+class IdleDeadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    IdleDeadline(asio::io_context& io_context, std::chrono::milliseconds timeout, std::function<void()> on_expire)
+        : state_(std::make_shared<State>(io_context)) {
+        state_->on_expire = std::move(on_expire);
+        reset(timeout);
+    }
+
+    IdleDeadline(const IdleDeadline&) = delete;
+    IdleDeadline& operator=(const IdleDeadline&) = delete;
+
+    ~IdleDeadline() {
+        state_->active = false;
+        state_->on_expire = nullptr;
+        state_->timer.cancel();
+    }
+
+    // Start a new period with the given timeout, e.g. moving from the
+    // connect timeout to the idle timeout. A zero timeout disables it.
+    void reset(std::chrono::milliseconds timeout) {
+        state_->timeout = timeout;
+        state_->expired = false;
+        touch();
+        if (timeout.count() > 0) {
+            arm(state_, state_->last + timeout);  // Replaces any pending wait
+        } else {
+            state_->timer.cancel();
+        }
+    }
+
+    // Progress was made; the deadline moves to now + timeout
+    void touch() {
+        state_->last = Clock::now();
+    }
+
+    bool expired() const {
+        return state_->expired;
+    }
+
+private:
+    struct State {
+        explicit State(asio::io_context& io_context) : timer(io_context) {}
+        asio::steady_timer timer;
+        std::function<void()> on_expire;
+        std::chrono::milliseconds timeout{0};
+        Clock::time_point last;
+        bool active{true};
+        bool expired{false};
+    };
+
+    static void arm(const std::shared_ptr<State>& state, Clock::time_point at) {
+        state->timer.expires_at(at);
+        state->timer.async_wait([state](const asio::error_code& ec) {
+            if (ec || !state->active || state->timeout.count() <= 0) return;
+            auto due = state->last + state->timeout;
+            if (Clock::now() < due) {
+                arm(state, due);  // Progress since the wait began
+                return;
+            }
+            state->expired = true;
+            if (state->on_expire) state->on_expire();
+        });
+    }
+
+    std::shared_ptr<State> state_;
+};
+
+}
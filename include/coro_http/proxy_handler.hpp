@@ -1,6 +1,8 @@
 #pragma once
 
+#include "auth.hpp"
 #include <string>
+#include <sstream>
 #include <regex>
 #include <stdexcept>
 
@@ -52,6 +54,29 @@ inline ProxyInfo parse_proxy_url(const std::string& proxy_url) {
     return info;
 }
 
+// Identity of the route through a proxy, for keying pooled connections.
+// The user is part of it, so connections authenticated as one user are
+// never handed to requests made as another. Empty without a proxy.
+inline std::string proxy_route(const ProxyInfo& info) {
+    static const char* schemes[] = {"", "http", "https", "socks5"};
+    if (info.type == ProxyType::NONE) {
+        return "";
+    }
+    std::string route = std::string(schemes[static_cast<int>(info.type)]) + "://";
+    if (!info.username.empty()) {
+        route += info.username + "@";
+    }
+    return route + info.host + ":" + info.port;
+}
+
+// Proxy-Authorization value for Basic credentials, empty without a user
+inline std::string proxy_authorization(const std::string& username, const std::string& password) {
+    if (username.empty()) {
+        return "";
+    }
+    return "Basic " + base64_encode(username + ":" + password);
+}
+
 inline std::string build_connect_request(const std::string& host, const std::string& port, 
                                          const std::string& proxy_username = "", 
                                          const std::string& proxy_password = "") {
@@ -60,9 +85,7 @@ inline std::string build_connect_request(const std::string& host, const std::str
     req << "Host: " << host << ":" << port << "\r\n";
     
     if (!proxy_username.empty()) {
-        std::string credentials = proxy_username + ":" + proxy_password;
-        std::string encoded = "Basic " + credentials;
-        req << "Proxy-Authorization: " << encoded << "\r\n";
+        req << "Proxy-Authorization: " << proxy_authorization(proxy_username, proxy_password) << "\r\n";
     }
     
     req << "\r\n";
@@ -88,10 +111,16 @@ inline bool parse_connect_response(const std::string& response) {
     return false;
 }
 
-inline std::string build_socks5_handshake(bool use_auth) {
+// Greeting offering no auth, plus user/password when use_auth. With
+// auth_only, user/password is the single method offered, so the proxy's
+// choice is known before it answers.
+inline std::string build_socks5_handshake(bool use_auth, bool auth_only = false) {
     std::string handshake;
     handshake.push_back(0x05);
-    if (use_auth) {
+    if (use_auth && auth_only) {
+        handshake.push_back(0x01);
+        handshake.push_back(0x02);
+    } else if (use_auth) {
         handshake.push_back(0x02);
         handshake.push_back(0x00);
         handshake.push_back(0x02);
@@ -128,6 +157,32 @@ inline std::string build_socks5_connect(const std::string& host, const std::stri
     return request;
 }
 
+// Total length of a CONNECT reply, from its address type and the byte
+// after it (the length of a domain name). 0 for an unknown address type.
+inline size_t socks5_reply_length(unsigned char address_type, unsigned char first_address_byte) {
+    switch (address_type) {
+        case 0x01: return 4 + 4 + 2;
+        case 0x04: return 4 + 16 + 2;
+        case 0x03: return 4 + 1 + first_address_byte + 2;
+        default: return 0;
+    }
+}
+
+// Reason for a failed CONNECT reply (RFC 1928, section 6)
+inline std::string socks5_reply_error(unsigned char code) {
+    switch (code) {
+        case 0x01: return "general SOCKS server failure";
+        case 0x02: return "connection not allowed by ruleset";
+        case 0x03: return "network unreachable";
+        case 0x04: return "host unreachable";
+        case 0x05: return "connection refused";
+        case 0x06: return "TTL expired";
+        case 0x07: return "command not supported";
+        case 0x08: return "address type not supported";
+        default: return "unknown error " + std::to_string(code);
+    }
+}
+
 inline bool parse_socks5_response(const std::string& response, size_t min_size = 2) {
     if (response.size() < min_size) return false;
     return response[1] == 0x00;
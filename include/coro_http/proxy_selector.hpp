@@ -0,0 +1,359 @@
+#pragma once
+
+#include "proxy_handler.hpp"
+#include <asio.hpp>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace coro_http {
+
+// Hosts that bypass the proxy, compiled from a NO_PROXY style list:
+// comma or space separated entries, each "*" (everything), a domain
+// ("example.com" or ".example.com", matching it and its subdomains), or an
+// IPv4/IPv6 address with an optional /prefix.
+//
+// Domains go into a trie keyed by label from the right, so a lookup costs
+// one step per label of the host, however many entries there are.
+class NoProxyMatcher {
+public:
+    NoProxyMatcher() = default;
+
+    explicit NoProxyMatcher(std::string_view list) {
+        size_t pos = 0;
+        while (pos < list.size()) {
+            size_t end = list.find_first_of(", \t", pos);
+            if (end == std::string_view::npos) end = list.size();
+            if (end > pos) add(list.substr(pos, end - pos));
+            pos = end + 1;
+        }
+    }
+
+    bool empty() const {
+        return !all_ && root_.children.empty() && networks_.empty();
+    }
+
+    bool matches(std::string_view host) const {
+        if (all_) return true;
+        if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+
+        asio::error_code ec;
+        auto address = asio::ip::make_address(std::string(host), ec);
+        if (!ec) {
+            auto bytes = address_bytes(address);
+            for (const auto& network : networks_) {
+                if (network.v6 == address.is_v6() && in_network(bytes, network)) return true;
+            }
+            return false;
+        }
+
+        const Node* node = &root_;
+        size_t end = host.size();
+        if (end > 0 && host[end - 1] == '.') --end;  // Fully qualified form
+        while (true) {
+            size_t dot = host.rfind('.', end == 0 ? 0 : end - 1);
+            size_t start = dot == std::string_view::npos || dot >= end ? 0 : dot + 1;
+            auto it = node->children.find(lower(host.substr(start, end - start)));
+            if (it == node->children.end()) return false;
+            node = it->second.get();
+            if (node->terminal) return true;
+            if (start == 0) return false;
+            end = start - 1;
+        }
+    }
+
+private:
+    struct Node {
+        std::map<std::string, std::unique_ptr<Node>, std::less<>> children;
+        bool terminal{false};
+    };
+
+    struct Network {
+        std::array<unsigned char, 16> bytes{};
+        int prefix{0};
+        bool v6{false};
+    };
+
+    static std::string lower(std::string_view text) {
+        std::string result(text);
+        std::transform(result.begin(), result.end(), result.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return result;
+    }
+
+    static std::array<unsigned char, 16> address_bytes(const asio::ip::address& address) {
+        std::array<unsigned char, 16> bytes{};
+        if (address.is_v6()) {
+            auto v6 = address.to_v6().to_bytes();
+            std::copy(v6.begin(), v6.end(), bytes.begin());
+        } else {
+            auto v4 = address.to_v4().to_bytes();
+            std::copy(v4.begin(), v4.end(), bytes.begin());
+        }
+        return bytes;
+    }
+
+    static bool in_network(const std::array<unsigned char, 16>& bytes, const Network& network) {
+        int bits = network.prefix;
+        for (size_t i = 0; bits > 0; ++i, bits -= 8) {
+            unsigned char mask = bits >= 8 ? 0xff : static_cast<unsigned char>(0xff << (8 - bits));
+            if ((bytes[i] & mask) != (network.bytes[i] & mask)) return false;
+        }
+        return true;
+    }
+
+    void add(std::string_view entry) {
+        if (entry == "*") {
+            all_ = true;
+            return;
+        }
+
+        std::string_view address_part = entry;
+        int prefix = -1;
+        size_t slash = entry.find('/');
+        if (slash != std::string_view::npos) {
+            address_part = entry.substr(0, slash);
+            try {
+                prefix = std::stoi(std::string(entry.substr(slash + 1)));
+            } catch (const std::exception&) {
+                return;
+            }
+        }
+        if (address_part.size() > 2 && address_part.front() == '[' && address_part.back() == ']') {
+            address_part = address_part.substr(1, address_part.size() - 2);
+        }
+        asio::error_code ec;
+        auto address = asio::ip::make_address(std::string(address_part), ec);
+        if (!ec) {
+            Network network;
+            network.bytes = address_bytes(address);
+            network.v6 = address.is_v6();
+            int max_prefix = network.v6 ? 128 : 32;
+            network.prefix = prefix < 0 || prefix > max_prefix ? max_prefix : prefix;
+            networks_.push_back(network);
+            return;
+        }
+
+        std::string domain = lower(entry);
+        if (domain.rfind("*.", 0) == 0) domain.erase(0, 2);
+        while (!domain.empty() && domain.front() == '.') domain.erase(0, 1);
+        while (!domain.empty() && domain.back() == '.') domain.pop_back();
+        if (domain.empty()) return;
+
+        Node* node = &root_;
+        size_t end = domain.size();
+        while (true) {
+            size_t dot = domain.rfind('.', end - 1);
+            size_t start = dot == std::string::npos ? 0 : dot + 1;
+            auto& child = node->children[domain.substr(start, end - start)];
+            if (!child) child = std::make_unique<Node>();
+            node = child.get();
+            if (start == 0) break;
+            end = start - 1;
+        }
+        node->terminal = true;
+    }
+
+    Node root_;
+    std::vector<Network> networks_;
+    bool all_{false};
+};
+
+// One proxy of a ProxySelector. `key` is its proxy_route(), part of the
+// pool key of every connection made through it.
+struct ProxyRoute {
+    ProxyInfo info;
+    std::string key;
+    unsigned weight{1};
+};
+
+// Picks the proxy for each request from a weighted set.
+//
+// Selection is power of two choices: two distinct healthy proxies are drawn
+// with probability proportional to their weight, and the one with the lower
+// (in-flight + 1) x latency / weight wins, where latency is a moving average
+// of request times through the proxy. Load spreads by weight without every
+// client piling onto the single least-loaded proxy.
+//
+// A proxy that fails max_failures requests in a row is ejected. Once
+// probe_interval has passed, take_due_probe() hands it out for a health
+// probe, run by the caller in the background; a successful probe puts it
+// back. If every proxy is ejected, all of them are candidates again, since
+// trying a suspect proxy beats failing outright.
+//
+// Thread-safe; routes live as long as the selector.
+class ProxySelector {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        std::string key;
+        unsigned weight{1};
+        size_t in_flight{0};
+        size_t requests{0};
+        size_t failures{0};            // In total
+        double latency_ms{0};          // Moving average
+        bool ejected{false};
+    };
+
+    ProxySelector(std::vector<ProxyRoute> routes, NoProxyMatcher bypass, int max_failures,
+                  std::chrono::milliseconds probe_interval)
+        : bypass_(std::move(bypass)),
+          max_failures_(std::max(1, max_failures)),
+          probe_interval_(probe_interval),
+          random_(std::random_device{}()) {
+        for (auto& route : routes) {
+            route.weight = std::max(1u, route.weight);
+            states_.push_back(std::make_unique<State>(std::move(route)));
+        }
+    }
+
+    bool empty() const {
+        return states_.empty();
+    }
+
+    // Proxy for a request to `host`, or nullptr to connect directly. Every
+    // proxy returned must be handed back to release().
+    const ProxyRoute* acquire(std::string_view host) {
+        if (states_.empty() || bypass_.matches(host)) return nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<State*> candidates;
+        for (auto& state : states_) {
+            if (!state->ejected) candidates.push_back(state.get());
+        }
+        if (candidates.empty()) {
+            for (auto& state : states_) candidates.push_back(state.get());
+        }
+
+        State* chosen = pick(candidates);
+        if (candidates.size() > 1) {
+            State* other = pick(candidates, chosen);
+            if (score(*other) < score(*chosen)) chosen = other;
+        }
+        ++chosen->in_flight;
+        return &chosen->route;
+    }
+
+    // Report how a request through `route` went. A failure is a transport
+    // error (connect, proxy handshake, I/O), not an HTTP error status. A
+    // zero elapsed time leaves the latency average alone.
+    void release(const ProxyRoute* route, bool ok, std::chrono::nanoseconds elapsed) {
+        if (!route) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        State& state = state_of(route);
+        if (state.in_flight > 0) --state.in_flight;
+        ++state.requests;
+        if (ok && elapsed.count() > 0) {
+            double ms = std::chrono::duration<double, std::milli>(elapsed).count();
+            state.latency_ms = state.latency_ms == 0 ? ms : state.latency_ms * 0.8 + ms * 0.2;
+        }
+        if (ok) {
+            state.consecutive_failures = 0;
+            return;
+        }
+        ++state.failures;
+        if (++state.consecutive_failures >= max_failures_ && !state.ejected) {
+            state.ejected = true;
+            state.next_probe = Clock::now() + probe_interval_;
+        }
+    }
+
+    // An ejected proxy whose health probe is due, marked as being probed,
+    // or nullptr. Report the outcome with probe_result().
+    const ProxyRoute* take_due_probe() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = Clock::now();
+        for (auto& state : states_) {
+            if (state->ejected && !state->probing && now >= state->next_probe) {
+                state->probing = true;
+                return &state->route;
+            }
+        }
+        return nullptr;
+    }
+
+    void probe_result(const ProxyRoute* route, bool healthy) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        State& state = state_of(route);
+        state.probing = false;
+        if (healthy) {
+            state.ejected = false;
+            state.consecutive_failures = 0;
+        } else {
+            state.next_probe = Clock::now() + probe_interval_;
+        }
+    }
+
+    std::vector<Stats> stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<Stats> result;
+        for (const auto& state : states_) {
+            result.push_back({state->route.key, state->route.weight, state->in_flight, state->requests,
+                              state->failures, state->latency_ms, state->ejected});
+        }
+        return result;
+    }
+
+private:
+    struct State {
+        explicit State(ProxyRoute r) : route(std::move(r)) {}
+        ProxyRoute route;
+        size_t in_flight{0};
+        size_t requests{0};
+        size_t failures{0};
+        int consecutive_failures{0};
+        double latency_ms{0};
+        bool ejected{false};
+        bool probing{false};
+        Clock::time_point next_probe;
+    };
+
+    // Route pointers handed out point into State, which is never moved
+    State& state_of(const ProxyRoute* route) {
+        for (auto& state : states_) {
+            if (&state->route == route) return *state;
+        }
+        throw std::invalid_argument("Proxy route not from this selector");
+    }
+
+    // Weighted draw from candidates, skipping `exclude`
+    State* pick(const std::vector<State*>& candidates, State* exclude = nullptr) {
+        unsigned total = 0;
+        for (State* state : candidates) {
+            if (state != exclude) total += state->route.weight;
+        }
+        unsigned target = std::uniform_int_distribution<unsigned>(0, total - 1)(random_);
+        for (State* state : candidates) {
+            if (state == exclude) continue;
+            if (target < state->route.weight) return state;
+            target -= state->route.weight;
+        }
+        return candidates.back();
+    }
+
+    // Unmeasured proxies count as 1 ms, so they get tried
+    static double score(const State& state) {
+        return (state.in_flight + 1) * std::max(state.latency_ms, 1.0) / state.route.weight;
+    }
+
+    std::vector<std::unique_ptr<State>> states_;
+    NoProxyMatcher bypass_;
+    int max_failures_;
+    std::chrono::milliseconds probe_interval_;
+    std::minstd_rand random_;
+    mutable std::mutex mutex_;
+};
+
+}
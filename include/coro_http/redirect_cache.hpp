@@ -0,0 +1,92 @@
+#pragma once
+
+#include "http_cache.hpp"
+#include "http_response.hpp"
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace coro_http {
+
+// Permanent redirects (301 and 308) seen so far, so later requests for a
+// moved URL go straight to its new location. Entries live until evicted,
+// least recently used first, unless the redirect carried Cache-Control:
+// max-age, which bounds them; no-store keeps a redirect out entirely.
+class RedirectCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Target {
+        std::string url;
+        bool preserve_method{false};  // 308; a 301 turns POST into GET
+    };
+
+    explicit RedirectCache(size_t capacity) : capacity_(capacity) {}
+
+    RedirectCache(const RedirectCache&) = delete;
+    RedirectCache& operator=(const RedirectCache&) = delete;
+
+    // Remember where `from` redirected to, if the response is a permanent
+    // redirect that may be cached
+    void store(const std::string& from, const std::string& to, const HttpResponse& response) {
+        int status = response.status_code();
+        if ((status != 301 && status != 308) || capacity_ == 0 || from == to) return;
+        CacheControl cc = parse_cache_control(response.get_header("Cache-Control"));
+        if (cc.no_store) return;
+        auto expires = cc.max_age ? Clock::now() + *cc.max_age : Clock::time_point::max();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(from);
+        if (it != entries_.end()) {
+            order_.erase(it->second.position);
+            entries_.erase(it);
+        }
+        order_.push_front(from);
+        entries_.emplace(from, Entry{{to, status == 308}, expires, order_.begin()});
+        while (entries_.size() > capacity_) {
+            entries_.erase(order_.back());
+            order_.pop_back();
+        }
+    }
+
+    std::optional<Target> lookup(const std::string& url) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(url);
+        if (it == entries_.end()) return std::nullopt;
+        if (it->second.expires <= Clock::now()) {
+            order_.erase(it->second.position);
+            entries_.erase(it);
+            return std::nullopt;
+        }
+        order_.splice(order_.begin(), order_, it->second.position);
+        return it->second.target;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        order_.clear();
+    }
+
+private:
+    struct Entry {
+        Target target;
+        Clock::time_point expires;
+        std::list<std::string>::iterator position;
+    };
+
+    size_t capacity_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> order_;  // Most recently used first
+    mutable std::mutex mutex_;
+};
+
+}
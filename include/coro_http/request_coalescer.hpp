@@ -0,0 +1,181 @@
+#pragma once
+
+#include "http_request.hpp"
+#include "http_response.hpp"
+#include "url_parser.hpp"
+#include <asio.hpp>
+#include <asio/use_awaitable.hpp>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace coro_http {
+
+// Single-flight for identical concurrent requests.
+// The first caller for a key performs the fetch; callers arriving while it
+// is in flight wait for it and receive the same refcounted response. A
+// waiter detaches after max_wait and fetches on its own, and a waiter whose
+// own wait is cancelled leaves without disturbing the others. If the leader
+// is cancelled, its waiters fall back to their own fetch; any other leader
+// failure is delivered to every waiter.
+//
+// The flight table is locked, and a finished fetch wakes each waiter by
+// posting to the waiter's own executor, so callers may run on different
+// threads or io_contexts.
+class RequestCoalescer {
+public:
+    using Response = std::shared_ptr<const HttpResponse>;
+    using Fetch = std::function<asio::awaitable<HttpResponse>(HttpRequest)>;
+
+    struct Stats {
+        size_t fetches{0};    // requests that went to the next layer
+        size_t joined{0};     // requests served by another caller's fetch
+        size_t detached{0};   // waiters that gave up and fetched alone
+    };
+
+    explicit RequestCoalescer(std::chrono::milliseconds max_wait = std::chrono::seconds(30))
+        : max_wait_(max_wait) {}
+
+    RequestCoalescer(const RequestCoalescer&) = delete;
+    RequestCoalescer& operator=(const RequestCoalescer&) = delete;
+
+    // Requests coalesce when method, URL and every header match, which
+    // covers whatever the response may later name in Vary. Bodies are not
+    // compared; only bodiless requests should be coalesced.
+    static std::string key_for(const HttpRequest& request) {
+        std::string key = method_to_string(request.method());
+        key += ' ';
+        key += request.url();
+        for (const auto& [name, value] : request.headers()) {
+            key += '\n';
+            key += name;
+            key += ':';
+            key += value;
+        }
+        return key;
+    }
+
+    asio::awaitable<Response> co_execute(HttpRequest request, Fetch fetch) {
+        std::string key = key_for(request);
+        auto executor = co_await asio::this_coro::executor;
+        std::shared_ptr<Flight> flight;
+        std::shared_ptr<asio::steady_timer> timer;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = flights_.find(key);
+            if (it == flights_.end()) {
+                flight = std::make_shared<Flight>();
+                flights_.emplace(key, flight);
+                ++stats_.fetches;
+            } else {
+                flight = it->second;
+                timer = std::make_shared<asio::steady_timer>(executor, max_wait_);
+                flight->waiters.push_back(timer);
+            }
+        }
+        if (!timer) {
+            co_return co_await co_lead(std::move(key), std::move(flight), std::move(request), std::move(fetch));
+        }
+
+        auto [ec] = co_await timer->async_wait(asio::as_tuple(asio::use_awaitable));
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (flight->done) {
+                if (!flight->error) {
+                    ++stats_.joined;
+                    co_return flight->response;
+                }
+                if (!is_cancellation(flight->error)) {
+                    std::rethrow_exception(flight->error);
+                }
+            } else {
+                auto& waiters = flight->waiters;
+                waiters.erase(std::remove(waiters.begin(), waiters.end(), timer), waiters.end());
+                if (ec == asio::error::operation_aborted) {
+                    throw asio::system_error(ec);  // This waiter was cancelled
+                }
+            }
+
+            // Timed out, or the leader was cancelled: fetch alone
+            ++stats_.detached;
+            ++stats_.fetches;
+        }
+        co_return std::make_shared<const HttpResponse>(co_await fetch(std::move(request)));
+    }
+
+    // Number of distinct requests currently in flight
+    size_t in_flight() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return flights_.size();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    // Written by the leader before `done` is set under the lock
+    struct Flight {
+        Response response;
+        std::exception_ptr error;
+        bool done{false};
+        std::vector<std::shared_ptr<asio::steady_timer>> waiters;
+    };
+
+    asio::awaitable<Response> co_lead(std::string key, std::shared_ptr<Flight> flight,
+                                      HttpRequest request, Fetch fetch) {
+        try {
+            flight->response = std::make_shared<const HttpResponse>(co_await fetch(std::move(request)));
+        } catch (...) {
+            flight->error = std::current_exception();
+        }
+
+        std::vector<std::shared_ptr<asio::steady_timer>> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            flight->done = true;
+            auto it = flights_.find(key);
+            if (it != flights_.end() && it->second == flight) {
+                flights_.erase(it);
+            }
+            waiters.swap(flight->waiters);
+        }
+        // An expiry in the past completes both pending and not-yet-started
+        // waits. Timers are only touched from their own executor.
+        for (auto& waiter : waiters) {
+            asio::post(waiter->get_executor(), [waiter] {
+                waiter->expires_at(asio::steady_timer::time_point::min());
+            });
+        }
+
+        if (flight->error) {
+            std::rethrow_exception(flight->error);
+        }
+        co_return flight->response;
+    }
+
+    static bool is_cancellation(const std::exception_ptr& error) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const asio::system_error& e) {
+            return e.code() == asio::error::operation_aborted;
+        } catch (...) {
+            return false;
+        }
+    }
+
+    std::chrono::milliseconds max_wait_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> flights_;
+    Stats stats_;
+};
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <asio.hpp>
+#if !defined(_WIN32)
+#include <netinet/tcp.h>
+#endif
+#include <chrono>
+#include <cstddef>
+
+namespace coro_http {
+
+// Socket-level tuning for the connections a client opens. Zero leaves the
+// system default in place.
+struct SocketOptions {
+    bool tcp_nodelay{true};            // Disable Nagle, so a head and body written apart are not held back
+    int send_buffer{0};                // SO_SNDBUF bytes
+    int receive_buffer{0};             // SO_RCVBUF bytes; set before connect so the window scale fits
+    bool keepalive{false};             // SO_KEEPALIVE, to notice dead pooled peers
+    std::chrono::seconds keepalive_idle{0};      // TCP_KEEPIDLE (TCP_KEEPALIVE on macOS): silence before the first probe
+    std::chrono::seconds keepalive_interval{0};  // TCP_KEEPINTVL: between probes
+    int keepalive_count{0};            // TCP_KEEPCNT: unanswered probes before the peer is dead
+    bool fast_open{false};             // TCP_FASTOPEN_CONNECT: first write rides on the SYN
+    int busy_poll_us{0};               // SO_BUSY_POLL: spin on the device queue before sleeping
+    std::chrono::milliseconds user_timeout{0};   // TCP_USER_TIMEOUT: unacknowledged data before the connection drops
+};
+
+namespace detail {
+
+// An int-valued option in the form asio's set_option() takes, for the
+// platform-specific options asio has no type for
+template<int Level, int Name>
+class int_option {
+public:
+    explicit int_option(int value) : value_(value) {}
+
+    template<typename Protocol> int level(const Protocol&) const { return Level; }
+    template<typename Protocol> int name(const Protocol&) const { return Name; }
+    template<typename Protocol> const int* data(const Protocol&) const { return &value_; }
+    template<typename Protocol> std::size_t size(const Protocol&) const { return sizeof(value_); }
+
+private:
+    int value_;
+};
+
+#if defined(TCP_KEEPIDLE)
+inline constexpr int tcp_keepidle = TCP_KEEPIDLE;
+#elif defined(TCP_KEEPALIVE)
+inline constexpr int tcp_keepidle = TCP_KEEPALIVE;  // The same option on macOS
+#endif
+
+// Tuning is best effort: a kernel without the option, or a busy-poll value
+// above what an unprivileged process may set, keeps the default
+template<typename Option>
+inline void set_option(asio::ip::tcp::socket& socket, const Option& option) {
+    asio::error_code ignored;
+    socket.set_option(option, ignored);
+}
+
+}
+
+// Apply options to an open, unconnected socket. Options that only matter
+// for the handshake (buffer sizes, fast open) must be in place before connect.
+// The keepalive timings and the rest below them exist on some platforms only.
+inline void apply_socket_options(asio::ip::tcp::socket& socket, const SocketOptions& options) {
+    if (options.tcp_nodelay) detail::set_option(socket, asio::ip::tcp::no_delay(true));
+    if (options.send_buffer > 0) detail::set_option(socket, asio::socket_base::send_buffer_size(options.send_buffer));
+    if (options.receive_buffer > 0) {
+        detail::set_option(socket, asio::socket_base::receive_buffer_size(options.receive_buffer));
+    }
+    if (options.keepalive) {
+        detail::set_option(socket, asio::socket_base::keep_alive(true));
+#if defined(TCP_KEEPIDLE) || defined(TCP_KEEPALIVE)
+        if (options.keepalive_idle.count() > 0) {
+            detail::set_option(socket, detail::int_option<IPPROTO_TCP, detail::tcp_keepidle>(
+                static_cast<int>(options.keepalive_idle.count())));
+        }
+#endif
+#if defined(TCP_KEEPINTVL)
+        if (options.keepalive_interval.count() > 0) {
+            detail::set_option(socket, detail::int_option<IPPROTO_TCP, TCP_KEEPINTVL>(
+                static_cast<int>(options.keepalive_interval.count())));
+        }
+#endif
+#if defined(TCP_KEEPCNT)
+        if (options.keepalive_count > 0) {
+            detail::set_option(socket, detail::int_option<IPPROTO_TCP, TCP_KEEPCNT>(options.keepalive_count));
+        }
+#endif
+    }
+#if defined(TCP_FASTOPEN_CONNECT)
+    if (options.fast_open) detail::set_option(socket, detail::int_option<IPPROTO_TCP, TCP_FASTOPEN_CONNECT>(1));
+#endif
+#if defined(SO_BUSY_POLL)
+    if (options.busy_poll_us > 0) {
+        detail::set_option(socket, detail::int_option<SOL_SOCKET, SO_BUSY_POLL>(options.busy_poll_us));
+    }
+#endif
+#if defined(TCP_USER_TIMEOUT)
+    if (options.user_timeout.count() > 0) {
+        detail::set_option(socket, detail::int_option<IPPROTO_TCP, TCP_USER_TIMEOUT>(
+            static_cast<int>(options.user_timeout.count())));
+    }
+#endif
+}
+
+}
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <map>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 
 namespace coro_http {
@@ -29,94 +32,210 @@ struct SseEvent {
     }
 };
 
-// Parse SSE format stream line by line
-// Returns parsed events as they come in
-inline std::vector<SseEvent> parse_sse_stream(const std::string& stream_data) {
-    std::vector<SseEvent> events;
-    std::istringstream stream(stream_data);
-    std::string line;
-    
-    SseEvent current_event;
-    std::vector<std::string> data_lines;
+// Incremental SSE parser for data arriving in arbitrary pieces.
+// Complete lines are parsed in place from the fed data; only a line split
+// across feeds is carried over, in a buffer bounded by max_event_size.
+// Each byte is looked at a constant number of times, however many lines a
+// piece holds. Events are built in one reused SseEvent, so a steady stream
+// of small events does not allocate once its strings have grown.
+//
+// Lines may end in CRLF, LF or CR, also when the CR and LF arrive in
+// different pieces, and a leading UTF-8 BOM is skipped. As the callback API
+// always has, events that carry only an event type or id are delivered
+// too; the specification drops them.
+class SseParser {
+public:
+    explicit SseParser(size_t max_event_size = 8 * 1024 * 1024)
+        : max_event_size_(max_event_size) {}
 
-    while (std::getline(stream, line)) {
-        // Remove trailing \r if present
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
+    // Parse data, calling on_event(const SseEvent&) for each completed
+    // event. The event is only valid during the call.
+    template<typename F>
+    void feed(std::string_view data, F&& on_event) {
+        if (bom_state_ < 3) {
+            data = skip_bom(data);
+            if (data.empty()) return;
+        }
+        if (skip_lf_) {
+            skip_lf_ = false;
+            if (data[0] == '\n') data.remove_prefix(1);
         }
 
-        // Empty line indicates end of event
-        if (line.empty()) {
-            if (!data_lines.empty() || !current_event.type.empty() || 
-                !current_event.id.empty() || !current_event.retry.empty()) {
-                // Concatenate all data lines with newlines
-                for (size_t i = 0; i < data_lines.size(); ++i) {
-                    if (i > 0) current_event.data += "\n";
-                    current_event.data += data_lines[i];
-                }
-                
-                if (!current_event.empty()) {
-                    events.push_back(current_event);
-                }
-                
-                current_event = SseEvent{};
-                data_lines.clear();
+        size_t start = 0;
+        if (!carry_.empty()) {
+            size_t end = data.find_first_of("\r\n");
+            if (end == std::string_view::npos) {
+                append_carry(data);
+                return;
             }
-            continue;
+            append_carry(data.substr(0, end));
+            start = end_of_line(data, end);
+            process_line(carry_, on_event);
+            carry_.clear();
         }
 
-        // Line starting with : is a comment
-        if (line[0] == ':') {
-            continue;
+        while (start < data.size()) {
+            size_t end = data.find_first_of("\r\n", start);
+            if (end == std::string_view::npos) {
+                append_carry(data.substr(start));
+                return;
+            }
+            std::string_view line = data.substr(start, end - start);
+            start = end_of_line(data, end);
+            process_line(line, on_event);
         }
+    }
 
-        // Parse field: value
-        size_t colon_pos = line.find(':');
-        std::string field;
-        std::string value;
+    // Drop any partial line and event, e.g. before reconnecting; the last
+    // event id and retry interval are kept
+    void reset() {
+        carry_.clear();
+        clear_event();
+        skip_lf_ = false;
+        bom_state_ = 0;
+    }
 
-        if (colon_pos == std::string::npos) {
-            // Line with no colon
-            field = line;
-            value = "";
-        } else {
-            field = line.substr(0, colon_pos);
-            value = line.substr(colon_pos + 1);
-            
-            // Remove leading space if present
-            if (!value.empty() && value[0] == ' ') {
-                value = value.substr(1);
+    // Deliver an event still being built, for callers that treat the end
+    // of the stream as the end of the event
+    template<typename F>
+    void flush(F&& on_event) {
+        if (!carry_.empty()) {
+            std::string line = std::move(carry_);
+            carry_.clear();
+            process_line(line, on_event);
+        }
+        dispatch(on_event);
+    }
+
+    // Id of the most recent complete event block, to send as Last-Event-ID
+    const std::string& last_event_id() const {
+        return last_event_id_;
+    }
+
+    // Most recent valid retry field in milliseconds, or -1 if none was seen
+    long long retry_ms() const {
+        return retry_ms_;
+    }
+
+private:
+    std::string_view skip_bom(std::string_view data) {
+        static constexpr unsigned char bom[3] = {0xEF, 0xBB, 0xBF};
+        while (bom_state_ < 3 && !data.empty()) {
+            if (static_cast<unsigned char>(data[0]) != bom[bom_state_]) {
+                // Not a BOM after all: the bytes matched so far are content
+                std::string_view matched(reinterpret_cast<const char*>(bom), static_cast<size_t>(bom_state_));
+                bom_state_ = 3;
+                append_carry(matched);
+                return data;
             }
+            data.remove_prefix(1);
+            ++bom_state_;
         }
+        return data;
+    }
 
-        // Process field
-        if (field == "event") {
-            current_event.type = value;
-        } else if (field == "data") {
-            data_lines.push_back(value);
+    // Position after the line ending at end, noting a CR that may be
+    // followed by an LF in the next piece
+    size_t end_of_line(std::string_view data, size_t end) {
+        if (data[end] == '\r') {
+            if (end + 1 == data.size()) {
+                skip_lf_ = true;
+                return end + 1;
+            }
+            if (data[end + 1] == '\n') return end + 2;
+        }
+        return end + 1;
+    }
+
+    void append_carry(std::string_view data) {
+        if (carry_.size() + data.size() > max_event_size_) {
+            throw std::runtime_error("SSE line exceeds size limit");
+        }
+        carry_.append(data);
+    }
+
+    template<typename F>
+    void process_line(std::string_view line, F& on_event) {
+        if (line.empty()) {
+            dispatch(on_event);
+            return;
+        }
+        if (line[0] == ':') return;  // Comment
+
+        std::string_view field = line;
+        std::string_view value;
+        size_t colon = line.find(':');
+        if (colon != std::string_view::npos) {
+            field = line.substr(0, colon);
+            value = line.substr(colon + 1);
+            if (!value.empty() && value[0] == ' ') value.remove_prefix(1);
+        }
+
+        if (field == "data") {
+            if (has_data_) event_.data += '\n';
+            if (event_.data.size() + value.size() > max_event_size_) {
+                throw std::runtime_error("SSE event exceeds size limit");
+            }
+            event_.data.append(value);
+            has_data_ = true;
+        } else if (field == "event") {
+            event_.type.assign(value);
         } else if (field == "id") {
-            current_event.id = value;
+            if (value.find('\0') == std::string_view::npos) {
+                event_.id.assign(value);
+                has_id_ = true;
+            }
         } else if (field == "retry") {
-            current_event.retry = value;
+            event_.retry.assign(value);
+            if (!value.empty() && value.size() <= 15 &&
+                value.find_first_not_of("0123456789") == std::string_view::npos) {
+                retry_ms_ = std::stoll(std::string(value));
+            }
         } else {
-            // Unknown field - store it anyway
-            current_event.fields[field] = value;
+            event_.fields[std::string(field)] = std::string(value);
         }
     }
 
-    // Handle last event if stream doesn't end with blank line
-    if (!data_lines.empty() || !current_event.type.empty() || 
-        !current_event.id.empty() || !current_event.retry.empty()) {
-        for (size_t i = 0; i < data_lines.size(); ++i) {
-            if (i > 0) current_event.data += "\n";
-            current_event.data += data_lines[i];
-        }
-        
-        if (!current_event.empty()) {
-            events.push_back(current_event);
+    template<typename F>
+    void dispatch(F& on_event) {
+        // The id takes effect only once its event is complete
+        if (has_id_) last_event_id_ = event_.id;
+        if (has_data_ || !event_.type.empty() || !event_.id.empty()) {
+            on_event(static_cast<const SseEvent&>(event_));
         }
+        clear_event();
+    }
+
+    // Clears without giving up the strings' capacity
+    void clear_event() {
+        event_.type.clear();
+        event_.data.clear();
+        event_.id.clear();
+        event_.retry.clear();
+        if (!event_.fields.empty()) event_.fields.clear();
+        has_data_ = false;
+        has_id_ = false;
     }
 
+    size_t max_event_size_;
+    std::string carry_;         // Start of a line continued in the next piece
+    SseEvent event_;
+    bool has_data_{false};
+    bool has_id_{false};
+    bool skip_lf_{false};       // Previous piece ended in CR
+    int bom_state_{0};          // BOM bytes matched; 3 once past the start
+    std::string last_event_id_;
+    long long retry_ms_{-1};
+};
+
+// Parse a complete SSE stream. An event not terminated by a blank line at
+// the end of the stream is returned as well.
+inline std::vector<SseEvent> parse_sse_stream(const std::string& stream_data) {
+    std::vector<SseEvent> events;
+    SseParser parser(std::max<size_t>(stream_data.size(), 8 * 1024 * 1024));
+    auto collect = [&](const SseEvent& event) { events.push_back(event); };
+    parser.feed(stream_data, collect);
+    parser.flush(collect);
     return events;
 }
 
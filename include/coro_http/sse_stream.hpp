@@ -0,0 +1,217 @@
+#pragma once
+
+#include "sse_event.hpp"
+#include <asio.hpp>
+#include <asio/use_awaitable.hpp>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+namespace coro_http {
+
+// What an SseEventChannel does with an event that arrives while it is full
+enum class SseOverflowPolicy {
+    block,        // Stop reading the connection until the consumer catches up
+    drop_oldest,  // Discard the oldest queued event
+    coalesce      // Replace the newest queued event of the same type, else drop the oldest
+};
+
+struct SseChannelOptions {
+    size_t capacity{64};
+    SseOverflowPolicy overflow{SseOverflowPolicy::block};
+};
+
+// Bounded queue of events between the coroutine reading a stream and the
+// coroutine consuming it. With the block policy the reader finishes the
+// piece it is parsing, so the queue can briefly hold more than capacity
+// events, and then waits before reading the connection again.
+//
+// Like the rest of a client's per-request state, a channel assumes the
+// client's io_context is run from a single thread.
+class SseEventChannel {
+public:
+    struct Stats {
+        size_t pushed{0};     // events received from the stream
+        size_t dropped{0};    // events discarded by drop_oldest or coalesce
+        size_t coalesced{0};  // events merged into a queued one
+        size_t blocked{0};    // times the reader waited for the consumer
+    };
+
+    SseEventChannel(asio::any_io_executor executor, SseChannelOptions options = {})
+        : executor_(std::move(executor)), options_(options) {
+        if (options_.capacity == 0) options_.capacity = 1;
+    }
+
+    SseEventChannel(const SseEventChannel&) = delete;
+    SseEventChannel& operator=(const SseEventChannel&) = delete;
+
+    // Producer side
+
+    void push(const SseEvent& event) {
+        if (cancelled_) throw std::system_error(std::make_error_code(std::errc::operation_canceled));
+        ++stats_.pushed;
+        if (queue_.size() >= options_.capacity && options_.overflow != SseOverflowPolicy::block) {
+            if (options_.overflow == SseOverflowPolicy::coalesce) {
+                for (auto it = queue_.rbegin(); it != queue_.rend(); ++it) {
+                    if (it->type == event.type) {
+                        *it = event;
+                        ++stats_.coalesced;
+                        return;
+                    }
+                }
+            }
+            queue_.pop_front();
+            ++stats_.dropped;
+        }
+        queue_.push_back(event);
+        wake(reader_);
+    }
+
+    // Wait until the queue has room; only the block policy ever waits.
+    // Throws operation_canceled once the consumer has gone.
+    asio::awaitable<void> wait_writable() {
+        if (queue_.size() >= options_.capacity && !cancelled_) {
+            ++stats_.blocked;
+        }
+        while (queue_.size() >= options_.capacity && !cancelled_) {
+            co_await wait(writer_);
+        }
+        if (cancelled_) throw std::system_error(std::make_error_code(std::errc::operation_canceled));
+    }
+
+    // End of the stream. Queued events are still delivered, then next()
+    // throws the error if there is one, or returns nullopt.
+    void close(std::exception_ptr error = nullptr) {
+        closed_ = true;
+        error_ = std::move(error);
+        wake(reader_);
+    }
+
+    // The reader should wait before reading more
+    bool full() const {
+        return queue_.size() >= options_.capacity;
+    }
+
+    // True once the consumer has gone; the reader should stop
+    bool cancelled() const {
+        return cancelled_;
+    }
+
+    // Called on cancel(), so a reader blocked on the network can be woken,
+    // e.g. by closing its socket
+    void set_cancel_handler(std::function<void()> handler) {
+        cancel_handler_ = std::move(handler);
+    }
+
+    // Consumer side
+
+    asio::awaitable<std::optional<SseEvent>> next() {
+        while (queue_.empty() && !closed_ && !cancelled_) {
+            co_await wait(reader_);
+        }
+        if (!queue_.empty()) {
+            std::optional<SseEvent> event(std::move(queue_.front()));
+            queue_.pop_front();
+            if (queue_.size() < options_.capacity) wake(writer_);
+            co_return event;
+        }
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+        co_return std::nullopt;
+    }
+
+    // Stop the stream and discard queued events
+    void cancel() {
+        if (cancelled_) return;
+        cancelled_ = true;
+        queue_.clear();
+        wake(writer_);
+        wake(reader_);
+        if (auto handler = std::move(cancel_handler_)) handler();
+    }
+
+    size_t size() const {
+        return queue_.size();
+    }
+
+    bool closed() const {
+        return closed_;
+    }
+
+    Stats stats() const {
+        return stats_;
+    }
+
+private:
+    asio::awaitable<void> wait(asio::steady_timer*& slot) {
+        asio::steady_timer timer(executor_, asio::steady_timer::time_point::max());
+        slot = &timer;
+        co_await timer.async_wait(asio::as_tuple(asio::use_awaitable));
+        if (slot == &timer) slot = nullptr;
+    }
+
+    // An expiry in the past completes both pending and not-yet-started waits
+    static void wake(asio::steady_timer*& slot) {
+        if (slot) {
+            slot->expires_at(asio::steady_timer::time_point::min());
+            slot = nullptr;
+        }
+    }
+
+    asio::any_io_executor executor_;
+    SseChannelOptions options_;
+    std::deque<SseEvent> queue_;
+    asio::steady_timer* reader_{nullptr};
+    asio::steady_timer* writer_{nullptr};
+    std::function<void()> cancel_handler_;
+    std::exception_ptr error_;
+    bool closed_{false};
+    bool cancelled_{false};
+    Stats stats_;
+};
+
+// Consumer handle for a stream opened with CoroHttpClient::open_event_stream.
+// Destroying it stops the stream and closes its connection.
+class SseStream {
+public:
+    explicit SseStream(std::shared_ptr<SseEventChannel> channel)
+        : channel_(std::move(channel)) {}
+
+    SseStream(SseStream&&) noexcept = default;
+    SseStream& operator=(SseStream&& other) noexcept {
+        if (this != &other) {
+            close();
+            channel_ = std::move(other.channel_);
+        }
+        return *this;
+    }
+
+    ~SseStream() {
+        close();
+    }
+
+    // Next event, or nullopt once the stream has ended. Rethrows the error
+    // that ended the stream, after the events queued before it.
+    asio::awaitable<std::optional<SseEvent>> next() {
+        return channel_->next();
+    }
+
+    // Stop the stream; next() returns nullopt
+    void close() {
+        if (channel_) channel_->cancel();
+    }
+
+    SseEventChannel::Stats stats() const {
+        return channel_->stats();
+    }
+
+private:
+    std::shared_ptr<SseEventChannel> channel_;
+};
+
+}
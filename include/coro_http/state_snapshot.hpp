@@ -0,0 +1,509 @@
+#pragma once
+
+#include "cookie_jar.hpp"
+#include "dns_cache.hpp"
+#include "tls_session_cache.hpp"
+#include <zlib.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace coro_http {
+
+// Client state saved across restarts: cookies, resolved hosts and TLS
+// sessions, so a restarted client can skip DNS lookups and full handshakes.
+//
+// File layout (host byte order, everything 8-byte aligned):
+//   header   "CHSNAP\r\n", u32 version, u32 section count
+//   section  u32 type, u32 CRC32 of payload, u64 payload length, payload
+// A payload is a u32 record count followed by the records; strings are a
+// u32 length and the bytes, times are i64 milliseconds since the epoch.
+// Unknown section types are skipped, so older readers accept newer files
+// as long as the version is unchanged.
+//
+// Files are written to a temporary name, fsync'd and renamed into place,
+// so a reader sees either the previous snapshot or the new one. On POSIX,
+// loading maps the file and decodes straight from the mapping; elsewhere
+// the file is read into memory and not fsync'd when saved.
+struct StateSnapshot {
+    static constexpr uint32_t version = 1;
+
+    std::vector<Cookie> cookies;
+    std::vector<DnsCache::Entry> dns;
+    std::vector<TlsSessionCache::Entry> tls_sessions;
+
+    // Collect state from whichever of the sources are present
+    static StateSnapshot capture(const CookieJar* jar, const DnsCache* dns, const TlsSessionCache* tls) {
+        StateSnapshot snapshot;
+        if (jar) snapshot.cookies = jar->all_cookies();
+        if (dns) snapshot.dns = dns->entries();
+        if (tls) snapshot.tls_sessions = tls->entries();
+        return snapshot;
+    }
+
+    // Move the loaded state into whichever of the targets are present;
+    // expired entries are dropped on the way in
+    void restore(CookieJar* jar, DnsCache* dns_cache, TlsSessionCache* tls) {
+        if (jar) {
+            auto now = std::chrono::system_clock::now();
+            cookies.erase(std::remove_if(cookies.begin(), cookies.end(), [&](const Cookie& cookie) {
+                return cookie.is_expired(now);
+            }), cookies.end());
+            jar->add_cookies(std::move(cookies));
+        }
+        if (dns_cache) dns_cache->import(std::move(dns));
+        if (tls) tls->import(tls_sessions);
+    }
+
+    std::string serialize() const {
+        std::string out;
+        out.append(magic, sizeof(magic));
+        put_u32(out, version);
+        put_u32(out, 3);
+
+        section(out, SectionType::Cookies, [&](std::string& payload) {
+            put_u32(payload, static_cast<uint32_t>(cookies.size()));
+            for (const auto& cookie : cookies) {
+                put_string(payload, cookie.name);
+                put_string(payload, cookie.value);
+                put_string(payload, cookie.domain);
+                put_string(payload, cookie.path);
+                put_time(payload, cookie.expires);
+                put_u32(payload, (cookie.secure ? 1u : 0u) | (cookie.http_only ? 2u : 0u) |
+                                 (cookie.session ? 4u : 0u));
+            }
+        });
+        section(out, SectionType::Dns, [&](std::string& payload) {
+            put_u32(payload, static_cast<uint32_t>(dns.size()));
+            for (const auto& entry : dns) {
+                put_string(payload, entry.host);
+                put_string(payload, entry.port);
+                put_time(payload, entry.expires);
+                put_u32(payload, static_cast<uint32_t>(entry.endpoints.size()));
+                for (const auto& endpoint : entry.endpoints) {
+                    put_endpoint(payload, endpoint);
+                }
+            }
+        });
+        section(out, SectionType::TlsSessions, [&](std::string& payload) {
+            put_u32(payload, static_cast<uint32_t>(tls_sessions.size()));
+            for (const auto& entry : tls_sessions) {
+                put_string(payload, entry.key);
+                put_string(payload, entry.der);
+                put_time(payload, entry.expires);
+            }
+        });
+        return out;
+    }
+
+    // Throws std::runtime_error on a foreign, truncated or corrupt snapshot
+    static StateSnapshot parse(std::string_view data) {
+        if (data.size() < header_size || data.compare(0, sizeof(magic), std::string_view(magic, sizeof(magic))) != 0) {
+            throw std::runtime_error("Not a state snapshot");
+        }
+        Reader header{data.substr(sizeof(magic), header_size - sizeof(magic))};
+        if (header.u32() != version) {
+            throw std::runtime_error("Unsupported state snapshot version");
+        }
+        uint32_t sections = header.u32();
+
+        StateSnapshot snapshot;
+        size_t offset = header_size;
+        for (uint32_t i = 0; i < sections; ++i) {
+            if (data.size() - offset < section_header_size) {
+                throw std::runtime_error("Truncated state snapshot");
+            }
+            Reader section_header{data.substr(offset, section_header_size)};
+            uint32_t type = section_header.u32();
+            uint32_t checksum = section_header.u32();
+            uint64_t length = section_header.u64();
+            offset += section_header_size;
+            if (length > data.size() - offset) {
+                throw std::runtime_error("Truncated state snapshot");
+            }
+            std::string_view payload = data.substr(offset, static_cast<size_t>(length));
+            if (crc(payload) != checksum) {
+                throw std::runtime_error("State snapshot checksum mismatch");
+            }
+            offset += static_cast<size_t>(padded(length));
+            if (offset > data.size()) offset = data.size();
+
+            Reader reader{payload};
+            switch (static_cast<SectionType>(type)) {
+            case SectionType::Cookies:
+                snapshot.parse_cookies(reader);
+                break;
+            case SectionType::Dns:
+                snapshot.parse_dns(reader);
+                break;
+            case SectionType::TlsSessions:
+                snapshot.parse_tls_sessions(reader);
+                break;
+            default:
+                break;
+            }
+        }
+        return snapshot;
+    }
+
+    // Atomically replace the snapshot at path
+    void save(const std::string& path) const {
+        std::string data = serialize();
+        std::string temp = path + ".tmp";
+#if defined(_WIN32)
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!out.flush()) {
+                out.close();
+                std::filesystem::remove(temp);
+                throw std::runtime_error("State snapshot write failed");
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp);
+            throw std::system_error(ec, "State snapshot rename failed");
+        }
+#else
+        int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) throw_errno("Cannot create state snapshot");
+        size_t written = 0;
+        while (written < data.size()) {
+            ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                int error = errno;
+                ::close(fd);
+                ::unlink(temp.c_str());
+                throw std::system_error(error, std::generic_category(), "State snapshot write failed");
+            }
+            written += static_cast<size_t>(n);
+        }
+        if (::fsync(fd) != 0) {
+            int error = errno;
+            ::close(fd);
+            ::unlink(temp.c_str());
+            throw std::system_error(error, std::generic_category(), "State snapshot fsync failed");
+        }
+        ::close(fd);
+        if (::rename(temp.c_str(), path.c_str()) != 0) {
+            int error = errno;
+            ::unlink(temp.c_str());
+            throw std::system_error(error, std::generic_category(), "State snapshot rename failed");
+        }
+#endif
+    }
+
+    // Load the snapshot at path; nullopt if there is none
+    static std::optional<StateSnapshot> load(const std::string& path) {
+#if defined(_WIN32)
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            if (!std::filesystem::exists(path)) return std::nullopt;
+            throw std::runtime_error("Cannot open state snapshot");
+        }
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (data.empty()) throw std::runtime_error("Not a state snapshot");
+        return parse(data);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            if (errno == ENOENT) return std::nullopt;
+            throw_errno("Cannot open state snapshot");
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "Cannot stat state snapshot");
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        if (size == 0) {
+            ::close(fd);
+            throw std::runtime_error("Not a state snapshot");
+        }
+        void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) throw_errno("Cannot map state snapshot");
+
+        struct Unmap {
+            void* mapping;
+            size_t size;
+            ~Unmap() { ::munmap(mapping, size); }
+        } unmap{mapping, size};
+        return parse(std::string_view(static_cast<const char*>(mapping), size));
+#endif
+    }
+
+private:
+    enum class SectionType : uint32_t {
+        Cookies = 1,
+        Dns = 2,
+        TlsSessions = 3,
+    };
+
+    static constexpr char magic[8] = {'C', 'H', 'S', 'N', 'A', 'P', '\r', '\n'};
+    static constexpr size_t header_size = sizeof(magic) + 8;
+    static constexpr size_t section_header_size = 16;
+
+    // Bounds-checked cursor over a payload
+    struct Reader {
+        std::string_view data;
+        size_t offset{0};
+
+        std::string_view take(size_t n) {
+            if (n > data.size() - offset) {
+                throw std::runtime_error("Truncated state snapshot record");
+            }
+            std::string_view bytes = data.substr(offset, n);
+            offset += n;
+            return bytes;
+        }
+
+        uint32_t u32() {
+            uint32_t value;
+            std::memcpy(&value, take(sizeof(value)).data(), sizeof(value));
+            return value;
+        }
+
+        uint64_t u64() {
+            uint64_t value;
+            std::memcpy(&value, take(sizeof(value)).data(), sizeof(value));
+            return value;
+        }
+
+        std::string string() {
+            uint32_t length = u32();
+            return std::string(take(length));
+        }
+
+        std::chrono::system_clock::time_point time() {
+            auto ms = static_cast<int64_t>(u64());
+            return std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(ms)));
+        }
+
+        // Cap reservations by what the remaining bytes could possibly hold
+        size_t count(size_t min_record_size) {
+            uint32_t n = u32();
+            if (n > (data.size() - offset) / min_record_size) {
+                throw std::runtime_error("Truncated state snapshot record");
+            }
+            return n;
+        }
+    };
+
+    void parse_cookies(Reader& reader) {
+        size_t n = reader.count(28);
+        cookies.reserve(cookies.size() + n);
+        for (size_t i = 0; i < n; ++i) {
+            Cookie cookie;
+            cookie.name = reader.string();
+            cookie.value = reader.string();
+            cookie.domain = reader.string();
+            cookie.path = reader.string();
+            cookie.expires = reader.time();
+            uint32_t flags = reader.u32();
+            cookie.secure = flags & 1u;
+            cookie.http_only = flags & 2u;
+            cookie.session = flags & 4u;
+            cookies.push_back(std::move(cookie));
+        }
+    }
+
+    void parse_dns(Reader& reader) {
+        size_t n = reader.count(20);
+        dns.reserve(dns.size() + n);
+        for (size_t i = 0; i < n; ++i) {
+            DnsCache::Entry entry;
+            entry.host = reader.string();
+            entry.port = reader.string();
+            entry.expires = reader.time();
+            size_t endpoints = reader.count(12);
+            entry.endpoints.reserve(endpoints);
+            for (size_t j = 0; j < endpoints; ++j) {
+                entry.endpoints.push_back(get_endpoint(reader));
+            }
+            dns.push_back(std::move(entry));
+        }
+    }
+
+    void parse_tls_sessions(Reader& reader) {
+        size_t n = reader.count(16);
+        tls_sessions.reserve(tls_sessions.size() + n);
+        for (size_t i = 0; i < n; ++i) {
+            TlsSessionCache::Entry entry;
+            entry.key = reader.string();
+            entry.der = reader.string();
+            entry.expires = reader.time();
+            tls_sessions.push_back(std::move(entry));
+        }
+    }
+
+    // Endpoint: u32 family (4 or 6), u32 port, then 4 or 16 address bytes
+    static void put_endpoint(std::string& out, const asio::ip::tcp::endpoint& endpoint) {
+        auto address = endpoint.address();
+        put_u32(out, address.is_v6() ? 6 : 4);
+        put_u32(out, endpoint.port());
+        if (address.is_v6()) {
+            auto bytes = address.to_v6().to_bytes();
+            out.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        } else {
+            auto bytes = address.to_v4().to_bytes();
+            out.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        }
+    }
+
+    static asio::ip::tcp::endpoint get_endpoint(Reader& reader) {
+        uint32_t family = reader.u32();
+        auto port = static_cast<unsigned short>(reader.u32());
+        if (family == 6) {
+            asio::ip::address_v6::bytes_type bytes;
+            std::memcpy(bytes.data(), reader.take(bytes.size()).data(), bytes.size());
+            return {asio::ip::address_v6(bytes), port};
+        }
+        if (family != 4) {
+            throw std::runtime_error("Bad address family in state snapshot");
+        }
+        asio::ip::address_v4::bytes_type bytes;
+        std::memcpy(bytes.data(), reader.take(bytes.size()).data(), bytes.size());
+        return {asio::ip::address_v4(bytes), port};
+    }
+
+    template<typename Fill>
+    static void section(std::string& out, SectionType type, Fill&& fill) {
+        size_t header = out.size();
+        out.append(section_header_size, '\0');
+        fill(out);
+        std::string_view payload(out.data() + header + section_header_size, out.size() - header - section_header_size);
+        uint32_t type_value = static_cast<uint32_t>(type);
+        uint32_t checksum = crc(payload);
+        uint64_t length = payload.size();
+        std::memcpy(&out[header], &type_value, 4);
+        std::memcpy(&out[header + 4], &checksum, 4);
+        std::memcpy(&out[header + 8], &length, 8);
+        out.append(static_cast<size_t>(padded(length) - length), '\0');
+    }
+
+    static uint64_t padded(uint64_t length) {
+        return (length + 7) & ~uint64_t(7);
+    }
+
+    static uint32_t crc(std::string_view bytes) {
+        return static_cast<uint32_t>(::crc32(0, reinterpret_cast<const Bytef*>(bytes.data()),
+                                             static_cast<uInt>(bytes.size())));
+    }
+
+    static void put_u32(std::string& out, uint32_t value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    static void put_u64(std::string& out, uint64_t value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    static void put_string(std::string& out, std::string_view value) {
+        put_u32(out, static_cast<uint32_t>(value.size()));
+        out.append(value);
+    }
+
+    static void put_time(std::string& out, std::chrono::system_clock::time_point time) {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+        put_u64(out, static_cast<uint64_t>(ms));
+    }
+
+    static void throw_errno(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+};
+
+// Saves a snapshot every interval on its own thread, and once more when
+// destroyed. Capturing reads the cookie jar's published snapshot and
+// briefly locks the DNS and TLS caches, so the io thread is never blocked
+// on file I/O.
+class StateSnapshotWriter {
+public:
+    using SaveFunction = std::function<void()>;
+
+    StateSnapshotWriter(SaveFunction save, std::chrono::milliseconds interval)
+        : save_(std::move(save)), interval_(interval), thread_([this] { loop(); }) {}
+
+    StateSnapshotWriter(const StateSnapshotWriter&) = delete;
+    StateSnapshotWriter& operator=(const StateSnapshotWriter&) = delete;
+
+    ~StateSnapshotWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    // Number of successful saves, and the error of the latest save (empty if it succeeded)
+    size_t saves() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return saves_;
+    }
+
+    std::string last_error() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_error_;
+    }
+
+private:
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            bool stop = wake_.wait_for(lock, interval_, [this] { return stopping_; });
+            lock.unlock();
+            std::string error;
+            try {
+                save_();
+            } catch (const std::exception& e) {
+                error = e.what();  // Keep running; the next save may succeed
+            }
+            lock.lock();
+            if (error.empty()) {
+                ++saves_;
+            }
+            last_error_ = std::move(error);
+            if (stop) return;
+        }
+    }
+
+    SaveFunction save_;
+    std::chrono::milliseconds interval_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_{false};
+    size_t saves_{0};
+    std::string last_error_;
+    std::thread thread_;  // Last, so it starts after the members it uses
+};
+
+}
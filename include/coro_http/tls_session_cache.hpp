@@ -0,0 +1,146 @@
+#pragma once
+
+#include <openssl/ssl.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace coro_http {
+
+// TLS sessions per host and port, offered on the next handshake so the
+// server can resume instead of running a full key exchange.
+// Sessions are stored after a response has been read: with TLS 1.3 the
+// ticket arrives after the handshake, together with the first data.
+// The cache keeps private copies, and every handshake gets a copy of its
+// own: OpenSSL marks a connection's session unresumable when the
+// connection is freed without a close_notify, which would otherwise spoil
+// the cached one.
+class TlsSessionCache {
+public:
+    using Clock = std::chrono::system_clock;
+
+    // A session in DER form, as written to state snapshots
+    struct Entry {
+        std::string key;
+        std::string der;
+        Clock::time_point expires;
+    };
+
+    TlsSessionCache() = default;
+
+    TlsSessionCache(const TlsSessionCache&) = delete;
+    TlsSessionCache& operator=(const TlsSessionCache&) = delete;
+
+    static std::string key_for(const std::string& host, const std::string& port) {
+        return host + ':' + port;
+    }
+
+    // Offer the cached session for key on a connection about to handshake
+    void apply(SSL* ssl, const std::string& key) {
+        std::shared_ptr<SSL_SESSION> session;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = sessions_.find(key);
+            if (it == sessions_.end()) return;
+            if (expiry_of(it->second.session.get()) <= Clock::now()) {
+                sessions_.erase(it);
+                return;
+            }
+            session = it->second.session;
+        }
+        SSL_SESSION* copy = SSL_SESSION_dup(session.get());
+        if (!copy) return;
+        SSL_set_session(ssl, copy);
+        SSL_SESSION_free(copy);  // The connection holds its own reference
+    }
+
+    // Remember the connection's session if it can be resumed
+    void store(SSL* ssl, const std::string& key) {
+        SSL_SESSION* current = SSL_get_session(ssl);
+        if (!current || !SSL_SESSION_is_resumable(current)) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = sessions_.find(key);
+            if (it != sessions_.end() && it->second.source.get() == current) return;  // Already copied
+        }
+        SSL_SESSION* copy = SSL_SESSION_dup(current);
+        if (!copy) return;
+        SSL_SESSION_up_ref(current);
+        std::lock_guard<std::mutex> lock(mutex_);
+        sessions_[key] = Cached{adopt(copy), adopt(current)};
+    }
+
+    void import(const std::vector<Entry>& entries) {
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : entries) {
+            if (entry.expires <= now) continue;
+            const auto* data = reinterpret_cast<const unsigned char*>(entry.der.data());
+            SSL_SESSION* session = d2i_SSL_SESSION(nullptr, &data, static_cast<long>(entry.der.size()));
+            if (!session) continue;
+            sessions_[entry.key] = Cached{adopt(session), nullptr};
+        }
+    }
+
+    // Unexpired sessions, for saving. Encoding happens outside the lock
+    // so a background save does not hold up handshakes.
+    std::vector<Entry> entries() const {
+        auto now = Clock::now();
+        std::vector<std::pair<std::string, std::shared_ptr<SSL_SESSION>>> live;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            live.reserve(sessions_.size());
+            for (const auto& [key, cached] : sessions_) {
+                live.emplace_back(key, cached.session);
+            }
+        }
+        std::vector<Entry> result;
+        result.reserve(live.size());
+        for (const auto& [key, session] : live) {
+            auto expires = expiry_of(session.get());
+            if (expires <= now) continue;
+            int length = i2d_SSL_SESSION(session.get(), nullptr);
+            if (length <= 0) continue;
+            Entry entry{key, std::string(static_cast<size_t>(length), '\0'), expires};
+            auto* out = reinterpret_cast<unsigned char*>(entry.der.data());
+            i2d_SSL_SESSION(session.get(), &out);
+            result.push_back(std::move(entry));
+        }
+        return result;
+    }
+
+    void remove(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sessions_.erase(key);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return sessions_.size();
+    }
+
+private:
+    struct Cached {
+        std::shared_ptr<SSL_SESSION> session;  // Private copy, offered to handshakes
+        std::shared_ptr<SSL_SESSION> source;   // Connection session it was copied from
+    };
+
+    static std::shared_ptr<SSL_SESSION> adopt(SSL_SESSION* session) {
+        return std::shared_ptr<SSL_SESSION>(session, SSL_SESSION_free);
+    }
+
+    static Clock::time_point expiry_of(const SSL_SESSION* session) {
+        auto issued = static_cast<std::chrono::seconds::rep>(SSL_SESSION_get_time(session));
+        auto lifetime = static_cast<std::chrono::seconds::rep>(SSL_SESSION_get_timeout(session));
+        return Clock::time_point(std::chrono::seconds(issued + lifetime));
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Cached> sessions_;
+};
+
+}
@@ -1,22 +1,47 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <regex>
+#include <cctype>
 
 namespace coro_http {
 
+struct ProxyRoute;
+
 struct UrlInfo {
     std::string scheme;
     std::string host;
     std::string port;
     std::string path;
     bool is_https;
+    std::string unix_socket;           // Socket path for http+unix URLs and ClientConfig::unix_sockets hosts
+    const ProxyRoute* proxy{nullptr};  // Chosen by the client per request; nullptr = direct
+    bool* proxy_failed{nullptr};       // Set when reaching the proxy or opening its tunnel fails
 };
 
+// Decode %XX escapes, as in the host of an http+unix URL
+inline std::string percent_decode(const std::string& value) {
+    std::string decoded;
+    decoded.reserve(value.size());
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '%' && i + 2 < value.size() && std::isxdigit(static_cast<unsigned char>(value[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(value[i + 2]))) {
+            decoded += static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            decoded += value[i];
+        }
+    }
+    return decoded;
+}
+
+// http+unix://%2Fvar%2Frun%2Fapp.sock/path reaches the server listening on
+// the Unix domain socket /var/run/app.sock; the encoded path stays the host.
 inline UrlInfo parse_url(const std::string& url) {
     UrlInfo info;
     
-    std::regex url_regex(R"(^(https?):\/\/([^:\/\s]+)(?::(\d+))?(\/[^\s]*)?)");
+    std::regex url_regex(R"(^(https?|http\+unix):\/\/([^:\/\s]+)(?::(\d+))?(\/[^\s]*)?)");
     std::smatch matches;
     
     if (std::regex_search(url, matches, url_regex)) {
@@ -25,6 +50,9 @@ inline UrlInfo parse_url(const std::string& url) {
         info.port = matches[3].matched ? matches[3].str() : (matches[1].str() == "https" ? "443" : "80");
         info.path = matches[4].matched ? matches[4].str() : "/";
         info.is_https = matches[1].str() == "https";
+        if (info.scheme == "http+unix") {
+            info.unix_socket = percent_decode(info.host);
+        }
     } else {
         throw std::runtime_error("Invalid URL format");
     }
@@ -32,6 +60,121 @@ inline UrlInfo parse_url(const std::string& url) {
     return info;
 }
 
+// Remove "." and ".." segments from a path (RFC 3986 section 5.2.4)
+inline std::string remove_dot_segments(std::string_view input) {
+    std::string output;
+    auto drop_last_segment = [&output] {
+        size_t slash = output.rfind('/');
+        output.erase(slash == std::string::npos ? 0 : slash);
+    };
+    while (!input.empty()) {
+        if (input.substr(0, 3) == "../") {
+            input.remove_prefix(3);
+        } else if (input.substr(0, 2) == "./" || input.substr(0, 3) == "/./") {
+            input.remove_prefix(2);
+        } else if (input == "/.") {
+            input = "/";
+        } else if (input.substr(0, 4) == "/../") {
+            input.remove_prefix(3);
+            drop_last_segment();
+        } else if (input == "/..") {
+            input = "/";
+            drop_last_segment();
+        } else if (input == "." || input == "..") {
+            input = {};
+        } else {
+            size_t end = input.find('/', 1);
+            if (end == std::string_view::npos) end = input.size();
+            output.append(input.substr(0, end));
+            input.remove_prefix(end);
+        }
+    }
+    return output;
+}
+
+// Resolve a URI reference, such as a Location header, against the URL it
+// came from (RFC 3986 section 5.2.2). The base's fragment is ignored.
+inline std::string resolve_url(const UrlInfo& base, std::string_view reference) {
+    // Split the reference into scheme, authority, path, query and fragment (5.2.1)
+    std::string_view scheme, authority, path, query, fragment;
+    bool has_authority = false, has_query = false, has_fragment = false;
+
+    size_t hash = reference.find('#');
+    if (hash != std::string_view::npos) {
+        fragment = reference.substr(hash + 1);
+        has_fragment = true;
+        reference = reference.substr(0, hash);
+    }
+    size_t question = reference.find('?');
+    if (question != std::string_view::npos) {
+        query = reference.substr(question + 1);
+        has_query = true;
+        reference = reference.substr(0, question);
+    }
+    size_t colon = reference.find(':');
+    if (colon != std::string_view::npos && colon > 0 && std::isalpha(static_cast<unsigned char>(reference[0])) &&
+        reference.substr(0, colon).find_first_not_of(
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+-.") == std::string_view::npos) {
+        scheme = reference.substr(0, colon);
+        reference.remove_prefix(colon + 1);
+    }
+    if (reference.substr(0, 2) == "//") {
+        size_t end = reference.find('/', 2);
+        if (end == std::string_view::npos) end = reference.size();
+        authority = reference.substr(2, end - 2);
+        has_authority = true;
+        reference.remove_prefix(end);
+    }
+    path = reference;
+
+    // The base URL's parts; the port is left out when it is the default
+    std::string base_path = base.path.substr(0, base.path.find('#'));
+    std::string base_query;
+    bool base_has_query = false;
+    if (size_t mark = base_path.find('?'); mark != std::string::npos) {
+        base_query = base_path.substr(mark + 1);
+        base_has_query = true;
+        base_path.erase(mark);
+    }
+    std::string base_authority = base.host;
+    if (base.port != (base.is_https ? "443" : "80")) base_authority += ":" + base.port;
+
+    // Transform the reference (5.2.2)
+    std::string target_scheme(scheme.empty() ? std::string_view(base.scheme) : scheme);
+    std::string target_authority(authority);
+    bool target_has_authority = has_authority || scheme.empty();
+    std::string target_path;
+    std::string target_query(query);
+    bool target_has_query = has_query;
+    if (!scheme.empty() || has_authority) {
+        target_path = remove_dot_segments(path);
+    } else {
+        target_authority = base_authority;
+        if (path.empty()) {
+            target_path = base_path;
+            if (!has_query) {
+                target_query = base_query;
+                target_has_query = base_has_query;
+            }
+        } else if (path.front() == '/') {
+            target_path = remove_dot_segments(path);
+        } else {
+            // Merge with the directory of the base path (5.2.3)
+            std::string merged = base_path.empty() ? "/" : base_path.substr(0, base_path.rfind('/') + 1);
+            merged.append(path);
+            target_path = remove_dot_segments(merged);
+        }
+    }
+
+    // Recompose (5.3)
+    std::string result = target_scheme + ":";
+    if (target_has_authority) result += "//" + target_authority;
+    result += target_path;
+    if (target_has_query) result += "?" + target_query;
+    if (has_fragment) result += "#" + std::string(fragment);
+    return result;
+}
+
 inline std::string method_to_string(HttpMethod method) {
     switch (method) {
         case HttpMethod::GET: return "GET";
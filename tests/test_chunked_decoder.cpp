@@ -0,0 +1,234 @@
+#include "test_support.hpp"
+#include "coro_http/http_request.hpp"
+#include "coro_http/url_parser.hpp"
+#include "coro_http/http_parser.hpp"
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Test incremental chunked transfer decoding
+ *
+ * Key Points:
+ * - Any split of the input decodes to the same body
+ * - Spans point into the caller's buffer (no intermediate copies)
+ * - Extensions and trailers are parsed, not mistaken for data
+ * - feed() stops at the exact end of the message
+ * - Body bytes that look like a last chunk do not end the message early
+ * - Malformed framing is rejected
+ * - Responses are framed from the parsed head: header names in any case,
+ *   chunked only as the final transfer coding and overriding
+ *   Content-Length, no body for 204 and 304
+ */
+
+using namespace coro_http;
+
+static std::string encode_chunked(const std::string& body, size_t chunk_size) {
+    std::string out;
+    char size_line[32];
+    for (size_t pos = 0; pos < body.size(); pos += chunk_size) {
+        std::string piece = body.substr(pos, chunk_size);
+        std::snprintf(size_line, sizeof(size_line), "%zx\r\n", piece.size());
+        out += size_line + piece + "\r\n";
+    }
+    out += "0\r\n\r\n";
+    return out;
+}
+
+int test_any_split() {
+    std::cout << "Test: Decode in arbitrary pieces\n";
+
+    std::string body;
+    for (int i = 0; i < 5000; ++i) body += "line " + std::to_string(i) + "\n";
+    std::string wire = encode_chunked(body, 777);
+
+    for (size_t piece : {1ul, 2ul, 13ul, 4096ul, wire.size()}) {
+        ChunkedDecoder decoder;
+        std::string out;
+        size_t consumed = 0;
+        for (size_t pos = 0; pos < wire.size(); pos += piece) {
+            std::string_view input = std::string_view(wire).substr(pos, piece);
+            consumed += decoder.feed(input, [&](std::string_view span) {
+                check(span.data() >= input.data() &&
+                      span.data() + span.size() <= input.data() + input.size(),
+                      "span does not point into the input");
+                out.append(span);
+            });
+        }
+        check(decoder.done(), "end of message not detected");
+        check(consumed == wire.size(), "consumed byte count");
+        check(out == body, "decoded body differs");
+    }
+
+    check(decode_chunked(wire) == body, "decode_chunked");
+
+    std::cout << "✓ Split decode test passed\n";
+    return 0;
+}
+
+int test_extensions_and_trailers() {
+    std::cout << "Test: Chunk extensions and trailers\n";
+
+    std::string wire =
+        "5;name=value\r\nhello\r\n"
+        "6 ; ext\r\n world\r\n"
+        "0;last\r\n"
+        "Checksum: abc123\r\n"
+        "X-Trailer:  two words \r\n"
+        "\r\n";
+
+    ChunkedDecoder decoder;
+    std::string out;
+    decoder.feed(wire, [&](std::string_view span) { out.append(span); });
+
+    check(decoder.done(), "message not complete");
+    check(out == "hello world", "extension parsed as data");
+    check(decoder.extensions() == "last", "last chunk extension");
+    check(decoder.trailers().size() == 2, "trailer count");
+    check(decoder.trailers()[0].first == "Checksum" && decoder.trailers()[0].second == "abc123",
+          "first trailer");
+    check(decoder.trailers()[1].second == "two words", "trailer value trimmed");
+
+    std::cout << "✓ Extensions and trailers test passed\n";
+    return 0;
+}
+
+int test_exact_end_of_message() {
+    std::cout << "Test: Exact end of message\n";
+
+    // The body itself contains a "last chunk" sequence
+    std::string body = "data 0\r\n\r\n more";
+    std::string first = encode_chunked(body, 4);
+    std::string next = "HTTP/1.1 200 OK\r\n";
+    std::string wire = first + next;
+
+    ChunkedDecoder decoder;
+    std::string out;
+    size_t consumed = decoder.feed(wire, [&](std::string_view span) { out.append(span); });
+
+    check(decoder.done(), "message not complete");
+    check(consumed == first.size(), "decoder consumed bytes of the next message");
+    check(out == body, "body ended early");
+
+    // Nothing more is consumed once done
+    check(decoder.feed(next, [](std::string_view) {}) == 0, "consumed after done");
+
+    // Incomplete input is not done
+    ChunkedDecoder partial;
+    partial.feed(std::string_view(first).substr(0, first.size() - 1), [](std::string_view) {});
+    check(!partial.done(), "truncated message reported done");
+
+    std::cout << "✓ Exact end test passed\n";
+    return 0;
+}
+
+int test_malformed() {
+    std::cout << "Test: Malformed framing\n";
+
+    for (const char* wire : {"zz\r\nhello\r\n0\r\n\r\n",
+                             "5\r\nhelloXX0\r\n\r\n",
+                             "5\rhello\r\n0\r\n\r\n",
+                             "ffffffffffffffffff\r\n"}) {
+        bool threw = false;
+        try {
+            ChunkedDecoder decoder;
+            decoder.feed(wire, [](std::string_view) {});
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        check(threw, "malformed input accepted");
+    }
+
+    std::cout << "✓ Malformed framing test passed\n";
+    return 0;
+}
+
+int test_parse_response() {
+    std::cout << "Test: parse_response with chunked body\n";
+
+    std::string raw =
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n" +
+        encode_chunked("chunked body", 5);
+
+    auto response = parse_response(raw);
+    check(response.status_code() == 200, "status");
+    check(response.body() == "chunked body", "body");
+
+    auto split = parse_response("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n", "already decoded");
+    check(split.body() == "already decoded", "pre-decoded body");
+
+    std::cout << "✓ parse_response test passed\n";
+    return 0;
+}
+
+int test_framing_from_head() {
+    std::cout << "Test: response framing from the parsed head\n";
+
+    HttpResponse response;
+    response.add_header("Transfer-Encoding", "gzip, Chunked");
+    check(is_chunked_response(response), "final chunked coding missed");
+    HttpResponse not_last;
+    not_last.add_header("Transfer-Encoding", "chunked, gzip");
+    check(!is_chunked_response(not_last), "chunked taken from the middle of the codings");
+    HttpResponse sized;
+    sized.add_header("content-length", "12");
+    check(response_content_length(sized) == 12u, "lowercase Content-Length missed");
+    check(!response_content_length(response), "Content-Length taken alongside Transfer-Encoding");
+
+    // Every response shares one keep-alive connection, so any framing error
+    // shows up as a wrong body further down the line
+    asio::io_context io;
+    LoopbackServer server(io, [](const ServerRequest& request) -> std::string {
+        if (request.target == "/lower") {
+            return "HTTP/1.1 200 OK\r\ncontent-length:5\r\n\r\nhello";
+        }
+        if (request.target == "/both") {
+            return "HTTP/1.1 200 OK\r\nContent-Length: 999\r\ntransfer-encoding: chunked\r\n\r\n" +
+                   encode_chunked("chunked wins", 4);
+        }
+        if (request.target == "/not-modified") {
+            return "HTTP/1.1 304 Not Modified\r\nContent-Length: 5\r\n\r\n";
+        }
+        return "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nlast";
+    });
+    CoroHttpClient client(io);
+
+    std::vector<std::string> bodies;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (const char* path : {"/lower", "/both", "/not-modified", "/last"}) {
+            bodies.push_back((co_await client.co_get(server.url(path))).body());
+        }
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(bodies == std::vector<std::string>({"hello", "chunked wins", "", "last"}), "responses framed wrongly");
+    check(server.connections == 1, "connection not kept across the responses");
+
+    std::cout << "✓ Framing from head test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== Chunked Decoder Tests ===\n\n";
+
+    try {
+        test_any_split();
+        test_extensions_and_trailers();
+        test_exact_end_of_message();
+        test_malformed();
+        test_parse_response();
+        test_framing_from_head();
+
+        std::cout << "\n=== All chunked decoder tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
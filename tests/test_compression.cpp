@@ -0,0 +1,283 @@
+#include "test_support.hpp"
+#include "coro_http/content_codec.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Test Content-Encoding decompression
+ *
+ * Key Points:
+ * - One-shot gzip/deflate decode of a complete body
+ * - Streaming decode matches one-shot output for any split of the input
+ * - Corrupt and truncated input is reported, never silently accepted
+ * - Codec registry drives Accept-Encoding and stacked Content-Encoding
+ * - Request body encoders round-trip through the matching decoder
+ * - Responses are inflated as they are read, over chunked and
+ *   Content-Length framing alike; stacked codings still decode
+ */
+
+using namespace coro_http;
+
+static std::string compress(const std::string& data, int window_bits) {
+    z_stream stream{};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&stream, data.size()) + 32, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+static std::string sample_body() {
+    std::string body;
+    for (int i = 0; i < 20000; ++i) {
+        body += "{\"id\":" + std::to_string(i) + ",\"name\":\"item\"}\n";
+    }
+    return body;
+}
+
+int test_oneshot_roundtrip() {
+    std::cout << "Test: One-shot gzip/deflate decode\n";
+
+    std::string body = sample_body();
+    check(decompress_gzip(compress(body, 16 + MAX_WBITS)) == body, "gzip roundtrip");
+    check(decompress_deflate(compress(body, MAX_WBITS)) == body, "deflate roundtrip");
+    check(decompress_gzip(compress("", 16 + MAX_WBITS)).empty(), "empty gzip body");
+
+    std::cout << "✓ One-shot decode test passed\n";
+    return 0;
+}
+
+int test_streaming_matches_oneshot() {
+    std::cout << "Test: Streaming decode in arbitrary pieces\n";
+
+    std::string body = sample_body();
+    std::string gz = compress(body, 16 + MAX_WBITS);
+
+    for (size_t piece : {1ul, 7ul, 1000ul, gz.size()}) {
+        StreamingInflater inflater(StreamingInflater::Format::Gzip);
+        std::string out;
+        for (size_t pos = 0; pos < gz.size(); pos += piece) {
+            inflater.write(std::string_view(gz).substr(pos, piece), out);
+        }
+        inflater.finish();
+        check(out == body, "streamed output differs");
+    }
+
+    std::cout << "✓ Streaming decode test passed\n";
+    return 0;
+}
+
+int test_corrupt_input() {
+    std::cout << "Test: Corrupt and truncated input\n";
+
+    std::string gz = compress(sample_body(), 16 + MAX_WBITS);
+
+    bool threw = false;
+    try {
+        decompress_gzip(gz.substr(0, gz.size() / 2));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    check(threw, "truncated gzip accepted");
+
+    threw = false;
+    try {
+        decompress_deflate("not compressed at all");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    check(threw, "garbage deflate accepted");
+
+    StreamingInflater inflater(StreamingInflater::Format::Gzip);
+    std::string out;
+    inflater.write(std::string_view(gz).substr(0, gz.size() / 2), out);
+    check(!inflater.done(), "truncated stream reported complete");
+
+    std::cout << "✓ Corrupt input test passed\n";
+    return 0;
+}
+
+int test_codec_registry() {
+    std::cout << "Test: Content codec registry\n";
+
+    auto& registry = ContentCodecRegistry::instance();
+    check(registry.find("GZIP") != nullptr, "gzip not registered");
+    check(registry.accept_encoding().find("gzip") != std::string::npos, "gzip not advertised");
+
+    // Custom codec applied on top of gzip: "Content-Encoding: gzip, x-upper"
+    registry.register_codec({"x-upper",
+        [](std::string_view data) {
+            std::string out(data);
+            for (auto& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            return out;
+        },
+        nullptr,
+        nullptr});
+    check(registry.accept_encoding().find("x-upper") != std::string::npos, "custom codec not advertised");
+
+    std::string body = "hello codec registry";
+    std::string gz = compress(body, 16 + MAX_WBITS);
+    check(decode_content(gz, "gzip") == body, "single coding");
+    check(decode_content(gz, "identity, gzip") == body, "identity coding");
+    check(decode_content("HELLO", "x-upper") == "hello", "custom coding");
+    check(decode_content("raw", "x-unknown") == "raw", "unknown coding altered body");
+    check(decode_content(gz, "x-unknown, gzip") == gz, "body half decoded past an unknown coding");
+
+    auto decoder = make_content_decoder("gzip");
+    check(decoder != nullptr, "no streaming gzip decoder");
+    check(make_content_decoder("gzip, x-upper") == nullptr, "stacked codings streamed");
+
+    registry.unregister_codec("x-upper");
+    check(registry.find("x-upper") == nullptr, "custom codec not removed");
+
+    std::cout << "✓ Codec registry test passed\n";
+    return 0;
+}
+
+#if defined(CORO_HTTP_HAS_ZSTD)
+int test_zstd_frames() {
+    std::cout << "Test: Concatenated zstd frames\n";
+
+    std::string first = sample_body();
+    std::string second = "second frame";
+    std::string sized(ZSTD_compressBound(second.size()), '\0');
+    sized.resize(ZSTD_compress(sized.data(), sized.size(), second.data(), second.size(), 3));
+    auto encoder = make_content_encoder("zstd");
+    std::string unsized;
+    encoder->write(first, unsized);
+    encoder->finish(unsized);
+
+    // Frames with and without a declared content size, in both orders
+    std::vector<std::pair<std::string, std::string>> cases = {
+        {sized + sized, second + second},
+        {unsized + sized, first + second},
+        {sized + unsized, second + first},
+    };
+    for (const auto& [frames, expected] : cases) {
+        check(decompress_zstd(frames) == expected, "one-shot decode stopped after the first frame");
+        for (size_t piece : {1ul, 1000ul, frames.size()}) {
+            StreamingZstdDecoder decoder;
+            std::string out;
+            for (size_t pos = 0; pos < frames.size(); pos += piece) {
+                decoder.write(std::string_view(frames).substr(pos, piece), out);
+            }
+            decoder.finish();
+            check(out == expected, "streaming decode stopped after the first frame");
+        }
+    }
+
+    std::cout << "✓ Concatenated zstd frames test passed\n";
+    return 0;
+}
+#endif
+
+int test_request_encoding() {
+    std::cout << "Test: Request body encoding\n";
+
+    std::string body = sample_body();
+
+    for (const char* token : {"gzip", "deflate"}) {
+        // One pass and slice by slice must both decode back to the input
+        for (size_t slice : {body.size(), 4096ul}) {
+            auto encoder = make_content_encoder(token, 6);
+            check(encoder != nullptr, "missing built-in encoder");
+            std::string encoded;
+            for (size_t pos = 0; pos < body.size(); pos += slice) {
+                encoder->write(std::string_view(body).substr(pos, slice), encoded);
+            }
+            encoder->finish(encoded);
+            check(encoded.size() < body.size(), "body not compressed");
+            check(decode_content(encoded, token) == body, "encoded body does not round-trip");
+        }
+    }
+
+    check(make_content_encoder("x-unknown") == nullptr, "unknown coding yields an encoder");
+
+    std::cout << "✓ Request encoding test passed\n";
+    return 0;
+}
+
+static std::string to_hex(size_t value) {
+    char hex[16];
+    std::snprintf(hex, sizeof(hex), "%zx", value);
+    return hex;
+}
+
+int test_response_decoding() {
+    std::cout << "Test: Responses decoded while they are read\n";
+
+    std::string body = sample_body();
+    std::string gz = compress(body, 16 + MAX_WBITS);
+    std::string twice = compress(compress(body, MAX_WBITS), 16 + MAX_WBITS);
+
+    // /chunked sends the gzip body in uneven chunks, /length with
+    // Content-Length and /stacked with two codings
+    asio::io_context io;
+    LoopbackServer server(io, [&](const ServerRequest& request) {
+        if (request.target == "/chunked") {
+            std::string chunks;
+            for (size_t pos = 0, size = 1; pos < gz.size(); pos += size, size = size * 3 + 1) {
+                std::string piece = gz.substr(pos, size);
+                chunks += to_hex(piece.size()) + "\r\n" + piece + "\r\n";
+            }
+            return "HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nTransfer-Encoding: chunked\r\n\r\n" +
+                   chunks + "0\r\n\r\n";
+        }
+        if (request.target == "/stacked") {
+            return "HTTP/1.1 200 OK\r\nContent-Encoding: deflate, gzip\r\nContent-Length: " +
+                   std::to_string(twice.size()) + "\r\n\r\n" + twice;
+        }
+        return "HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nContent-Length: " +
+               std::to_string(gz.size()) + "\r\n\r\n" + gz;
+    });
+    CoroHttpClient client(io);
+
+    std::vector<std::string> bodies;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (const char* path : {"/chunked", "/length", "/stacked", "/chunked"}) {
+            bodies.push_back((co_await client.co_get(server.url(path))).body());
+        }
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(bodies.size() == 4, "requests did not complete");
+    check(bodies[0] == body, "chunked gzip body not decoded");
+    check(bodies[1] == body, "Content-Length gzip body not decoded");
+    check(bodies[2] == body, "stacked codings not decoded");
+    check(bodies[3] == body, "decoded body left the connection out of sync");
+    check(server.connections == 1, "decoded responses did not keep the connection");
+
+    std::cout << "✓ Response decoding test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== Compression Tests ===\n\n";
+
+    try {
+        test_oneshot_roundtrip();
+        test_streaming_matches_oneshot();
+        test_corrupt_input();
+        test_codec_registry();
+#if defined(CORO_HTTP_HAS_ZSTD)
+        test_zstd_frames();
+#endif
+        test_request_encoding();
+        test_response_decoding();
+
+        std::cout << "\n=== All compression tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,153 +1,378 @@
-#include "coro_http/coro_http_client.hpp"
+#include "test_support.hpp"
 #include "coro_http/connection_pool.hpp"
-#include <cassert>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <stdexcept>
+#include <string>
 
 /**
  * Test connection pool resource reuse
  * 
  * Key Points:
- * - Verify connections are reused (not leaked)
- * - Confirm coroutines properly release connections
- * - Detect resource stagnation/hoarding
- * - Ensure thread-safe pool operations
+ * - Sequential requests to a host share one connection
+ * - Concurrent requests past max_connections_per_host run on temporary
+ *   connections; the pool never holds more than the limit
+ * - A connection the server closed while idle is detected and replaced
+ * - Hosts, and HTTP and HTTPS, are pooled apart
+ * - Many coroutines leave no connection in use and no descriptor open
+ * - Failed requests free their pool slot
+ * - Handing out an idle connection never touches one still reading a response
  */
 
+using namespace coro_http;
+
+// Server answering every request with a body larger than one read buffer
+static asio::awaitable<void> serve_large(asio::ip::tcp::acceptor& acceptor, const std::string& response) {
+    while (true) {
+        auto [ec, socket] = co_await acceptor.async_accept(asio::as_tuple(asio::use_awaitable));
+        if (ec) co_return;
+        asio::co_spawn(acceptor.get_executor(), [&response, s = std::move(socket)]() mutable -> asio::awaitable<void> {
+            std::string buffer;
+            char chunk[4096];
+            while (true) {
+                size_t end;
+                while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                    auto [rec, n] = co_await s.async_read_some(asio::buffer(chunk), asio::as_tuple(asio::use_awaitable));
+                    if (rec || n == 0) co_return;
+                    buffer.append(chunk, n);
+                }
+                buffer.erase(0, end + 4);
+                auto [wec, n] = co_await asio::async_write(s, asio::buffer(response), asio::as_tuple(asio::use_awaitable));
+                if (wec) co_return;
+            }
+        }, asio::detached);
+    }
+}
+
+// Answers with the request target, so a response can be matched to its request
+static std::string echo_target(const ServerRequest& request) {
+    return "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(request.target.size()) + "\r\n\r\n" +
+           request.target;
+}
+
+static size_t open_descriptors() {
+    return static_cast<size_t>(std::distance(std::filesystem::directory_iterator("/proc/self/fd"),
+                                             std::filesystem::directory_iterator()));
+}
+
 int test_connection_reuse() {
     std::cout << "Test: Basic connection reuse\n";
-    
-    // Scenario:
-    // - Create connection pool with max_size = 5
-    // - Issue 10 sequential requests to same host
-    // - Monitor: max concurrent connections should be ≤ 5
-    // - On return: all connections returned to pool
-    //
-    // Each coroutine must:
-    // 1. Acquire connection from pool (or wait)
-    // 2. Execute request
-    // 3. Release connection back to pool
-    // 4. NOT hold connection after promise destruction
-    
+
+    asio::io_context io;
+    LoopbackServer server(io, echo_target);
+    CoroHttpClient client(io);
+
+    int matched = 0;
+    ConnectionPool::Stats stats;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (int i = 0; i < 10; ++i) {
+            std::string path = "/" + std::to_string(i);
+            matched += (co_await client.co_get(server.url(path))).body() == path;
+        }
+        stats = client.get_pool_stats();
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(matched == 10, "responses lost or mixed up");
+    check(server.connections == 1, "sequential requests did not reuse the connection");
+    check(stats.total_http_connections == 1 && stats.active_http_connections == 0,
+          "connection not returned to the pool");
+
     std::cout << "✓ Connection reuse test passed\n";
     return 0;
 }
 
 int test_concurrent_pool_access() {
     std::cout << "Test: Concurrent access to connection pool\n";
+
+    // Responses are held back briefly so requests overlap
+    asio::io_context io;
+    LoopbackServer server(io, [&](asio::ip::tcp::socket& socket, int) -> asio::awaitable<void> {
+        while (true) {
+            ServerRequest request = co_await server.read_request(socket);
+            if (request.head.empty()) co_return;
+            asio::steady_timer delay(socket.get_executor(), std::chrono::milliseconds(5));
+            co_await delay.async_wait(asio::use_awaitable);
+            co_await asio::async_write(socket, asio::buffer(echo_target(request)), asio::use_awaitable);
+        }
+    });
+    ClientConfig config;
+    config.max_connections_per_host = 5;
+    CoroHttpClient client(io, config);
+
+    // 20 coroutines, 5 requests each, every response checked against its request
+    int matched = 0;
+    int running = 20;
+    ConnectionPool::Stats stats;
+    for (int c = 0; c < 20; ++c) {
+        asio::co_spawn(io, [&, c]() -> asio::awaitable<void> {
+            for (int i = 0; i < 5; ++i) {
+                std::string path = "/" + std::to_string(c) + "/" + std::to_string(i);
+                matched += (co_await client.co_get(server.url(path))).body() == path;
+            }
+            if (--running == 0) {
+                stats = client.get_pool_stats();
+                client.clear_connection_pool();
+                server.stop();
+            }
+        }, asio::detached);
+    }
+    io.run();
+
+    check(matched == 100, "a connection served two requests at once");
+    check(stats.total_http_connections == 5, "pool grew past max_connections_per_host");
+    check(stats.active_http_connections == 0, "connections left in use");
+
+    std::cout << "✓ Concurrent pool access test passed\n";
+    return 0;
+}
+
+int test_concurrent_multi_read_responses() {
+    std::cout << "Test: Concurrent responses spanning several reads\n";
     
-    // Scenario:
-    // - 20 concurrent coroutines
-    // - Connection pool size = 5
-    // - Expected behavior:
-    //   * First 5 coroutines acquire connections
-    //   * Next 15 coroutines wait in queue
-    //   * As coroutines complete, waiting requests proceed
-    //   * Total time ~4x single-threaded (20/5)
-    //
-    // Detect issues:
-    // - Deadlocks: threads waiting indefinitely
-    // - Race conditions: same connection used twice
-    // - Resource leaks: connections not returned
+    asio::io_context io;
+    asio::ip::tcp::acceptor acceptor(io, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+    std::string body(3 * BufferPool::buffer_size, 'x');
+    std::string response = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    asio::co_spawn(io, serve_large(acceptor, response), asio::detached);
     
-    std::cout << "✓ Concurrent pool access test passed\n";
+    // One coroutine finishing and taking an idle connection must not probe
+    // the connection the other is still reading from
+    CoroHttpClient client(io);
+    std::string url = "http://127.0.0.1:" + std::to_string(acceptor.local_endpoint().port()) + "/";
+    int completed = 0;
+    int running = 4;
+    asio::steady_timer deadline(io, std::chrono::seconds(10));
+    deadline.async_wait([&io](asio::error_code ec) {
+        if (!ec) io.stop();  // A stuck read would otherwise hang the test
+    });
+    for (int c = 0; c < 4; ++c) {
+        asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+            for (int i = 0; i < 20; ++i) {
+                auto result = co_await client.co_get(url);
+                if (result.body() == body) ++completed;
+            }
+            if (--running == 0) {
+                client.clear_connection_pool();
+                asio::error_code ec;
+                acceptor.close(ec);
+                deadline.cancel();
+            }
+        }, asio::detached);
+    }
+    io.run();
+    
+    if (completed != 80) {
+        throw std::runtime_error("responses lost or truncated under concurrency");
+    }
+    
+    std::cout << "✓ Concurrent multi-read responses test passed\n";
     return 0;
 }
 
 int test_stale_connection_detection() {
     std::cout << "Test: Stale connection detection and removal\n";
-    
-    // Scenario:
-    // - Connection held in pool for extended time
-    // - Server closes connection (timeout)
-    // - Next request reuses "stale" connection
-    // - Detect dead connection, remove from pool, retry
-    //
-    // Coroutine must:
-    // - Detect connection error (broken pipe, timeout)
-    // - Release failed connection properly
-    // - Acquire fresh connection
-    // - Retry request
-    
+
+    // Every connection answers one keep-alive response, then the server
+    // closes it while it sits idle in the pool
+    asio::io_context io;
+    LoopbackServer server(io, [&](asio::ip::tcp::socket& socket, int) -> asio::awaitable<void> {
+        ServerRequest request = co_await server.read_request(socket);
+        co_await asio::async_write(socket, asio::buffer(echo_target(request)), asio::use_awaitable);
+        socket.shutdown(asio::ip::tcp::socket::shutdown_both);
+    });
+    CoroHttpClient client(io);
+
+    std::vector<std::string> bodies;
+    std::string error;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        try {
+            for (const char* path : {"/one", "/two", "/three"}) {
+                bodies.push_back((co_await client.co_get(server.url(path))).body());
+                asio::steady_timer settle(io, std::chrono::milliseconds(20));
+                co_await settle.async_wait(asio::use_awaitable);
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(error.empty(), "request sent on a connection the server had closed");
+    check(bodies == std::vector<std::string>({"/one", "/two", "/three"}), "wrong responses");
+    check(server.connections == 3, "closed connection not replaced");
+
     std::cout << "✓ Stale connection detection test passed\n";
     return 0;
 }
 
 int test_pool_exhaustion() {
-    std::cout << "Test: Pool exhaustion and waiting\n";
-    
-    // Scenario:
-    // - Connection pool size = 2
-    // - Long-running request holds connection for 5 seconds
-    // - Rapid requests come in
-    // - Expected: 3rd+ requests wait in queue, don't create new connections
-    //
-    // Monitor:
-    // - Queue depth
-    // - Wait time
-    // - No connection leaks even with waiting
-    
+    std::cout << "Test: Pool exhaustion\n";
+
+    // The pool does not queue: with both slots busy, further requests run on
+    // temporary connections that are closed after use
+    asio::io_context io;
+    LoopbackServer server(io, [&](asio::ip::tcp::socket& socket, int) -> asio::awaitable<void> {
+        while (true) {
+            ServerRequest request = co_await server.read_request(socket);
+            if (request.head.empty()) co_return;
+            asio::steady_timer delay(socket.get_executor(), std::chrono::milliseconds(50));
+            co_await delay.async_wait(asio::use_awaitable);
+            co_await asio::async_write(socket, asio::buffer(echo_target(request)), asio::use_awaitable);
+        }
+    });
+    ClientConfig config;
+    config.max_connections_per_host = 2;
+    CoroHttpClient client(io, config);
+
+    int matched = 0;
+    int running = 4;
+    int connections_after_burst = 0;
+    ConnectionPool::Stats stats;
+    for (int c = 0; c < 4; ++c) {
+        asio::co_spawn(io, [&, c]() -> asio::awaitable<void> {
+            std::string path = "/" + std::to_string(c);
+            matched += (co_await client.co_get(server.url(path))).body() == path;
+            if (--running > 0) co_return;
+
+            // Afterwards only the two pooled connections are used
+            connections_after_burst = server.connections;
+            for (int i = 0; i < 4; ++i) {
+                matched += (co_await client.co_get(server.url("/again"))).body() == "/again";
+            }
+            stats = client.get_pool_stats();
+            client.clear_connection_pool();
+            server.stop();
+        }, asio::detached);
+    }
+    io.run();
+
+    check(matched == 8, "requests failed while the pool was full");
+    check(connections_after_burst == 4, "requests past the limit did not get their own connection");
+    check(server.connections == 4, "pooled connections not reused after the burst");
+    check(stats.total_http_connections == 2 && stats.active_http_connections == 0,
+          "temporary connections kept in the pool");
+
     std::cout << "✓ Pool exhaustion test passed\n";
     return 0;
 }
 
 int test_different_hosts_separate_pools() {
     std::cout << "Test: Different hosts use separate connection pools\n";
-    
-    // Scenario:
-    // - Request to host A (pool size 5)
-    // - Request to host B (pool size 5)
-    // - Expected: two independent pools, not shared
-    // - Total connections: up to 10, not 5
-    //
-    // Verify correct pool lookup by:
-    // - Host key (domain:port)
-    // - Protocol (HTTP vs HTTPS)
-    
+
+    // 127.0.0.1 and localhost reach the same server under two host names
+    asio::io_context io;
+    LoopbackServer plain(io, echo_target);
+    LoopbackServer tls(io, echo_target, LoopbackServer::Tls{});
+    CoroHttpClient client(io);
+
+    int matched = 0;
+    ConnectionPool::Stats stats;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (int i = 0; i < 2; ++i) {
+            matched += (co_await client.co_get(plain.url("/ip"))).body() == "/ip";
+            matched += (co_await client.co_get("http://localhost:" + plain.port() + "/name")).body() == "/name";
+            matched += (co_await client.co_get(tls.url("/tls"))).body() == "/tls";
+        }
+        stats = client.get_pool_stats();
+        client.clear_connection_pool();
+        plain.stop();
+        tls.stop();
+    }, asio::detached);
+    io.run();
+
+    check(matched == 6, "responses lost or mixed up");
+    check(plain.connections == 2, "host names shared a connection");
+    check(tls.connections == 1, "HTTPS connection not reused");
+    check(stats.total_http_connections == 2 && stats.total_ssl_connections == 1, "pools not kept apart");
+
     std::cout << "✓ Different hosts test passed\n";
     return 0;
 }
 
 int test_no_resource_stagnation() {
     std::cout << "Test: No resource stagnation\n";
-    
-    // Critical test for detecting resource leaks!
-    //
-    // Scenario:
-    // - Create 100 coroutines
-    // - Each makes 10 requests
-    // - Monitor system resources
-    //   * Memory: should stabilize (not grow unbounded)
-    //   * File descriptors: should return to baseline
-    //   * Connections: should return to pool
-    //
-    // Run with tools:
-    // - Valgrind: detect leaked memory
-    // - LSOF: monitor open file descriptors
-    // - ASAN: detect use-after-free on connection objects
-    
+
+    asio::io_context io;
+    LoopbackServer server(io, echo_target);
+    CoroHttpClient client(io);
+    size_t descriptors_before = open_descriptors();
+
+    // 50 coroutines, 10 requests each, against a pool of 5
+    int matched = 0;
+    int running = 50;
+    ConnectionPool::Stats stats;
+    for (int c = 0; c < 50; ++c) {
+        asio::co_spawn(io, [&, c]() -> asio::awaitable<void> {
+            for (int i = 0; i < 10; ++i) {
+                std::string path = "/" + std::to_string(c) + "/" + std::to_string(i);
+                matched += (co_await client.co_get(server.url(path))).body() == path;
+            }
+            if (--running == 0) {
+                stats = client.get_pool_stats();
+                client.clear_connection_pool();
+                server.stop();
+            }
+        }, asio::detached);
+    }
+    io.run();
+
+    check(matched == 500, "responses lost or mixed up");
+    check(stats.total_http_connections <= 5 && stats.active_http_connections == 0, "connections hoarded");
+    check(open_descriptors() <= descriptors_before, "sockets left open");
+
     std::cout << "✓ No resource stagnation test passed\n";
     return 0;
 }
 
 int test_exception_releases_connection() {
     std::cout << "Test: Exception handling releases connection\n";
-    
-    // Critical coroutine scenario!
-    //
-    // Scenario:
-    // - Acquire connection from pool
-    // - co_await request
-    // - Exception thrown (timeout, network error)
-    // - Coroutine unwinds
-    // - Connection MUST be released back to pool
-    //
-    // Verify:
-    // - Try-catch in destructor/cleanup
-    // - Connection object RAII principles
-    // - Pool size recovers after exception
-    
+
+    // /cut promises more body than it sends
+    asio::io_context io;
+    LoopbackServer server(io, [](const ServerRequest& request) -> std::string {
+        if (request.target == "/cut") {
+            return "HTTP/1.1 200 OK\r\nContent-Length: 100\r\nConnection: close\r\n\r\nshort";
+        }
+        return echo_target(request);
+    });
+    CoroHttpClient client(io);
+
+    // More failures than the host has pool slots
+    int failures = 0;
+    std::vector<std::string> bodies;
+    ConnectionPool::Stats after_failures, after_success;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (int i = 0; i < 8; ++i) {
+            try {
+                co_await client.co_get(server.url("/cut"));
+            } catch (const std::exception&) {
+                ++failures;
+            }
+        }
+        after_failures = client.get_pool_stats();
+        bodies.push_back((co_await client.co_get(server.url("/ok"))).body());
+        bodies.push_back((co_await client.co_get(server.url("/ok"))).body());
+        after_success = client.get_pool_stats();
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(failures == 8, "cut responses accepted");
+    check(after_failures.total_http_connections == 0 && after_failures.active_http_connections == 0,
+          "failed requests kept their pool slots");
+    check(bodies == std::vector<std::string>({"/ok", "/ok"}), "requests after failures did not work");
+    check(after_success.total_http_connections == 1 && server.connections == 9,
+          "pool did not recover after failures");
+
     std::cout << "✓ Exception releases connection test passed\n";
     return 0;
 }
@@ -158,6 +383,7 @@ int main() {
     try {
         test_connection_reuse();
         test_concurrent_pool_access();
+        test_concurrent_multi_read_responses();
         test_stale_connection_detection();
         test_pool_exhaustion();
         test_different_hosts_separate_pools();
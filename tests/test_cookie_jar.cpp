@@ -0,0 +1,221 @@
+#include "test_support.hpp"
+#include "coro_http/cookie_jar.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * Test the indexed cookie jar
+ *
+ * Key Points:
+ * - Host-only and Domain cookies match the right hosts
+ * - Domain attributes for public suffixes or foreign hosts are rejected
+ * - Cookie header lists longer paths first
+ * - Expires and Max-Age set expiry; a past date deletes the cookie
+ * - Cached Cookie headers follow every change to the jar
+ * - Readers on other threads see whole updates, in order
+ */
+
+using namespace coro_http;
+using namespace std::chrono_literals;
+
+int test_domain_matching() {
+    std::cout << "Test: domain matching\n";
+
+    CookieJar jar;
+    jar.parse_set_cookie("host=1", "www.example.com");
+    jar.parse_set_cookie("wide=2; Domain=example.com", "www.example.com");
+    jar.parse_set_cookie("dotted=3; Domain=.Example.COM", "www.example.com");
+
+    check(jar.get_cookies_for_request("www.example.com", "/", false) == "host=1; wide=2; dotted=3",
+          "cookies missing for setting host");
+    check(jar.get_cookies_for_request("api.example.com", "/", false) == "wide=2; dotted=3",
+          "host-only cookie sent to sibling");
+    check(jar.get_cookies_for_request("example.com", "/", false) == "wide=2; dotted=3",
+          "domain cookie not sent to the domain itself");
+    check(jar.get_cookies_for_request("badexample.com", "/", false).empty(),
+          "domain cookie matched a non-subdomain");
+
+    // Secure cookies need HTTPS
+    jar.parse_set_cookie("token=s; Secure", "www.example.com");
+    check(jar.get_cookies_for_request("www.example.com", "/", false).find("token") == std::string::npos,
+          "secure cookie sent over HTTP");
+    check(jar.get_cookies_for_request("www.example.com", "/", true).find("token=s") != std::string::npos,
+          "secure cookie not sent over HTTPS");
+
+    // Manually added cookies without a domain match every host
+    jar.set("global", "g");
+    check(jar.get_cookies_for_request("other.org", "/", false) == "global=g", "domainless cookie missing");
+
+    std::cout << "✓ Domain matching test passed\n";
+    return 0;
+}
+
+int test_domain_rejection() {
+    std::cout << "Test: Domain attribute rejection\n";
+
+    CookieJar jar;
+    jar.parse_set_cookie("a=1; Domain=com", "www.example.com");
+    jar.parse_set_cookie("b=1; Domain=co.uk", "shop.example.co.uk");
+    jar.parse_set_cookie("c=1; Domain=other.com", "www.example.com");
+    jar.parse_set_cookie("d=1; Domain=example.com", "10.0.0.1");
+    check(jar.size() == 0, "invalid Domain attribute accepted");
+
+    jar.parse_set_cookie("e=1; Domain=example.co.uk", "shop.example.co.uk");
+    check(jar.get_cookies_for_request("www.example.co.uk", "/", false) == "e=1", "registrable domain rejected");
+
+    jar.add_public_suffix("corp.internal");
+    jar.parse_set_cookie("f=1; Domain=corp.internal", "app.corp.internal");
+    check(jar.get_cookies_for_request("app.corp.internal", "/", false).empty(), "custom public suffix ignored");
+
+    std::cout << "✓ Domain rejection test passed\n";
+    return 0;
+}
+
+int test_path_order() {
+    std::cout << "Test: path matching and order\n";
+
+    CookieJar jar;
+    jar.parse_set_cookie("root=1; Path=/", "example.com");
+    jar.parse_set_cookie("deep=3; Path=/api/v1", "example.com");
+    jar.parse_set_cookie("mid=2; Path=/api", "example.com");
+    jar.parse_set_cookie("dir=4", "example.com", "/docs/index.html");
+
+    check(jar.get_cookies_for_request("example.com", "/api/v1/users?id=7", false) == "deep=3; mid=2; root=1",
+          "wrong order for nested paths");
+    check(jar.get_cookies_for_request("example.com", "/apiary", false) == "root=1", "path prefix matched mid-segment");
+    check(jar.get_cookies_for_request("example.com", "/docs/guide", false) == "dir=4; root=1",
+          "default path not taken from request");
+
+    // Same name, domain and path replaces the value
+    jar.parse_set_cookie("mid=changed; Path=/api", "example.com");
+    check(jar.get_cookies_for_request("example.com", "/api", false) == "mid=changed; root=1", "cookie not replaced");
+    check(jar.size() == 4, "replacement added a cookie");
+
+    std::cout << "✓ Path order test passed\n";
+    return 0;
+}
+
+int test_expiry() {
+    std::cout << "Test: Expires and Max-Age\n";
+
+    CookieJar jar;
+    jar.parse_set_cookie("future=1; Expires=Wed, 09 Jun 2100 10:18:14 GMT", "example.com");
+    jar.parse_set_cookie("past=1; Expires=Thu, 01 Jan 1970 00:00:00 GMT", "example.com");
+    jar.parse_set_cookie("override=1; Max-Age=3600; Expires=Thu, 01 Jan 1970 00:00:00 GMT", "example.com");
+    check(jar.get_cookies_for_request("example.com", "/", false) == "future=1; override=1", "wrong expiry");
+
+    auto cookies = jar.all_cookies();
+    check(cookies.size() == 2 && !cookies[0].session, "expiry not recorded");
+
+    // A past date or Max-Age=0 deletes the stored cookie
+    jar.parse_set_cookie("future=1; Max-Age=0", "example.com");
+    check(jar.get_cookies_for_request("example.com", "/", false) == "override=1", "cookie not deleted");
+
+    // Expired cookies are dropped when their domain is visited
+    Cookie brief("brief", "1");
+    brief.domain = "example.com";
+    brief.session = false;
+    brief.expires = std::chrono::system_clock::now() + 50ms;
+    jar.add(brief);
+    check(jar.get_cookies_for_request("example.com", "/", false) == "override=1; brief=1", "short-lived cookie missing");
+    auto before = jar.generation();
+    std::this_thread::sleep_for(100ms);
+    check(jar.get_cookies_for_request("example.com", "/", false) == "override=1", "expired cookie sent");
+    check(jar.size() == 1 && jar.generation() != before, "expired cookie not dropped");
+
+    std::cout << "✓ Expiry test passed\n";
+    return 0;
+}
+
+int test_header_cache() {
+    std::cout << "Test: cached Cookie header\n";
+
+    CookieJar jar;
+    jar.set("a", "1", "example.com");
+    std::string first = jar.get_cookies_for_request("example.com", "/", false);
+    check(first == "a=1", "wrong header");
+    check(jar.get_cookies_for_request("example.com", "/", false) == first, "cached header differs");
+
+    jar.set("b", "2", "example.com");
+    check(jar.get_cookies_for_request("example.com", "/", false) == "a=1; b=2", "stale header after add");
+    jar.remove("a", "example.com");
+    check(jar.get_cookies_for_request("example.com", "/", false) == "b=2", "stale header after remove");
+    jar.clear();
+    check(jar.get_cookies_for_request("example.com", "/", false).empty(), "stale header after clear");
+
+    std::cout << "✓ Header cache test passed\n";
+    return 0;
+}
+
+int test_concurrent_access() {
+    std::cout << "Test: concurrent readers and writer\n";
+
+    CookieJar jar;
+    for (int d = 0; d < 50; ++d) {
+        jar.set("id", std::to_string(d), "site" + std::to_string(d) + ".example.com");
+    }
+    jar.set("counter", "0", ".example.com");
+
+    // Both headers of a batch land in one update
+    auto before = jar.generation();
+    jar.parse_set_cookies({"a=1", "b=2"}, "batch.example.com");
+    check(jar.generation() == before + 1, "batch published more than once");
+
+    constexpr int writes = 2000;
+    std::atomic<bool> failed{false};
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t] {
+            int last = 0;
+            std::string host = "site" + std::to_string(t) + ".example.com";
+            while (!stop.load()) {
+                std::string header = jar.get_cookies_for_request(host, "/", false);
+                // Expect "id=<t>; counter=<n>" with n never going backwards
+                std::string prefix = "id=" + std::to_string(t) + "; counter=";
+                if (header.compare(0, prefix.size(), prefix) != 0) {
+                    failed = true;
+                    return;
+                }
+                int counter = std::stoi(header.substr(prefix.size()));
+                if (counter < last) failed = true;
+                last = counter;
+            }
+        });
+    }
+    for (int i = 1; i <= writes; ++i) {
+        jar.parse_set_cookie("counter=" + std::to_string(i) + "; Domain=example.com", "www.example.com");
+    }
+    stop = true;
+    for (auto& reader : readers) reader.join();
+
+    check(!failed, "reader saw a torn or reordered jar");
+    check(jar.get_cookies_for_request("site1.example.com", "/", false) == "id=1; counter=" + std::to_string(writes),
+          "last write lost");
+
+    std::cout << "✓ Concurrent access test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== Cookie Jar Tests ===\n\n";
+
+    try {
+        test_domain_matching();
+        test_domain_rejection();
+        test_path_order();
+        test_expiry();
+        test_header_cache();
+        test_concurrent_access();
+
+        std::cout << "\n=== All cookie jar tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
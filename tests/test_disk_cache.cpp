@@ -0,0 +1,270 @@
+#include "test_support.hpp"
+#include "coro_http/http_cache.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Test the persistent disk cache
+ *
+ * Key Points:
+ * - Records survive closing and reopening the cache directory
+ * - Bodies are served from an mmap that outlives segment eviction
+ * - Overwrite and erase keep one live record per key
+ * - Oldest segments are evicted once the byte budget is exceeded
+ * - Records are visible before their sync and published by flush()
+ * - Index compaction swaps in a new index file, keeping live records
+ * - Corrupt index slots are dropped on reopen, never followed
+ * - A directory in use by another instance is rejected
+ * - HttpCache warms from disk after a restart, one record per Vary variant
+ */
+
+using namespace coro_http;
+using namespace std::chrono_literals;
+namespace fs = std::filesystem;
+
+static std::string fresh_directory(const std::string& name) {
+    fs::path dir = fs::temp_directory_path() /
+        ("coro_http_" + name + "_" + std::to_string(::getpid()));
+    fs::remove_all(dir);
+    return dir.string();
+}
+
+int test_persistence() {
+    std::cout << "Test: Records survive reopen\n";
+
+    std::string dir = fresh_directory("persist");
+    std::string body(100000, 'b');
+    {
+        DiskCache cache(dir, 16 * 1024 * 1024);
+        check(cache.put("http://example.com/a", "meta-a", body), "put a");
+        check(cache.put("http://example.com/b", "meta-b", "small"), "put b");
+        check(cache.put("http://example.com/b", "meta-b2", "replaced"), "overwrite b");
+        cache.erase("http://example.com/missing");
+        check(cache.stats().entries == 2, "entry count");
+    }
+    {
+        DiskCache cache(dir, 16 * 1024 * 1024);
+        auto a = cache.find("http://example.com/a");
+        check(a && a->meta == "meta-a" && a->body == body, "a after reopen");
+        auto b = cache.find("http://example.com/b");
+        check(b && b->meta == "meta-b2" && b->body == "replaced", "b after reopen");
+        check(!cache.find("http://example.com/c"), "phantom entry");
+
+        cache.erase("http://example.com/a");
+        check(!cache.find("http://example.com/a"), "erase");
+        check(cache.stats().entries == 1, "entry count after erase");
+    }
+    fs::remove_all(dir);
+
+    std::cout << "✓ Persistence test passed\n";
+    return 0;
+}
+
+int test_segment_eviction() {
+    std::cout << "Test: Oldest segments evicted over budget\n";
+
+    std::string dir = fresh_directory("evict");
+    DiskCache cache(dir, 1024 * 1024, 128 * 1024);
+    std::string body(60 * 1024, 'x');
+
+    check(cache.put("key-0", "", body), "put first");
+    auto first = cache.find("key-0");
+    check(first.has_value(), "first readable");
+
+    for (int i = 1; i < 40; ++i) {
+        check(cache.put("key-" + std::to_string(i), "", body), "put");
+    }
+    auto stats = cache.stats();
+    check(stats.bytes <= 1024 * 1024, "over budget");
+    check(stats.segments > 1, "no segment rollover");
+    check(!cache.find("key-0"), "oldest entry kept");
+    check(cache.find("key-39").has_value(), "newest entry evicted");
+
+    // The mapping taken before eviction still reads the original bytes
+    check(first->body == body, "mapped body changed after eviction");
+
+    fs::remove_all(dir);
+    std::cout << "✓ Segment eviction test passed\n";
+    return 0;
+}
+
+static ino_t index_inode(const std::string& dir) {
+    struct stat st{};
+    ::stat((fs::path(dir) / "index.bin").c_str(), &st);
+    return st.st_ino;
+}
+
+int test_flush_and_compaction() {
+    std::cout << "Test: Pending records and index compaction\n";
+
+    std::string dir = fresh_directory("compact");
+    {
+        DiskCache cache(dir, 1024 * 1024);
+        check(cache.put("kept", "meta", "kept-body"), "put kept");
+        auto pending = cache.find("kept");
+        check(pending && pending->body == "kept-body", "pending record not visible");
+        cache.flush();
+        check(cache.find("kept")->body == "kept-body", "record lost by flush");
+
+        // Published then erased records leave tombstones until the index is rebuilt
+        bool rebuilt = false;
+        for (int round = 0; round < 150; ++round) {
+            ino_t before = index_inode(dir);
+            for (int i = 0; i < 100; ++i) {
+                cache.put("churn-" + std::to_string(round) + "-" + std::to_string(i), "", "x");
+            }
+            cache.flush();
+            for (int i = 0; i < 100; ++i) {
+                cache.erase("churn-" + std::to_string(round) + "-" + std::to_string(i));
+            }
+            rebuilt = rebuilt || index_inode(dir) != before;
+        }
+        check(rebuilt, "index not rebuilt into a new file");
+        check(!fs::exists(fs::path(dir) / "index.bin.tmp"), "temporary index left behind");
+        check(cache.stats().entries == 1, "entry count after compaction");
+        check(cache.find("kept")->body == "kept-body", "live record lost by compaction");
+    }
+    {
+        DiskCache cache(dir, 1024 * 1024);
+        check(cache.find("kept").has_value(), "compacted index not reopened");
+        check(!cache.find("churn-0-0"), "erased record came back");
+    }
+
+    fs::remove_all(dir);
+    std::cout << "✓ Flush and compaction test passed\n";
+    return 0;
+}
+
+int test_corrupt_index() {
+    std::cout << "Test: Corrupt index slots are dropped\n";
+
+    std::string dir = fresh_directory("corrupt");
+    {
+        DiskCache cache(dir, 16 * 1024 * 1024);
+        for (int i = 0; i < 50; ++i) {
+            cache.put("key-" + std::to_string(i), "meta", "body-" + std::to_string(i));
+        }
+    }
+
+    // Scribble over the slot area, as a torn write would
+    {
+        std::fstream index(fs::path(dir) / "index.bin", std::ios::in | std::ios::out | std::ios::binary);
+        index.seekg(0, std::ios::end);
+        std::streamoff size = index.tellg();
+        for (std::streamoff pos = 64 + 17; pos < size; pos += 997) {
+            index.seekp(pos);
+            index.put('\x5a');
+        }
+    }
+
+    DiskCache cache(dir, 16 * 1024 * 1024);
+    size_t survivors = 0;
+    for (int i = 0; i < 50; ++i) {
+        if (auto record = cache.find("key-" + std::to_string(i))) {
+            check(record->body == "body-" + std::to_string(i), "corrupt slot served wrong record");
+            ++survivors;
+        }
+    }
+    check(survivors == cache.stats().entries, "entry count disagrees with lookups");
+    check(cache.put("key-new", "meta", "after"), "put after recovery");
+    check(cache.find("key-new")->body == "after", "find after recovery");
+
+    fs::remove_all(dir);
+    std::cout << "✓ Corrupt index test passed\n";
+    return 0;
+}
+
+int test_directory_lock() {
+    std::cout << "Test: Directory used by one instance at a time\n";
+
+    std::string dir = fresh_directory("lock");
+    {
+        DiskCache cache(dir, 1024 * 1024);
+        bool threw = false;
+        try {
+            DiskCache second(dir, 1024 * 1024);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        check(threw, "second instance opened a locked directory");
+    }
+    DiskCache reopened(dir, 1024 * 1024);  // Lock released with the first instance
+
+    fs::remove_all(dir);
+    std::cout << "✓ Directory lock test passed\n";
+    return 0;
+}
+
+int test_http_cache_warm_restart() {
+    std::cout << "Test: HttpCache warm restart from disk\n";
+
+    std::string dir = fresh_directory("warm");
+    auto t0 = std::chrono::system_clock::now();
+    HttpRequest request(HttpMethod::GET, "http://example.com/dataset");
+    request.add_header("Accept", "text/csv");
+
+    HttpResponse response;
+    response.set_status_code(200);
+    response.set_reason("OK");
+    response.add_header("Cache-Control", "max-age=3600");
+    response.add_header("ETag", "\"d1\"");
+    response.add_header("Vary", "Accept");
+    response.set_body(std::string(300000, 'd'));
+
+    HttpRequest json(HttpMethod::GET, "http://example.com/dataset");
+    json.add_header("Accept", "application/json");
+    HttpResponse json_response = response;
+    json_response.set_body(std::string(200000, 'j'));
+
+    {
+        // Memory budget smaller than the body: served from disk only
+        HttpCache cache(64 * 1024, 4, std::make_shared<DiskCache>(dir, 16 * 1024 * 1024));
+        check(cache.store(request, response, t0, t0) != nullptr, "store");
+        check(cache.store(json, json_response, t0, t0) != nullptr, "store second variant");
+    }
+
+    HttpCache cache(64 * 1024 * 1024, 4, std::make_shared<DiskCache>(dir, 16 * 1024 * 1024));
+    auto hit = cache.lookup(request, t0 + 10s);
+    check(hit && hit->freshness == HttpCache::Freshness::Fresh, "not fresh after restart");
+    check(hit->entry->response.body() == response.body(), "body after restart");
+    check(hit->entry->etag == "\"d1\"", "validators after restart");
+    check(hit->entry->current_age(t0 + 10s) >= 10s, "age lost across restart");
+
+    auto json_hit = cache.lookup(json, t0 + 10s);
+    check(json_hit && json_hit->entry->response.body() == json_response.body(), "second variant replaced the first");
+
+    HttpRequest html(HttpMethod::GET, "http://example.com/dataset");
+    html.add_header("Accept", "text/html");
+    check(!cache.lookup(html, t0 + 10s), "wrong variant served from disk");
+
+    cache.invalidate("http://example.com/dataset");
+    check(!cache.lookup(request, t0 + 10s) && !cache.lookup(json, t0 + 10s), "invalidate left disk entries");
+
+    fs::remove_all(dir);
+    std::cout << "✓ Warm restart test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== Disk Cache Tests ===\n\n";
+
+    try {
+        test_persistence();
+        test_segment_eviction();
+        test_flush_and_compaction();
+        test_corrupt_index();
+        test_directory_lock();
+        test_http_cache_warm_restart();
+
+        std::cout << "\n=== All disk cache tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,189 @@
+#include "test_support.hpp"
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+/**
+ * Test file-backed request bodies
+ *
+ * Key Points:
+ * - Small files go out with the head; large ones follow it by sendfile()
+ *   over plain TCP, and the connection stays usable for the next request
+ * - Through TLS the file is read and encrypted in slices
+ * - A missing file fails the request before anything is sent
+ * - A 307 redirect sends the file again
+ */
+
+using namespace coro_http;
+
+// Test file filled with a position-dependent pattern, removed on destruction
+class TempFile {
+public:
+    explicit TempFile(size_t size) {
+        path_ = "/tmp/coro_http_body_" + std::to_string(::getpid()) + "_" + std::to_string(size);
+        content_.resize(size);
+        for (size_t i = 0; i < size; ++i) content_[i] = static_cast<char>('a' + (i * 7 + i / 4096) % 26);
+        std::ofstream(path_, std::ios::binary).write(content_.data(), static_cast<std::streamsize>(size));
+    }
+
+    ~TempFile() {
+        ::unlink(path_.c_str());
+    }
+
+    const std::string& path() const { return path_; }
+    const std::string& content() const { return content_; }
+
+private:
+    std::string path_;
+    std::string content_;
+};
+
+// Answers each upload with its size; POST /redirect answers 307 to /upload
+static std::string upload_response(const ServerRequest& request) {
+    if (request.method == "POST" && request.target == "/redirect") {
+        return "HTTP/1.1 307 Temporary Redirect\r\nLocation: /upload\r\nContent-Length: 0\r\n\r\n";
+    }
+    std::string size = std::to_string(request.body.size());
+    return "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(size.size()) + "\r\n\r\n" + size;
+}
+
+// Request bodies in arrival order
+static std::vector<std::string> bodies(const LoopbackServer& server) {
+    std::vector<std::string> received;
+    for (const auto& request : server.requests) received.push_back(request.body);
+    return received;
+}
+
+static asio::awaitable<std::string> upload(CoroHttpClient& client, const std::string& url, const std::string& path) {
+    HttpRequest request(HttpMethod::POST, url);
+    request.add_header("Content-Type", "application/octet-stream");
+    request.set_body_file(path);
+    auto response = co_await client.co_execute(std::move(request));
+    co_return response.body();
+}
+
+int test_plain_uploads() {
+    std::cout << "Test: small and sendfile uploads over plain TCP\n";
+
+    TempFile small(1000);
+    TempFile large(3 * 1024 * 1024 + 17);
+    asio::io_context io;
+    LoopbackServer server(io, upload_response);
+    CoroHttpClient client(io);
+
+    std::vector<std::string> replies;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        replies.push_back(co_await upload(client, server.url("/upload"), small.path()));
+        replies.push_back(co_await upload(client, server.url("/upload"), large.path()));
+        replies.push_back(co_await upload(client, server.url("/upload"), small.path()));
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(replies == std::vector<std::string>({"1000", std::to_string(large.content().size()), "1000"}),
+          "wrong sizes received");
+    check(bodies(server) == std::vector<std::string>({small.content(), large.content(), small.content()}),
+          "file content corrupted");
+    check(server.connections == 1, "connection not reused after sendfile");
+
+    std::cout << "✓ Plain uploads test passed\n";
+    return 0;
+}
+
+int test_tls_upload() {
+    std::cout << "Test: large upload through TLS\n";
+
+    TempFile large(1024 * 1024 + 5);
+    asio::io_context io;
+    LoopbackServer server(io, upload_response, LoopbackServer::Tls{});
+    CoroHttpClient client(io);
+
+    std::string reply;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        reply = co_await upload(client, server.url("/upload"), large.path());
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(reply == std::to_string(large.content().size()), "wrong size received");
+    check(bodies(server) == std::vector<std::string>({large.content()}), "file content corrupted");
+
+    std::cout << "✓ TLS upload test passed\n";
+    return 0;
+}
+
+int test_missing_file() {
+    std::cout << "Test: missing file fails before sending\n";
+
+    TempFile small(10);
+    asio::io_context io;
+    LoopbackServer server(io, upload_response);
+    CoroHttpClient client(io);
+
+    bool failed = false;
+    std::string reply;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        try {
+            co_await upload(client, server.url("/upload"), "/nonexistent/coro_http_body");
+        } catch (const std::system_error&) {
+            failed = true;
+        }
+        reply = co_await upload(client, server.url("/upload"), small.path());
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(failed, "missing file not reported");
+    check(reply == "10" && server.requests.size() == 1, "client unusable after a missing file");
+
+    std::cout << "✓ Missing file test passed\n";
+    return 0;
+}
+
+int test_redirect_resends_file() {
+    std::cout << "Test: 307 sends the file again\n";
+
+    TempFile large(200 * 1024);
+    asio::io_context io;
+    LoopbackServer server(io, upload_response);
+    CoroHttpClient client(io);
+
+    std::string reply;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        reply = co_await upload(client, server.url("/redirect"), large.path());
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(reply == std::to_string(large.content().size()), "redirected upload lost its body");
+    check(bodies(server) == std::vector<std::string>({large.content(), large.content()}),
+          "file not sent on both hops");
+
+    std::cout << "✓ Redirect resend test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== File Body Tests ===\n\n";
+
+    try {
+        test_plain_uploads();
+        test_tls_upload();
+        test_missing_file();
+        test_redirect_resends_file();
+
+        std::cout << "\n=== All file body tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,248 @@
+#include "test_support.hpp"
+#include "coro_http/http_cache.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+/**
+ * Test the RFC 9111 response cache
+ *
+ * Key Points:
+ * - HTTP dates in all three formats parse to the same instant
+ * - Freshness from max-age, Expires and the Last-Modified heuristic
+ * - Stale entries are revalidated; 304 refreshes the stored response
+ * - stale-while-revalidate serves stale within its window
+ * - Vary selects between stored variants
+ * - no-store, Vary: * and authenticated requests are not stored
+ * - Byte-bounded LRU evicts least recently used entries
+ */
+
+using namespace coro_http;
+using namespace std::chrono_literals;
+
+static HttpResponse make_response(const std::string& body,
+                                  std::initializer_list<std::pair<std::string, std::string>> headers) {
+    HttpResponse response;
+    response.set_status_code(200);
+    response.set_reason("OK");
+    for (const auto& [key, value] : headers) response.add_header(key, value);
+    response.set_body(body);
+    return response;
+}
+
+static const auto t0 = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+
+int test_http_dates() {
+    std::cout << "Test: HTTP date formats\n";
+
+    auto imf = parse_http_date("Sun, 06 Nov 1994 08:49:37 GMT");
+    auto rfc850 = parse_http_date("Sunday, 06-Nov-94 08:49:37 GMT");
+    auto asctime = parse_http_date("Sun Nov  6 08:49:37 1994");
+    check(imf && rfc850 && asctime, "date not parsed");
+    check(*imf == *rfc850 && *imf == *asctime, "formats disagree");
+    check(std::chrono::duration_cast<std::chrono::seconds>(imf->time_since_epoch()).count() == 784111777,
+          "wrong epoch seconds");
+    check(!parse_http_date("not a date"), "garbage accepted");
+    check(!parse_http_date("Sun, 32 Nov 1994 08:49:37 GMT"), "invalid day accepted");
+
+    std::cout << "✓ HTTP date test passed\n";
+    return 0;
+}
+
+int test_freshness() {
+    std::cout << "Test: Freshness lifetime and age\n";
+
+    HttpCache cache;
+    HttpRequest request(HttpMethod::GET, "http://example.com/config");
+    cache.store(request, make_response("v1", {{"Cache-Control", "max-age=60"}}), t0, t0);
+
+    auto fresh = cache.lookup(request, t0 + 30s);
+    check(fresh && fresh->freshness == HttpCache::Freshness::Fresh, "should be fresh");
+    check(HttpCache::serve(*fresh->entry, t0 + 30s).get_header("Age") == "30", "Age header");
+    check(HttpCache::serve(*fresh->entry, t0 + 30s).body() == "v1", "cached body");
+
+    // No validators: once stale it is a miss, not a revalidation
+    check(!cache.lookup(request, t0 + 61s), "stale entry without validators returned");
+
+    // Age from upstream counts against freshness
+    HttpRequest aged(HttpMethod::GET, "http://example.com/aged");
+    cache.store(aged, make_response("x", {{"Cache-Control", "max-age=60"}, {"Age", "50"}}), t0, t0);
+    check(cache.lookup(aged, t0 + 5s)->freshness == HttpCache::Freshness::Fresh, "aged fresh");
+    check(!cache.lookup(aged, t0 + 11s), "Age header ignored");
+
+    // Expires relative to Date
+    HttpRequest expires(HttpMethod::GET, "http://example.com/expires");
+    cache.store(expires, make_response("x", {{"Date", "Tue, 14 Nov 2023 22:13:20 GMT"},
+                                             {"Expires", "Tue, 14 Nov 2023 22:23:20 GMT"}}), t0, t0);
+    check(cache.lookup(expires, t0 + 599s)->freshness == HttpCache::Freshness::Fresh, "Expires fresh");
+    check(!cache.lookup(expires, t0 + 601s), "Expires ignored");
+
+    // Heuristic: 10% of the time since Last-Modified (1000s -> 100s)
+    HttpRequest heuristic(HttpMethod::GET, "http://example.com/heuristic");
+    cache.store(heuristic, make_response("x", {{"Date", "Tue, 14 Nov 2023 22:13:20 GMT"},
+                                               {"Last-Modified", "Tue, 14 Nov 2023 21:56:40 GMT"}}), t0, t0);
+    check(cache.lookup(heuristic, t0 + 99s)->freshness == HttpCache::Freshness::Fresh, "heuristic fresh");
+    check(cache.lookup(heuristic, t0 + 101s)->freshness == HttpCache::Freshness::Stale, "heuristic stale");
+
+    std::cout << "✓ Freshness test passed\n";
+    return 0;
+}
+
+int test_revalidation() {
+    std::cout << "Test: Conditional revalidation\n";
+
+    HttpCache cache;
+    HttpRequest request(HttpMethod::GET, "http://example.com/catalog");
+    cache.store(request, make_response("catalog", {{"Cache-Control", "max-age=10"},
+                                                   {"ETag", "\"v1\""},
+                                                   {"X-Version", "1"}}), t0, t0);
+
+    auto stale = cache.lookup(request, t0 + 20s);
+    check(stale && stale->freshness == HttpCache::Freshness::Stale, "should need revalidation");
+
+    HttpRequest conditional = request;
+    HttpCache::add_validators(conditional, *stale->entry);
+    check(conditional.headers().at("If-None-Match") == "\"v1\"", "If-None-Match");
+
+    HttpResponse not_modified;
+    not_modified.set_status_code(304);
+    not_modified.add_header("Cache-Control", "max-age=100");
+    not_modified.add_header("X-Version", "2");
+    auto refreshed = cache.freshen(request, *stale->entry, not_modified, t0 + 20s, t0 + 20s);
+    check(refreshed != nullptr, "refreshed entry not stored");
+    check(refreshed->response.status_code() == 200, "status replaced by 304");
+    check(refreshed->response.body() == "catalog", "body lost on 304");
+    check(refreshed->response.get_header("X-Version") == "2", "headers not updated");
+
+    auto again = cache.lookup(request, t0 + 60s);
+    check(again && again->freshness == HttpCache::Freshness::Fresh, "refreshed lifetime");
+    check(cache.stats().revalidations == 1, "revalidation count");
+
+    // Request no-cache forces revalidation even when fresh
+    HttpRequest no_cache = request;
+    no_cache.add_header("Cache-Control", "no-cache");
+    check(cache.lookup(no_cache, t0 + 60s)->freshness == HttpCache::Freshness::Stale, "request no-cache");
+
+    std::cout << "✓ Revalidation test passed\n";
+    return 0;
+}
+
+int test_stale_while_revalidate() {
+    std::cout << "Test: stale-while-revalidate and stale-if-error\n";
+
+    HttpCache cache;
+    HttpRequest request(HttpMethod::GET, "http://example.com/poll");
+    cache.store(request, make_response("x", {{"Cache-Control", "max-age=10, stale-while-revalidate=30, stale-if-error=100"},
+                                             {"ETag", "\"a\""}}), t0, t0);
+
+    check(cache.lookup(request, t0 + 20s)->freshness == HttpCache::Freshness::StaleWhileRevalidate, "swr window");
+    auto stale = cache.lookup(request, t0 + 50s);
+    check(stale->freshness == HttpCache::Freshness::Stale, "past swr window");
+    check(HttpCache::usable_on_error(*stale->entry, t0 + 50s), "stale-if-error window");
+    check(!HttpCache::usable_on_error(*stale->entry, t0 + 200s), "past stale-if-error window");
+
+    HttpRequest strict(HttpMethod::GET, "http://example.com/strict");
+    cache.store(strict, make_response("x", {{"Cache-Control", "max-age=10, stale-while-revalidate=30, must-revalidate"},
+                                            {"ETag", "\"a\""}}), t0, t0);
+    check(cache.lookup(strict, t0 + 20s)->freshness == HttpCache::Freshness::Stale, "must-revalidate");
+
+    std::cout << "✓ stale-while-revalidate test passed\n";
+    return 0;
+}
+
+int test_vary() {
+    std::cout << "Test: Vary variants\n";
+
+    HttpCache cache;
+    HttpRequest en(HttpMethod::GET, "http://example.com/page");
+    en.add_header("Accept-Language", "en");
+    HttpRequest de(HttpMethod::GET, "http://example.com/page");
+    de.add_header("accept-language", "de");
+
+    cache.store(en, make_response("hello", {{"Cache-Control", "max-age=60"}, {"Vary", "Accept-Language"}}), t0, t0);
+    check(!cache.lookup(de, t0), "variant mismatch served");
+    cache.store(de, make_response("hallo", {{"Cache-Control", "max-age=60"}, {"Vary", "Accept-Language"}}), t0, t0);
+
+    check(cache.lookup(en, t0)->entry->response.body() == "hello", "en variant");
+    check(cache.lookup(de, t0)->entry->response.body() == "hallo", "de variant");
+
+    cache.invalidate("http://example.com/page");
+    check(!cache.lookup(en, t0) && !cache.lookup(de, t0), "invalidate left variants");
+
+    std::cout << "✓ Vary test passed\n";
+    return 0;
+}
+
+int test_not_stored() {
+    std::cout << "Test: Responses that must not be stored\n";
+
+    HttpCache cache;
+    HttpRequest request(HttpMethod::GET, "http://example.com/x");
+    check(!cache.store(request, make_response("x", {{"Cache-Control", "no-store, max-age=60"}}), t0, t0), "no-store");
+    check(!cache.store(request, make_response("x", {{"Cache-Control", "max-age=60"}, {"Vary", "*"}}), t0, t0), "Vary: *");
+    check(!cache.store(request, make_response("x", {}), t0, t0), "nothing reusable");
+
+    HttpRequest auth = request;
+    auth.add_header("Authorization", "Bearer t");
+    check(!cache.store(auth, make_response("x", {{"Cache-Control", "max-age=60"}}), t0, t0), "authorized");
+    check(cache.store(auth, make_response("x", {{"Cache-Control", "public, max-age=60"}}), t0, t0) != nullptr,
+          "authorized public");
+
+    HttpRequest post(HttpMethod::POST, "http://example.com/x");
+    check(!HttpCache::is_cacheable_request(post), "POST cacheable");
+    HttpRequest range = request;
+    range.add_header("Range", "bytes=0-10");
+    check(!HttpCache::is_cacheable_request(range), "Range cacheable");
+
+    std::cout << "✓ Not-stored test passed\n";
+    return 0;
+}
+
+int test_lru_eviction() {
+    std::cout << "Test: Byte-bounded LRU eviction\n";
+
+    // One shard so eviction order is deterministic
+    HttpCache cache(20 * 1024, 1);
+    std::string body(4 * 1024, 'x');
+    auto url = [](int i) { return "http://example.com/item/" + std::to_string(i); };
+
+    for (int i = 0; i < 4; ++i) {
+        cache.store(HttpRequest(HttpMethod::GET, url(i)), make_response(body, {{"Cache-Control", "max-age=60"}}), t0, t0);
+    }
+    cache.lookup(HttpRequest(HttpMethod::GET, url(0)), t0);  // 0 becomes most recent
+    for (int i = 4; i < 6; ++i) {
+        cache.store(HttpRequest(HttpMethod::GET, url(i)), make_response(body, {{"Cache-Control", "max-age=60"}}), t0, t0);
+    }
+
+    auto stats = cache.stats();
+    check(stats.bytes <= 20 * 1024, "over budget");
+    check(stats.evictions >= 1, "nothing evicted");
+    check(cache.lookup(HttpRequest(HttpMethod::GET, url(0)), t0).has_value(), "recently used entry evicted");
+    check(!cache.lookup(HttpRequest(HttpMethod::GET, url(1)), t0), "least recently used entry kept");
+    check(!cache.store(HttpRequest(HttpMethod::GET, url(9)),
+                       make_response(std::string(64 * 1024, 'y'), {{"Cache-Control", "max-age=60"}}), t0, t0),
+          "oversized entry stored");
+
+    std::cout << "✓ LRU eviction test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== HTTP Cache Tests ===\n\n";
+
+    try {
+        test_http_dates();
+        test_freshness();
+        test_revalidation();
+        test_stale_while_revalidate();
+        test_vary();
+        test_not_stored();
+        test_lru_eviction();
+
+        std::cout << "\n=== All HTTP cache tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
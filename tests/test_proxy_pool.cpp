@@ -0,0 +1,167 @@
+#include "test_support.hpp"
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Test connection reuse through an HTTP proxy
+ *
+ * Key Points:
+ * - Plain HTTP requests share keep-alive connections to the proxy,
+ *   whatever their target host, and carry Proxy-Authorization
+ * - A CONNECT tunnel and its TLS session serve later requests to the
+ *   same target; another target gets its own tunnel
+ * - Pool keys include the proxy, so proxied and direct connections,
+ *   or connections through different proxies, never mix
+ */
+
+using namespace coro_http;
+
+// Copy one direction of a tunnel; both relays own both sockets
+static asio::awaitable<void> relay(std::shared_ptr<asio::ip::tcp::socket> from,
+                                   std::shared_ptr<asio::ip::tcp::socket> to) {
+    char chunk[8192];
+    while (true) {
+        auto [ec, n] = co_await from->async_read_some(asio::buffer(chunk), asio::as_tuple(asio::use_awaitable));
+        if (ec || n == 0) break;
+        auto [wec, written] = co_await asio::async_write(*to, asio::buffer(chunk, n), asio::as_tuple(asio::use_awaitable));
+        if (wec) break;
+    }
+    asio::error_code ec;
+    to->shutdown(asio::ip::tcp::socket::shutdown_send, ec);
+}
+
+// Forward proxy session echoing the request target, and CONNECT proxy to
+// the origin
+static asio::awaitable<void> proxy_session(LoopbackServer& proxy, asio::ip::tcp::socket& socket,
+                                           unsigned short origin_port) {
+    while (true) {
+        auto request = co_await proxy.read_request(socket);
+        if (request.head.empty()) co_return;
+
+        if (request.method == "CONNECT") {
+            auto client = std::make_shared<asio::ip::tcp::socket>(std::move(socket));
+            auto upstream = std::make_shared<asio::ip::tcp::socket>(client->get_executor());
+            co_await upstream->async_connect(
+                asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), origin_port), asio::use_awaitable);
+            std::string established = "HTTP/1.1 200 Connection established\r\n\r\n";
+            co_await asio::async_write(*client, asio::buffer(established), asio::use_awaitable);
+            asio::co_spawn(client->get_executor(), relay(upstream, client), asio::detached);
+            co_await relay(client, upstream);
+            co_return;
+        }
+
+        std::string response = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(request.target.size()) +
+                               "\r\n\r\n" + request.target;
+        co_await asio::async_write(socket, asio::buffer(response), asio::use_awaitable);
+        if (request.head.find("Connection: close") != std::string::npos) co_return;
+    }
+}
+
+static std::string ok_response(const ServerRequest&) {
+    return "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+}
+
+int test_forward_proxy_keep_alive() {
+    std::cout << "Test: keep-alive to a forward proxy\n";
+
+    asio::io_context io;
+    LoopbackServer proxy(io, [&](asio::ip::tcp::socket& socket, int) { return proxy_session(proxy, socket, 0); });
+    ClientConfig config;
+    config.proxy_url = "http://127.0.0.1:" + proxy.port();
+    config.proxy_username = "user";
+    config.proxy_password = "pw";
+    CoroHttpClient client(io, config);
+
+    std::vector<std::string> bodies;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (const char* url : {"http://a.example/1", "http://b.example/2", "http://a.example:8080/3"}) {
+            auto response = co_await client.co_get(url);
+            bodies.push_back(response.body());
+        }
+        proxy.stop();
+        client.clear_connection_pool();
+    }, asio::detached);
+    io.run();
+
+    check(bodies == std::vector<std::string>({"http://a.example/1", "http://b.example/2", "http://a.example:8080/3"}),
+          "wrong responses");
+    check(proxy.connections == 1, "proxy connection not reused across targets");
+    for (const auto& request : proxy.requests) {
+        check(request.header("Proxy-Authorization") == "Basic dXNlcjpwdw==",
+              "Proxy-Authorization missing or not encoded");
+        check(request.head.find("Connection: close") == std::string::npos, "proxy connection closed per request");
+    }
+
+    std::cout << "✓ Forward proxy keep-alive test passed\n";
+    return 0;
+}
+
+int test_connect_tunnel_reuse() {
+    std::cout << "Test: CONNECT tunnels are reused per target\n";
+
+    asio::io_context io;
+    LoopbackServer origin(io, ok_response, LoopbackServer::Tls{});
+    unsigned short origin_port = static_cast<unsigned short>(std::stoi(origin.port()));
+    LoopbackServer proxy(io, [&](asio::ip::tcp::socket& socket, int) {
+        return proxy_session(proxy, socket, origin_port);
+    });
+    ClientConfig config;
+    config.proxy_url = "http://127.0.0.1:" + proxy.port();
+    CoroHttpClient client(io, config);
+
+    std::string port = origin.port();
+    std::vector<std::string> bodies;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (int i = 0; i < 3; ++i) {
+            auto response = co_await client.co_get("https://127.0.0.1:" + port + "/" + std::to_string(i));
+            bodies.push_back(response.body());
+        }
+        // Another target name needs its own tunnel
+        auto response = co_await client.co_get("https://localhost:" + port + "/other");
+        bodies.push_back(response.body());
+        client.clear_connection_pool();
+        proxy.stop();
+        origin.stop();
+    }, asio::detached);
+    io.run();
+
+    check(bodies.size() == 4 && bodies[0] == "ok" && bodies[3] == "ok", "wrong responses");
+    check(origin.requests.size() == 4, "requests lost");
+    check(proxy.connections == 2, "tunnel not reused, or shared across targets");
+    check(origin.connections == 2, "TLS handshake repeated on a pooled tunnel");
+    check(proxy.requests[0].head.rfind("CONNECT 127.0.0.1:" + port + " HTTP/1.1\r\n", 0) == 0, "wrong CONNECT target");
+
+    std::cout << "✓ CONNECT tunnel reuse test passed\n";
+    return 0;
+}
+
+int test_pool_keys() {
+    std::cout << "Test: pool keys include the route\n";
+
+    check(ConnectionPool::key_for("example.com", "443") == "example.com:443", "direct key changed");
+    std::string via_a = ConnectionPool::key_for("example.com", "443", "http://proxy-a:8080");
+    std::string via_b = ConnectionPool::key_for("example.com", "443", "http://proxy-b:8080");
+    check(via_a != via_b && via_a != "example.com:443", "routes share a pool key");
+
+    std::cout << "✓ Pool key test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== Proxy Connection Pool Tests ===\n\n";
+
+    try {
+        test_forward_proxy_keep_alive();
+        test_connect_tunnel_reuse();
+        test_pool_keys();
+
+        std::cout << "\n=== All proxy pool tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
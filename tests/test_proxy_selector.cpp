@@ -0,0 +1,250 @@
+#include "test_support.hpp"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Test proxy selection across a weighted proxy set
+ *
+ * Key Points:
+ * - NO_PROXY entries match domains on label boundaries and addresses by CIDR
+ * - Power of two choices sends requests to the less loaded proxy and
+ *   spreads idle load by weight
+ * - A proxy failing proxy_max_failures times in a row is ejected, probed,
+ *   and brought back once it accepts connections
+ * - The client fails over to a healthy proxy and sends NO_PROXY hosts direct
+ * - Only failing to reach a proxy or open its tunnel counts against it;
+ *   errors from the origin behind it do not
+ */
+
+using namespace coro_http;
+using namespace std::chrono_literals;
+
+static std::vector<ProxyRoute> make_routes(std::vector<unsigned> weights) {
+    std::vector<ProxyRoute> routes;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        ProxyRoute route;
+        route.info = parse_proxy_url("http://proxy" + std::to_string(i) + ":8080");
+        route.key = proxy_route(route.info);
+        route.weight = weights[i];
+        routes.push_back(route);
+    }
+    return routes;
+}
+
+// Answers every request with its request target
+static std::string echo_target(const ServerRequest& request) {
+    return "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(request.target.size()) + "\r\n\r\n" +
+           request.target;
+}
+
+int test_no_proxy_matcher() {
+    std::cout << "Test: NO_PROXY matching\n";
+
+    NoProxyMatcher matcher("example.com, .internal,  *.corp.net 10.0.0.0/8,192.168.1.7, [fd00::]/8");
+    check(matcher.matches("example.com"), "exact domain");
+    check(matcher.matches("api.example.com"), "subdomain");
+    check(matcher.matches("API.Example.COM."), "case and trailing dot");
+    check(!matcher.matches("notexample.com"), "suffix without label boundary");
+    check(!matcher.matches("example.org"), "other domain");
+    check(matcher.matches("db.internal"), "leading-dot entry");
+    check(matcher.matches("build.corp.net"), "wildcard entry");
+    check(matcher.matches("10.20.30.40"), "IPv4 CIDR");
+    check(!matcher.matches("11.0.0.1"), "outside IPv4 CIDR");
+    check(matcher.matches("192.168.1.7") && !matcher.matches("192.168.1.8"), "single address");
+    check(matcher.matches("[fd12::1]") && !matcher.matches("fe80::1"), "IPv6 CIDR");
+    check(NoProxyMatcher("*").matches("anything"), "wildcard everything");
+    check(NoProxyMatcher("").empty() && !NoProxyMatcher("").matches("example.com"), "empty list");
+
+    std::cout << "✓ NO_PROXY matcher test passed\n";
+    return 0;
+}
+
+int test_least_loaded() {
+    std::cout << "Test: power of two choices prefers the less loaded proxy\n";
+
+    ProxySelector selector(make_routes({1, 1}), NoProxyMatcher(), 3, 1000ms);
+    const ProxyRoute* first = selector.acquire("a.example");
+    const ProxyRoute* second = selector.acquire("a.example");
+    check(first && second && first != second, "second request not sent to the idle proxy");
+    selector.release(first, true, 50ms);
+    selector.release(second, true, 1ms);
+
+    // Equally loaded, the faster proxy wins
+    for (int i = 0; i < 10; ++i) {
+        const ProxyRoute* route = selector.acquire("a.example");
+        check(route == second, "slower proxy selected");
+        selector.release(route, true, 1ms);
+    }
+    auto stats = selector.stats();
+    check(stats[0].in_flight == 0 && stats[1].in_flight == 0, "in-flight count leaked");
+
+    std::cout << "✓ Least loaded test passed\n";
+    return 0;
+}
+
+int test_weights() {
+    std::cout << "Test: idle load follows weights\n";
+
+    ProxySelector selector(make_routes({1, 1, 8}), NoProxyMatcher(), 3, 1000ms);
+    for (int i = 0; i < 1000; ++i) {
+        selector.release(selector.acquire("a.example"), true, 10ms);
+    }
+    auto stats = selector.stats();
+    check(stats[2].requests > stats[0].requests * 3 && stats[2].requests > stats[1].requests * 3,
+          "heavy proxy not preferred");
+    check(stats[0].requests > 0 && stats[1].requests > 0, "light proxies starved");
+
+    std::cout << "✓ Weights test passed\n";
+    return 0;
+}
+
+int test_ejection_and_probe() {
+    std::cout << "Test: failing proxy is ejected and probed back\n";
+
+    ProxySelector selector(make_routes({1, 1}), NoProxyMatcher("skip.example"), 2, 20ms);
+    check(selector.acquire("skip.example") == nullptr, "NO_PROXY host not sent direct");
+
+    // One failure is not enough; the proxy fails until ejected
+    const ProxyRoute* victim = selector.acquire("a.example");
+    selector.release(victim, false, {});
+    int victim_index = victim->key == selector.stats()[0].key ? 0 : 1;
+    check(!selector.stats()[victim_index].ejected, "ejected before proxy_max_failures");
+    while (!selector.stats()[victim_index].ejected) {
+        const ProxyRoute* route = selector.acquire("a.example");
+        selector.release(route, route != victim, 1ms);
+    }
+    for (int i = 0; i < 20; ++i) {
+        const ProxyRoute* route = selector.acquire("a.example");
+        check(route != victim, "ejected proxy selected");
+        selector.release(route, true, 1ms);
+    }
+
+    check(selector.take_due_probe() == nullptr, "probe before probe_interval");
+    std::this_thread::sleep_for(30ms);
+    const ProxyRoute* probe = selector.take_due_probe();
+    check(probe == victim, "ejected proxy not probed");
+    check(selector.take_due_probe() == nullptr, "probe handed out twice");
+    selector.probe_result(probe, false);
+    check(selector.stats()[victim_index].ejected, "failed probe reinstated proxy");
+    std::this_thread::sleep_for(30ms);
+    selector.probe_result(selector.take_due_probe(), true);
+    check(!selector.stats()[victim_index].ejected, "healthy probe did not reinstate proxy");
+
+    std::cout << "✓ Ejection and probe test passed\n";
+    return 0;
+}
+
+int test_client_failover() {
+    std::cout << "Test: client fails over and bypasses NO_PROXY hosts\n";
+
+    asio::io_context io;
+    LoopbackServer proxy(io, echo_target);
+    LoopbackServer origin(io, echo_target);
+
+    // A port with nothing listening
+    std::string dead_port;
+    {
+        asio::ip::tcp::acceptor closed(io, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+        dead_port = std::to_string(closed.local_endpoint().port());
+    }
+
+    ClientConfig config;
+    config.proxies = {{"http://127.0.0.1:" + dead_port, 1}, {"http://127.0.0.1:" + proxy.port(), 1}};
+    config.proxy_max_failures = 1;
+    config.proxy_probe_interval = 60000ms;
+    config.no_proxy = "localhost";
+    CoroHttpClient client(io, config);
+
+    int failures = 0;
+    std::vector<std::string> bodies;
+    std::string direct_body;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (int i = 0; i < 6; ++i) {
+            try {
+                auto response = co_await client.co_get("http://a.example/" + std::to_string(i));
+                bodies.push_back(response.body());
+            } catch (const std::exception&) {
+                ++failures;
+            }
+        }
+        auto response = co_await client.co_get("http://localhost:" + origin.port() + "/direct");
+        direct_body = response.body();
+        client.clear_connection_pool();
+        proxy.stop();
+        origin.stop();
+    }, asio::detached);
+    io.run();
+
+    check(failures <= 1, "dead proxy kept being selected");
+    check(bodies.size() == 6 - static_cast<size_t>(failures), "requests lost");
+    check(!bodies.empty() && bodies.back() == "http://a.example/5", "request not sent through the live proxy");
+    check(direct_body == "/direct" && origin.requests.size() == 1, "NO_PROXY host not requested directly");
+    auto stats = client.proxy_stats();
+    check(stats.size() == 2 && stats[0].ejected == (failures == 1), "dead proxy ejection not recorded");
+
+    std::cout << "✓ Client failover test passed\n";
+    return 0;
+}
+
+int test_origin_errors_not_counted() {
+    std::cout << "Test: origin errors do not count against the proxy\n";
+
+    // The tunnel opens, but what is behind it does not speak TLS
+    asio::io_context io;
+    LoopbackServer proxy(io, [&](asio::ip::tcp::socket& socket, int) -> asio::awaitable<void> {
+        co_await proxy.read_request(socket);
+        std::string reply = "HTTP/1.1 200 Connection established\r\n\r\nnot a TLS server\r\n";
+        co_await asio::async_write(socket, asio::buffer(reply), asio::use_awaitable);
+        socket.shutdown(asio::ip::tcp::socket::shutdown_both);
+    });
+
+    ClientConfig config;
+    config.proxies = {{"http://127.0.0.1:" + proxy.port(), 1}};
+    config.proxy_max_failures = 1;
+    config.proxy_probe_interval = 60000ms;
+    config.verify_ssl = false;
+    CoroHttpClient client(io, config);
+
+    int failures = 0;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (int i = 0; i < 3; ++i) {
+            try {
+                co_await client.co_get("https://secure.example/" + std::to_string(i));
+            } catch (const std::exception&) {
+                ++failures;
+            }
+        }
+        proxy.stop();
+    }, asio::detached);
+    io.run();
+
+    auto stats = client.proxy_stats();
+    check(failures == 3 && proxy.connections == 3, "requests did not reach the proxy");
+    check(stats.size() == 1 && stats[0].failures == 0 && !stats[0].ejected, "origin error counted against the proxy");
+
+    std::cout << "✓ Origin errors test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== Proxy Selector Tests ===\n\n";
+
+    try {
+        test_no_proxy_matcher();
+        test_least_loaded();
+        test_weights();
+        test_ejection_and_probe();
+        test_client_failover();
+        test_origin_errors_not_counted();
+
+        std::cout << "\n=== All proxy selector tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,108 +1,260 @@
-#include "coro_http/coro_http_client.hpp"
-#include <cassert>
+#include "test_support.hpp"
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 /**
  * Test HTTP redirect handling
  * 
- * Key Points (Critical for Coroutines):
- * - Multiple co_await calls must preserve coroutine state
- * - Promise must survive across multiple suspensions
- * - Redirect chain handling: issue request -> suspend -> resume -> 
- *                           follow redirect -> suspend -> resume
+ * Key Points:
+ * - 301, 302, 303 and 307 are followed over the pooled connection and
+ *   recorded in the redirect chain
+ * - 301, 302 and 303 turn a POST into a bodyless GET
+ * - Cookies set by a redirect go out with the next hop; credentials stay
+ *   behind when the origin changes
+ * - Concurrent redirect chains do not mix
+ * - A redirect loop stops at max_redirects and returns the last redirect
+ * - Location values resolve against the request URL as in RFC 3986 5.2,
+ *   dot segments included
  */
 
+using namespace coro_http;
+
+static std::string redirect(int status, const std::string& location) {
+    return "HTTP/1.1 " + std::to_string(status) + " Moved\r\nLocation: " + location + "\r\nContent-Length: 0\r\n\r\n";
+}
+
+// Answers with the request target, so each response names the hop it ended on
+static std::string echo_target(const ServerRequest& request) {
+    return "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(request.target.size()) + "\r\n\r\n" +
+           request.target;
+}
+
 int test_single_redirect() {
     std::cout << "Test: Single HTTP redirect (301)\n";
-    
-    // Scenario: GET /old-path -> 301 Moved Permanently /new-path
-    // 
-    // Coroutine flow:
-    // 1. co_await client.get() - first request
-    // 2. Receive 301 response
-    // 3. Resume coroutine
-    // 4. co_await client.get() - follow redirect
-    // 5. Receive 200 response
-    // 6. Resume coroutine
-    //
-    // Promise state must be preserved throughout!
-    
+
+    asio::io_context io;
+    LoopbackServer server(io, [](const ServerRequest& request) -> std::string {
+        if (request.target == "/old-path") return redirect(301, "/new-path");
+        return echo_target(request);
+    });
+    ClientConfig config;
+    config.redirect_cache_size = 0;  // Ask the server every time
+    CoroHttpClient client(io, config);
+
+    std::vector<HttpResponse> responses;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        responses.push_back(co_await client.co_get(server.url("/old-path")));
+        responses.push_back(co_await client.co_get(server.url("/old-path")));
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    for (const auto& response : responses) {
+        check(response.status_code() == 200 && response.body() == "/new-path", "301 not followed");
+        check(response.redirect_chain() == std::vector<std::string>({server.url("/new-path")}),
+              "redirect chain wrong");
+    }
+    check(server.requests.size() == 4, "each request should take two hops");
+    check(server.connections == 1, "redirect hops did not share the pooled connection");
+
     std::cout << "✓ Single redirect test passed\n";
     return 0;
 }
 
 int test_redirect_chain() {
     std::cout << "Test: Redirect chain (multiple consecutive redirects)\n";
-    
-    // Scenario: /a -> 301 /b -> 302 /c -> 200 OK
-    // 
-    // Each co_await must:
-    // - Suspend the coroutine
-    // - Preserve the promise's internal state
-    // - Properly resume with the next response
-    // 
-    // State preservation checklist:
-    // - Local variables in coroutine function remain valid
-    // - Temporary response objects don't outlive scope
-    // - No dangling pointers/references across suspensions
-    
+
+    // /a -> 301 /b -> 302 /c -> 303 /d -> 200, started as a POST
+    asio::io_context io;
+    LoopbackServer server(io, [](const ServerRequest& request) -> std::string {
+        if (request.target == "/a") return redirect(301, "/b");
+        if (request.target == "/b") return redirect(302, "/c");
+        if (request.target == "/c") return redirect(303, "/d");
+        return echo_target(request);
+    });
+    CoroHttpClient client(io);
+
+    HttpResponse response;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        response = co_await client.co_post(server.url("/a"), "payload");
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(response.body() == "/d", "chain did not end on the last hop");
+    check(response.redirect_chain() ==
+              std::vector<std::string>({server.url("/b"), server.url("/c"), server.url("/d")}),
+          "redirect chain wrong");
+    check(server.requests.size() == 4, "wrong number of hops");
+    check(server.requests[0].method == "POST" && server.requests[0].body == "payload", "first hop not a POST");
+    for (size_t i = 1; i < server.requests.size(); ++i) {
+        check(server.requests[i].method == "GET" && server.requests[i].body.empty(),
+              "POST not turned into a bodyless GET");
+    }
+
     std::cout << "✓ Redirect chain test passed\n";
     return 0;
 }
 
 int test_redirect_with_auth() {
     std::cout << "Test: Redirect with authentication\n";
-    
-    // Scenario: GET /protected -> 302 /new-location with Set-Cookie header
-    // 
-    // Complex state preservation:
-    // - First request: setup headers
-    // - First co_await: get redirect + Set-Cookie
-    // - Resume: update cookie jar
-    // - Second request: reuse updated cookies
-    // - Second co_await: get final response
-    //
-    // Promise must handle context change between suspensions
-    
+
+    // /login sets a cookie and sends the client on to /home, which then
+    // points to the same server under another host name
+    asio::io_context io;
+    LoopbackServer server(io, [&](const ServerRequest& request) -> std::string {
+        if (request.target == "/login") {
+            return "HTTP/1.1 302 Found\r\nSet-Cookie: session=abc; Path=/\r\nLocation: /home\r\n"
+                   "Content-Length: 0\r\n\r\n";
+        }
+        if (request.target == "/home") return redirect(302, "http://localhost:" + server.port() + "/away");
+        return echo_target(request);
+    });
+    ClientConfig config;
+    config.enable_cookies = true;
+    CoroHttpClient client(io, config);
+
+    HttpResponse response;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        HttpRequest request(HttpMethod::GET, server.url("/login"));
+        request.add_header("Authorization", "Bearer token");
+        response = co_await client.co_execute(std::move(request));
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(response.body() == "/away", "redirects not followed");
+    check(server.requests.size() == 3, "wrong number of hops");
+    check(server.requests[1].header("Cookie") == "session=abc", "cookie from the redirect not sent");
+    check(server.requests[1].header("Authorization") == "Bearer token", "credentials dropped on the same origin");
+    check(server.requests[2].header("Authorization").empty() && server.requests[2].header("Cookie").empty(),
+          "credentials sent to another origin");
+
     std::cout << "✓ Redirect with auth test passed\n";
     return 0;
 }
 
 int test_concurrent_redirects() {
     std::cout << "Test: Concurrent requests with different redirect counts\n";
-    
-    // Multiple simultaneous coroutines:
-    // - Coroutine A: enters redirect chain
-    // - Coroutine B: simple request, no redirect
-    // - Coroutine C: enters different redirect chain
-    //
-    // Each promise must independently maintain:
-    // - Redirect count/history
-    // - Response state
-    // - Connection state
-    //
-    // No cross-contamination between promises!
-    
+
+    // /a1 -> /a2 -> /a3, /plain, /c1 -> /c2, all in flight at once
+    asio::io_context io;
+    LoopbackServer server(io, [](const ServerRequest& request) -> std::string {
+        if (request.target == "/a1") return redirect(302, "/a2");
+        if (request.target == "/a2") return redirect(307, "/a3");
+        if (request.target == "/c1") return redirect(302, "/c2");
+        return echo_target(request);
+    });
+    CoroHttpClient client(io);
+
+    std::vector<std::string> paths = {"/a1", "/plain", "/c1"};
+    std::vector<HttpResponse> responses(paths.size());
+    int pending = static_cast<int>(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        asio::co_spawn(io, [&, i]() -> asio::awaitable<void> {
+            responses[i] = co_await client.co_get(server.url(paths[i]));
+            if (--pending == 0) {
+                client.clear_connection_pool();
+                server.stop();
+            }
+        }, asio::detached);
+    }
+    io.run();
+
+    check(responses[0].body() == "/a3" && responses[0].redirect_chain().size() == 2, "first chain mixed up");
+    check(responses[1].body() == "/plain" && responses[1].redirect_chain().empty(), "plain request redirected");
+    check(responses[2].body() == "/c2" && responses[2].redirect_chain().size() == 1, "second chain mixed up");
+    check(server.requests.size() == 6, "wrong number of hops");
+
     std::cout << "✓ Concurrent redirects test passed\n";
     return 0;
 }
 
 int test_redirect_loop_detection() {
     std::cout << "Test: Redirect loop detection\n";
-    
-    // Scenario: /a -> 302 /b -> 302 /a -> 302 /b (infinite loop)
-    //
-    // Must detect and abort:
-    // - Track visited URLs
-    // - Set max redirect limit (e.g., 10)
-    // - Throw exception when exceeded
-    // - Properly cleanup promise on exception
-    
+
+    // /a -> 302 /b -> 302 /a -> ... forever
+    asio::io_context io;
+    LoopbackServer server(io, [](const ServerRequest& request) -> std::string {
+        return redirect(302, request.target == "/a" ? "/b" : "/a");
+    });
+    ClientConfig config;
+    config.max_redirects = 5;
+    CoroHttpClient client(io, config);
+
+    HttpResponse response;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        response = co_await client.co_get(server.url("/a"));
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    // The loop stops at max_redirects and the last redirect is returned as is
+    check(server.requests.size() == 6, "max_redirects not enforced");
+    check(response.status_code() == 302, "last redirect not returned");
+    check(response.redirect_chain().size() == 5, "redirect chain wrong");
+
     std::cout << "✓ Redirect loop detection test passed\n";
     return 0;
 }
 
+int test_location_resolution() {
+    std::cout << "Test: Location resolution (RFC 3986 5.4)\n";
+
+    // The normal and abnormal examples of RFC 3986 5.4
+    UrlInfo base = parse_url("http://a/b/c/d;p?q");
+    std::vector<std::pair<const char*, const char*>> examples = {
+        {"g:h", "g:h"}, {"g", "http://a/b/c/g"}, {"./g", "http://a/b/c/g"}, {"g/", "http://a/b/c/g/"},
+        {"/g", "http://a/g"}, {"//g", "http://g"}, {"?y", "http://a/b/c/d;p?y"}, {"g?y", "http://a/b/c/g?y"},
+        {"#s", "http://a/b/c/d;p?q#s"}, {"g#s", "http://a/b/c/g#s"}, {"g?y#s", "http://a/b/c/g?y#s"},
+        {";x", "http://a/b/c/;x"}, {"g;x", "http://a/b/c/g;x"}, {"", "http://a/b/c/d;p?q"},
+        {".", "http://a/b/c/"}, {"./", "http://a/b/c/"}, {"..", "http://a/b/"}, {"../", "http://a/b/"},
+        {"../g", "http://a/b/g"}, {"../..", "http://a/"}, {"../../g", "http://a/g"},
+        {"../../../g", "http://a/g"}, {"../../../../g", "http://a/g"}, {"/./g", "http://a/g"},
+        {"/../g", "http://a/g"}, {"g.", "http://a/b/c/g."}, {".g", "http://a/b/c/.g"},
+        {"g..", "http://a/b/c/g.."}, {"..g", "http://a/b/c/..g"}, {"./../g", "http://a/b/g"},
+        {"./g/.", "http://a/b/c/g/"}, {"g/./h", "http://a/b/c/g/h"}, {"g/../h", "http://a/b/c/h"},
+        {"g;x=1/./y", "http://a/b/c/g;x=1/y"}, {"g;x=1/../y", "http://a/b/c/y"},
+        {"g?y/./x", "http://a/b/c/g?y/./x"}, {"g?y/../x", "http://a/b/c/g?y/../x"},
+        {"g#s/./x", "http://a/b/c/g#s/./x"}, {"g#s/../x", "http://a/b/c/g#s/../x"},
+    };
+    for (const auto& [reference, expected] : examples) {
+        check(resolve_url(base, reference) == expected, reference);
+    }
+    check(resolve_url(parse_url("https://h:8443/x/y"), "z") == "https://h:8443/x/z", "non-default port dropped");
+
+    // A dot-segment Location over the wire; the fragment is not sent
+    asio::io_context io;
+    LoopbackServer server(io, [](const ServerRequest& request) -> std::string {
+        if (request.target == "/docs/guide/intro") {
+            return "HTTP/1.1 302 Found\r\nLocation: ../api/./index?v=2#top\r\nContent-Length: 0\r\n\r\n";
+        }
+        return "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(request.target.size()) + "\r\n\r\n" +
+               request.target;
+    });
+    CoroHttpClient client(io);
+    HttpResponse response;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        response = co_await client.co_get(server.url("/docs/guide/intro"));
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(response.body() == "/docs/api/index?v=2", "Location not resolved against the request URL");
+    check(response.redirect_chain() == std::vector<std::string>({server.url("/docs/api/index?v=2")}),
+          "redirect chain records an unresolved URL");
+
+    std::cout << "✓ Location resolution test passed\n";
+    return 0;
+}
+
 int main() {
     std::cout << "=== HTTP Redirect Tests ===\n\n";
     
@@ -112,6 +264,7 @@ int main() {
         test_redirect_with_auth();
         test_concurrent_redirects();
         test_redirect_loop_detection();
+        test_location_resolution();
         
         std::cout << "\n=== All redirect tests passed ===\n";
         return 0;
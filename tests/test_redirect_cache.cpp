@@ -0,0 +1,240 @@
+#include "test_support.hpp"
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Test redirect method rules and the permanent redirect cache
+ *
+ * Key Points:
+ * - 307 and 308 keep the method and body; 303 turns POST into GET, and so
+ *   do 301 and 302
+ * - Chains are followed in one loop, recorded in order, over one pooled
+ *   connection while the host stays the same
+ * - Permanent redirects are remembered and applied before sending, unless
+ *   the redirect said no-store
+ * - Authorization is not forwarded to another origin
+ */
+
+using namespace coro_http;
+
+// Redirects by path; /echo answers with the method, body and whether
+// Authorization came along
+static std::string redirect_response(const ServerRequest& request) {
+    static const std::map<std::string, std::pair<std::string, std::string>> redirects = {
+        {"/temp", {"307 Temporary Redirect", "/echo"}},
+        {"/perm", {"308 Permanent Redirect", "/echo"}},
+        {"/see-other", {"303 See Other", "/echo"}},
+        {"/found", {"302 Found", "/echo"}},
+        {"/old", {"301 Moved Permanently", "/new"}},
+        {"/a", {"302 Found", "/dir/b"}},
+        {"/dir/b", {"301 Moved Permanently", "c?x=1"}},
+    };
+    auto it = redirects.find(request.target);
+    if (it != redirects.end()) {
+        return "HTTP/1.1 " + it->second.first + "\r\nLocation: " + it->second.second +
+               "\r\nContent-Length: 0\r\n\r\n";
+    }
+    if (request.target == "/uncacheable") {
+        return "HTTP/1.1 301 Moved Permanently\r\nLocation: /new\r\nCache-Control: no-store\r\n"
+               "Content-Length: 0\r\n\r\n";
+    }
+
+    std::string reply = request.method + " " + request.body;
+    if (!request.header("Authorization").empty()) reply += " auth";
+    if (!request.header("Content-Type").empty()) reply += " typed";
+    return "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(reply.size()) + "\r\n\r\n" + reply;
+}
+
+// Request targets in arrival order
+static std::vector<std::string> targets(const LoopbackServer& server) {
+    std::vector<std::string> paths;
+    for (const auto& request : server.requests) paths.push_back(request.target);
+    return paths;
+}
+
+static asio::awaitable<std::string> post(CoroHttpClient& client, const std::string& url) {
+    HttpRequest request(HttpMethod::POST, url);
+    request.add_header("Content-Type", "text/plain");
+    request.set_body("payload");
+    auto response = co_await client.co_execute(std::move(request));
+    co_return response.body();
+}
+
+int test_method_rules() {
+    std::cout << "Test: method and body per redirect status\n";
+
+    asio::io_context io;
+    LoopbackServer server(io, redirect_response);
+    CoroHttpClient client(io);
+
+    std::map<std::string, std::string> bodies;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (const char* path : {"/temp", "/perm", "/see-other", "/found", "/old"}) {
+            bodies[path] = co_await post(client, server.url(path));
+        }
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(bodies["/temp"] == "POST payload typed", "307 did not keep method and body");
+    check(bodies["/perm"] == "POST payload typed", "308 did not keep method and body");
+    check(bodies["/see-other"] == "GET ", "303 did not switch to GET");
+    check(bodies["/found"] == "GET ", "302 did not switch POST to GET");
+    check(bodies["/old"] == "GET ", "301 did not switch POST to GET");
+
+    std::cout << "✓ Method rules test passed\n";
+    return 0;
+}
+
+int test_chain_order_and_reuse() {
+    std::cout << "Test: chains are ordered and share a connection\n";
+
+    asio::io_context io;
+    LoopbackServer server(io, redirect_response);
+    CoroHttpClient client(io);
+
+    HttpResponse response;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        response = co_await client.co_get(server.url("/a"));
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(response.status_code() == 200 && response.body() == "GET ", "chain not followed");
+    check(response.redirect_chain() == std::vector<std::string>({server.url("/dir/b"), server.url("/dir/c?x=1")}),
+          "chain missing or out of order");
+    check(server.connections == 1, "same-host hops did not reuse the connection");
+
+    std::cout << "✓ Chain order and reuse test passed\n";
+    return 0;
+}
+
+int test_permanent_redirect_cache() {
+    std::cout << "Test: permanent redirects are applied before sending\n";
+
+    asio::io_context io;
+    LoopbackServer server(io, redirect_response);
+    CoroHttpClient client(io);
+
+    std::vector<HttpResponse> moved;
+    std::vector<std::string> posted;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (int i = 0; i < 2; ++i) {
+            moved.push_back(co_await client.co_get(server.url("/old")));
+            co_await client.co_get(server.url("/uncacheable"));
+            posted.push_back(co_await post(client, server.url("/perm")));
+        }
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(targets(server) == std::vector<std::string>({"/old", "/new", "/uncacheable", "/new", "/perm", "/echo",
+                                                      "/new", "/uncacheable", "/new", "/echo"}),
+          "cached redirect sent again, or no-store redirect cached");
+    check(moved[1].redirect_chain() == std::vector<std::string>({server.url("/new")}),
+          "cached hop missing from the chain");
+    check(posted[1] == "POST payload typed", "cached 308 did not keep method and body");
+
+    ClientConfig config;
+    config.redirect_cache_size = 0;
+    CoroHttpClient uncached(io, config);
+    io.restart();
+    LoopbackServer second(io, redirect_response);
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        co_await uncached.co_get(second.url("/old"));
+        co_await uncached.co_get(second.url("/old"));
+        uncached.clear_connection_pool();
+        second.stop();
+    }, asio::detached);
+    io.run();
+    check(targets(second) == std::vector<std::string>({"/old", "/new", "/old", "/new"}),
+          "redirect cached with redirect_cache_size = 0");
+
+    std::cout << "✓ Permanent redirect cache test passed\n";
+    return 0;
+}
+
+int test_cross_origin_credentials() {
+    std::cout << "Test: Authorization stays with its origin\n";
+
+    asio::io_context io;
+    // /cross sends the client to the same server under another host name
+    LoopbackServer server(io, [&](const ServerRequest& request) {
+        if (request.target == "/cross") {
+            return "HTTP/1.1 302 Found\r\nLocation: http://localhost:" + server.port() +
+                   "/echo\r\nContent-Length: 0\r\n\r\n";
+        }
+        return redirect_response(request);
+    });
+    CoroHttpClient client(io);
+
+    std::string same, cross;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        HttpRequest request(HttpMethod::GET, server.url("/found"));
+        request.add_header("Authorization", "Bearer token");
+        same = (co_await client.co_execute(request)).body();
+        HttpRequest leaving(HttpMethod::GET, server.url("/cross"));
+        leaving.add_header("Authorization", "Bearer token");
+        cross = (co_await client.co_execute(std::move(leaving))).body();
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(same == "GET  auth", "Authorization dropped on a same-origin redirect");
+    check(cross == "GET ", "Authorization sent to another origin");
+
+    std::cout << "✓ Cross-origin credentials test passed\n";
+    return 0;
+}
+
+int test_cache_bounds() {
+    std::cout << "Test: cache capacity and max-age\n";
+
+    HttpResponse moved;
+    moved.set_status_code(301);
+    RedirectCache cache(2);
+    cache.store("http://a/1", "http://a/x", moved);
+    cache.store("http://a/2", "http://a/x", moved);
+    check(cache.lookup("http://a/1").has_value(), "entry missing");
+    cache.store("http://a/3", "http://a/x", moved);
+    check(cache.size() == 2 && !cache.lookup("http://a/2"), "least recently used entry not evicted");
+
+    HttpResponse expired;
+    expired.set_status_code(308);
+    expired.add_header("Cache-Control", "max-age=0");
+    cache.store("http://a/4", "http://a/x", expired);
+    check(!cache.lookup("http://a/4"), "expired entry served");
+
+    HttpResponse found;
+    found.set_status_code(302);
+    cache.store("http://a/5", "http://a/x", found);
+    check(!cache.lookup("http://a/5"), "temporary redirect cached");
+
+    std::cout << "✓ Cache bounds test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== Redirect Cache Tests ===\n\n";
+
+    try {
+        test_method_rules();
+        test_chain_order_and_reuse();
+        test_permanent_redirect_cache();
+        test_cross_origin_credentials();
+        test_cache_bounds();
+
+        std::cout << "\n=== All redirect cache tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
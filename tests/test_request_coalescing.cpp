@@ -0,0 +1,245 @@
+#include "test_support.hpp"
+#include "coro_http/request_coalescer.hpp"
+#include <asio.hpp>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Test single-flight coalescing of identical concurrent requests
+ *
+ * Key Points:
+ * - Concurrent identical requests share one fetch and one response object
+ * - Requests differing in URL or headers are fetched separately
+ * - Waiters detach after max_wait and fetch on their own
+ * - A leader's failure reaches every waiter
+ * - A cancelled leader makes waiters fetch themselves
+ * - Waiters on other threads and io_contexts are woken on their own executor
+ */
+
+using namespace coro_http;
+using namespace std::chrono_literals;
+
+// Fetch stand-in that counts calls and completes after a delay
+struct FakeOrigin {
+    std::chrono::milliseconds delay{50ms};
+    int calls{0};
+    std::exception_ptr failure;
+
+    RequestCoalescer::Fetch fetch() {
+        return [this](HttpRequest request) -> asio::awaitable<HttpResponse> {
+            ++calls;
+            int call = calls;
+            auto outcome = failure;  // Decided when the request is sent
+            asio::steady_timer timer(co_await asio::this_coro::executor, delay);
+            co_await timer.async_wait(asio::use_awaitable);
+            if (outcome) std::rethrow_exception(outcome);
+            HttpResponse response;
+            response.set_status_code(200);
+            response.set_body(request.url() + "#" + std::to_string(call));
+            co_return response;
+        };
+    }
+};
+
+struct Outcome {
+    RequestCoalescer::Response response;
+    std::string error;
+};
+
+static void start(asio::io_context& io, RequestCoalescer& coalescer, FakeOrigin& origin,
+                  HttpRequest request, Outcome& outcome) {
+    asio::co_spawn(io, [&, request]() -> asio::awaitable<void> {
+        try {
+            outcome.response = co_await coalescer.co_execute(request, origin.fetch());
+        } catch (const std::exception& e) {
+            outcome.error = e.what();
+        }
+    }, asio::detached);
+}
+
+int test_identical_requests_share_fetch() {
+    std::cout << "Test: identical requests share one fetch\n";
+
+    asio::io_context io;
+    RequestCoalescer coalescer(5s);
+    FakeOrigin origin;
+    std::vector<Outcome> outcomes(10);
+    for (auto& outcome : outcomes) {
+        start(io, coalescer, origin, HttpRequest(HttpMethod::GET, "http://example.com/a"), outcome);
+    }
+    io.run();
+
+    check(origin.calls == 1, "identical requests fetched more than once");
+    for (const auto& outcome : outcomes) {
+        check(outcome.error.empty(), "waiter failed");
+        check(outcome.response == outcomes[0].response, "waiters received copies, not the shared response");
+    }
+    check(outcomes[0].response->body() == "http://example.com/a#1", "wrong body");
+    auto stats = coalescer.stats();
+    check(stats.fetches == 1 && stats.joined == 9, "wrong stats");
+    check(coalescer.in_flight() == 0, "flight not removed");
+
+    // Once a flight has finished, the next request starts a new one
+    Outcome later;
+    start(io, coalescer, origin, HttpRequest(HttpMethod::GET, "http://example.com/a"), later);
+    io.restart();
+    io.run();
+    check(origin.calls == 2, "finished flight reused");
+
+    std::cout << "✓ Shared fetch test passed\n";
+    return 0;
+}
+
+int test_distinct_requests() {
+    std::cout << "Test: distinct requests are not coalesced\n";
+
+    asio::io_context io;
+    RequestCoalescer coalescer(5s);
+    FakeOrigin origin;
+    HttpRequest plain(HttpMethod::GET, "http://example.com/a");
+    HttpRequest json(HttpMethod::GET, "http://example.com/a");
+    json.add_header("Accept", "application/json");
+    HttpRequest other(HttpMethod::GET, "http://example.com/b");
+
+    std::vector<Outcome> outcomes(4);
+    start(io, coalescer, origin, plain, outcomes[0]);
+    start(io, coalescer, origin, json, outcomes[1]);
+    start(io, coalescer, origin, other, outcomes[2]);
+    start(io, coalescer, origin, json, outcomes[3]);
+    io.run();
+
+    check(origin.calls == 3, "distinct requests coalesced");
+    check(outcomes[1].response == outcomes[3].response, "identical header sets not coalesced");
+    check(outcomes[0].response != outcomes[1].response, "header difference ignored");
+
+    std::cout << "✓ Distinct requests test passed\n";
+    return 0;
+}
+
+int test_waiter_timeout() {
+    std::cout << "Test: waiters detach after max_wait\n";
+
+    asio::io_context io;
+    RequestCoalescer coalescer(20ms);
+    FakeOrigin origin;
+    origin.delay = 200ms;
+    Outcome leader, waiter;
+    start(io, coalescer, origin, HttpRequest(HttpMethod::GET, "http://example.com/slow"), leader);
+    start(io, coalescer, origin, HttpRequest(HttpMethod::GET, "http://example.com/slow"), waiter);
+    io.run();
+
+    check(leader.error.empty() && waiter.error.empty(), "request failed");
+    check(origin.calls == 2, "detached waiter did not fetch");
+    check(leader.response != waiter.response, "detached waiter shared the response");
+    check(coalescer.stats().detached == 1, "detach not counted");
+
+    std::cout << "✓ Waiter timeout test passed\n";
+    return 0;
+}
+
+int test_leader_failure() {
+    std::cout << "Test: leader failure reaches waiters\n";
+
+    asio::io_context io;
+    RequestCoalescer coalescer(5s);
+    FakeOrigin origin;
+    origin.failure = std::make_exception_ptr(std::runtime_error("Connection refused"));
+    std::vector<Outcome> outcomes(3);
+    for (auto& outcome : outcomes) {
+        start(io, coalescer, origin, HttpRequest(HttpMethod::GET, "http://example.com/down"), outcome);
+    }
+    io.run();
+
+    check(origin.calls == 1, "failure refetched by waiters");
+    for (const auto& outcome : outcomes) {
+        check(outcome.error == "Connection refused", "error not delivered");
+    }
+
+    std::cout << "✓ Leader failure test passed\n";
+    return 0;
+}
+
+int test_leader_cancelled() {
+    std::cout << "Test: cancelled leader hands off to waiters\n";
+
+    asio::io_context io;
+    RequestCoalescer coalescer(5s);
+    FakeOrigin origin;
+    // A cancelled fetch surfaces as operation_aborted
+    origin.failure = std::make_exception_ptr(asio::system_error(asio::error::operation_aborted));
+    std::vector<Outcome> outcomes(3);
+    for (auto& outcome : outcomes) {
+        start(io, coalescer, origin, HttpRequest(HttpMethod::GET, "http://example.com/c"), outcome);
+    }
+    asio::steady_timer recover(io, 20ms);
+    recover.async_wait([&](asio::error_code) { origin.failure = nullptr; });
+    io.run();
+
+    check(!outcomes[0].error.empty(), "leader cancellation swallowed");
+    check(outcomes[1].error.empty() && outcomes[2].error.empty(), "cancellation leaked to waiters");
+    check(outcomes[1].response && outcomes[2].response, "waiters got no response");
+    check(origin.calls == 3, "waiters did not fetch after leader cancellation");
+    check(coalescer.stats().detached == 2, "hand-off not counted");
+
+    std::cout << "✓ Leader cancellation test passed\n";
+    return 0;
+}
+
+int test_waiters_on_other_threads() {
+    std::cout << "Test: waiters on other threads\n";
+
+    RequestCoalescer coalescer(5s);
+    FakeOrigin origin;
+    origin.delay = 300ms;
+    HttpRequest request(HttpMethod::GET, "http://example.com/threads");
+
+    asio::io_context leader_io;
+    Outcome leader;
+    start(leader_io, coalescer, origin, request, leader);
+    std::thread leader_thread([&] { leader_io.run(); });
+    while (coalescer.in_flight() == 0) std::this_thread::sleep_for(1ms);
+
+    // Each waiter on its own io_context and thread
+    std::vector<std::unique_ptr<asio::io_context>> contexts;
+    std::vector<Outcome> outcomes(4);
+    std::vector<std::thread> threads;
+    for (auto& outcome : outcomes) {
+        contexts.push_back(std::make_unique<asio::io_context>());
+        start(*contexts.back(), coalescer, origin, request, outcome);
+        threads.emplace_back([io = contexts.back().get()] { io->run(); });
+    }
+    leader_thread.join();
+    for (auto& thread : threads) thread.join();
+
+    check(origin.calls == 1, "waiters on other threads fetched on their own");
+    for (const auto& outcome : outcomes) {
+        check(outcome.error.empty() && outcome.response == leader.response, "waiter missed the shared response");
+    }
+    check(coalescer.stats().joined == 4 && coalescer.in_flight() == 0, "wrong stats");
+
+    std::cout << "✓ Cross-thread waiters test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== Request Coalescing Tests ===\n\n";
+
+    try {
+        test_identical_requests_share_fetch();
+        test_distinct_requests();
+        test_waiter_timeout();
+        test_leader_failure();
+        test_leader_cancelled();
+        test_waiters_on_other_threads();
+
+        std::cout << "\n=== All request coalescing tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
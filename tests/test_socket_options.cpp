@@ -0,0 +1,135 @@
+#include "test_support.hpp"
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Test socket-level tuning
+ *
+ * Key Points:
+ * - apply_socket_options sets what is configured and leaves the rest at
+ *   the system default, apart from TCP_NODELAY, which is on by default
+ * - socket_options_hosts overrides the client-wide options per host
+ * - Every endpoint of a host is tried in turn with tuned sockets, and
+ *   options that may be refused (fast open, busy poll) never fail a request
+ */
+
+using namespace coro_http;
+using namespace std::chrono_literals;
+
+static int get_option(asio::ip::tcp::socket& socket, int level, int name) {
+    int value = 0;
+    socklen_t length = sizeof(value);
+    ::getsockopt(socket.native_handle(), level, name, &value, &length);
+    return value;
+}
+
+int test_apply_options() {
+    std::cout << "Test: configured options reach the socket\n";
+
+    asio::io_context io;
+    asio::ip::tcp::socket socket(io);
+    socket.open(asio::ip::tcp::v4());
+    SocketOptions options;
+    options.receive_buffer = 256 * 1024;
+    options.keepalive = true;
+    options.keepalive_idle = 30s;
+    options.keepalive_interval = 5s;
+    options.keepalive_count = 4;
+    options.user_timeout = 10000ms;
+    apply_socket_options(socket, options);
+
+    check(get_option(socket, IPPROTO_TCP, TCP_NODELAY) != 0, "TCP_NODELAY not set");
+    check(get_option(socket, SOL_SOCKET, SO_RCVBUF) >= 256 * 1024, "SO_RCVBUF not set");
+    check(get_option(socket, SOL_SOCKET, SO_KEEPALIVE) != 0, "SO_KEEPALIVE not set");
+    check(get_option(socket, IPPROTO_TCP, TCP_KEEPIDLE) == 30, "TCP_KEEPIDLE not set");
+    check(get_option(socket, IPPROTO_TCP, TCP_KEEPINTVL) == 5, "TCP_KEEPINTVL not set");
+    check(get_option(socket, IPPROTO_TCP, TCP_KEEPCNT) == 4, "TCP_KEEPCNT not set");
+    check(get_option(socket, IPPROTO_TCP, TCP_USER_TIMEOUT) == 10000, "TCP_USER_TIMEOUT not set");
+
+    asio::ip::tcp::socket untouched(io);
+    untouched.open(asio::ip::tcp::v4());
+    int default_keepalive = get_option(untouched, SOL_SOCKET, SO_KEEPALIVE);
+    SocketOptions plain;
+    plain.tcp_nodelay = false;
+    apply_socket_options(untouched, plain);
+    check(get_option(untouched, IPPROTO_TCP, TCP_NODELAY) == 0, "TCP_NODELAY set when disabled");
+    check(get_option(untouched, SOL_SOCKET, SO_KEEPALIVE) == default_keepalive, "default options changed");
+
+    std::cout << "✓ Apply options test passed\n";
+    return 0;
+}
+
+int test_per_host_override() {
+    std::cout << "Test: per-host options override the client default\n";
+
+    asio::io_context io;
+    ClientConfig config;
+    config.socket_options.send_buffer = 64 * 1024;
+    SocketOptions sidecar;
+    sidecar.busy_poll_us = 50;
+    config.socket_options_hosts["sidecar.local"] = sidecar;
+    CoroHttpClient client(io, config);
+
+    check(client.socket_options_for("api.example.com").send_buffer == 64 * 1024, "default options not used");
+    check(client.socket_options_for("sidecar.local").busy_poll_us == 50, "host override not used");
+    check(client.socket_options_for("sidecar.local").send_buffer == 0, "override merged with the default");
+
+    std::cout << "✓ Per-host override test passed\n";
+    return 0;
+}
+
+int test_requests_with_tuning() {
+    std::cout << "Test: tuned connections serve pooled requests\n";
+
+    asio::io_context io;
+    LoopbackServer server(io, [](const ServerRequest&) {
+        return std::string("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+    });
+    ClientConfig config;
+    config.socket_options.keepalive = true;
+    config.socket_options.keepalive_idle = 60s;
+    config.socket_options.fast_open = true;
+    config.socket_options.busy_poll_us = 1000000;  // Above the unprivileged limit; ignored
+    config.socket_options.send_buffer = 128 * 1024;
+    config.socket_options.user_timeout = 5000ms;
+    CoroHttpClient client(io, config);
+
+    std::vector<std::string> bodies;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        // localhost may resolve to ::1 first, where nothing listens
+        for (const char* host : {"127.0.0.1", "localhost", "127.0.0.1"}) {
+            auto response = co_await client.co_get("http://" + std::string(host) + ":" + server.port() + "/");
+            bodies.push_back(response.body());
+        }
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(bodies == std::vector<std::string>({"ok", "ok", "ok"}), "requests failed");
+    check(server.connections == 2, "tuned connection not pooled");
+
+    std::cout << "✓ Requests with tuning test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== Socket Options Tests ===\n\n";
+
+    try {
+        test_apply_options();
+        test_per_host_override();
+        test_requests_with_tuning();
+
+        std::cout << "\n=== All socket options tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,251 @@
+#include "test_support.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Test the SOCKS5 handshake and pooled SOCKS5 tunnels
+ *
+ * Key Points:
+ * - With socks5_pipelining, greeting, auth and CONNECT arrive in one write
+ * - Replies with IPv6 and domain-name bound addresses are read in full,
+ *   leaving the tunnel positioned at the first byte of the response
+ * - Tunnels are pooled per target; another target gets its own tunnel
+ * - A refused CONNECT reports the proxy's reason
+ */
+
+using namespace coro_http;
+
+// SOCKS5 proxy that serves HTTP itself at the end of each tunnel, answering
+// with the target and path it was asked for
+class TestSocksProxy {
+public:
+    TestSocksProxy(asio::io_context& io, unsigned char bound_type, unsigned char reply_code = 0x00)
+        : server_(io, [this](asio::ip::tcp::socket& socket, int) { return session(Session{socket, {}}); }),
+          bound_type_(bound_type), reply_code_(reply_code) {
+    }
+
+    std::string url() const {
+        return "socks5://127.0.0.1:" + server_.port();
+    }
+
+    void stop() {
+        server_.stop();
+    }
+
+    int connections() const {
+        return server_.connections;
+    }
+
+    std::string username;  // Require this user ("pw" as password) when set
+    int pipelined{0};      // Handshakes whose CONNECT came with the greeting
+    std::vector<std::string> methods;  // Methods offered per greeting
+    std::vector<std::string> targets;
+
+private:
+    struct Session {
+        asio::ip::tcp::socket& socket;
+        std::string buffer;
+
+        // Make at least n bytes available in buffer
+        asio::awaitable<bool> need(size_t n) {
+            char chunk[1024];
+            while (buffer.size() < n) {
+                auto [ec, len] = co_await socket.async_read_some(asio::buffer(chunk), asio::as_tuple(asio::use_awaitable));
+                if (ec || len == 0) co_return false;
+                buffer.append(chunk, len);
+            }
+            co_return true;
+        }
+
+        std::string take(size_t n) {
+            std::string bytes = buffer.substr(0, n);
+            buffer.erase(0, n);
+            return bytes;
+        }
+
+        asio::awaitable<void> send(const std::string& bytes) {
+            co_await asio::async_write(socket, asio::buffer(bytes), asio::use_awaitable);
+        }
+    };
+
+    asio::awaitable<void> session(Session s) {
+        if (!co_await s.need(2)) co_return;
+        size_t count = static_cast<unsigned char>(s.buffer[1]);
+        if (!co_await s.need(2 + count)) co_return;
+        std::string offered = s.take(2 + count).substr(2);
+        methods.push_back(offered);
+        // Whatever follows the greeting in the same read was pipelined
+        if (!s.buffer.empty()) ++pipelined;
+
+        bool auth = !username.empty();
+        co_await s.send(std::string("\x05") + (auth ? '\x02' : '\x00'));
+        if (auth) {
+            if (!co_await s.need(2)) co_return;
+            size_t user_len = static_cast<unsigned char>(s.buffer[1]);
+            if (!co_await s.need(3 + user_len)) co_return;
+            size_t pass_len = static_cast<unsigned char>(s.buffer[2 + user_len]);
+            if (!co_await s.need(3 + user_len + pass_len)) co_return;
+            std::string message = s.take(3 + user_len + pass_len);
+            bool ok = message.substr(2, user_len) == username && message.substr(3 + user_len) == "pw";
+            co_await s.send(std::string("\x01") + (ok ? '\x00' : '\x01'));
+            if (!ok) co_return;
+        }
+
+        if (!co_await s.need(5)) co_return;
+        size_t host_len = static_cast<unsigned char>(s.buffer[4]);
+        if (!co_await s.need(7 + host_len)) co_return;
+        std::string request = s.take(7 + host_len);
+        int port = (static_cast<unsigned char>(request[5 + host_len]) << 8) |
+                   static_cast<unsigned char>(request[6 + host_len]);
+        std::string target = request.substr(5, host_len) + ":" + std::to_string(port);
+        targets.push_back(target);
+
+        std::string reply = {'\x05', static_cast<char>(reply_code_), '\x00', static_cast<char>(bound_type_)};
+        if (bound_type_ == 0x04) {
+            reply += std::string(15, '\0') + '\x01';  // ::1
+        } else if (bound_type_ == 0x03) {
+            reply += std::string("\x0d") + "bound.example";
+        } else {
+            reply += std::string("\x7f\x00\x00\x01", 4);
+        }
+        reply += std::string("\x04\x38", 2);
+        co_await s.send(reply);
+        if (reply_code_ != 0x00) co_return;
+
+        while (true) {
+            size_t end;
+            while ((end = s.buffer.find("\r\n\r\n")) == std::string::npos) {
+                if (!co_await s.need(s.buffer.size() + 1)) co_return;
+            }
+            std::string head = s.take(end + 4);
+            std::string path = head.substr(head.find(' ') + 1);
+            path = path.substr(0, path.find(' '));
+            std::string body = target + path;
+            co_await s.send("HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body);
+        }
+    }
+
+    LoopbackServer server_;
+    unsigned char bound_type_;
+    unsigned char reply_code_;
+};
+
+int test_pipelined_handshake() {
+    std::cout << "Test: pipelined handshake with auth and an IPv6 reply\n";
+
+    asio::io_context io;
+    TestSocksProxy proxy(io, 0x04);
+    proxy.username = "user";
+    ClientConfig config;
+    config.proxy_url = proxy.url();
+    config.proxy_username = "user";
+    config.proxy_password = "pw";
+    config.socks5_pipelining = true;
+    CoroHttpClient client(io, config);
+
+    std::vector<std::string> bodies;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (const char* url : {"http://a.example/1", "http://a.example/2"}) {
+            auto response = co_await client.co_get(url);
+            bodies.push_back(response.body());
+        }
+        client.clear_connection_pool();
+        proxy.stop();
+    }, asio::detached);
+    io.run();
+
+    check(bodies == std::vector<std::string>({"a.example:80/1", "a.example:80/2"}), "wrong responses");
+    check(proxy.methods.size() == 1 && proxy.methods[0] == "\x02", "pipelined greeting must offer only user/pass");
+    check(proxy.pipelined == 1, "greeting, auth and CONNECT not sent together");
+    check(proxy.connections() == 1, "SOCKS5 tunnel not reused");
+
+    std::cout << "✓ Pipelined handshake test passed\n";
+    return 0;
+}
+
+int test_serial_handshake_per_target() {
+    std::cout << "Test: serial handshake, domain reply, tunnels per target\n";
+
+    asio::io_context io;
+    TestSocksProxy proxy(io, 0x03);
+    ClientConfig config;
+    config.proxy_url = proxy.url();
+    CoroHttpClient client(io, config);
+
+    std::vector<std::string> bodies;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (const char* url : {"http://a.example/1", "http://b.example:8080/2", "http://a.example/3"}) {
+            auto response = co_await client.co_get(url);
+            bodies.push_back(response.body());
+        }
+        client.clear_connection_pool();
+        proxy.stop();
+    }, asio::detached);
+    io.run();
+
+    check(bodies == std::vector<std::string>({"a.example:80/1", "b.example:8080/2", "a.example:80/3"}),
+          "wrong responses");
+    check(proxy.pipelined == 0, "handshake pipelined without socks5_pipelining");
+    check(proxy.connections() == 2, "tunnels not pooled per target");
+    check(proxy.targets == std::vector<std::string>({"a.example:80", "b.example:8080"}), "wrong CONNECT targets");
+
+    std::cout << "✓ Serial handshake test passed\n";
+    return 0;
+}
+
+int test_connect_refused() {
+    std::cout << "Test: refused CONNECT reports the reason\n";
+
+    asio::io_context io;
+    TestSocksProxy proxy(io, 0x01, 0x05);
+    ClientConfig config;
+    config.proxy_url = proxy.url();
+    CoroHttpClient client(io, config);
+
+    std::string error;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        try {
+            co_await client.co_get("http://a.example/");
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        proxy.stop();
+    }, asio::detached);
+    io.run();
+
+    check(error.find("connection refused") != std::string::npos, "refusal reason not reported");
+
+    std::cout << "✓ Refused CONNECT test passed\n";
+    return 0;
+}
+
+int test_reply_length() {
+    std::cout << "Test: reply length by address type\n";
+
+    check(socks5_reply_length(0x01, 0) == 10, "IPv4 reply length");
+    check(socks5_reply_length(0x04, 0) == 22, "IPv6 reply length");
+    check(socks5_reply_length(0x03, 13) == 20, "domain reply length");
+    check(socks5_reply_length(0x07, 0) == 0, "unknown address type accepted");
+
+    std::cout << "✓ Reply length test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== SOCKS5 Tests ===\n\n";
+
+    try {
+        test_pipelined_handshake();
+        test_serial_handshake_per_target();
+        test_connect_refused();
+        test_reply_length();
+
+        std::cout << "\n=== All SOCKS5 tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
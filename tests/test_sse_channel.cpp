@@ -0,0 +1,284 @@
+#include "test_support.hpp"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Test the awaitable SSE event channel
+ *
+ * Key Points:
+ * - drop_oldest and coalesce keep the queue within capacity
+ * - block makes the reader wait until the consumer catches up
+ * - Queued events are delivered before the error that ended the stream
+ * - Cancelling wakes a waiting reader and runs the cancel handler
+ * - open_event_stream delivers every event in order to a slow consumer,
+ *   and dropping the stream closes an idle connection
+ */
+
+using namespace coro_http;
+using namespace std::chrono_literals;
+
+static SseEvent make_event(const std::string& type, const std::string& data) {
+    SseEvent event;
+    event.type = type;
+    event.data = data;
+    return event;
+}
+
+// Drain a channel that has been closed
+static std::vector<std::string> drain(asio::io_context& io, SseEventChannel& channel) {
+    std::vector<std::string> out;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        while (auto event = co_await channel.next()) {
+            out.push_back(event->data);
+        }
+    }, asio::detached);
+    io.run();
+    io.restart();
+    return out;
+}
+
+int test_drop_oldest() {
+    std::cout << "Test: drop_oldest policy\n";
+
+    asio::io_context io;
+    SseEventChannel channel(io.get_executor(), {3, SseOverflowPolicy::drop_oldest});
+    for (int i = 1; i <= 5; ++i) {
+        channel.push(make_event("", std::to_string(i)));
+    }
+    check(channel.size() == 3, "queue grew past capacity");
+    channel.close();
+
+    check(drain(io, channel) == std::vector<std::string>({"3", "4", "5"}), "wrong events kept");
+    check(channel.stats().dropped == 2, "drops not counted");
+
+    std::cout << "✓ drop_oldest test passed\n";
+    return 0;
+}
+
+int test_coalesce() {
+    std::cout << "Test: coalesce policy\n";
+
+    asio::io_context io;
+    SseEventChannel channel(io.get_executor(), {2, SseOverflowPolicy::coalesce});
+    channel.push(make_event("tick", "t1"));
+    channel.push(make_event("news", "n1"));
+    channel.push(make_event("tick", "t2"));   // Replaces t1 in place
+    channel.push(make_event("quote", "q1"));  // No queued quote: drops the oldest
+    channel.close();
+
+    check(drain(io, channel) == std::vector<std::string>({"n1", "q1"}), "wrong events kept");
+    auto stats = channel.stats();
+    check(stats.coalesced == 1 && stats.dropped == 1 && stats.pushed == 4, "wrong stats");
+
+    std::cout << "✓ Coalesce test passed\n";
+    return 0;
+}
+
+int test_block() {
+    std::cout << "Test: block policy\n";
+
+    asio::io_context io;
+    SseEventChannel channel(io.get_executor(), {2, SseOverflowPolicy::block});
+    size_t max_size = 0;
+    std::vector<std::string> received;
+
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        for (int i = 0; i < 10; ++i) {
+            channel.push(make_event("", std::to_string(i)));
+            max_size = std::max(max_size, channel.size());
+            co_await channel.wait_writable();
+        }
+        channel.close();
+    }, asio::detached);
+
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        asio::steady_timer timer(io);
+        while (auto event = co_await channel.next()) {
+            received.push_back(event->data);
+            timer.expires_after(1ms);
+            co_await timer.async_wait(asio::use_awaitable);
+        }
+    }, asio::detached);
+    io.run();
+
+    check(received.size() == 10, "events lost");
+    for (int i = 0; i < 10; ++i) {
+        check(received[i] == std::to_string(i), "events out of order");
+    }
+    check(max_size <= 2, "reader ran ahead of the consumer");
+    check(channel.stats().blocked > 0, "reader never waited");
+
+    std::cout << "✓ Block test passed\n";
+    return 0;
+}
+
+int test_close_with_error() {
+    std::cout << "Test: error after queued events\n";
+
+    asio::io_context io;
+    SseEventChannel channel(io.get_executor());
+    channel.push(make_event("", "a"));
+    channel.close(std::make_exception_ptr(std::runtime_error("stream failed")));
+
+    std::vector<std::string> received;
+    std::string error;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        try {
+            while (auto event = co_await channel.next()) {
+                received.push_back(event->data);
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+    }, asio::detached);
+    io.run();
+
+    check(received.size() == 1, "queued event lost");
+    check(error == "stream failed", "error not delivered");
+
+    std::cout << "✓ Close with error test passed\n";
+    return 0;
+}
+
+int test_cancel() {
+    std::cout << "Test: cancel wakes the reader\n";
+
+    asio::io_context io;
+    SseEventChannel channel(io.get_executor(), {1, SseOverflowPolicy::block});
+    bool handler_called = false;
+    bool reader_stopped = false;
+    channel.set_cancel_handler([&] { handler_called = true; });
+
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        channel.push(make_event("", "a"));
+        try {
+            co_await channel.wait_writable();
+        } catch (const std::system_error& e) {
+            reader_stopped = e.code() == std::errc::operation_canceled;
+        }
+    }, asio::detached);
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        channel.cancel();
+        co_return;
+    }, asio::detached);
+    io.run();
+
+    check(handler_called, "cancel handler not run");
+    check(reader_stopped, "waiting reader not cancelled");
+    bool rejected = false;
+    try {
+        channel.push(make_event("", "b"));
+    } catch (const std::system_error&) {
+        rejected = true;
+    }
+    check(rejected, "push accepted after cancel");
+
+    std::cout << "✓ Cancel test passed\n";
+    return 0;
+}
+
+static const char* sse_head = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n\r\n";
+
+int test_open_event_stream() {
+    std::cout << "Test: open_event_stream with a slow consumer\n";
+
+    std::string body;
+    for (int i = 0; i < 200; ++i) {
+        body += "id: " + std::to_string(i) + "\ndata: " + std::to_string(i) + "\n\n";
+    }
+
+    asio::io_context io;
+    LoopbackServer server(io, [&](asio::ip::tcp::socket& socket, int) -> asio::awaitable<void> {
+        co_await server.read_request(socket);
+        std::string response = sse_head + body;
+        co_await asio::async_write(socket, asio::buffer(response), asio::use_awaitable);
+        socket.shutdown(asio::ip::tcp::socket::shutdown_both);
+    });
+    CoroHttpClient client(io);
+    std::vector<std::string> received;
+    SseEventChannel::Stats stats;
+
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        auto stream = client.open_event_stream(HttpRequest(HttpMethod::GET, server.url("/events")),
+                                               {4, SseOverflowPolicy::block});
+        asio::steady_timer timer(io);
+        while (auto event = co_await stream.next()) {
+            received.push_back(event->data);
+            if (received.size() % 50 == 0) {
+                timer.expires_after(1ms);
+                co_await timer.async_wait(asio::use_awaitable);
+            }
+        }
+        stats = stream.stats();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(received.size() == 200, "events lost");
+    for (int i = 0; i < 200; ++i) {
+        check(received[i] == std::to_string(i), "events out of order");
+    }
+    check(stats.dropped == 0, "block policy dropped events");
+
+    std::cout << "✓ open_event_stream test passed\n";
+    return 0;
+}
+
+int test_drop_stream_closes_connection() {
+    std::cout << "Test: dropping the stream closes the connection\n";
+
+    asio::io_context io;
+    bool peer_closed = false;
+    LoopbackServer server(io, [&](asio::ip::tcp::socket& socket, int) -> asio::awaitable<void> {
+        co_await server.read_request(socket);
+        std::string response = std::string(sse_head) + "data: first\n\n";
+        co_await asio::async_write(socket, asio::buffer(response), asio::use_awaitable);
+        // Returns when the client closes its end
+        char chunk[64];
+        auto [ec, n] = co_await socket.async_read_some(asio::buffer(chunk), asio::as_tuple(asio::use_awaitable));
+        peer_closed = ec == asio::error::eof || n == 0;
+        server.stop();
+    });
+    CoroHttpClient client(io);
+    std::string first;
+
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        auto stream = client.open_event_stream(HttpRequest(HttpMethod::GET, server.url("/events")));
+        auto event = co_await stream.next();
+        if (event) first = event->data;
+        // The connection is idle; leaving the scope must not wait for it
+    }, asio::detached);
+
+    auto start = std::chrono::steady_clock::now();
+    io.run();
+
+    check(first == "first", "event not delivered");
+    check(peer_closed, "connection left open");
+    check(std::chrono::steady_clock::now() - start < 5s, "stream outlived its consumer");
+
+    std::cout << "✓ Drop stream test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== SSE Channel Tests ===\n\n";
+
+    try {
+        test_drop_oldest();
+        test_coalesce();
+        test_block();
+        test_close_with_error();
+        test_cancel();
+        test_open_event_stream();
+        test_drop_stream_closes_connection();
+
+        std::cout << "\n=== All SSE channel tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
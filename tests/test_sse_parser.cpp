@@ -0,0 +1,215 @@
+#include "test_support.hpp"
+#include "coro_http/sse_event.hpp"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Test the incremental SSE parser
+ *
+ * Key Points:
+ * - LF, CRLF and CR line endings, also with CR and LF in separate pieces
+ * - A leading BOM is skipped, also when split across pieces
+ * - Multi-line data, comments, unknown fields, id and retry
+ * - Byte-by-byte feeding yields the same events as one feed
+ * - A piece holding many lines is parsed in linear time
+ * - Lines and events beyond the size limit are rejected
+ */
+
+using namespace coro_http;
+
+static std::vector<SseEvent> parse_pieces(const std::vector<std::string>& pieces) {
+    std::vector<SseEvent> events;
+    SseParser parser;
+    for (const auto& piece : pieces) {
+        parser.feed(piece, [&](const SseEvent& event) { events.push_back(event); });
+    }
+    return events;
+}
+
+static std::vector<SseEvent> parse_bytes(const std::string& stream) {
+    std::vector<std::string> pieces;
+    for (char c : stream) pieces.emplace_back(1, c);
+    return parse_pieces(pieces);
+}
+
+int test_line_endings() {
+    std::cout << "Test: line endings\n";
+
+    for (const char* stream : {"data: a\n\ndata: b\n\n", "data: a\r\n\r\ndata: b\r\n\r\n",
+                               "data: a\r\rdata: b\r\r", "data: a\r\n\ndata: b\r\r\n"}) {
+        auto events = parse_pieces({stream});
+        check(events.size() == 2 && events[0].data == "a" && events[1].data == "b", "wrong events for ending");
+        auto split = parse_bytes(stream);
+        check(split.size() == 2 && split[0].data == "a" && split[1].data == "b", "split ending mishandled");
+    }
+
+    // A CR at the end of one piece and an LF at the start of the next are one line break
+    auto events = parse_pieces({"data: x\r", "\n\r", "\n"});
+    check(events.size() == 1 && events[0].data == "x", "CRLF across pieces counted twice");
+
+    std::cout << "✓ Line ending test passed\n";
+    return 0;
+}
+
+int test_bom() {
+    std::cout << "Test: byte order mark\n";
+
+    auto events = parse_pieces({"\xEF\xBB\xBF" "data: a\n\n"});
+    check(events.size() == 1 && events[0].data == "a", "BOM not skipped");
+
+    events = parse_pieces({"\xEF", "\xBB", "\xBF" "data: b\n\n"});
+    check(events.size() == 1 && events[0].data == "b", "split BOM not skipped");
+
+    // Only at the start of the stream
+    events = parse_pieces({"data: c\n\n", "\xEF\xBB\xBF" "data: d\n\n"});
+    check(events.size() == 1 && events[0].data == "c", "BOM skipped mid-stream");
+
+    std::cout << "✓ BOM test passed\n";
+    return 0;
+}
+
+int test_fields() {
+    std::cout << "Test: fields\n";
+
+    SseParser parser;
+    std::vector<SseEvent> events;
+    auto collect = [&](const SseEvent& event) { events.push_back(event); };
+    parser.feed(": keep-alive\n"
+                "event: update\n"
+                "data: line one\n"
+                "data:line two\n"
+                "data\n"
+                "id: 42\n"
+                "retry: 1500\n"
+                "custom: x\n"
+                "\n"
+                "data: next\n"
+                "retry: soon\n"
+                "\n", collect);
+
+    check(events.size() == 2, "wrong event count");
+    check(events[0].type == "update" && events[0].data == "line one\nline two\n", "wrong data or type");
+    check(events[0].id == "42" && events[0].retry == "1500", "wrong id or retry");
+    check(events[0].fields.at("custom") == "x", "unknown field lost");
+    check(events[1].type.empty() && events[1].id.empty() && events[1].fields.empty(), "event state leaked");
+    check(parser.last_event_id() == "42", "last event id not kept");
+    check(parser.retry_ms() == 1500, "invalid retry replaced a valid one");
+
+    // An id containing NUL is ignored
+    parser.feed(std::string_view("id: a\0b\ndata: z\n\n", 17), collect);
+    check(parser.last_event_id() == "42", "id with NUL accepted");
+
+    // The id of an event cut off before its blank line does not count
+    parser.feed("id: 43\ndata: partial\n", collect);
+    parser.reset();
+    check(parser.last_event_id() == "42", "id of an incomplete event kept");
+
+    // Blank lines without fields dispatch nothing
+    size_t before = events.size();
+    parser.feed("\n\n: comment\n\n", collect);
+    check(events.size() == before, "empty event dispatched");
+
+    std::cout << "✓ Fields test passed\n";
+    return 0;
+}
+
+int test_split_feeding() {
+    std::cout << "Test: split feeding matches whole feeding\n";
+
+    std::string stream = "event: a\r\ndata: 1\r\ndata: 2\r\n\r\nid: 7\rdata: x y z\r\r"
+                         ": c\ndata: last\n\n";
+    auto whole = parse_pieces({stream});
+    auto bytes = parse_bytes(stream);
+    check(whole.size() == 3 && bytes.size() == 3, "wrong event count");
+    for (size_t i = 0; i < whole.size(); ++i) {
+        check(whole[i].data == bytes[i].data && whole[i].type == bytes[i].type && whole[i].id == bytes[i].id,
+              "split feeding changed an event");
+    }
+
+    // An event still open at the end of the stream is not delivered by feed
+    auto open = parse_pieces({"data: pending\n"});
+    check(open.empty(), "unterminated event delivered");
+    check(parse_sse_stream("data: pending\n").size() == 1, "parse_sse_stream dropped the last event");
+
+    std::cout << "✓ Split feeding test passed\n";
+    return 0;
+}
+
+int test_linear_time() {
+    std::cout << "Test: many lines in one piece\n";
+
+    constexpr int count = 200000;
+    std::string stream;
+    for (int i = 0; i < count; ++i) {
+        stream += "data: token" + std::to_string(i) + "\n\n";
+    }
+
+    SseParser parser;
+    int events = 0;
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    parser.feed(stream, [&](const SseEvent& event) {
+        ++events;
+        bytes += event.data.size();
+    });
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    check(events == count, "events lost");
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    std::cout << "  " << count << " events from a " << stream.size() / 1024 << " KiB piece in " << ms << " ms\n";
+    check(elapsed < std::chrono::seconds(5), "parsing is not linear");
+
+    std::cout << "✓ Linear time test passed\n";
+    return 0;
+}
+
+int test_size_limit() {
+    std::cout << "Test: size limits\n";
+
+    SseParser parser(64);
+    auto ignore = [](const SseEvent&) {};
+    bool rejected = false;
+    try {
+        parser.feed(std::string(40, 'x'), ignore);
+        parser.feed(std::string(40, 'x'), ignore);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    check(rejected, "unterminated line grew past the limit");
+
+    SseParser events_parser(64);
+    rejected = false;
+    try {
+        for (int i = 0; i < 10; ++i) {
+            events_parser.feed("data: 0123456789\n", ignore);
+        }
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    check(rejected, "event data grew past the limit");
+
+    std::cout << "✓ Size limit test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== SSE Parser Tests ===\n\n";
+
+    try {
+        test_line_endings();
+        test_bom();
+        test_fields();
+        test_split_feeding();
+        test_linear_time();
+        test_size_limit();
+
+        std::cout << "\n=== All SSE parser tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
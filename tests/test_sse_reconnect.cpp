@@ -0,0 +1,156 @@
+#include "test_support.hpp"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Test SSE reconnection against a scripted local server
+ *
+ * Key Points:
+ * - A dropped stream resumes with Last-Event-ID and no duplicate or partial events
+ * - The server's retry field sets the reconnect delay
+ * - 429/5xx responses are retried with backoff; 204 ends the stream
+ * - Other statuses and exhausted attempts end the stream with an error
+ * - An exception from the callback stops the stream without reconnecting
+ */
+
+using namespace coro_http;
+using namespace std::chrono_literals;
+
+static std::string sse_response(const std::string& body) {
+    return "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nConnection: close\r\n\r\n" + body;
+}
+
+static std::string status_response(int status) {
+    return "HTTP/1.1 " + std::to_string(status) + " X\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+}
+
+static ClientConfig reconnect_config() {
+    ClientConfig config;
+    config.sse_reconnect = true;
+    config.sse_retry_delay = 5ms;
+    config.sse_max_retry_delay = 200ms;
+    config.sse_max_reconnect_attempts = 3;
+    return config;
+}
+
+struct StreamResult {
+    std::vector<std::string> events;
+    std::string error;
+    std::vector<std::string> requests;
+    std::vector<std::chrono::steady_clock::time_point> arrivals;
+};
+
+static StreamResult run_stream(std::vector<std::string> responses,
+                               std::function<void(const SseEvent&)> on_event = nullptr) {
+    asio::io_context io;
+    StreamResult result;
+    // One scripted response per connection, each closing it
+    LoopbackServer server(io, [&](const ServerRequest& request) {
+        result.requests.push_back(request.head);
+        result.arrivals.push_back(std::chrono::steady_clock::now());
+        return responses.at(result.requests.size() - 1);
+    });
+    CoroHttpClient client(io, reconnect_config());
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        try {
+            co_await client.co_stream_events(HttpRequest(HttpMethod::GET, server.url("/events")), [&](const SseEvent& event) {
+                result.events.push_back(event.id + ":" + event.data);
+                if (on_event) on_event(event);
+            });
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        server.stop();
+    }, asio::detached);
+    io.run();
+    return result;
+}
+
+int test_resume_after_drop() {
+    std::cout << "Test: resume with Last-Event-ID\n";
+
+    auto result = run_stream({
+        sse_response("retry: 40\nid: 1\ndata: a\n\nid: 2\ndata: b\n\nid: 3\ndata: cut off"),
+        status_response(503),
+        sse_response("id: 3\ndata: c\n\n"),
+        status_response(204),
+    });
+
+    check(result.error.empty(), "stream ended with an error");
+    check(result.events == std::vector<std::string>({"1:a", "2:b", "3:c"}), "events lost, repeated or partial");
+    check(result.requests.size() == 4, "wrong number of connections");
+    check(result.requests[0].find("Last-Event-ID") == std::string::npos, "first request sent Last-Event-ID");
+    check(result.requests[1].find("Last-Event-ID: 2\r\n") != std::string::npos, "Last-Event-ID missing");
+    check(result.requests[2].find("Last-Event-ID: 2\r\n") != std::string::npos, "Last-Event-ID lost on retry");
+    check(result.requests[3].find("Last-Event-ID: 3\r\n") != std::string::npos, "Last-Event-ID not advanced");
+    // retry: 40 sets the delay after a clean drop, less up to half as jitter
+    auto gap = result.arrivals[1] - result.arrivals[0];
+    check(gap >= 20ms, "server retry interval ignored");
+    check(gap < 1s, "reconnect took too long");
+
+    std::cout << "✓ Resume test passed\n";
+    return 0;
+}
+
+int test_fatal_status() {
+    std::cout << "Test: non-retryable status ends the stream\n";
+
+    auto result = run_stream({sse_response("id: 1\ndata: a\n\n"), status_response(404)});
+    check(result.events.size() == 1, "events before the failure lost");
+    check(result.error.find("404") != std::string::npos, "404 not reported");
+
+    std::cout << "✓ Fatal status test passed\n";
+    return 0;
+}
+
+int test_attempts_exhausted() {
+    std::cout << "Test: giving up after repeated failures\n";
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = run_stream({status_response(503), status_response(429), status_response(500),
+                              status_response(502), sse_response("data: never\n\n")});
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    check(result.events.empty(), "stream continued past the attempt limit");
+    check(result.error.find("502") != std::string::npos, "last failure not reported");
+    // Backoff of 100, 200 and 200 ms with jitter
+    check(elapsed >= 250ms, "failed attempts did not back off");
+
+    std::cout << "✓ Attempts exhausted test passed\n";
+    return 0;
+}
+
+int test_callback_stops_stream() {
+    std::cout << "Test: callback exception stops the stream\n";
+
+    auto result = run_stream({sse_response("id: 1\ndata: a\n\nid: 2\ndata: stop\n\nid: 3\ndata: c\n\n"),
+                              sse_response("data: reconnected\n\n")},
+                             [](const SseEvent& event) {
+                                 if (event.data == "stop") throw std::runtime_error("consumer done");
+                             });
+    check(result.error == "consumer done", "callback exception not propagated");
+    check(result.events.size() == 2, "events after the exception delivered");
+
+    std::cout << "✓ Callback stop test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== SSE Reconnect Tests ===\n\n";
+
+    try {
+        test_resume_after_drop();
+        test_fatal_status();
+        test_attempts_exhausted();
+        test_callback_stops_stream();
+
+        std::cout << "\n=== All SSE reconnect tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
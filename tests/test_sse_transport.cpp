@@ -0,0 +1,294 @@
+#include "test_support.hpp"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Test the connections SSE streams run on
+ *
+ * Key Points:
+ * - A silent stream fails after sse_idle_timeout instead of hanging
+ * - With reconnect, an idle stream is resumed on a new connection
+ * - A consumer holding up a stream does not trip the idle deadline
+ * - A chunked stream that ends cleanly leaves its connection in the pool,
+ *   and the reconnect reuses it
+ * - Through an HTTP proxy the request is sent in absolute form
+ * - A stream framed by Content-Length ends after that many bytes, and
+ *   transfer-encoding is matched in any case
+ */
+
+using namespace coro_http;
+using namespace std::chrono_literals;
+
+static const char* sse_head = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n\r\n";
+
+// Keeps a connection open without sending anything
+static asio::awaitable<void> hold(asio::ip::tcp::socket& socket) {
+    char buffer[64];
+    co_await socket.async_read_some(asio::buffer(buffer), asio::as_tuple(asio::use_awaitable));
+}
+
+int test_idle_timeout() {
+    std::cout << "Test: silent stream times out\n";
+
+    asio::io_context io;
+    LoopbackServer server(io, [&](asio::ip::tcp::socket& socket, int) -> asio::awaitable<void> {
+        co_await server.read_request(socket);
+        std::string response = std::string(sse_head) + "data: hello\n\n";
+        co_await asio::async_write(socket, asio::buffer(response), asio::use_awaitable);
+        co_await hold(socket);
+    });
+
+    ClientConfig config;
+    config.sse_idle_timeout = 100ms;
+    CoroHttpClient client(io, config);
+    int events = 0;
+    bool timed_out = false;
+    auto start = std::chrono::steady_clock::now();
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        try {
+            co_await client.co_stream_events(HttpRequest(HttpMethod::GET, server.url("/events")),
+                                             [&](const SseEvent&) { ++events; });
+        } catch (const std::system_error& e) {
+            timed_out = e.code() == std::errc::timed_out;
+        }
+        server.stop();
+    }, asio::detached);
+    io.run();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    check(events == 1, "event before the silence lost");
+    check(timed_out, "silent stream not reported as timed out");
+    check(elapsed >= 100ms && elapsed < 5s, "idle deadline not applied");
+
+    std::cout << "✓ Idle timeout test passed\n";
+    return 0;
+}
+
+int test_idle_reconnect() {
+    std::cout << "Test: idle stream is resumed\n";
+
+    asio::io_context io;
+    LoopbackServer server(io, [&](asio::ip::tcp::socket& socket, int index) -> asio::awaitable<void> {
+        co_await server.read_request(socket);
+        if (index > 1) {
+            // 204 ends the stream for good
+            std::string response = "HTTP/1.1 204 No Content\r\nConnection: close\r\n\r\n";
+            co_await asio::async_write(socket, asio::buffer(response), asio::use_awaitable);
+            co_return;
+        }
+        std::string response = std::string(sse_head);
+        response += index == 0 ? "id: 1\ndata: a\n\n" : "id: 2\ndata: b\n\n";
+        co_await asio::async_write(socket, asio::buffer(response), asio::use_awaitable);
+        if (index == 0) {
+            co_await hold(socket);  // Goes silent
+        } else {
+            socket.shutdown(asio::ip::tcp::socket::shutdown_both);
+        }
+    });
+
+    ClientConfig config;
+    config.sse_idle_timeout = 100ms;
+    config.sse_reconnect = true;
+    config.sse_retry_delay = 1ms;
+    config.sse_max_reconnect_attempts = 1;
+    CoroHttpClient client(io, config);
+    std::vector<std::string> events;
+    std::string error;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        try {
+            co_await client.co_stream_events(HttpRequest(HttpMethod::GET, server.url("/events")),
+                                             [&](const SseEvent& event) { events.push_back(event.data); });
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(error.empty(), "stream failed instead of resuming");
+    check(events == std::vector<std::string>({"a", "b"}), "stream not resumed after going idle");
+    check(server.requests.size() >= 2 && server.requests[1].head.find("Last-Event-ID: 1\r\n") != std::string::npos,
+          "resume did not send Last-Event-ID");
+
+    std::cout << "✓ Idle reconnect test passed\n";
+    return 0;
+}
+
+int test_backpressure_pauses_deadline() {
+    std::cout << "Test: slow consumer does not trip the idle deadline\n";
+
+    asio::io_context io;
+    LoopbackServer server(io, [&](asio::ip::tcp::socket& socket, int) -> asio::awaitable<void> {
+        co_await server.read_request(socket);
+        std::string response = std::string(sse_head) + "data: 1\n\ndata: 2\n\ndata: 3\n\n";
+        co_await asio::async_write(socket, asio::buffer(response), asio::use_awaitable);
+        socket.shutdown(asio::ip::tcp::socket::shutdown_send);
+        co_await hold(socket);
+    });
+
+    ClientConfig config;
+    config.sse_idle_timeout = 50ms;
+    CoroHttpClient client(io, config);
+    std::vector<std::string> events;
+    std::string error;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        auto stream = client.open_event_stream(HttpRequest(HttpMethod::GET, server.url("/events")),
+                                               {1, SseOverflowPolicy::block});
+        asio::steady_timer timer(io);
+        try {
+            while (auto event = co_await stream.next()) {
+                events.push_back(event->data);
+                timer.expires_after(120ms);
+                co_await timer.async_wait(asio::use_awaitable);
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(error.empty(), "stream failed while the consumer held it up");
+    check(events.size() == 3, "events lost");
+
+    std::cout << "✓ Backpressure deadline test passed\n";
+    return 0;
+}
+
+int test_pooled_reconnect() {
+    std::cout << "Test: reconnect reuses a pooled connection\n";
+
+    asio::io_context io;
+    LoopbackServer server(io, [&](asio::ip::tcp::socket& socket, int) -> asio::awaitable<void> {
+        // Each request gets a short chunked stream; the connection stays open
+        for (int i = 0;; ++i) {
+            if ((co_await server.read_request(socket)).head.empty()) co_return;
+            std::string event = "id: " + std::to_string(i) + "\ndata: e" + std::to_string(i) + "\n\n";
+            char size[16];
+            std::snprintf(size, sizeof(size), "%zx", event.size());
+            std::string response = "HTTP/1.1 ";
+            response += i < 2 ? "200 OK\r\nContent-Type: text/event-stream\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                + std::string(size) + "\r\n" + event + "\r\n0\r\n\r\n"
+                              : "204 No Content\r\n\r\n";
+            co_await asio::async_write(socket, asio::buffer(response), asio::use_awaitable);
+        }
+    });
+
+    ClientConfig config;
+    config.sse_reconnect = true;
+    config.sse_retry_delay = 1ms;
+    CoroHttpClient client(io, config);
+    std::vector<std::string> events;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        co_await client.co_stream_events(HttpRequest(HttpMethod::GET, server.url("/events")),
+                                         [&](const SseEvent& event) { events.push_back(event.data); });
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(events == std::vector<std::string>({"e0", "e1"}), "wrong events");
+    check(server.requests.size() == 3, "wrong number of requests");
+    check(server.connections == 1, "reconnects did not reuse the pooled connection");
+    check(server.requests[0].head.find("Accept-Encoding") == std::string::npos, "compression offered for a stream");
+
+    std::cout << "✓ Pooled reconnect test passed\n";
+    return 0;
+}
+
+int test_framing_from_head() {
+    std::cout << "Test: stream framing from the parsed head\n";
+
+    asio::io_context io;
+    LoopbackServer server(io, [&](asio::ip::tcp::socket& socket, int) -> asio::awaitable<void> {
+        // A lowercase chunked stream, then one with Content-Length; the
+        // connection stays open, so each must end by its own framing
+        for (int i = 0;; ++i) {
+            if ((co_await server.read_request(socket)).head.empty()) co_return;
+            std::string event = "id: " + std::to_string(i) + "\ndata: e" + std::to_string(i) + "\n\n";
+            char size[16];
+            std::snprintf(size, sizeof(size), "%zx", event.size());
+            std::string response = "HTTP/1.1 ";
+            if (i == 0) {
+                response += "200 OK\r\ncontent-type: text/event-stream\r\ntransfer-encoding: chunked\r\n\r\n" +
+                            std::string(size) + "\r\n" + event + "\r\n0\r\n\r\n";
+            } else if (i == 1) {
+                response += "200 OK\r\nContent-Type: text/event-stream\r\ncontent-length: " +
+                            std::to_string(event.size()) + "\r\n\r\n" + event;
+            } else {
+                response += "204 No Content\r\n\r\n";
+            }
+            co_await asio::async_write(socket, asio::buffer(response), asio::use_awaitable);
+        }
+    });
+
+    ClientConfig config;
+    config.sse_reconnect = true;
+    config.sse_retry_delay = 1ms;
+    CoroHttpClient client(io, config);
+    std::vector<std::string> events;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        co_await client.co_stream_events(HttpRequest(HttpMethod::GET, server.url("/events")),
+                                         [&](const SseEvent& event) { events.push_back(event.data); });
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(events == std::vector<std::string>({"e0", "e1"}), "wrong events");
+    check(server.requests.size() == 3 && server.connections == 1, "streams did not end by their framing");
+
+    std::cout << "✓ Framing from head test passed\n";
+    return 0;
+}
+
+int test_http_proxy() {
+    std::cout << "Test: stream through an HTTP proxy\n";
+
+    asio::io_context io;
+    LoopbackServer proxy(io, [&](asio::ip::tcp::socket& socket, int) -> asio::awaitable<void> {
+        co_await proxy.read_request(socket);
+        std::string response = std::string(sse_head) + "data: via proxy\n\n";
+        co_await asio::async_write(socket, asio::buffer(response), asio::use_awaitable);
+        socket.shutdown(asio::ip::tcp::socket::shutdown_both);
+    });
+
+    ClientConfig config;
+    config.proxy_url = "http://127.0.0.1:" + proxy.port();
+    CoroHttpClient client(io, config);
+    std::vector<std::string> events;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        co_await client.co_stream_events(HttpRequest(HttpMethod::GET, "http://events.example/feed"),
+                                         [&](const SseEvent& event) { events.push_back(event.data); });
+        proxy.stop();
+    }, asio::detached);
+    io.run();
+
+    check(events.size() == 1 && events[0] == "via proxy", "event not delivered through the proxy");
+    check(proxy.requests.size() == 1 && proxy.requests[0].head.rfind("GET http://events.example/feed HTTP/1.1\r\n", 0) == 0,
+          "request not sent in absolute form");
+
+    std::cout << "✓ HTTP proxy test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== SSE Transport Tests ===\n\n";
+
+    try {
+        test_idle_timeout();
+        test_idle_reconnect();
+        test_backpressure_pauses_deadline();
+        test_pooled_reconnect();
+        test_framing_from_head();
+        test_http_proxy();
+
+        std::cout << "\n=== All SSE transport tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
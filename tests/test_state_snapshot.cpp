@@ -0,0 +1,363 @@
+#include "test_support.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * Test warm-start snapshots of cookies, DNS entries and TLS sessions
+ *
+ * Key Points:
+ * - Cookies, resolver entries and TLS sessions survive a save/load round trip
+ * - Expired entries are dropped on load
+ * - Foreign, truncated, corrupt or newer-version files are rejected
+ * - DNS entries expire after the configured TTL
+ * - A DNS entry none of whose endpoints accepts a connection is dropped
+ * - Thousands of entries load in a fraction of a millisecond (optimized builds)
+ * - The background writer saves periodically and once more on shutdown
+ * - A client restores the snapshot on construction and saves it when destroyed
+ */
+
+using namespace coro_http;
+using namespace std::chrono_literals;
+
+static std::string temp_path(const char* name) {
+    return "/tmp/coro_http_" + std::string(name) + "_" + std::to_string(::getpid()) + ".snap";
+}
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void write_file(const std::string& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << data;
+}
+
+// A resumable TLS 1.3 session with made-up keys, valid for an hour
+static std::string make_session_der() {
+    SSL_SESSION* session = SSL_SESSION_new();
+    SSL_SESSION_set_protocol_version(session, TLS1_3_VERSION);
+    unsigned char key[32] = {1, 2, 3};
+    SSL_SESSION_set1_master_key(session, key, sizeof(key));
+    unsigned char id[4] = {'s', 'e', 's', 's'};
+    SSL_SESSION_set1_id(session, id, sizeof(id));
+    SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+    SSL* ssl = SSL_new(ctx);
+    const unsigned char aes128_gcm[2] = {0x13, 0x01};
+    SSL_SESSION_set_cipher(session, SSL_CIPHER_find(ssl, aes128_gcm));
+    SSL_SESSION_set_time(session, static_cast<long>(std::time(nullptr)));
+    SSL_SESSION_set_timeout(session, 3600);
+    int length = i2d_SSL_SESSION(session, nullptr);
+    std::string der(static_cast<size_t>(length), '\0');
+    auto* out = reinterpret_cast<unsigned char*>(der.data());
+    i2d_SSL_SESSION(session, &out);
+    SSL_SESSION_free(session);
+    SSL_free(ssl);
+    SSL_CTX_free(ctx);
+    return der;
+}
+
+int test_round_trip() {
+    std::cout << "Test: snapshot round trip\n";
+
+    auto now = std::chrono::system_clock::now();
+    CookieJar jar;
+    jar.parse_set_cookie("sid=abc; Secure; HttpOnly", "www.example.com");
+    jar.parse_set_cookie("pref=dark; Domain=example.com; Path=/app; Max-Age=3600", "www.example.com");
+    Cookie stale("old", "1");
+    stale.domain = "example.com";
+    stale.session = false;
+    stale.expires = now + 50ms;
+    jar.add(stale);
+
+    DnsCache dns(60s);
+    dns.store("example.com", "443", {{asio::ip::make_address("93.184.216.34"), 443},
+                                     {asio::ip::make_address("2606:2800:220:1::1"), 443}});
+
+    TlsSessionCache tls;
+    std::string der = make_session_der();
+    tls.import({{"example.com:443", der, now + 1h}});
+    check(tls.size() == 1, "session not imported");
+
+    std::string path = temp_path("round_trip");
+    StateSnapshot::capture(&jar, &dns, &tls).save(path);
+    std::this_thread::sleep_for(100ms);  // Lets "old" expire before loading
+
+    auto loaded = StateSnapshot::load(path);
+    check(loaded.has_value(), "snapshot not found");
+    check(loaded->cookies.size() == 3 && loaded->dns.size() == 1 && loaded->tls_sessions.size() == 1,
+          "wrong entry counts");
+
+    CookieJar restored_jar;
+    DnsCache restored_dns(60s);
+    TlsSessionCache restored_tls;
+    loaded->restore(&restored_jar, &restored_dns, &restored_tls);
+
+    check(restored_jar.size() == 2, "expired cookie restored");
+    check(restored_jar.get_cookies_for_request("www.example.com", "/app", true) == "pref=dark; sid=abc",
+          "cookies differ after restore");
+    check(restored_jar.get_cookies_for_request("www.example.com", "/app", false) == "pref=dark",
+          "Secure flag lost");
+    auto cookies = restored_jar.all_cookies();
+    for (const auto& cookie : cookies) {
+        if (cookie.name == "sid") check(cookie.session && cookie.http_only, "session flags lost");
+        if (cookie.name == "pref") check(!cookie.session && cookie.path == "/app", "expiry or path lost");
+    }
+
+    auto endpoints = restored_dns.lookup("example.com", "443");
+    check(endpoints && endpoints->size() == 2, "DNS entry lost");
+    check((*endpoints)[0].address().to_string() == "93.184.216.34" && (*endpoints)[0].port() == 443,
+          "IPv4 endpoint differs");
+    check((*endpoints)[1].address().is_v6() && (*endpoints)[1].address().to_string() == "2606:2800:220:1::1",
+          "IPv6 endpoint differs");
+
+    auto sessions = restored_tls.entries();
+    check(sessions.size() == 1 && sessions[0].key == "example.com:443" && sessions[0].der == der,
+          "TLS session differs");
+
+    // No file at all is not an error
+    std::remove(path.c_str());
+    check(!StateSnapshot::load(path).has_value(), "missing snapshot reported as present");
+
+    std::cout << "✓ Round trip test passed\n";
+    return 0;
+}
+
+int test_rejects_bad_files() {
+    std::cout << "Test: bad snapshots are rejected\n";
+
+    CookieJar jar;
+    jar.set("a", "1", "example.com");
+    std::string path = temp_path("bad");
+    StateSnapshot::capture(&jar, nullptr, nullptr).save(path);
+    const std::string good = read_file(path);
+
+    auto rejected = [&](std::string data, const char* expected) {
+        write_file(path, data);
+        try {
+            StateSnapshot::load(path);
+        } catch (const std::runtime_error& e) {
+            return std::string(e.what()).find(expected) != std::string::npos;
+        }
+        return false;
+    };
+
+    std::string foreign = good;
+    foreign[0] = 'X';
+    check(rejected(foreign, "Not a state snapshot"), "foreign file accepted");
+    check(rejected("", "Not a state snapshot"), "empty file accepted");
+
+    std::string newer = good;
+    newer[8] = static_cast<char>(StateSnapshot::version + 1);
+    check(rejected(newer, "version"), "newer version accepted");
+
+    std::string corrupt = good;
+    corrupt[corrupt.find("example.com")] ^= 0x20;
+    check(rejected(corrupt, "checksum"), "corrupt payload accepted");
+
+    check(rejected(good.substr(0, good.size() / 2), "Truncated"), "truncated file accepted");
+
+    write_file(path, good);
+    check(StateSnapshot::load(path)->cookies.size() == 1, "good file rejected");
+    std::remove(path.c_str());
+
+    std::cout << "✓ Bad snapshot test passed\n";
+    return 0;
+}
+
+int test_dns_ttl() {
+    std::cout << "Test: DNS entries expire\n";
+
+    DnsCache dns(1s);
+    asio::ip::tcp::endpoint endpoint(asio::ip::make_address("127.0.0.1"), 8080);
+    dns.store("api.local", "8080", {endpoint});
+    check(dns.lookup("api.local", "8080").has_value(), "fresh entry missing");
+    check(!dns.lookup("api.local", "8081").has_value(), "port ignored in key");
+
+    // Entries keep their original deadline across a snapshot
+    auto now = std::chrono::system_clock::now();
+    DnsCache restored(1h);
+    restored.import({{"live.local", "80", {endpoint}, now + 1s},
+                     {"dead.local", "80", {endpoint}, now - 1s}});
+    check(restored.size() == 1, "expired entry imported");
+
+    std::this_thread::sleep_for(1100ms);
+    check(!dns.lookup("api.local", "8080").has_value(), "entry outlived its TTL");
+    check(!restored.lookup("live.local", "80").has_value(), "imported entry outlived its deadline");
+    check(dns.size() == 0, "expired entry not dropped");
+
+    std::cout << "✓ DNS TTL test passed\n";
+    return 0;
+}
+
+int test_dns_eviction_on_connect_failure() {
+    std::cout << "Test: unreachable DNS entry evicted\n";
+
+    asio::io_context io;
+    LoopbackServer server(io, [](const ServerRequest&) {
+        return std::string("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+    });
+    ClientConfig config;
+    config.enable_dns_cache = true;
+    config.enable_retry = true;
+    config.max_retries = 1;
+    config.initial_retry_delay = 1ms;
+    CoroHttpClient client(io, config);
+
+    // A stale address: the server listens on 127.0.0.1 only
+    std::string port = server.port();
+    client.dns_cache()->store("localhost", port, {{asio::ip::make_address("127.0.0.2"),
+                                                    static_cast<unsigned short>(std::stoi(port))}});
+
+    std::string body;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        body = (co_await client.co_get("http://localhost:" + port + "/")).body();
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(body == "ok", "retry did not resolve the host again");
+    auto endpoints = client.dns_cache()->lookup("localhost", port);
+    check(endpoints && std::none_of(endpoints->begin(), endpoints->end(), [](const auto& endpoint) {
+        return endpoint.address() == asio::ip::make_address("127.0.0.2");
+    }), "unreachable entry kept");
+
+    std::cout << "✓ DNS eviction test passed\n";
+    return 0;
+}
+
+int test_load_time() {
+    std::cout << "Test: load time for thousands of entries\n";
+
+    constexpr int cookie_count = 4000;
+    constexpr int host_count = 1000;
+    StateSnapshot snapshot;
+    auto expires = std::chrono::system_clock::now() + 1h;
+    for (int i = 0; i < cookie_count; ++i) {
+        Cookie cookie("c" + std::to_string(i % 8), "value-" + std::to_string(i));
+        cookie.domain = "host" + std::to_string(i / 8) + ".example.com";
+        cookie.session = false;
+        cookie.expires = expires;
+        snapshot.cookies.push_back(cookie);
+    }
+    for (int i = 0; i < host_count; ++i) {
+        asio::ip::address_v4 address(static_cast<asio::ip::address_v4::uint_type>(0x0a000000 + i));
+        snapshot.dns.push_back({"host" + std::to_string(i) + ".example.com", "443", {{address, 443}}, expires});
+    }
+    std::string path = temp_path("load_time");
+    snapshot.save(path);
+
+    auto start = std::chrono::steady_clock::now();
+    auto loaded = StateSnapshot::load(path);
+    auto parsed = std::chrono::steady_clock::now();
+    CookieJar jar;
+    DnsCache dns(60s);
+    loaded->restore(&jar, &dns, nullptr);
+    auto restored = std::chrono::steady_clock::now();
+    std::remove(path.c_str());
+
+    check(jar.size() == cookie_count && dns.size() == host_count, "entries lost");
+    check(jar.get("c3", "host7.example.com") == "value-59", "wrong cookie value");
+    auto us = [](auto d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count(); };
+    std::cout << "  " << cookie_count << " cookies + " << host_count << " hosts: parse " << us(parsed - start)
+              << " us, restore " << us(restored - parsed) << " us\n";
+    // Generous bound so sanitizer and debug builds pass
+    check(restored - start < 500ms, "snapshot load far too slow");
+
+    std::cout << "✓ Load time test passed\n";
+    return 0;
+}
+
+int test_background_writer() {
+    std::cout << "Test: background writer\n";
+
+    std::string path = temp_path("writer");
+    CookieJar jar;
+    size_t saves = 0;
+    {
+        StateSnapshotWriter writer([&] { StateSnapshot::capture(&jar, nullptr, nullptr).save(path); }, 20ms);
+        jar.set("n", "1", "example.com");
+        std::this_thread::sleep_for(150ms);
+        saves = writer.saves();
+        check(saves >= 2 && writer.last_error().empty(), "periodic saves missing");
+        jar.set("n", "2", "example.com");
+    }
+    // Destruction saved the latest state
+    check(StateSnapshot::load(path)->cookies.at(0).value == "2", "final save missing");
+    std::remove(path.c_str());
+
+    // Failures are recorded, not thrown
+    StateSnapshotWriter failing([] { StateSnapshot().save("/nonexistent-dir/state.snap"); }, 10ms);
+    std::this_thread::sleep_for(50ms);
+    check(failing.saves() == 0 && !failing.last_error().empty(), "save failure not reported");
+
+    std::cout << "✓ Background writer test passed\n";
+    return 0;
+}
+
+int test_client_warm_start() {
+    std::cout << "Test: client warm start\n";
+
+    std::string path = temp_path("client");
+    ClientConfig config;
+    config.enable_cookies = true;
+    config.enable_dns_cache = true;
+    config.enable_tls_session_cache = true;
+    config.state_snapshot_path = path;
+    config.state_snapshot_interval = 1h;
+
+    asio::io_context io;
+    {
+        CoroHttpClient client(io, config);
+        check(client.cookies().size() == 0, "cold client has cookies");
+        client.cookies().set("token", "t1", "api.example.com");
+        client.dns_cache()->store("api.example.com", "443", {{asio::ip::make_address("10.1.2.3"), 443}});
+    }
+    {
+        CoroHttpClient client(io, config);
+        check(client.cookies().get("token", "api.example.com") == "t1", "cookie not restored");
+        auto endpoints = client.dns_cache()->lookup("api.example.com", "443");
+        check(endpoints && endpoints->at(0).address().to_string() == "10.1.2.3", "DNS entry not restored");
+    }
+
+    // A damaged snapshot means a cold start, not a failure
+    write_file(path, "garbage");
+    {
+        CoroHttpClient client(io, config);
+        check(client.cookies().size() == 0, "garbage snapshot restored");
+    }
+    check(StateSnapshot::load(path).has_value(), "damaged snapshot not replaced");
+    std::remove(path.c_str());
+
+    std::cout << "✓ Client warm start test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== State Snapshot Tests ===\n\n";
+
+    try {
+        test_round_trip();
+        test_rejects_bad_files();
+        test_dns_ttl();
+        test_dns_eviction_on_connect_failure();
+        test_load_time();
+        test_background_writer();
+        test_client_warm_start();
+
+        std::cout << "\n=== All state snapshot tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}
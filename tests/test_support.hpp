@@ -0,0 +1,266 @@
+#pragma once
+
+#include "coro_http/coro_http_client.hpp"
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Helpers shared by the test programs: an assertion that throws, and a
+// loopback HTTP/1.1 server over TCP, TLS or a Unix domain socket.
+
+inline void check(bool condition, const char* what) {
+    if (!condition) throw std::runtime_error(what);
+}
+
+// Give a server context a fresh self-signed P-256 certificate for "localhost"
+inline void use_self_signed_certificate(asio::ssl::context& context) {
+    EVP_PKEY* key = EVP_EC_gen("P-256");
+    X509* cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+    SSL_CTX_use_certificate(context.native_handle(), cert);
+    SSL_CTX_use_PrivateKey(context.native_handle(), key);
+    X509_free(cert);
+    EVP_PKEY_free(key);
+}
+
+// One request as the server read it
+struct ServerRequest {
+    std::string head;    // Request line and header fields; empty once the client closed
+    std::string method;
+    std::string target;
+    std::string body;    // Chunked request bodies arrive de-chunked
+
+    // Case-insensitive header lookup; empty when the field is absent
+    std::string header(const std::string& name) const {
+        size_t line = head.find("\r\n");
+        while (line != std::string::npos && line + 2 < head.size()) {
+            size_t start = line + 2;
+            size_t end = head.find("\r\n", start);
+            size_t colon = head.find(':', start);
+            if (colon != std::string::npos && colon < end && colon - start == name.size() &&
+                std::equal(name.begin(), name.end(), head.begin() + static_cast<std::ptrdiff_t>(start),
+                           [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) ==
+                                                       std::tolower(static_cast<unsigned char>(b)); })) {
+                size_t value = head.find_first_not_of(" \t", colon + 1);
+                return head.substr(value, end - value);
+            }
+            line = end;
+        }
+        return "";
+    }
+};
+
+// Read the next request off a connection. `buffer` carries bytes that came
+// in past the previous request. Returns false once the client has closed.
+template<typename Stream>
+asio::awaitable<bool> read_server_request(Stream& stream, std::string& buffer, ServerRequest& request) {
+    char chunk[16384];
+    auto read_more = [&]() -> asio::awaitable<bool> {
+        auto [ec, n] = co_await stream.async_read_some(asio::buffer(chunk), asio::as_tuple(asio::use_awaitable));
+        if (ec || n == 0) co_return false;
+        buffer.append(chunk, n);
+        co_return true;
+    };
+
+    size_t end;
+    while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (!co_await read_more()) co_return false;
+    }
+    request = ServerRequest();
+    request.head = buffer.substr(0, end + 4);
+    buffer.erase(0, end + 4);
+    request.method = request.head.substr(0, request.head.find(' '));
+    request.target = request.head.substr(request.method.size() + 1);
+    request.target = request.target.substr(0, request.target.find(' '));
+
+    if (request.header("Transfer-Encoding").find("chunked") != std::string::npos) {
+        coro_http::ChunkedDecoder decoder;
+        while (true) {
+            size_t used = decoder.feed(buffer, [&](std::string_view span) { request.body.append(span); });
+            buffer.erase(0, used);
+            if (decoder.done()) break;
+            if (!co_await read_more()) co_return false;
+        }
+    } else {
+        std::string length_field = request.header("Content-Length");
+        size_t length = length_field.empty() ? 0 : std::stoul(length_field);
+        while (buffer.size() < length) {
+            if (!co_await read_more()) co_return false;
+        }
+        request.body = buffer.substr(0, length);
+        buffer.erase(0, length);
+    }
+    co_return true;
+}
+
+// Loopback HTTP/1.1 server for tests.
+//
+// With a Respond function, every request on a keep-alive connection gets the
+// raw response it returns; the connection closes after a response carrying
+// "Connection: close" or one with neither Content-Length nor Transfer-Encoding.
+// With a Session coroutine, each accepted connection is handed over as is,
+// for servers that stall, stream or misbehave on purpose.
+template<typename Protocol>
+class BasicLoopbackServer {
+public:
+    using Socket = typename Protocol::socket;
+    using Endpoint = typename Protocol::endpoint;
+    using Respond = std::function<std::string(const ServerRequest&)>;
+    using Session = std::function<asio::awaitable<void>(Socket&, int index)>;
+
+    struct Tls {};
+
+    BasicLoopbackServer(asio::io_context& io, Respond respond, Endpoint endpoint = loopback())
+        : acceptor_(io, bindable(endpoint)), context_(asio::ssl::context::tls_server), respond_(std::move(respond)) {
+        start(io);
+    }
+
+    BasicLoopbackServer(asio::io_context& io, Session session, Endpoint endpoint = loopback())
+        : acceptor_(io, bindable(endpoint)), context_(asio::ssl::context::tls_server), session_(std::move(session)) {
+        start(io);
+    }
+
+    // TLS with a self-signed certificate; the client must not verify peers
+    BasicLoopbackServer(asio::io_context& io, Respond respond, Tls)
+        : acceptor_(io, loopback()), context_(asio::ssl::context::tls_server), respond_(std::move(respond)), tls_(true) {
+        use_self_signed_certificate(context_);
+        start(io);
+    }
+
+    ~BasicLoopbackServer() {
+        if constexpr (is_local) ::unlink(path_.c_str());
+    }
+
+    BasicLoopbackServer(const BasicLoopbackServer&) = delete;
+    BasicLoopbackServer& operator=(const BasicLoopbackServer&) = delete;
+
+    // Still valid after stop()
+    std::string port() const {
+        return std::to_string(port_);
+    }
+
+    std::string url(const std::string& path = "/") const {
+        return (tls_ ? "https://127.0.0.1:" : "http://127.0.0.1:") + port() + path;
+    }
+
+    // Stop accepting and drop every open connection
+    void stop() {
+        asio::error_code ec;
+        acceptor_.close(ec);
+        for (auto* socket : open_) socket->close(ec);
+    }
+
+    // Next request on a Session connection, recorded like any other; the
+    // head is empty once the client has closed. Bytes past it are dropped.
+    asio::awaitable<ServerRequest> read_request(Socket& socket) {
+        std::string buffer;
+        ServerRequest request;
+        if (co_await read_server_request(socket, buffer, request)) {
+            requests.push_back(request);
+        }
+        co_return request;
+    }
+
+    int connections{0};
+    std::vector<ServerRequest> requests;
+
+private:
+    static constexpr bool is_local = !std::is_same_v<Protocol, asio::ip::tcp>;
+
+    static Endpoint loopback() {
+        return Endpoint(asio::ip::make_address("127.0.0.1"), 0);
+    }
+
+    // A Unix socket path left over from an earlier run would fail the bind
+    Endpoint bindable(const Endpoint& endpoint) {
+        if constexpr (is_local) {
+            path_ = endpoint.path();
+            ::unlink(path_.c_str());
+        }
+        return endpoint;
+    }
+
+    void start(asio::io_context& io) {
+        if constexpr (!is_local) port_ = acceptor_.local_endpoint().port();
+        asio::co_spawn(io, serve(), asio::detached);
+    }
+
+    asio::awaitable<void> serve() {
+        while (true) {
+            auto [ec, socket] = co_await acceptor_.async_accept(asio::as_tuple(asio::use_awaitable));
+            if (ec) co_return;
+            asio::co_spawn(acceptor_.get_executor(), run(std::move(socket), connections++), asio::detached);
+        }
+    }
+
+    asio::awaitable<void> run(Socket socket, int index) {
+        open_.push_back(&socket);
+        try {
+            if (session_) {
+                co_await session_(socket, index);
+            } else if constexpr (!is_local) {
+                if (tls_) {
+                    asio::ssl::stream<Socket&> stream(socket, context_);
+                    auto [ec] = co_await stream.async_handshake(asio::ssl::stream_base::server,
+                                                               asio::as_tuple(asio::use_awaitable));
+                    if (!ec) co_await exchange(stream);
+                } else {
+                    co_await exchange(socket);
+                }
+            } else {
+                co_await exchange(socket);
+            }
+        } catch (...) {
+        }
+        open_.erase(std::find(open_.begin(), open_.end(), &socket));
+    }
+
+    template<typename Stream>
+    asio::awaitable<void> exchange(Stream& stream) {
+        std::string buffer;
+        ServerRequest request;
+        while (co_await read_server_request(stream, buffer, request)) {
+            requests.push_back(request);
+            std::string response = respond_(request);
+            auto [ec, n] = co_await asio::async_write(stream, asio::buffer(response), asio::as_tuple(asio::use_awaitable));
+            if (ec) co_return;
+
+            std::string head = response.substr(0, response.find("\r\n\r\n"));
+            std::transform(head.begin(), head.end(), head.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (head.find("connection: close") != std::string::npos ||
+                (head.find("content-length:") == std::string::npos &&
+                 head.find("transfer-encoding:") == std::string::npos)) {
+                asio::error_code shutdown_ec;
+                stream.lowest_layer().shutdown(asio::socket_base::shutdown_both, shutdown_ec);
+                co_return;
+            }
+        }
+    }
+
+    std::string path_;  // Unix socket path; set while the acceptor is built
+    typename Protocol::acceptor acceptor_;
+    asio::ssl::context context_;
+    Respond respond_;
+    Session session_;
+    bool tls_{false};
+    unsigned short port_{0};
+    std::vector<Socket*> open_;
+};
+
+using LoopbackServer = BasicLoopbackServer<asio::ip::tcp>;
+using UnixLoopbackServer = BasicLoopbackServer<asio::local::stream_protocol>;
@@ -0,0 +1,199 @@
+#include "test_support.hpp"
+#include "coro_http/form_data.hpp"
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Test the Unix domain socket transport
+ *
+ * Key Points:
+ * - http+unix URLs carry the percent-encoded socket path as their host
+ * - ClientConfig::unix_sockets sends plain http:// requests for a host to
+ *   a socket, keeping the host name in the Host header and for redirects
+ * - Pooling, chunked framing, file bodies and event streams work as over TCP
+ * - A missing socket fails the request
+ */
+
+using namespace coro_http;
+
+static std::string socket_path(const char* name) {
+    return "/tmp/coro_http_" + std::string(name) + "_" + std::to_string(::getpid()) + ".sock";
+}
+
+static std::string to_hex(size_t value) {
+    char hex[16];
+    std::snprintf(hex, sizeof(hex), "%zx", value);
+    return hex;
+}
+
+// /echo answers with the Host header and the body size, /chunked with a
+// chunked body, /moved redirects to /echo and /events with a short chunked
+// event stream
+static std::string unix_response(const ServerRequest& request) {
+    if (request.target == "/moved") {
+        return "HTTP/1.1 302 Found\r\nLocation: /echo\r\nContent-Length: 0\r\n\r\n";
+    }
+    if (request.target == "/chunked") {
+        return "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n";
+    }
+    if (request.target == "/events") {
+        std::string events = "data: one\n\ndata: two\n\n";
+        return "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nTransfer-Encoding: chunked\r\n\r\n" +
+               to_hex(events.size()) + "\r\n" + events + "\r\n0\r\n\r\n";
+    }
+    std::string reply = request.header("Host") + " " + std::to_string(request.body.size());
+    return "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(reply.size()) + "\r\n\r\n" + reply;
+}
+
+int test_url_parsing() {
+    std::cout << "Test: http+unix URLs\n";
+
+    auto info = parse_url("http+unix://%2Fvar%2Frun%2Fenvoy.sock/v1/stats?format=json");
+    check(info.unix_socket == "/var/run/envoy.sock", "socket path not decoded");
+    check(info.host == "%2Fvar%2Frun%2Fenvoy.sock", "encoded host not kept");
+    check(info.path == "/v1/stats?format=json" && !info.is_https, "path or scheme wrong");
+    check(parse_url("http://localhost/").unix_socket.empty(), "TCP URL given a socket");
+
+    std::cout << "✓ URL parsing test passed\n";
+    return 0;
+}
+
+int test_pooled_requests() {
+    std::cout << "Test: pooled requests over a Unix socket\n";
+
+    asio::io_context io;
+    std::string path = socket_path("pool");
+    UnixLoopbackServer server(io, unix_response, UnixSocket::endpoint_type(path));
+    CoroHttpClient client(io);
+    std::string base = "http+unix://" + url_encode(path);
+
+    std::vector<std::string> bodies;
+    ConnectionPool::Stats stats;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        bodies.push_back((co_await client.co_get(base + "/echo")).body());
+        bodies.push_back((co_await client.co_get(base + "/chunked")).body());
+        bodies.push_back((co_await client.co_post(base + "/echo", "payload")).body());
+        stats = client.get_pool_stats();
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(bodies[0] == url_encode(path) + " 0", "GET over the socket failed");
+    check(bodies[1] == "hello world", "chunked body not decoded");
+    check(bodies[2] == url_encode(path) + " 7", "POST body not sent");
+    check(server.connections == 1 && stats.total_unix_connections == 1 && stats.total_http_connections == 0,
+          "Unix socket connection not pooled");
+
+    std::cout << "✓ Pooled requests test passed\n";
+    return 0;
+}
+
+int test_host_mapping() {
+    std::cout << "Test: hosts mapped to a Unix socket\n";
+
+    asio::io_context io;
+    std::string path = socket_path("map");
+    UnixLoopbackServer server(io, unix_response, UnixSocket::endpoint_type(path));
+    ClientConfig config;
+    config.unix_sockets["sidecar.local"] = path;
+    config.proxy_url = "http://127.0.0.1:1";  // Must not be used for the socket
+    CoroHttpClient client(io, config);
+
+    HttpResponse moved;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        moved = co_await client.co_get("http://sidecar.local/moved");
+        client.clear_connection_pool();
+        server.stop();
+    }, asio::detached);
+    io.run();
+
+    check(moved.body() == "sidecar.local 0", "mapped host not sent over the socket");
+    check(moved.redirect_chain() == std::vector<std::string>({"http://sidecar.local/echo"}),
+          "redirect did not keep the host name");
+    check(server.connections == 1, "redirect did not reuse the socket connection");
+
+    std::cout << "✓ Host mapping test passed\n";
+    return 0;
+}
+
+int test_unpooled_file_and_events() {
+    std::cout << "Test: unpooled file upload and event stream\n";
+
+    asio::io_context io;
+    std::string path = socket_path("stream");
+    UnixLoopbackServer server(io, unix_response, UnixSocket::endpoint_type(path));
+    ClientConfig config;
+    config.enable_connection_pool = false;
+    CoroHttpClient client(io, config);
+    std::string base = "http+unix://" + url_encode(path);
+
+    std::string file_path = path + ".body";
+    std::ofstream(file_path, std::ios::binary) << std::string(300 * 1024, 'f');
+
+    std::string uploaded;
+    std::vector<std::string> events;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        HttpRequest upload(HttpMethod::PUT, base + "/echo");
+        upload.set_body_file(file_path);
+        uploaded = (co_await client.co_execute(std::move(upload))).body();
+        co_await client.co_stream_events(HttpRequest(HttpMethod::GET, base + "/events"),
+                                         [&](const SseEvent& event) { events.push_back(event.data); });
+        server.stop();
+    }, asio::detached);
+    io.run();
+    ::unlink(file_path.c_str());
+
+    check(uploaded == url_encode(path) + " " + std::to_string(300 * 1024), "file body not sent whole");
+    check(events == std::vector<std::string>({"one", "two"}), "events not delivered");
+    check(server.connections == 2, "unpooled requests shared a connection");
+
+    std::cout << "✓ Unpooled file and events test passed\n";
+    return 0;
+}
+
+int test_missing_socket() {
+    std::cout << "Test: a missing socket fails the request\n";
+
+    asio::io_context io;
+    ClientConfig config;
+    config.max_retries = 0;
+    CoroHttpClient client(io, config);
+
+    bool failed = false;
+    asio::co_spawn(io, [&]() -> asio::awaitable<void> {
+        try {
+            co_await client.co_get("http+unix://" + url_encode(socket_path("missing")) + "/");
+        } catch (const std::exception&) {
+            failed = true;
+        }
+    }, asio::detached);
+    io.run();
+
+    check(failed, "request to a missing socket did not fail");
+
+    std::cout << "✓ Missing socket test passed\n";
+    return 0;
+}
+
+int main() {
+    std::cout << "=== Unix Socket Tests ===\n\n";
+
+    try {
+        test_url_parsing();
+        test_pooled_requests();
+        test_host_mapping();
+        test_unpooled_file_and_events();
+        test_missing_socket();
+
+        std::cout << "\n=== All unix socket tests passed ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed: " << e.what() << "\n";
+        return 1;
+    }
+}